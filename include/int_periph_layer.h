@@ -81,6 +81,26 @@ typedef struct {
     volatile const uint32_t CALIB;
 } SYSTICK_t;
 
+/************************** DWT Peripheral register structure definition **************************/
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+    volatile uint32_t CPICNT;
+    volatile uint32_t EXCCNT;
+    volatile uint32_t SLEEPCNT;
+    volatile uint32_t LSUCNT;
+    volatile uint32_t FOLDCNT;
+    volatile const uint32_t PCSR;
+} DWT_t;
+
+/*********************** CORE_DEBUG Peripheral register structure definition **********************/
+typedef struct {
+    volatile uint32_t DHCSR;
+    volatile uint32_t DCRSR;
+    volatile uint32_t DCRDR;
+    volatile uint32_t DEMCR;
+} CORE_DEBUG_t;
+
 
 /**************************************************************************************************/
 /*                                 Internal Peripheral Declaration                                */
@@ -90,6 +110,8 @@ typedef struct {
 #define SCNSCB                      ((SCNSCB_t *) SCS_BASE)
 #define SYSTICK                     ((SYSTICK_t *) SYSTICK_BASE)
 #define NVIC                        ((NVIC_t *) NVIC_BASE)
+#define DWT                         ((DWT_t *) DWT_BASE)
+#define CORE_DEBUG                  ((CORE_DEBUG_t *) CORE_DEBUG_BASE)
 
 
 /**************************************************************************************************/
@@ -531,6 +553,34 @@ typedef struct {
 #define SYSTICK_CALIB_NOREF         SYSTICK_CALIB_NOREF_Msk
 
 
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                   DATA WATCHPOINT AND TRACE (DWT)                              */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/****************************** Bits definition for DWT_CTRL register *****************************/
+#define DWT_CTRL_CYCCNTENA_Pos      (0U)
+#define DWT_CTRL_CYCCNTENA_Msk      (0x1UL << DWT_CTRL_CYCCNTENA_Pos)
+#define DWT_CTRL_CYCCNTENA          DWT_CTRL_CYCCNTENA_Msk
+
+#define DWT_CTRL_NOCYCCNT_Pos       (25U)
+#define DWT_CTRL_NOCYCCNT_Msk       (0x1UL << DWT_CTRL_NOCYCCNT_Pos)
+#define DWT_CTRL_NOCYCCNT           DWT_CTRL_NOCYCCNT_Msk
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                             CORE DEBUG                                         */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/************************** Bits definition for CORE_DEBUG_DEMCR register *************************/
+#define CORE_DEBUG_DEMCR_TRCENA_Pos (24U)
+#define CORE_DEBUG_DEMCR_TRCENA_Msk (0x1UL << CORE_DEBUG_DEMCR_TRCENA_Pos)
+#define CORE_DEBUG_DEMCR_TRCENA     CORE_DEBUG_DEMCR_TRCENA_Msk
+
+
 
 
 /* end C linkage and return to C++ linkage */
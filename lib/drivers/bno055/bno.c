@@ -28,6 +28,20 @@ static Status BNO_Write_Reg_Retry(
     uint8_t        *data
 );
 
+/**************************************************************************************************/
+/*                                    Read-Through Cache State                                    */
+/**************************************************************************************************/
+
+/** @brief Latest raw values of each output data block, the time they were read and their stats */
+static int16_t           g_bno_cache_raw[BNO_CACHE_COUNT][BNO_CACHE_VALUES_MAX];
+static uint64_t          g_bno_cache_read_us[BNO_CACHE_COUNT];
+static uint16_t          g_bno_cache_valid_mask = 0U;
+static BNO_Cache_Stats_t g_bno_cache_stats;
+
+/** @brief Shadow of the UNIT_SEL register, so conversions do not need a read per call */
+static uint8_t g_bno_unit_sel       = 0U;
+static uint8_t g_bno_unit_sel_valid = 0U;
+
 /**************************************************************************************************/
 /*                                      Core Helper Functions                                     */
 /**************************************************************************************************/
@@ -299,6 +313,90 @@ static Status BNO_Write_Reg_Retry(
     return SUCCESS;
 }
 
+/**
+ * @brief  Starts a read command to the BNO055 via USART without waiting for the response
+ * @param  usart:  Pointer to a struct containing USART settings
+ * @param  reg:    Address of the register to be read
+ * @param  length: Number of bytes to be read
+ * @param  data:   Pointer to an array that will be used to store the retrieved read values
+ * @retval Status indicating success, invalid parameters or error
+ * @note   The data array should be initialised as data[BNO_RESPONSE_HEADER_LENGTH + length] and
+ *         must remain valid until @ref BNO_Read_Reg_Poll reports completion
+ * @note   Returns ERROR if the USART is still transmitting or receiving. Safe to call from an
+ *         interrupt handler with a higher priority than the USART interrupt
+ */
+Status BNO_Read_Reg_Start(USART_Config_t *usart, uint8_t reg, uint16_t length, uint8_t *data) {
+    CHECK_STATUS(Validate_Ptr(data));
+    if (length <= 0U) {
+        return INVALID_PARAM;
+    }
+
+    //get current global USART state and check the bus is idle
+    volatile USART_State_t *current_state = NULL;
+    CHECK_STATUS(USART_Get_State(usart, &current_state));
+    if ((current_state->tx_status == USART_TX_BUSY)
+    ||  (current_state->rx_status == USART_RX_BUSY)) {
+        return ERROR;
+    }
+
+    //arm reception before the command, as the response follows the command directly
+    data[0] = 0U;
+    CHECK_STATUS(USART_Receive_IRQ(usart, data, BNO_RESPONSE_HEADER_LENGTH + length));
+
+    //compose and transmit the read command
+    uint8_t read_cmd[] = {0xAAU, 0x01U, reg, length};
+    CHECK_STATUS(USART_Transmit_IRQ(usart, read_cmd, 4U));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Checks whether a read started via @ref BNO_Read_Reg_Start has completed
+ * @param  usart:    Pointer to a struct containing USART settings
+ * @param  data:     Pointer to the array passed to @ref BNO_Read_Reg_Start
+ * @param  complete: Pointer to a variable set to 1U once the response has been received
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR once the BNO055 responds with an error, which is only
+ *         BNO_RESPONSE_HEADER_LENGTH bytes long, so the reception is aborted rather than left to
+ *         wait for data bytes that will never arrive
+ */
+Status BNO_Read_Reg_Poll(USART_Config_t *usart, uint8_t *data, uint8_t *complete) {
+    CHECK_STATUS(Validate_Ptr(data));
+    CHECK_STATUS(Validate_Ptr(complete));
+
+    volatile USART_State_t *current_state = NULL;
+    CHECK_STATUS(USART_Get_State(usart, &current_state));
+
+    //check for an error response while the data bytes are outstanding
+    *complete = 0U;
+    if (current_state->rx_status == USART_RX_BUSY) {
+        if ((current_state->rx_index >= BNO_RESPONSE_HEADER_LENGTH) && (data[0] == 0xEEU)) {
+            CHECK_STATUS(USART_Abort_Receive_IRQ(usart));
+            *complete = 1U;
+            return ERROR;
+        }
+        return SUCCESS;
+    }
+
+    *complete = 1U;
+    if (data[0] != 0xBBU) {
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Aborts a read started via @ref BNO_Read_Reg_Start
+ * @param  usart: Pointer to a struct containing USART settings
+ * @retval Status indicating success or invalid parameters
+ */
+Status BNO_Read_Reg_Abort(USART_Config_t *usart) {
+    CHECK_STATUS(USART_Abort_Receive_IRQ(usart));
+
+    return SUCCESS;
+}
+
 /**
  * @brief  Selects either page 0 or page 1 on the register map
  * @param  usart:   Pointer to a struct containing USART settings
@@ -474,6 +572,7 @@ Status BNO_Init(USART_Config_t *usart, BNO_Config_t *bno_config) {
     CHECK_STATUS(Validate_Enum(bno_config->pwr_mode, BNO_PWR_NORMAL_MODE, BNO_PWR_SUSPEND_MODE));
 
     CHECK_STATUS(BNO_Select_Page(usart, BNO_PAGE_0));
+    CHECK_STATUS(BNO_Invalidate_Cache());
 
     //configure power mode
     uint8_t clear_pwr_mode_val[] = {(~((uint8_t) BNO_PWR_MODE))};
@@ -617,14 +716,25 @@ Status BNO_MAG_Init(USART_Config_t *usart, BNO_MAG_Config_t *mag_config) {
 }
 
 /**
- * @brief  Initialises the mag
+ * @brief  Initialises the gyr
  * @param  usart:      Pointer to a struct containing USART settings
  * @param  gyr_config: Pointer to a struct containing gyr init settings
  * @retval Status indicating success, invalid parameters or error
+ * @note   The GYR_Config registers are on page 1, and are only applied outside the fusion modes,
+ *         which configure the gyr themselves. The bandwidth also sets the output data rate, e.g.
+ *         BNO_GYR_BW_32_HZ outputs at 100 Hz, BNO_GYR_BW_64_HZ at 200 Hz and BNO_GYR_BW_47_HZ at
+ *         400 Hz
  */
 Status BNO_GYR_Init(USART_Config_t *usart, BNO_GYR_Config_t *gyr_config) {
     CHECK_STATUS(BNO_Validate_GYR_Avail(usart));
     CHECK_STATUS(Validate_Ptr(gyr_config));
+    CHECK_STATUS(Validate_Enum(gyr_config->gyr_range, BNO_GYR_RANGE_2000_DPS, BNO_GYR_RANGE_125_DPS));
+    CHECK_STATUS(Validate_Enum(gyr_config->gyr_bw, BNO_GYR_BW_523_HZ, BNO_GYR_BW_32_HZ));
+    CHECK_STATUS(Validate_Enum(
+        gyr_config->gyr_pwr_mode, 
+        BNO_GYR_PWR_MODE_NORMAL, 
+        BNO_GYR_PWR_MODE_ADV_PWRSAVE
+    ));
 
     CHECK_STATUS(BNO_Select_Page(usart, BNO_PAGE_0));
 
@@ -632,42 +742,33 @@ Status BNO_GYR_Init(USART_Config_t *usart, BNO_GYR_Config_t *gyr_config) {
     uint8_t current_opr_mode = 0U;
     CHECK_STATUS(BNO_Set_Config_Mode(usart, &current_opr_mode));
 
+    CHECK_STATUS(BNO_Select_Page(usart, BNO_PAGE_1));
+
     //configure range
-    CHECK_STATUS(Validate_Enum(gyr_config->gyr_range, BNO_GYR_RANGE_2000_DPS, BNO_GYR_RANGE_125_DPS));
     CHECK_STATUS(BNO_Set_Setting(
         usart, 
         BNO_GYR_CONFIG_0_REG, 
         BNO_GYR_CONFIG_0_RANGE, 
-        (uint8_t) gyr_config->gyr_range
+        (uint8_t) (gyr_config->gyr_range << BNO_GYR_CONFIG_0_RANGE_Pos)
     ));
 
     //configure bandwidth
-    CHECK_STATUS(Validate_Enum(
-        gyr_config->gyr_bw, 
-        BNO_GYR_BW_523_HZ, 
-        BNO_GYR_BW_32_HZ
-    ));
     CHECK_STATUS(BNO_Set_Setting(
         usart, 
         BNO_GYR_CONFIG_0_REG, 
         BNO_GYR_CONFIG_0_BW, 
-        (uint8_t) gyr_config->gyr_bw
+        (uint8_t) (gyr_config->gyr_bw << BNO_GYR_CONFIG_0_BW_Pos)
     ));
 
     //configure power mode
-    CHECK_STATUS(Validate_Enum(
-        gyr_config->gyr_pwr_mode, 
-        BNO_GYR_PWR_MODE_NORMAL, 
-        BNO_GYR_PWR_MODE_ADV_PWRSAVE
-    ));
     CHECK_STATUS(BNO_Set_Setting(
         usart, 
         BNO_GYR_CONFIG_1_REG, 
         BNO_GYR_CONFIG_1_PWR_MODE, 
-        (uint8_t) gyr_config->gyr_pwr_mode
+        (uint8_t) (gyr_config->gyr_pwr_mode << BNO_GYR_CONFIG_1_PWR_MODE_Pos)
     ));
 
-    //restore previous operating mode
+    //restore previous operating mode, which selects page 0 again
     CHECK_STATUS(BNO_Set_OPR_Mode(usart, current_opr_mode));
 
     return SUCCESS;
@@ -734,6 +835,9 @@ Status BNO_Set_OPR_Mode(USART_Config_t *usart, BNO_OPR_Mode opr_mode) {
     uint8_t current_opr_mode = 0U;
     CHECK_STATUS(BNO_Get_OPR_Mode(usart, &current_opr_mode));
 
+    //drop the cached values, as the fusion outputs are not updated outside the fusion modes
+    CHECK_STATUS(BNO_Invalidate_Cache());
+
     //write operating mode selection
     uint8_t setting_val = ((uint8_t) opr_mode);
     CHECK_STATUS(BNO_Set_Setting(usart, BNO_OPR_MODE_REG, BNO_OPR_MODE, setting_val));
@@ -1748,6 +1852,55 @@ Status BNO_Set_GYR_Offset(USART_Config_t *usart, BNO_Offset_t *gyr_offset) {
     return BNO_Set_Offset(usart, BNO_GYR, gyr_offset);
 }
 
+/**
+ * @brief  Sets the mag soft-iron matrix and offset in a single register write
+ * @param  usart:      Pointer to a struct containing USART settings
+ * @param  sic:        Pointer to a struct containing the soft-iron matrix in row-major order, where
+ *                     BNO_SIC_ONE is 1.0
+ * @param  mag_offset: Pointer to a struct containing mag offset data
+ * @retval Status indicating success, invalid parameters or error
+ * @note   The SIC_MATRIX and MAG_OFFSET registers enclose the ACC_OFFSET registers, so those are
+ *         read first and written back unchanged with the rest of the block
+ */
+Status BNO_Set_MAG_SIC_Offset(
+    USART_Config_t   *usart,
+    BNO_SIC_Matrix_t *sic,
+    BNO_Offset_t     *mag_offset
+) {
+    CHECK_STATUS(Validate_Ptr(sic));
+    CHECK_STATUS(Validate_Ptr(mag_offset));
+
+    CHECK_STATUS(BNO_Select_Page(usart, BNO_PAGE_0));
+
+    //save operating mode and switch to CONFIG_MODE
+    uint8_t current_opr_mode = 0U;
+    CHECK_STATUS(BNO_Set_Config_Mode(usart, &current_opr_mode));
+
+    //read the whole block, so the enclosed acc offset is preserved
+    uint8_t block[BNO_RESPONSE_HEADER_LENGTH + BNO_SIC_OFFSET_LENGTH] = {0};
+    CHECK_STATUS(BNO_Read_Reg(usart, BNO_SIC_MATRIX_LSB0_REG, BNO_SIC_OFFSET_LENGTH, block));
+    uint8_t *data = &block[BNO_RESPONSE_HEADER_LENGTH];
+
+    //compose the soft-iron matrix and mag offset, then write the block
+    for (uint8_t i = 0U; i < 9U; i++) {
+        data[2U * i]        = (uint8_t) (sic->sic[i] & 0xFF);
+        data[(2U * i) + 1U] = (uint8_t) ((sic->sic[i] >> 8U) & 0xFF);
+    }
+    uint8_t mag_index = (BNO_MAG_OFFSET_X_LSB_REG - BNO_SIC_MATRIX_LSB0_REG);
+    data[mag_index]      = (uint8_t) (mag_offset->offset_x & 0xFF);
+    data[mag_index + 1U] = (uint8_t) ((mag_offset->offset_x >> 8U) & 0xFF);
+    data[mag_index + 2U] = (uint8_t) (mag_offset->offset_y & 0xFF);
+    data[mag_index + 3U] = (uint8_t) ((mag_offset->offset_y >> 8U) & 0xFF);
+    data[mag_index + 4U] = (uint8_t) (mag_offset->offset_z & 0xFF);
+    data[mag_index + 5U] = (uint8_t) ((mag_offset->offset_z >> 8U) & 0xFF);
+    CHECK_STATUS(BNO_Write_Reg(usart, BNO_SIC_MATRIX_LSB0_REG, BNO_SIC_OFFSET_LENGTH, data));
+
+    //restore previous operating mode
+    CHECK_STATUS(BNO_Set_OPR_Mode(usart, current_opr_mode));
+
+    return SUCCESS;
+}
+
 /**
  * @brief  Gets the radius of a particular sensor
  * @param  usart:  Pointer to a struct containing USART settings
@@ -1920,35 +2073,47 @@ Status BNO_Transmit_Calib_Profile(USART_Config_t *usart_term_config, BNO_Calib_P
     volatile USART_State_t *current_state = NULL;
     CHECK_STATUS(USART_Get_State(usart_term_config, &current_state));
 
-    //compose and transmit message
-    uint8_t profile_msg[TX_BUFFER_SIZE] = {0};
-    snprintf(
-        (char *) profile_msg, sizeof(profile_msg), 
-        "ACC Offset Values\n\r"
-        "x-axis -> %6i\n\r"
-        "y-axis -> %6i\n\r"
-        "z-axis -> %6i\n\r"
-        "MAG Offset Values\n\r"
-        "x-axis -> %6i\n\r"
-        "y-axis -> %6i\n\r"
-        "z-axis -> %6i\n\r"
-        "GYR Offset Values\n\r"
-        "x-axis -> %6i\n\r"
-        "y-axis -> %6i\n\r"
-        "z-axis -> %6i\n\r"
-        "ACC Radius Values\n\r"
-        "lsb    -> %6i\n\r"
-        "msb    -> %6i\n\r"
-        "MAG Radius Values\n\r"
-        "lsb    -> %6i\n\r"
-        "msb    -> %6i\n\n\n\r",
-        profile->acc_offset->offset_x, profile->acc_offset->offset_y, profile->acc_offset->offset_z,
-        profile->mag_offset->offset_x, profile->mag_offset->offset_y, profile->mag_offset->offset_z,
-        profile->gyr_offset->offset_x, profile->gyr_offset->offset_y, profile->gyr_offset->offset_z,
-        profile->acc_radius->radius_lsb, profile->acc_radius->radius_msb,
-        profile->mag_radius->radius_lsb, profile->mag_radius->radius_msb
-    );
-    CHECK_STATUS(USART_Transmit_IRQ(usart_term_config, profile_msg, strlen((char *) profile_msg)));
+    //wait for any previous transmission to complete
+    while (current_state->tx_status == USART_TX_BUSY) {}
+
+    //compose message directly in the TX buffer
+    uint8_t *tx_buffer = NULL;
+    CHECK_STATUS(USART_Get_TX_Buffer(usart_term_config, &tx_buffer));
+    FMT_Frame_t msg;
+    CHECK_STATUS(FMT_Frame_Init(&msg, tx_buffer, TX_BUFFER_SIZE));
+
+    //append offset values
+    const char *offset_labels[] = {
+        "ACC Offset Values\n\r", "MAG Offset Values\n\r", "GYR Offset Values\n\r"
+    };
+    const char *axis_labels[] = {"x-axis -> ", "y-axis -> ", "z-axis -> "};
+    BNO_Offset_t *offsets[]   = {profile->acc_offset, profile->mag_offset, profile->gyr_offset};
+    for (int i = 0; i < 3; i++) {
+        int16_t axis_values[] = {offsets[i]->offset_x, offsets[i]->offset_y, offsets[i]->offset_z};
+        CHECK_STATUS(FMT_Frame_Append_Str(&msg, offset_labels[i]));
+        for (int j = 0; j < 3; j++) {
+            CHECK_STATUS(FMT_Frame_Append_Str(&msg, axis_labels[j]));
+            CHECK_STATUS(FMT_Frame_Append_Int(&msg, axis_values[j], 6U));
+            CHECK_STATUS(FMT_Frame_Append_Str(&msg, "\n\r"));
+        }
+    }
+
+    //append radius values
+    const char *radius_labels[] = {"ACC Radius Values\n\r", "MAG Radius Values\n\r"};
+    BNO_Radius_t *radii[]       = {profile->acc_radius, profile->mag_radius};
+    for (int i = 0; i < 2; i++) {
+        CHECK_STATUS(FMT_Frame_Append_Str(&msg, radius_labels[i]));
+        CHECK_STATUS(FMT_Frame_Append_Str(&msg, "lsb    -> "));
+        CHECK_STATUS(FMT_Frame_Append_Int(&msg, radii[i]->radius_lsb, 6U));
+        CHECK_STATUS(FMT_Frame_Append_Str(&msg, "\n\r"));
+        CHECK_STATUS(FMT_Frame_Append_Str(&msg, "msb    -> "));
+        CHECK_STATUS(FMT_Frame_Append_Int(&msg, radii[i]->radius_msb, 6U));
+        CHECK_STATUS(FMT_Frame_Append_Str(&msg, "\n\r"));
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(&msg, "\n\n\r"));
+
+    //transmit message
+    CHECK_STATUS(USART_Transmit_Buffer_IRQ(usart_term_config, msg.length));
 
     //wait for tx to complete
     while (current_state->tx_status == USART_TX_BUSY) {}
@@ -2202,6 +2367,72 @@ static Status BNO_Read_QUA_Value(USART_Config_t *usart, int16_t *qua_raw, BNO_QU
     return SUCCESS;
 }
 
+/**
+ * @brief  Reads the raw values of an output data block, from the cache if they are recent enough
+ * @param  usart:      Pointer to a struct containing USART settings
+ * @param  block:      Output data block to be read
+ * @param  max_age_us: Maximum age of the cached values in micro-seconds (0 always reads the bus)
+ * @param  raw:        Pointer to an array of BNO_CACHE_VALUES_MAX values used to store raw data
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Ages are measured with the DWT time, so values are never served from the cache if
+ *         DWT_Init() has not been called. Only reads with max_age_us > 0 are counted as hits or
+ *         misses
+ */
+static Status BNO_Read_Cached(
+    USART_Config_t  *usart,
+    BNO_Cache_Block block,
+    uint32_t        max_age_us,
+    int16_t         *raw
+) {
+    CHECK_STATUS(Validate_Ptr(raw));
+    CHECK_STATUS(Validate_Enum(block, BNO_CACHE_ACC, BNO_CACHE_QUA));
+
+    uint64_t now_us = 0ULL;
+    uint8_t  timed  = (DWT_Get_Time_US(&now_us) == SUCCESS);
+    uint8_t  valid  = ((g_bno_cache_valid_mask >> block) & 1U);
+
+    //serve the cached values if they are younger than the bound
+    if (max_age_us > 0UL) {
+        if (timed && valid && ((now_us - g_bno_cache_read_us[block]) < max_age_us)) {
+            for (uint8_t i = 0U; i < BNO_CACHE_VALUES_MAX; i++) {
+                raw[i] = g_bno_cache_raw[block][i];
+            }
+            g_bno_cache_stats.hits[block]++;
+            return SUCCESS;
+        }
+        g_bno_cache_stats.misses[block]++;
+    }
+
+    //otherwise read the whole block in a single transaction
+    g_bno_cache_valid_mask &= (uint16_t) ~(1U << block);
+    if (block == BNO_CACHE_QUA) {
+        BNO_QUA_Raw_t qua_raw = {0, 0, 0, 0};
+        CHECK_STATUS(BNO_Read_QUA_All(usart, &qua_raw));
+        raw[0] = qua_raw.w_raw;
+        raw[1] = qua_raw.x_raw;
+        raw[2] = qua_raw.y_raw;
+        raw[3] = qua_raw.z_raw;
+    } else {
+        BNO_ODR_Raw_t odr_raw = {0, 0, 0};
+        CHECK_STATUS(BNO_Read_ODR_All(usart, &odr_raw, (BNO_ODR) block));
+        raw[0] = odr_raw.x_raw;
+        raw[1] = odr_raw.y_raw;
+        raw[2] = odr_raw.z_raw;
+        raw[3] = 0;
+    }
+
+    //refresh the cache
+    for (uint8_t i = 0U; i < BNO_CACHE_VALUES_MAX; i++) {
+        g_bno_cache_raw[block][i] = raw[i];
+    }
+    if (timed) {
+        g_bno_cache_read_us[block]  = now_us;
+        g_bno_cache_valid_mask     |= (uint16_t) (1U << block);
+    }
+
+    return SUCCESS;
+}
+
 
 /**************************************************************************************************/
 /*                          Sensor and Fusion Output Conversion Functions                         */
@@ -2304,22 +2535,40 @@ static Status BNO_Get_TEMP_Conv_Factor(USART_Config_t *usart, float *conv_factor
  * @param  usart:         Pointer to a struct containing USART settings
  * @param  acc_xyz_float: Pointer to a struct used to store acc data
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_ACC_XYZ_Cached
  */
 Status BNO_Get_ACC_XYZ(USART_Config_t *usart, BNO_ODR_Float_t *acc_xyz_float) {
+    return BNO_Get_ACC_XYZ_Cached(usart, 0UL, acc_xyz_float);
+}
+
+/**
+ * @brief  Reads x, y and z-axis acc values
+ * @param  usart:         Pointer to a struct containing USART settings
+ * @param  max_age_us:    Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  acc_xyz_float: Pointer to a struct used to store acc data
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_ACC_XYZ_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_ODR_Float_t *acc_xyz_float
+) {
     CHECK_STATUS(Validate_Ptr(acc_xyz_float));
 
-    //read raw values
-    BNO_ODR_Raw_t acc_xyz_raw = {0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_ODR_All(usart, &acc_xyz_raw, BNO_ODR_ACC));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t acc_xyz_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_ACC, max_age_us, acc_xyz_raw));
 
     //get conversion factor
     float conv_factor = 0.0f;
     CHECK_STATUS(BNO_Get_ACC_Conv_Factor(usart, &conv_factor));
 
     //perform conversion and store float values
-    acc_xyz_float->x_float = (((float) acc_xyz_raw.x_raw) / conv_factor);
-    acc_xyz_float->y_float = (((float) acc_xyz_raw.y_raw) / conv_factor);
-    acc_xyz_float->z_float = (((float) acc_xyz_raw.z_raw) / conv_factor);
+    acc_xyz_float->x_float = (((float) acc_xyz_raw[0]) / conv_factor);
+    acc_xyz_float->y_float = (((float) acc_xyz_raw[1]) / conv_factor);
+    acc_xyz_float->z_float = (((float) acc_xyz_raw[2]) / conv_factor);
 
     return SUCCESS;
 }
@@ -2392,18 +2641,36 @@ Status BNO_Get_ACC_Z(USART_Config_t *usart, float *acc_z_float) {
  * @param  usart:         Pointer to a struct containing USART settings
  * @param  mag_xyz_float: Pointer to a struct used to store mag data
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_MAG_XYZ_Cached
  */
 Status BNO_Get_MAG_XYZ(USART_Config_t *usart, BNO_ODR_Float_t *mag_xyz_float) {
+    return BNO_Get_MAG_XYZ_Cached(usart, 0UL, mag_xyz_float);
+}
+
+/**
+ * @brief  Reads x, y and z-axis mag values
+ * @param  usart:         Pointer to a struct containing USART settings
+ * @param  max_age_us:    Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  mag_xyz_float: Pointer to a struct used to store mag data
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_MAG_XYZ_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_ODR_Float_t *mag_xyz_float
+) {
     CHECK_STATUS(Validate_Ptr(mag_xyz_float));
 
-    //read raw values
-    BNO_ODR_Raw_t mag_xyz_raw = {0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_ODR_All(usart, &mag_xyz_raw, BNO_ODR_MAG));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t mag_xyz_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_MAG, max_age_us, mag_xyz_raw));
 
     //perform conversion and store float values
-    mag_xyz_float->x_float = (((float) mag_xyz_raw.x_raw) / BNO_MAG_UT);
-    mag_xyz_float->y_float = (((float) mag_xyz_raw.y_raw) / BNO_MAG_UT);
-    mag_xyz_float->z_float = (((float) mag_xyz_raw.z_raw) / BNO_MAG_UT);
+    mag_xyz_float->x_float = (((float) mag_xyz_raw[0]) / BNO_MAG_UT);
+    mag_xyz_float->y_float = (((float) mag_xyz_raw[1]) / BNO_MAG_UT);
+    mag_xyz_float->z_float = (((float) mag_xyz_raw[2]) / BNO_MAG_UT);
 
     return SUCCESS;
 }
@@ -2464,22 +2731,40 @@ Status BNO_Get_MAG_Z(USART_Config_t *usart, float *mag_z_float) {
  * @param  usart:         Pointer to a struct containing USART settings
  * @param  gyr_xyz_float: Pointer to a struct used to store gyr data
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_GYR_XYZ_Cached
  */
 Status BNO_Get_GYR_XYZ(USART_Config_t *usart, BNO_ODR_Float_t *gyr_xyz_float) {
+    return BNO_Get_GYR_XYZ_Cached(usart, 0UL, gyr_xyz_float);
+}
+
+/**
+ * @brief  Reads x, y and z-axis gyr values
+ * @param  usart:         Pointer to a struct containing USART settings
+ * @param  max_age_us:    Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  gyr_xyz_float: Pointer to a struct used to store gyr data
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_GYR_XYZ_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_ODR_Float_t *gyr_xyz_float
+) {
     CHECK_STATUS(Validate_Ptr(gyr_xyz_float));
 
-    //read raw values
-    BNO_ODR_Raw_t gyr_xyz_raw = {0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_ODR_All(usart, &gyr_xyz_raw, BNO_ODR_GYR));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t gyr_xyz_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_GYR, max_age_us, gyr_xyz_raw));
 
     //get conversion factor
     float conv_factor = 0.0f;
     CHECK_STATUS(BNO_Get_GYR_Conv_Factor(usart, &conv_factor));
 
     //perform conversion and store float values
-    gyr_xyz_float->x_float = (((float) gyr_xyz_raw.x_raw) / conv_factor);
-    gyr_xyz_float->y_float = (((float) gyr_xyz_raw.y_raw) / conv_factor);
-    gyr_xyz_float->z_float = (((float) gyr_xyz_raw.z_raw) / conv_factor);
+    gyr_xyz_float->x_float = (((float) gyr_xyz_raw[0]) / conv_factor);
+    gyr_xyz_float->y_float = (((float) gyr_xyz_raw[1]) / conv_factor);
+    gyr_xyz_float->z_float = (((float) gyr_xyz_raw[2]) / conv_factor);
 
     return SUCCESS;
 }
@@ -2552,22 +2837,40 @@ Status BNO_Get_GYR_Z(USART_Config_t *usart, float *gyr_z_float) {
  * @param  usart:         Pointer to a struct containing USART settings
  * @param  eul_hrp_float: Pointer to a struct used to store euler angles
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_EUL_HRP_Cached
  */
 Status BNO_Get_EUL_HRP(USART_Config_t *usart, BNO_ODR_Float_t *eul_hrp_float) {
+    return BNO_Get_EUL_HRP_Cached(usart, 0UL, eul_hrp_float);
+}
+
+/**
+ * @brief  Reads heading, roll and pitch euler values
+ * @param  usart:         Pointer to a struct containing USART settings
+ * @param  max_age_us:    Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  eul_hrp_float: Pointer to a struct used to store euler angles
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_EUL_HRP_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_ODR_Float_t *eul_hrp_float
+) {
     CHECK_STATUS(Validate_Ptr(eul_hrp_float));
 
-    //read raw values
-    BNO_ODR_Raw_t eul_hrp_raw = {0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_ODR_All(usart, &eul_hrp_raw, BNO_ODR_EUL));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t eul_hrp_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_EUL, max_age_us, eul_hrp_raw));
 
     //get conversion factor
     float conv_factor = 0.0f;
     CHECK_STATUS(BNO_Get_EUL_Conv_Factor(usart, &conv_factor));
 
     //perform conversion and store float values
-    eul_hrp_float->x_float = (((float) eul_hrp_raw.x_raw) / conv_factor);
-    eul_hrp_float->y_float = (((float) eul_hrp_raw.y_raw) / conv_factor);
-    eul_hrp_float->z_float = (((float) eul_hrp_raw.z_raw) / conv_factor);
+    eul_hrp_float->x_float = (((float) eul_hrp_raw[0]) / conv_factor);
+    eul_hrp_float->y_float = (((float) eul_hrp_raw[1]) / conv_factor);
+    eul_hrp_float->z_float = (((float) eul_hrp_raw[2]) / conv_factor);
 
     return SUCCESS;
 }
@@ -2640,19 +2943,37 @@ Status BNO_Get_EUL_Pitch(USART_Config_t *usart, float *eul_pitch_float) {
  * @param  usart:          Pointer to a struct containing USART settings
  * @param  qua_wxyz_float: Pointer to a struct used to store quaternion values
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_QUA_WXYZ_Cached
  */
 Status BNO_Get_QUA_WXYZ(USART_Config_t *usart, BNO_QUA_Float_t *qua_wxyz_float) {
+    return BNO_Get_QUA_WXYZ_Cached(usart, 0UL, qua_wxyz_float);
+}
+
+/**
+ * @brief  Reads w, x, y and z quaternion values
+ * @param  usart:          Pointer to a struct containing USART settings
+ * @param  max_age_us:     Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  qua_wxyz_float: Pointer to a struct used to store quaternion values
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_QUA_WXYZ_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_QUA_Float_t *qua_wxyz_float
+) {
     CHECK_STATUS(Validate_Ptr(qua_wxyz_float));
 
-    //read raw values
-    BNO_QUA_Raw_t qua_wxyz_raw = {0.0f, 0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_QUA_All(usart, &qua_wxyz_raw));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t qua_wxyz_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_QUA, max_age_us, qua_wxyz_raw));
 
     //perform conversion and store float values
-    qua_wxyz_float->w_float = (((float) qua_wxyz_raw.w_raw) / BNO_QUA_QUATERNIONS);
-    qua_wxyz_float->x_float = (((float) qua_wxyz_raw.x_raw) / BNO_QUA_QUATERNIONS);
-    qua_wxyz_float->y_float = (((float) qua_wxyz_raw.y_raw) / BNO_QUA_QUATERNIONS);
-    qua_wxyz_float->z_float = (((float) qua_wxyz_raw.z_raw) / BNO_QUA_QUATERNIONS);
+    qua_wxyz_float->w_float = (((float) qua_wxyz_raw[0]) / BNO_QUA_QUATERNIONS);
+    qua_wxyz_float->x_float = (((float) qua_wxyz_raw[1]) / BNO_QUA_QUATERNIONS);
+    qua_wxyz_float->y_float = (((float) qua_wxyz_raw[2]) / BNO_QUA_QUATERNIONS);
+    qua_wxyz_float->z_float = (((float) qua_wxyz_raw[3]) / BNO_QUA_QUATERNIONS);
 
     return SUCCESS;
 }
@@ -2730,22 +3051,40 @@ Status BNO_Get_QUA_Z(USART_Config_t *usart, float *qua_z_float) {
  * @param  usart:         Pointer to a struct containing USART settings
  * @param  lia_xyz_float: Pointer to a struct used to store linear acceleration data
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_LIA_XYZ_Cached
  */
 Status BNO_Get_LIA_XYZ(USART_Config_t *usart, BNO_ODR_Float_t *lia_xyz_float) {
+    return BNO_Get_LIA_XYZ_Cached(usart, 0UL, lia_xyz_float);
+}
+
+/**
+ * @brief  Reads x, y and z-axis linear acceleration values
+ * @param  usart:         Pointer to a struct containing USART settings
+ * @param  max_age_us:    Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  lia_xyz_float: Pointer to a struct used to store linear acceleration data
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_LIA_XYZ_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_ODR_Float_t *lia_xyz_float
+) {
     CHECK_STATUS(Validate_Ptr(lia_xyz_float));
 
-    //read raw value
-    BNO_ODR_Raw_t lia_xyz_raw = {0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_ODR_All(usart, &lia_xyz_raw, BNO_ODR_LIA));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t lia_xyz_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_LIA, max_age_us, lia_xyz_raw));
 
     //get conversion factor
     float conv_factor = 0.0f;
     CHECK_STATUS(BNO_Get_ACC_Conv_Factor(usart, &conv_factor));
 
     //perform conversion and store float values
-    lia_xyz_float->x_float = (((float) lia_xyz_raw.x_raw) / conv_factor);
-    lia_xyz_float->y_float = (((float) lia_xyz_raw.y_raw) / conv_factor);
-    lia_xyz_float->z_float = (((float) lia_xyz_raw.z_raw) / conv_factor);
+    lia_xyz_float->x_float = (((float) lia_xyz_raw[0]) / conv_factor);
+    lia_xyz_float->y_float = (((float) lia_xyz_raw[1]) / conv_factor);
+    lia_xyz_float->z_float = (((float) lia_xyz_raw[2]) / conv_factor);
 
     return SUCCESS;
 }
@@ -2818,22 +3157,40 @@ Status BNO_Get_LIA_Z(USART_Config_t *usart, float *lia_z_float) {
  * @param  usart:         Pointer to a struct containing USART settings
  * @param  grv_xyz_float: Pointer to a struct used to store gravity vector data 
  * @retval Status indicating success, invalid parameters or error
+ * @note   Always reads the bus, see @ref BNO_Get_GRV_XYZ_Cached
  */
 Status BNO_Get_GRV_XYZ(USART_Config_t *usart, BNO_ODR_Float_t *grv_xyz_float) {
+    return BNO_Get_GRV_XYZ_Cached(usart, 0UL, grv_xyz_float);
+}
+
+/**
+ * @brief  Reads x, y and z axis gravity vector values
+ * @param  usart:         Pointer to a struct containing USART settings
+ * @param  max_age_us:    Maximum age of cached values in micro-seconds (0 always reads the bus)
+ * @param  grv_xyz_float: Pointer to a struct used to store gravity vector data 
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A bus read refreshes the cache in a single transaction, as the unit selection is
+ *         also cached
+ */
+Status BNO_Get_GRV_XYZ_Cached(
+    USART_Config_t  *usart,
+    uint32_t        max_age_us,
+    BNO_ODR_Float_t *grv_xyz_float
+) {
     CHECK_STATUS(Validate_Ptr(grv_xyz_float));
 
-    //read raw value
-    BNO_ODR_Raw_t grv_xyz_raw = {0.0f, 0.0f, 0.0f};
-    CHECK_STATUS(BNO_Read_ODR_All(usart, &grv_xyz_raw, BNO_ODR_GRV));
+    //read raw values, from the cache if they are younger than max_age_us
+    int16_t grv_xyz_raw[BNO_CACHE_VALUES_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Cached(usart, BNO_CACHE_GRV, max_age_us, grv_xyz_raw));
 
     //get conversion factor
     float conv_factor = 0.0f;
     CHECK_STATUS(BNO_Get_ACC_Conv_Factor(usart, &conv_factor));
 
     //perform conversion and store float values
-    grv_xyz_float->x_float = (((float) grv_xyz_raw.x_raw) / conv_factor);
-    grv_xyz_float->y_float = (((float) grv_xyz_raw.y_raw) / conv_factor);
-    grv_xyz_float->z_float = (((float) grv_xyz_raw.z_raw) / conv_factor);
+    grv_xyz_float->x_float = (((float) grv_xyz_raw[0]) / conv_factor);
+    grv_xyz_float->y_float = (((float) grv_xyz_raw[1]) / conv_factor);
+    grv_xyz_float->z_float = (((float) grv_xyz_raw[2]) / conv_factor);
 
     return SUCCESS;
 }
@@ -2925,6 +3282,39 @@ Status BNO_Get_TEMP(USART_Config_t *usart, float *temp_float) {
 }
 
 
+/**************************************************************************************************/
+/*                                  Read-Through Cache Functions                                  */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the read-through cache hit and miss counts of each output data block
+ * @param  stats: Pointer to a struct used to store the counts
+ * @retval Status indicating success or invalid parameters
+ * @note   A high miss count for a block read at a known rate suggests its max_age_us bound is
+ *         below the read period
+ */
+Status BNO_Get_Cache_Stats(BNO_Cache_Stats_t *stats) {
+    CHECK_STATUS(Validate_Ptr(stats));
+
+    *stats = g_bno_cache_stats;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Invalidates every cached output data block and the unit selection shadow
+ * @retval Status indicating success
+ * @note   Called by the driver whenever the operating mode or the units change. Should also be
+ *         called after writing the output or unit registers with @ref BNO_Write_Reg
+ */
+Status BNO_Invalidate_Cache(void) {
+    g_bno_cache_valid_mask = 0U;
+    g_bno_unit_sel_valid   = 0U;
+
+    return SUCCESS;
+}
+
+
 /**************************************************************************************************/
 /*                                    Unit Selection Functions                                    */
 /**************************************************************************************************/
@@ -2966,6 +3356,9 @@ static Status BNO_Set_Unit(USART_Config_t *usart, BNO_Unit unit) {
     uint8_t current_opr_mode = 0U;
     CHECK_STATUS(BNO_Set_Config_Mode(usart, &current_opr_mode));
 
+    //drop the UNIT_SEL shadow and the cached values, which were read in the previous units
+    CHECK_STATUS(BNO_Invalidate_Cache());
+
     //write unit setting
     uint8_t mask        = (0x01U << unit_offset);
     uint8_t setting_val = (write_val << unit_offset);
@@ -3002,10 +3395,19 @@ static Status BNO_Get_Unit(USART_Config_t *usart, BNO_Unit_DO data_output, uint8
         unit_offset = 7U;
     }
 
-    //read UNIT_SEL value and extract relevant bit
-    uint8_t reg_val_og[BNO_RESPONSE_HEADER_LENGTH + BNO_GENERIC_RW_LENGTH] = {0};
-    CHECK_STATUS(BNO_Read_Reg(usart, BNO_UNIT_SEL_REG, 1U, reg_val_og));
-    uint8_t reg_val_ex = (reg_val_og[2] & (1U << unit_offset));
+    //read UNIT_SEL value once, then use its shadow until the units are changed
+    if (!g_bno_unit_sel_valid) {
+        uint8_t reg_val_og[BNO_RESPONSE_HEADER_LENGTH + BNO_GENERIC_RW_LENGTH] = {0};
+        CHECK_STATUS(BNO_Read_Reg(usart, BNO_UNIT_SEL_REG, 1U, reg_val_og));
+        if (reg_val_og[0] != 0xBBU) {
+            return ERROR;
+        }
+        g_bno_unit_sel       = reg_val_og[2];
+        g_bno_unit_sel_valid = 1U;
+    }
+
+    //extract relevant bit
+    uint8_t reg_val_ex = (g_bno_unit_sel & (1U << unit_offset));
 
     //store the extracted bit
     if (reg_val_ex == 0U) {
@@ -3323,6 +3725,23 @@ Status BNO_Reset_IRQ(USART_Config_t *usart) {
     return SUCCESS;
 }
 
+/**
+ * @brief  Releases the INT pin without changing the operating mode
+ * @param  usart: Pointer to a struct containing USART settings
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Unlike @ref BNO_Reset_IRQ, this is a single write to SYS_TRIGGER (page 0), which is
+ *         writable in any operating mode. It is intended for interrupt-driven acquisition, where
+ *         the INT pin must be released after every event
+ * @note   Assumes register page 0 is selected, so no page read is needed
+ */
+Status BNO_Clear_INT(USART_Config_t *usart) {
+    //set reset interrupt bit
+    uint8_t reg_val = BNO_SYS_TRIGGER_RST_INT;
+    CHECK_STATUS(BNO_Write_Reg(usart, BNO_SYS_TRIGGER_REG, 1U, &reg_val));
+
+    return SUCCESS;
+}
+
 /**
  * @brief  Gets the status of a particular BNO055 interrupt
  * @param  usart:  Pointer to a struct containing USART settings
@@ -3345,6 +3764,30 @@ Status BNO_Get_IRQ_Status(USART_Config_t *usart, BNO_IRQ irq, uint8_t *status) {
     return SUCCESS;
 }
 
+/**
+ * @brief  Gets the status of all BNO055 interrupts with a single read of INT_STA
+ * @param  usart:  Pointer to a struct containing USART settings
+ * @param  status: Pointer to a variable used to store INT_STA, one bit per @ref BNO_IRQ
+ * @retval Status indicating success, invalid parameters or error
+ * @note   INT_STA is cleared on read, so every set bit must be handled from this one value
+ * @note   Assumes register page 0 is selected, so no page read is needed
+ * @note   Returns ERROR, leaving status unchanged, if the response is not a read success (0xBB),
+ *         so a failed read is not taken for a set of pending interrupts
+ */
+Status BNO_Get_IRQ_Status_All(USART_Config_t *usart, uint8_t *status) {
+    CHECK_STATUS(Validate_Ptr(status));
+
+    //read INT_STA, then check the response header before using its value
+    uint8_t data[BNO_RESPONSE_HEADER_LENGTH + BNO_GENERIC_RW_LENGTH] = {0};
+    CHECK_STATUS(BNO_Read_Reg(usart, BNO_INT_STA_REG, 1U, data));
+    if (data[0] != 0xBBU) {
+        return ERROR;
+    }
+    *status = data[2];
+
+    return SUCCESS;
+}
+
 /**
  * @brief  Enables masking for a specified interrupt, allowing it to trigger the INT pin
  * @param  usart:  Pointer to a struct containing USART settings
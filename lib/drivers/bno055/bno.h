@@ -16,6 +16,8 @@
 
 #include <stdint.h>
 #include "../usart/usart.h"
+#include "../dwt/dwt.h"
+#include "../../utils/fmt.h"
 
 
 /**************************************************************************************************/
@@ -236,6 +238,17 @@ typedef enum {
     BNO_QUA_Z
 } BNO_QUA_Value;
 
+typedef enum {
+    BNO_CACHE_ACC,
+    BNO_CACHE_MAG,
+    BNO_CACHE_GYR,
+    BNO_CACHE_EUL,
+    BNO_CACHE_LIA,
+    BNO_CACHE_GRV,
+    BNO_CACHE_QUA,
+    BNO_CACHE_COUNT
+} BNO_Cache_Block;
+
 /************************************* Axis Remap Enumerations ************************************/
 typedef enum {
     BNO_AXIS_X,
@@ -334,6 +347,10 @@ typedef struct {
     int8_t radius_msb;
 } BNO_Radius_t;
 
+typedef struct {
+    int16_t sic[9];
+} BNO_SIC_Matrix_t;
+
 typedef struct {
     BNO_Offset_t *acc_offset;
     BNO_Offset_t *mag_offset;
@@ -369,6 +386,12 @@ typedef struct {
     float z_float;
 } BNO_QUA_Float_t;
 
+/********************************** Read-Through Cache Structures *********************************/
+typedef struct {
+    uint32_t hits[BNO_CACHE_COUNT];
+    uint32_t misses[BNO_CACHE_COUNT];
+} BNO_Cache_Stats_t;
+
 /************************************** Interrupt Structures **************************************/
 typedef struct {
     BNO_SM_NM_Det_Type det_type;
@@ -600,8 +623,13 @@ typedef struct {
 #define BNO_GYR_DATA_LENGTH         ((uint8_t) 6U)
 #define BNO_AMG_DATA_LENGTH         ((uint8_t) 6U)
 #define BNO_QUA_DATA_LENGTH         ((uint8_t) 8U)
+#define BNO_SIC_DATA_LENGTH         ((uint8_t) 18U)
+#define BNO_SIC_OFFSET_LENGTH       ((uint8_t) 30U)
 #define BNO_RESPONSE_HEADER_LENGTH  ((uint8_t) 2U)
 
+/*************************************** Read-Through Cache ***************************************/
+#define BNO_CACHE_VALUES_MAX        4U
+
 /****************************************** Unit settings *****************************************/
 #define BNO_ACC_MS                  (100.0f)
 #define BNO_ACC_MG                  (1.0f)
@@ -617,6 +645,7 @@ typedef struct {
 #define BNO_GRV_MG                  BNO_ACC_MG
 #define BNO_TEMP_CEL                (1.0f)
 #define BNO_TEMP_FAH                (0.5f)
+#define BNO_SIC_ONE                 (16384.0f)
 
 
 
@@ -1153,8 +1182,11 @@ typedef struct {
 /**************************************************************************************************/
 
 /********************************** Register Read/Write Functions *********************************/
-Status BNO_Read_Reg (USART_Config_t *usart, uint8_t reg, uint16_t length, uint8_t *data);
-Status BNO_Write_Reg(USART_Config_t *usart, uint8_t reg, uint16_t length, uint8_t *data);
+Status BNO_Read_Reg      (USART_Config_t *usart, uint8_t reg, uint16_t length, uint8_t *data);
+Status BNO_Write_Reg     (USART_Config_t *usart, uint8_t reg, uint16_t length, uint8_t *data);
+Status BNO_Read_Reg_Start(USART_Config_t *usart, uint8_t reg, uint16_t length, uint8_t *data);
+Status BNO_Read_Reg_Poll (USART_Config_t *usart, uint8_t *data, uint8_t *complete);
+Status BNO_Read_Reg_Abort(USART_Config_t *usart);
 
 /*************************** Sensor and System Initialisation Functions ***************************/
 Status BNO_Init    (USART_Config_t *usart, BNO_Config_t *bno_config);
@@ -1219,6 +1251,12 @@ Status BNO_Set_MAG_Offset(USART_Config_t *usart, BNO_Offset_t *mag_offset);
 Status BNO_Get_GYR_Offset(USART_Config_t *usart, BNO_Offset_t *gyr_offset);
 Status BNO_Set_GYR_Offset(USART_Config_t *usart, BNO_Offset_t *gyr_offset);
 
+Status BNO_Set_MAG_SIC_Offset(
+    USART_Config_t   *usart,
+    BNO_SIC_Matrix_t *sic,
+    BNO_Offset_t     *mag_offset
+);
+
 Status BNO_Get_ACC_Radius(USART_Config_t *usart, BNO_Radius_t *acc_radius);
 Status BNO_Set_MAG_Radius(USART_Config_t *usart, BNO_Radius_t *mag_radius);
 
@@ -1273,6 +1311,17 @@ Status BNO_Get_GRV_Z  (USART_Config_t *usart, float *grv_z_float);
 
 Status BNO_Get_TEMP   (USART_Config_t *usart, float *temp_float);
 
+/********************************** Read-Through Cache Functions **********************************/
+Status BNO_Get_ACC_XYZ_Cached (USART_Config_t *usart, uint32_t max_age_us, BNO_ODR_Float_t *acc_xyz_float);
+Status BNO_Get_MAG_XYZ_Cached (USART_Config_t *usart, uint32_t max_age_us, BNO_ODR_Float_t *mag_xyz_float);
+Status BNO_Get_GYR_XYZ_Cached (USART_Config_t *usart, uint32_t max_age_us, BNO_ODR_Float_t *gyr_xyz_float);
+Status BNO_Get_EUL_HRP_Cached (USART_Config_t *usart, uint32_t max_age_us, BNO_ODR_Float_t *eul_hrp_float);
+Status BNO_Get_QUA_WXYZ_Cached(USART_Config_t *usart, uint32_t max_age_us, BNO_QUA_Float_t *qua_wxyz_float);
+Status BNO_Get_LIA_XYZ_Cached (USART_Config_t *usart, uint32_t max_age_us, BNO_ODR_Float_t *lia_xyz_float);
+Status BNO_Get_GRV_XYZ_Cached (USART_Config_t *usart, uint32_t max_age_us, BNO_ODR_Float_t *grv_xyz_float);
+Status BNO_Get_Cache_Stats    (BNO_Cache_Stats_t *stats);
+Status BNO_Invalidate_Cache   (void);
+
 /************************************ Unit Selection Functions ************************************/
 Status BNO_Set_ACC_Unit (USART_Config_t *usart, BNO_Unit acc_unit);
 Status BNO_Get_ACC_Unit (USART_Config_t *usart, uint8_t *acc_unit);
@@ -1294,12 +1343,14 @@ Status BNO_Axis_Remap     (USART_Config_t *usart, BNO_Axis target, BNO_Axis new_
 Status BNO_Axis_Sign_Remap(USART_Config_t *usart, BNO_Axis axis, BNO_Axis_Sign sign);
 
 /*************************************** Interrupt Functions **************************************/
-Status BNO_Enable_IRQ     (USART_Config_t *usart, BNO_IRQ irq);
-Status BNO_Disable_IRQ    (USART_Config_t *usart, BNO_IRQ irq);
-Status BNO_Reset_IRQ      (USART_Config_t *usart);
-Status BNO_Get_IRQ_Status (USART_Config_t *usart, BNO_IRQ irq, uint8_t *status);
-Status BNO_Enable_IRQ_Msk (USART_Config_t *usart, BNO_IRQ irq);
-Status BNO_Disable_IRQ_Msk(USART_Config_t *usart, BNO_IRQ irq);
+Status BNO_Enable_IRQ        (USART_Config_t *usart, BNO_IRQ irq);
+Status BNO_Disable_IRQ       (USART_Config_t *usart, BNO_IRQ irq);
+Status BNO_Reset_IRQ         (USART_Config_t *usart);
+Status BNO_Clear_INT         (USART_Config_t *usart);
+Status BNO_Get_IRQ_Status    (USART_Config_t *usart, BNO_IRQ irq, uint8_t *status);
+Status BNO_Get_IRQ_Status_All(USART_Config_t *usart, uint8_t *status);
+Status BNO_Enable_IRQ_Msk    (USART_Config_t *usart, BNO_IRQ irq);
+Status BNO_Disable_IRQ_Msk   (USART_Config_t *usart, BNO_IRQ irq);
 
 Status BNO_Set_ACC_SM_NM_Det_Type  (USART_Config_t *usart, BNO_SM_NM_Det_Type det_type);
 Status BNO_Get_ACC_SM_NM_Det_Type  (USART_Config_t *usart, uint8_t *det_type);
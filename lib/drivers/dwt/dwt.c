@@ -0,0 +1,107 @@
+/**
+ * @file    dwt.c
+ * @brief   Cortex-M4 DWT Cycle Counter Driver
+ * @details This driver provides an interface for the cycle counter (CYCCNT) of the Cortex-M4 data
+ *          watchpoint and trace unit. The counter runs at the core clock and is independent of
+ *          SysTick, so unlike g_systick_time it keeps counting while Delay_Loop() reprograms
+ *          SysTick. The 32-bit counter is extended to 64 bits in software by counting wraps,
+ *          giving micro-second timestamps that do not wrap in practice.
+ *
+ * @par     Driver functions:
+ *          - DWT_Init(): Enables and resets the cycle counter
+ *          - DWT_Get_Cycles(): Gets the raw 32-bit cycle count
+ *          - DWT_Get_Time_US(): Gets the 64-bit time in micro-seconds since DWT_Init()
+ *
+ * @warning DWT_Get_Time_US() must be called at least once per counter wrap (2^32 core clock
+ *          cycles, 268 s at 16 MHz or 44.7 s at 96 MHz), otherwise a wrap is missed
+ */
+
+
+#include "dwt.h"
+
+
+/**************************************************************************************************/
+/*                                Global DWT State Initialisation                                 */
+/**************************************************************************************************/
+
+/** @brief Core clock cycles per micro-second, and the state of the 64-bit counter extension */
+volatile uint32_t g_dwt_cycles_per_us = 0UL;
+volatile uint32_t g_dwt_last_cycles   = 0UL;
+volatile uint32_t g_dwt_wraps         = 0UL;
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Enables and resets the cycle counter
+ * @retval Status indicating success or error
+ * @note   Should be called after the system clock has been configured, as the micro-second scale
+ *         is derived from g_ahb_clk_freq
+ */
+Status DWT_Init(void) {
+    uint32_t cycles_per_us = (g_ahb_clk_freq / SEC_TO_USEC);
+    if (cycles_per_us < DWT_CYCLES_PER_US_MIN) {
+        return ERROR;
+    }
+
+    //enable trace, then check the cycle counter is implemented
+    CORE_DEBUG->DEMCR |= CORE_DEBUG_DEMCR_TRCENA;
+    if (DWT->CTRL & DWT_CTRL_NOCYCCNT) {
+        return ERROR;
+    }
+
+    //reset and start the counter
+    DWT->CYCCNT = 0UL;
+    g_dwt_cycles_per_us = cycles_per_us;
+    g_dwt_last_cycles   = 0UL;
+    g_dwt_wraps         = 0UL;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the raw 32-bit cycle count
+ * @param  cycles: Pointer to a variable used to store the cycle count
+ * @retval Status indicating success or invalid parameters
+ * @note   Intended for benchmarking: the difference of two counts is correct across a single
+ *         wrap when computed with unsigned arithmetic
+ */
+Status DWT_Get_Cycles(uint32_t *cycles) {
+    CHECK_STATUS(Validate_Ptr(cycles));
+
+    *cycles = DWT->CYCCNT;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the 64-bit time in micro-seconds since DWT_Init()
+ * @param  time_us: Pointer to a variable used to store the time in micro-seconds
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Safe to call from interrupt handlers: the wrap extension is updated with interrupts
+ *         masked, and the previous mask is restored
+ */
+Status DWT_Get_Time_US(uint64_t *time_us) {
+    CHECK_STATUS(Validate_Ptr(time_us));
+    if (g_dwt_cycles_per_us == 0UL) {
+        return ERROR;
+    }
+
+    //extend the counter, counting a wrap whenever it is lower than at the previous call
+    uint32_t primask = GET_PRIMASK();
+    DISABLE_IRQ();
+    uint32_t cycles = DWT->CYCCNT;
+    if (cycles < g_dwt_last_cycles) {
+        g_dwt_wraps++;
+    }
+    g_dwt_last_cycles = cycles;
+    uint64_t total = (((uint64_t) g_dwt_wraps << 32U) | cycles);
+    SET_PRIMASK(primask);
+
+    *time_us = (total / g_dwt_cycles_per_us);
+
+    return SUCCESS;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file    dwt.h
+ * @brief   Cortex-M4 DWT Cycle Counter Driver
+ * @details This header file contains the public interface for the Cortex-M4 data watchpoint and
+ *          trace (DWT) cycle counter driver. It includes global variable declarations, constants
+ *          and function prototypes used for cycle counting and 64-bit micro-second timestamps.
+ */
+
+
+#ifndef __DWT_H
+#define __DWT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../../utils/utils.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define DWT_CYCLES_PER_US_MIN       1UL
+
+
+/**************************************************************************************************/
+/*                                        Global Variables                                        */
+/**************************************************************************************************/
+
+extern volatile uint32_t g_dwt_cycles_per_us;
+extern volatile uint32_t g_dwt_last_cycles;
+extern volatile uint32_t g_dwt_wraps;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status DWT_Init       (void);
+Status DWT_Get_Cycles (uint32_t *cycles);
+Status DWT_Get_Time_US(uint64_t *time_us);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
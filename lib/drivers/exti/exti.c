@@ -0,0 +1,309 @@
+/**
+ * @file    exti.c
+ * @brief   STM32F411 EXTI Driver
+ * @details This driver provides an interface for the STM32F411 external interrupt controller for
+ *          GPIO lines 0-15. It supports routing a GPIO port to an EXTI line via SYSCFG, edge
+ *          selection, NVIC configuration and per-line callbacks. The driver maintains a global
+ *          state per line storing the registered callback and an event counter.
+ *
+ * @par     Driver functions:
+ *          - EXTI_Init(): Initialises an EXTI line
+ *          - EXTI_Deinit(): Deinitialises an EXTI line
+ *          - EXTI_Enable_Line(): Unmasks an EXTI line
+ *          - EXTI_Disable_Line(): Masks an EXTI line
+ *          - EXTI_Trigger_SW(): Triggers an EXTI line from software
+ *          - EXTI_Get_Event_Count(): Gets the number of events handled on an EXTI line
+ *          - EXTI0_IRQHandler() - EXTI4_IRQHandler(): Handle EXTI line 0-4 interrupts
+ *          - EXTI9_5_IRQHandler(): Handles EXTI line 5-9 interrupts
+ *          - EXTI15_10_IRQHandler(): Handles EXTI line 10-15 interrupts
+ *
+ * @warning Ensure the GPIO pin is configured as an input before calling EXTI_Init()
+ */
+
+
+#include "exti.h"
+
+
+/**************************************************************************************************/
+/*                           Global EXTI State Structure Initialisation                           */
+/**************************************************************************************************/
+
+/** @brief Initialisation of the structures used to store the global state of each EXTI line */
+volatile EXTI_Line_State_t g_exti_lines[EXTI_GPIO_LINE_COUNT] = {0};
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the NVIC interrupt number of an EXTI line
+ * @param  line: EXTI line
+ * @retval Interrupt number
+ * @note   Lines 5-9 and 10-15 share an interrupt
+ */
+static IRQn_t EXTI_Get_IRQn(EXTI_Line line) {
+    switch (line) {
+        case EXTI_LINE_0: return EXTI0_IRQn;
+        case EXTI_LINE_1: return EXTI1_IRQn;
+        case EXTI_LINE_2: return EXTI2_IRQn;
+        case EXTI_LINE_3: return EXTI3_IRQn;
+        case EXTI_LINE_4: return EXTI4_IRQn;
+        default: break;
+    }
+    if (line <= EXTI_LINE_9) {
+        return EXTI9_5_IRQn;
+    }
+    return EXTI15_10_IRQn;
+}
+
+/**
+ * @brief  Checks whether another line sharing the interrupt of an EXTI line is configured
+ * @param  line: EXTI line
+ * @retval 1U if the interrupt is shared with a configured line, otherwise 0U
+ */
+static uint8_t EXTI_IRQn_Shared(EXTI_Line line) {
+    IRQn_t irqn = EXTI_Get_IRQn(line);
+    for (uint8_t i = 0U; i < EXTI_GPIO_LINE_COUNT; i++) {
+        if ((i != line) && (EXTI_Get_IRQn(i) == irqn) && (g_exti_lines[i].callback != NULL)) {
+            return 1U;
+        }
+    }
+    return 0U;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an EXTI line
+ * @param  exti_config: Pointer to a struct containing EXTI settings
+ * @retval Status indicating success or invalid parameters
+ * @note   Lines sharing an interrupt (5-9, 10-15) must use the same interrupt priority
+ * @note   A configured line may be initialised again, e.g. to change its callback or trigger. Its
+ *         interrupt priority is then released if it changes, so it may also be kept
+ * @note   The callback is called from interrupt context
+ */
+Status EXTI_Init(EXTI_Config_t *exti_config) {
+    CHECK_STATUS(Validate_Ptr(exti_config));
+    if (exti_config->callback == NULL) {
+        return INVALID_PARAM;
+    }
+
+    CHECK_STATUS(Validate_Enum(exti_config->line, EXTI_LINE_0, EXTI_LINE_15));
+    CHECK_STATUS(Validate_Enum(exti_config->trigger, EXTI_TRIGGER_RISING, EXTI_TRIGGER_BOTH));
+    if ((exti_config->port > EXTI_PORT_E) && (exti_config->port != EXTI_PORT_H)) {
+        return INVALID_PARAM;
+    }
+
+    CHECK_STATUS(Validate_Priority_IRQ(exti_config->irq_priority));
+
+    //validate availability of interrupt priority level, which a configured line already holds
+    IRQn_t   irqn        = EXTI_Get_IRQn(exti_config->line);
+    uint8_t  shared      = EXTI_IRQn_Shared(exti_config->line);
+    uint8_t  configured  = (g_exti_lines[exti_config->line].callback != NULL);
+    uint32_t priority_og = NVIC_Get_Priority(irqn);
+    if (shared) {
+        if (priority_og != exti_config->irq_priority) {
+            return INVALID_PARAM;
+        }
+    } else if (irq_priority_tracker[exti_config->irq_priority]
+           && !(configured && (priority_og == exti_config->irq_priority))) {
+        return INVALID_PARAM;
+    }
+
+    uint32_t line_bit = (1UL << exti_config->line);
+
+    //mask the line while it is being configured
+    EXTI->IMR &= ~(line_bit);
+
+    //enable SYSCFG clock and route the GPIO port to the line
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    volatile uint32_t *exticr = &SYSCFG->EXTICR1;
+    uint8_t cr_index = (exti_config->line >> 2U);
+    uint8_t cr_shift = ((exti_config->line & 0x3U) * 4U);
+    exticr[cr_index] &= ~(0xFUL << cr_shift);
+    exticr[cr_index] |= (((uint32_t) exti_config->port) << cr_shift);
+
+    //configure edge selection
+    EXTI->RTSR &= ~(line_bit);
+    EXTI->FTSR &= ~(line_bit);
+    if (exti_config->trigger != EXTI_TRIGGER_FALLING) {
+        EXTI->RTSR |= line_bit;
+    }
+    if (exti_config->trigger != EXTI_TRIGGER_RISING) {
+        EXTI->FTSR |= line_bit;
+    }
+
+    //register callback and clear any stale pending event
+    g_exti_lines[exti_config->line].callback    = exti_config->callback;
+    g_exti_lines[exti_config->line].context     = exti_config->context;
+    g_exti_lines[exti_config->line].event_count = 0U;
+    EXTI->PR = line_bit;
+
+    DISABLE_IRQ();
+    NVIC_Set_Priority(irqn, exti_config->irq_priority);
+    NVIC_Clear_Pending_IRQ(irqn);
+    NVIC_Enable_IRQ(irqn);
+    ENABLE_IRQ();
+
+    //record utilised interrupt priority level, releasing the one it replaces
+    if (configured && !shared) {
+        irq_priority_tracker[priority_og] = 0U;
+    }
+    irq_priority_tracker[exti_config->irq_priority] = 1U;
+
+    //unmask the line
+    EXTI->IMR |= line_bit;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Deinitialises an EXTI line
+ * @param  line: EXTI line to be deinitialised
+ * @retval Status indicating success or invalid parameters
+ * @note   The interrupt is only disabled in the NVIC if no other configured line shares it
+ */
+Status EXTI_Deinit(EXTI_Line line) {
+    CHECK_STATUS(Validate_Enum(line, EXTI_LINE_0, EXTI_LINE_15));
+
+    uint32_t line_bit = (1UL << line);
+    EXTI->IMR  &= ~(line_bit);
+    EXTI->RTSR &= ~(line_bit);
+    EXTI->FTSR &= ~(line_bit);
+    EXTI->PR    = line_bit;
+
+    //release the interrupt if no other line uses it
+    IRQn_t irqn = EXTI_Get_IRQn(line);
+    if (!EXTI_IRQn_Shared(line)) {
+        NVIC_Disable_IRQ(irqn);
+        irq_priority_tracker[NVIC_Get_Priority(irqn)] = 0U;
+    }
+
+    g_exti_lines[line].callback = NULL;
+    g_exti_lines[line].context  = NULL;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Unmasks an EXTI line
+ * @param  line: EXTI line
+ * @retval Status indicating success or invalid parameters
+ */
+Status EXTI_Enable_Line(EXTI_Line line) {
+    CHECK_STATUS(Validate_Enum(line, EXTI_LINE_0, EXTI_LINE_15));
+
+    EXTI->IMR |= (1UL << line);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Masks an EXTI line
+ * @param  line: EXTI line
+ * @retval Status indicating success or invalid parameters
+ * @note   Edges occurring while the line is masked are still latched in EXTI_PR and are handled
+ *         once the line is unmasked
+ */
+Status EXTI_Disable_Line(EXTI_Line line) {
+    CHECK_STATUS(Validate_Enum(line, EXTI_LINE_0, EXTI_LINE_15));
+
+    EXTI->IMR &= ~(1UL << line);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Triggers an EXTI line from software
+ * @param  line: EXTI line
+ * @retval Status indicating success or invalid parameters
+ */
+Status EXTI_Trigger_SW(EXTI_Line line) {
+    CHECK_STATUS(Validate_Enum(line, EXTI_LINE_0, EXTI_LINE_15));
+
+    EXTI->SWIER = (1UL << line);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the number of events handled on an EXTI line
+ * @param  line:        EXTI line
+ * @param  event_count: Pointer to a variable used to store the event count
+ * @retval Status indicating success or invalid parameters
+ */
+Status EXTI_Get_Event_Count(EXTI_Line line, uint32_t *event_count) {
+    CHECK_STATUS(Validate_Enum(line, EXTI_LINE_0, EXTI_LINE_15));
+    CHECK_STATUS(Validate_Ptr(event_count));
+
+    *event_count = g_exti_lines[line].event_count;
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************************************/
+/*                                       Interrupt Handlers                                       */
+/**************************************************************************************************/
+
+/**
+ * @brief  Clears pending EXTI lines and calls their callbacks
+ * @param  first: First line handled by the interrupt
+ * @param  last:  Last line handled by the interrupt
+ * @retval None
+ * @note   The pending bit is cleared before the callback is called, so an edge occurring during
+ *         the callback is latched and handled rather than lost
+ */
+static void EXTI_Dispatch(EXTI_Line first, EXTI_Line last) {
+    uint32_t pending = EXTI->PR;
+    for (uint8_t line = first; line <= last; line++) {
+        uint32_t line_bit = (1UL << line);
+        if (!(pending & line_bit)) {
+            continue;
+        }
+        EXTI->PR = line_bit;
+        g_exti_lines[line].event_count++;
+        if (g_exti_lines[line].callback != NULL) {
+            g_exti_lines[line].callback((EXTI_Line) line, g_exti_lines[line].context);
+        }
+    }
+}
+
+/** @brief Handles EXTI line 0 interrupts */
+void EXTI0_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_0, EXTI_LINE_0);
+}
+
+/** @brief Handles EXTI line 1 interrupts */
+void EXTI1_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_1, EXTI_LINE_1);
+}
+
+/** @brief Handles EXTI line 2 interrupts */
+void EXTI2_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_2, EXTI_LINE_2);
+}
+
+/** @brief Handles EXTI line 3 interrupts */
+void EXTI3_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_3, EXTI_LINE_3);
+}
+
+/** @brief Handles EXTI line 4 interrupts */
+void EXTI4_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_4, EXTI_LINE_4);
+}
+
+/** @brief Handles EXTI line 5-9 interrupts */
+void EXTI9_5_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_5, EXTI_LINE_9);
+}
+
+/** @brief Handles EXTI line 10-15 interrupts */
+void EXTI15_10_IRQHandler(void) {
+    EXTI_Dispatch(EXTI_LINE_10, EXTI_LINE_15);
+}
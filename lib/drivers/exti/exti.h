@@ -0,0 +1,117 @@
+/**
+ * @file    exti.h
+ * @brief   STM32F411 EXTI Driver
+ * @details This header file contains the public interface for the STM32F411 external interrupt
+ *          (EXTI) driver. It includes global variable declarations, enumerations, configuration
+ *          structures and function prototypes used to route GPIO pins to EXTI lines and handle
+ *          their interrupts via per-line callbacks.
+ */
+
+
+#ifndef __EXTI_H
+#define __EXTI_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../../utils/utils.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define EXTI_GPIO_LINE_COUNT        16U
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    EXTI_LINE_0 = 0,
+    EXTI_LINE_1,
+    EXTI_LINE_2,
+    EXTI_LINE_3,
+    EXTI_LINE_4,
+    EXTI_LINE_5,
+    EXTI_LINE_6,
+    EXTI_LINE_7,
+    EXTI_LINE_8,
+    EXTI_LINE_9,
+    EXTI_LINE_10,
+    EXTI_LINE_11,
+    EXTI_LINE_12,
+    EXTI_LINE_13,
+    EXTI_LINE_14,
+    EXTI_LINE_15
+} EXTI_Line;
+
+typedef enum {
+    EXTI_PORT_A = 0,
+    EXTI_PORT_B,
+    EXTI_PORT_C,
+    EXTI_PORT_D,
+    EXTI_PORT_E,
+    EXTI_PORT_H = 7
+} EXTI_Port;
+
+typedef enum {
+    EXTI_TRIGGER_RISING = 0,
+    EXTI_TRIGGER_FALLING,
+    EXTI_TRIGGER_BOTH
+} EXTI_Trigger;
+
+
+/**************************************************************************************************/
+/*                                    Configuration Structures                                    */
+/**************************************************************************************************/
+
+typedef void (*EXTI_Callback_t)(EXTI_Line line, void *context);
+
+typedef struct {
+    /* Required */
+    EXTI_Port       port;
+    EXTI_Line       line;
+    EXTI_Trigger    trigger;
+    uint32_t        irq_priority;
+    EXTI_Callback_t callback;
+    /* Optional */
+    void            *context;
+} EXTI_Config_t;
+
+typedef struct {
+    EXTI_Callback_t callback;
+    void            *context;
+    uint32_t        event_count;
+} EXTI_Line_State_t;
+
+
+/**************************************************************************************************/
+/*                                        Global Variables                                        */
+/**************************************************************************************************/
+
+extern volatile EXTI_Line_State_t g_exti_lines[EXTI_GPIO_LINE_COUNT];
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status EXTI_Init           (EXTI_Config_t *exti_config);
+Status EXTI_Deinit         (EXTI_Line line);
+Status EXTI_Enable_Line    (EXTI_Line line);
+Status EXTI_Disable_Line   (EXTI_Line line);
+Status EXTI_Trigger_SW     (EXTI_Line line);
+Status EXTI_Get_Event_Count(EXTI_Line line, uint32_t *event_count);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
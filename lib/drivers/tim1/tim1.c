@@ -12,12 +12,17 @@
  *          - TIM1_OC_Init(): Initialises TIM1 in output compare mode
  *          - TIM1_PWM_Output_Init(): Initialises TIM1 in PWM output mode
  *          - TIM1_PWM_Set_Duty_Cycle(): Sets the PWM duty cycle for a particular TIM1 channel
+ *          - TIM1_Set_Compare(): Sets the compare value of a particular TIM1 channel
  *          - TIM1_Deinit(): Deinitialises TIM1
  *          - TIM1_Validate_Channel(): Validates TIM1 channel
  *          - TIM1_Servo_Init(): Initialises TIM1 in PWM output mode to drive a servo motor
  *          - TIM1_Servo_Set_Position(): Sets the angle for a servo driven by a TIM1 channel
  *          - TIM1_MS_Base_Init(): Initialises TIM1 as a time base in milli-seconds
  *          - TIM1_MS_Delay(): Delays program execution by a specified number of milli-seconds
+ *          - TIM1_MS_Base_Get_US(): Gets the time of the milli-second time base in micro-seconds
+ *          - TIM1_MS_Base_PWM_Init(): Initialises a preloaded PWM output on the milli-second time
+ *            base
+ *          - TIM1_Set_Update_Callback(): Sets the function called on every TIM1 update event
  *          - TIM1_UP_TIM10_IRQHandler(): Handles TIM1 update and TIM10 global interrupts
  *          - TIM1_CC_IRQHandler(): Handles TIM1 capture and compare interrupts
  * 
@@ -28,6 +33,15 @@
  #include "tim1.h"
 
 
+/**************************************************************************************************/
+/*                                     Update Callback State                                      */
+/**************************************************************************************************/
+
+/** @brief Function called on every TIM1 update event, and the context passed to it */
+static TIM1_Update_Callback_t g_tim1_update_callback = NULL;
+static void                   *g_tim1_update_context = NULL;
+
+
 /**************************************************************************************************/
 /*                               TIM1 Core Initialisation Functions                               */
 /**************************************************************************************************/
@@ -483,6 +497,27 @@ Status TIM1_PWM_Set_Duty_Cycle(TIM1_Channel channel, float duty_cycle) {
     return SUCCESS;
 }
 
+/**
+ * @brief  Sets the compare value of a particular TIM1 channel
+ * @param  channel:       TIM1 channel whose compare value will be set
+ * @param  compare_value: Compare value in counter ticks
+ * @retval Status indicating success or invalid parameters
+ * @note   If the channel was configured with TIM1_OC_PRELOAD_ENABLED, the value is latched at the
+ *         next update event, so a value written from the update interrupt applies to exactly the
+ *         next counter period
+ */
+Status TIM1_Set_Compare(TIM1_Channel channel, uint16_t compare_value) {
+    switch (channel) {
+        case TIM1_CHANNEL_1: TIM1->CCR1 = compare_value; break;
+        case TIM1_CHANNEL_2: TIM1->CCR2 = compare_value; break;
+        case TIM1_CHANNEL_3: TIM1->CCR3 = compare_value; break;
+        case TIM1_CHANNEL_4: TIM1->CCR4 = compare_value; break;
+        default: return INVALID_PARAM;
+    }
+
+    return SUCCESS;
+}
+
 /**
  * @brief  Deinitialises TIM1
  * @retval Status indicating success
@@ -601,7 +636,7 @@ Status TIM1_MS_Base_Init(void) {
 
     //configure settings for time base
     TIM1_CNT_Config_t base_config = {
-        .auto_reload = 1000UL,
+        .auto_reload = TIM1_MS_BASE_PERIOD_US,
         .prescaler   = prescaler_val,
         .interrupt_enable = TIM1_INTERRUPT_ENABLED
     };
@@ -629,6 +664,81 @@ Status TIM1_MS_Delay(uint32_t time_delay) {
     return SUCCESS;
 }
 
+/**
+ * @brief  Gets the time of the milli-second time base in micro-seconds
+ * @param  time_us: Pointer to a variable used to store the time in micro-seconds
+ * @retval Status indicating success or invalid parameters
+ * @note   Assumes TIM1 has been configured as a time base unit via @ref TIM1_MS_Base_Init, so the
+ *         counter counts micro-seconds within the current milli-second
+ * @note   The time wraps around every 71.6 minutes
+ */
+Status TIM1_MS_Base_Get_US(uint32_t *time_us) {
+    CHECK_STATUS(Validate_Ptr(time_us));
+
+    //re-read the counter if an update event occurred between the two reads
+    uint32_t time_ms = g_tim1_time;
+    uint32_t count   = TIM1->CNT;
+    if (time_ms != g_tim1_time) {
+        time_ms = g_tim1_time;
+        count   = TIM1->CNT;
+    }
+    *time_us = ((time_ms * 1000UL) + count);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Initialises a preloaded PWM output on the milli-second time base
+ * @param  channel: TIM1 channel to be used as the output
+ * @retval Status indicating success or invalid parameters
+ * @note   Assumes TIM1 has been configured as a time base unit via @ref TIM1_MS_Base_Init. The
+ *         period is the time base period and the compare value counts micro-seconds, so the time
+ *         base is unchanged. The output is low until a compare value is set via
+ *         @ref TIM1_Set_Compare, which is latched at the next update event
+ */
+Status TIM1_MS_Base_PWM_Init(TIM1_Channel channel) {
+    //set prescaler value based on system clock source
+    uint16_t prescaler_val = 1UL;
+    if (g_sys_clk_source == HSI_CLOCK) {
+        prescaler_val = 16UL;
+    } else if (g_sys_clk_source == HSE_CLOCK) {
+        prescaler_val = 25UL;
+    }
+
+    //configure PWM output with the period of the time base
+    TIM1_PWM_Output_Config_t config = {
+        .channel     = channel,
+        .auto_reload = TIM1_MS_BASE_PERIOD_US,
+        .prescaler   = prescaler_val,
+        .duty_cycle  = 0.0f,
+        .oc_mode     = TIM1_OCM_PWM_1,
+        .polarity    = TIM1_CC_ACTIVE_HIGH,
+        .preload     = TIM1_OC_PRELOAD_ENABLED
+    };
+
+    //initialise PWM output
+    CHECK_STATUS(TIM1_PWM_Output_Init(&config));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Sets the function called on every TIM1 update event
+ * @param  callback: Function called from the update interrupt, or NULL to remove the callback
+ * @param  context:  Pointer passed to the callback
+ * @retval Status indicating success
+ * @note   If TIM1 is configured as a time base, the callback is called after g_tim1_time has been
+ *         incremented, at the update interrupt priority
+ */
+Status TIM1_Set_Update_Callback(TIM1_Update_Callback_t callback, void *context) {
+    DISABLE_IRQ();
+    g_tim1_update_callback = callback;
+    g_tim1_update_context  = context;
+    ENABLE_IRQ();
+
+    return SUCCESS;
+}
+
 
 /**************************************************************************************************/
 /*                                     TIM1 Interrupt Handlers                                    */
@@ -639,6 +749,9 @@ void TIM1_UP_TIM10_IRQHandler(void) {
     if (TIM1->SR & TIM_SR_UIF) {
         TIM1->SR &= ~(TIM_SR_UIF);
         g_tim1_time++;
+        if (g_tim1_update_callback != NULL) {
+            g_tim1_update_callback(g_tim1_update_context);
+        }
     }
 }
 
@@ -18,6 +18,13 @@
 #include "../../utils/utils.h"
 
 
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define TIM1_MS_BASE_PERIOD_US      1000UL
+
+
 /**************************************************************************************************/
 /*                                        Global Variables                                        */
 /**************************************************************************************************/
@@ -168,6 +175,8 @@ typedef enum {
 /*                                    Configuration Structures                                    */
 /**************************************************************************************************/
 
+typedef void (*TIM1_Update_Callback_t)(void *context);
+
 typedef struct {
     /* Required */
     int                 prescaler;
@@ -261,12 +270,16 @@ Status TIM1_PWM_Input_Init     (TIM1_PWM_Input_Config_t *pwm_input_config);
 Status TIM1_OC_Init            (TIM1_OC_Config_t *oc_config);
 Status TIM1_PWM_Output_Init    (TIM1_PWM_Output_Config_t *pwm_output_config);
 Status TIM1_PWM_Set_Duty_Cycle (TIM1_Channel channel, float duty_cycle_input);
+Status TIM1_Set_Compare        (TIM1_Channel channel, uint16_t compare_value);
 Status TIM1_Deinit             (void);
 Status TIM1_Validate_Channel   (TIM1_Channel channel);
 Status TIM1_Servo_Init         (TIM1_Channel channel);
 Status TIM1_Servo_Set_Position (TIM1_Channel channel, float degrees);
 Status TIM1_MS_Base_Init       (void);
 Status TIM1_MS_Delay           (uint32_t time_delay);
+Status TIM1_MS_Base_Get_US     (uint32_t *time_us);
+Status TIM1_MS_Base_PWM_Init   (TIM1_Channel channel);
+Status TIM1_Set_Update_Callback(TIM1_Update_Callback_t callback, void *context);
 void   TIM1_UP_TIM10_IRQHandler(void);
 void   TIM1_CC_IRQHandler      (void);
 
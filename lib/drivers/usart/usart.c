@@ -10,6 +10,9 @@
  *          - USART_Init(): Initialises a USART instance
  *          - USART_Deinit(): Deinitialises USART instance
  *          - USART_Transmit_IRQ(): Transmits an array/string of bytes via USART using interrupts
+ *          - USART_Get_TX_Buffer(): Gets the global TX buffer of an idle USART instance
+ *          - USART_Transmit_Buffer_IRQ(): Transmits bytes already written to the global TX buffer
+ *          - USART_Get_TX_Pending(): Gets the number of bytes still queued for transmission
  *          - USART_Receive_IRQ(): Receives bytes via USART using interrupts
  *          - USART_Abort_Receive_IRQ(): Aborts data reception using interrupts
  *          - USART_Tranmsit_Block(): Transmits an array/string of bytes via USART using blocking
@@ -336,6 +339,91 @@ Status USART_Transmit_IRQ(USART_Config_t *init_config, uint8_t *tx_buffer, uint1
     return SUCCESS;
 }
 
+/**
+ * @brief  Gets the global TX buffer of an idle USART instance
+ * @param  init_config: Pointer to a struct containing USART settings
+ * @param  tx_buffer:   Address of the pointer used to store the TX buffer address
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if the USART is currently transmitting. Data written to the buffer is sent
+ *         via @ref USART_Transmit_Buffer_IRQ, avoiding the copy made by @ref USART_Transmit_IRQ
+ * @note   The buffer holds TX_BUFFER_SIZE bytes
+ */
+Status USART_Get_TX_Buffer(USART_Config_t *init_config, uint8_t **tx_buffer) {
+    CHECK_STATUS(Validate_Ptr(init_config));
+    CHECK_STATUS(Validate_Ptr(tx_buffer));
+
+    //select appropriate global state given the USART instance
+    volatile USART_State_t *current = NULL;
+    CHECK_STATUS(USART_Get_State(init_config, &current));
+
+    //the buffer is owned by the interrupt handler while transmitting
+    if (current->tx_status == USART_TX_BUSY) {
+        return ERROR;
+    }
+
+    *tx_buffer = (uint8_t *) current->tx_buffer;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Transmits bytes already written to the global TX buffer via USART using interrupts
+ * @param  init_config: Pointer to a struct containing USART settings
+ * @param  tx_length:   Number of bytes to be transmitted
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Assumes the data has been written to the buffer obtained via @ref USART_Get_TX_Buffer
+ */
+Status USART_Transmit_Buffer_IRQ(USART_Config_t *init_config, uint16_t tx_length) {
+    CHECK_STATUS(Validate_Ptr(init_config));
+    if (tx_length <= 0U || tx_length > TX_BUFFER_SIZE) {
+        return INVALID_PARAM;
+    }
+
+    //select appropriate global state given the USART instance
+    volatile USART_State_t *current = NULL;
+    CHECK_STATUS(USART_Get_State(init_config, &current));
+    current->tx_instance = init_config->instance;
+
+    //check if USART is currently transmitting
+    if (current->tx_status == USART_TX_BUSY) {
+        return ERROR;
+    }
+
+    //initialise the global state
+    current->tx_length = tx_length;
+    current->tx_index  = 0U;
+    current->tx_status = USART_TX_BUSY;
+
+    //enable TXE interrupts
+    init_config->instance->CR1 |= USART_CR1_TXEIE;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the number of bytes still queued for transmission
+ * @param  init_config: Pointer to a struct containing USART settings
+ * @param  tx_pending:  Pointer to a variable used to store the number of queued bytes
+ * @retval Status indicating success or invalid parameters
+ * @note   Returns 0 when the USART is idle
+ */
+Status USART_Get_TX_Pending(USART_Config_t *init_config, uint16_t *tx_pending) {
+    CHECK_STATUS(Validate_Ptr(init_config));
+    CHECK_STATUS(Validate_Ptr(tx_pending));
+
+    //select appropriate global state given the USART instance
+    volatile USART_State_t *current = NULL;
+    CHECK_STATUS(USART_Get_State(init_config, &current));
+
+    if (current->tx_status == USART_TX_BUSY) {
+        *tx_pending = (current->tx_length - current->tx_index);
+    } else {
+        *tx_pending = 0U;
+    }
+
+    return SUCCESS;
+}
+
 /**
  * @brief  Receives bytes via USART using interrupts
  * @param  init_config: Pointer to a struct containing USART settings
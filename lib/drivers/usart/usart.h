@@ -142,6 +142,9 @@ extern volatile USART_State_t g_usart_6;
 Status USART_Init             (USART_Config_t *init_config);
 Status USART_Deinit           (USART_t *instance);
 Status USART_Transmit_IRQ     (USART_Config_t *init_config, uint8_t *tx_buffer, uint16_t tx_length);
+Status USART_Get_TX_Buffer    (USART_Config_t *init_config, uint8_t **tx_buffer);
+Status USART_Transmit_Buffer_IRQ(USART_Config_t *init_config, uint16_t tx_length);
+Status USART_Get_TX_Pending   (USART_Config_t *init_config, uint16_t *tx_pending);
 Status USART_Receive_IRQ      (USART_Config_t *init_config, uint8_t *rx_buffer, uint16_t rx_length);
 Status USART_Abort_Receive_IRQ(USART_Config_t *init_config);
 Status USART_Transmit_Block   (
@@ -0,0 +1,421 @@
+/**
+ * @file    ahrs.c
+ * @brief   Attitude and Heading Reference System
+ * @details This source file estimates orientation on the MCU from the raw accelerometer,
+ *          magnetometer and gyroscope channels read in BNO_OPR_AMG_MODE. The BNO055 caps its own
+ *          fusion output at 100 Hz, whereas this engine produces a quaternion for every new
+ *          gyroscope sample, i.e. at the gyroscope output rate if the acquisition keeps up with
+ *          it, and with the latency of a single read. The gyroscope outputs at 100 Hz in the
+ *          default AMG configuration, and faster once configured via BNO_GYR_Init(), e.g. at
+ *          200 Hz with BNO_GYR_BW_64_HZ. Duplicate gyroscope reads carry no new sample, so they
+ *          are ignored rather than integrating the same rate twice.
+ *
+ *          The gyroscope rate is integrated over the time between the sample times of successive
+ *          frames, and the drift is corrected towards the reference directions measured by the
+ *          accelerometer (gravity) and, if use_mag is set, the magnetometer (earth field). The
+ *          latest accelerometer and magnetometer directions are held between their samples, so
+ *          they can be read at lower rates than the gyroscope. Two filters are provided:
+ *          - AHRS_FILTER_MADGWICK: a gradient descent step of size gain (beta) is subtracted from
+ *            the quaternion rate. The gyroscope bias is estimated by integrating the angular
+ *            rate error implied by the gradient, with gain bias_gain (zeta)
+ *          - AHRS_FILTER_MAHONY: the cross product between the measured and predicted reference
+ *            directions is fed back to the angular rate with proportional gain gain (Kp), and
+ *            the gyroscope bias is estimated by its integral, with gain bias_gain (Ki)
+ *
+ *          All arithmetic is single precision so it runs on the Cortex-M4F FPU, and the rotation
+ *          matrix of the current orientation is computed once per update and shared by both
+ *          reference directions. Every update is timed with the DWT cycle counter, and the last,
+ *          maximum and mean cycles per update are reported as a benchmark.
+ *
+ * @par     Functions include:
+ *          - AHRS_Init(): Initialises the filter at the identity orientation
+ *          - AHRS_Update(): Updates the orientation with the channels of a frame
+ *          - AHRS_Get_Quaternion(): Gets the current orientation
+ *          - AHRS_Get_Report(): Gets the estimated gyroscope bias and the cycles per update
+ *
+ * @note    The orientation converges from the identity within a few seconds at the default gains.
+ *          In BNO_OPR_AMG_MODE the magnetometer is not calibrated by the BNO055, so use_mag should
+ *          only be set once the hard and soft-iron offsets are compensated
+ */
+
+
+#include "ahrs.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Normalises a vector to unit length
+ * @param  v:     Pointer to the vector
+ * @param  count: Number of elements of the vector
+ * @retval 1 if the vector was normalised, 0 if it has zero length
+ */
+static uint8_t AHRS_Normalise(float *v, uint8_t count) {
+    float norm_sq = 0.0f;
+    for (uint8_t i = 0U; i < count; i++) {
+        norm_sq += (v[i] * v[i]);
+    }
+    if (norm_sq <= 0.0f) {
+        return 0U;
+    }
+
+    float inv_norm = (1.0f / sqrtf(norm_sq));
+    for (uint8_t i = 0U; i < count; i++) {
+        v[i] *= inv_norm;
+    }
+
+    return 1U;
+}
+
+/**
+ * @brief  Computes the rotation matrix of a quaternion
+ * @param  q: Pointer to the unit quaternion (w, x, y, z)
+ * @param  r: Matrix used to store the rotation from the sensor frame to the earth frame
+ * @retval None
+ */
+static void AHRS_Rotation(const float *q, float r[3][3]) {
+    float q0q1 = (q[0] * q[1]);
+    float q0q2 = (q[0] * q[2]);
+    float q0q3 = (q[0] * q[3]);
+    float q1q1 = (q[1] * q[1]);
+    float q1q2 = (q[1] * q[2]);
+    float q1q3 = (q[1] * q[3]);
+    float q2q2 = (q[2] * q[2]);
+    float q2q3 = (q[2] * q[3]);
+    float q3q3 = (q[3] * q[3]);
+
+    r[0][0] = (1.0f - (2.0f * (q2q2 + q3q3)));
+    r[0][1] = (2.0f * (q1q2 - q0q3));
+    r[0][2] = (2.0f * (q1q3 + q0q2));
+    r[1][0] = (2.0f * (q1q2 + q0q3));
+    r[1][1] = (1.0f - (2.0f * (q1q1 + q3q3)));
+    r[1][2] = (2.0f * (q2q3 - q0q1));
+    r[2][0] = (2.0f * (q1q3 - q0q2));
+    r[2][1] = (2.0f * (q2q3 + q0q1));
+    r[2][2] = (1.0f - (2.0f * (q1q1 + q2q2)));
+}
+
+/**
+ * @brief  Computes the reference direction of the earth field in the sensor frame
+ * @param  r:   Rotation matrix of the current orientation
+ * @param  mag: Pointer to the measured field direction, in the sensor frame
+ * @param  b:   Pointer to a 2-element array used to store the horizontal and vertical components
+ *              of the field in the earth frame
+ * @param  w:   Pointer to a 3-element array used to store the predicted field direction, in the
+ *              sensor frame
+ * @retval None
+ * @note   The measured field is rotated into the earth frame and its horizontal component is
+ *         aligned with the x axis, so that only the heading is corrected by the magnetometer
+ */
+static void AHRS_Earth_Field(float r[3][3], const float *mag, float *b, float *w) {
+    float h[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        h[i] = ((r[i][0] * mag[0]) + (r[i][1] * mag[1]) + (r[i][2] * mag[2]));
+    }
+    b[0] = sqrtf((h[0] * h[0]) + (h[1] * h[1]));
+    b[1] = h[2];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        w[i] = ((b[0] * r[0][i]) + (b[1] * r[2][i]));
+    }
+}
+
+/**
+ * @brief  Computes the quaternion rate of an angular rate
+ * @param  q:     Pointer to the current quaternion (w, x, y, z)
+ * @param  rate:  Pointer to the angular rate in rad/s, in the sensor frame
+ * @param  q_dot: Pointer to a 4-element array used to store the quaternion rate
+ * @retval None
+ */
+static void AHRS_Rate(const float *q, const float *rate, float *q_dot) {
+    q_dot[0] = (0.5f * (-(q[1] * rate[0]) - (q[2] * rate[1]) - (q[3] * rate[2])));
+    q_dot[1] = (0.5f * ((q[0] * rate[0]) + (q[2] * rate[2]) - (q[3] * rate[1])));
+    q_dot[2] = (0.5f * ((q[0] * rate[1]) - (q[1] * rate[2]) + (q[3] * rate[0])));
+    q_dot[3] = (0.5f * ((q[0] * rate[2]) + (q[1] * rate[1]) - (q[2] * rate[0])));
+}
+
+/**
+ * @brief  Computes the quaternion rate of a Madgwick update
+ * @param  state: Pointer to the AHRS state
+ * @param  gyr:   Pointer to the measured angular rate in rad/s
+ * @param  dt:    Time since the previous update in seconds
+ * @param  q_dot: Pointer to a 4-element array used to store the quaternion rate
+ * @retval None
+ */
+static void AHRS_Madgwick(AHRS_State_t *state, const float *gyr, float dt, float *q_dot) {
+    const float *q = state->q;
+    float s[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    if (state->acc_valid) {
+        float r[3][3];
+        AHRS_Rotation(q, r);
+
+        //gradient of the error between the predicted and measured gravity directions
+        const float *a = state->acc;
+        float f_g[3]    = {(r[2][0] - a[0]), (r[2][1] - a[1]), (r[2][2] - a[2])};
+        float j_g[3][4] = {
+            {(-2.0f * q[2]), (2.0f * q[3]), (-2.0f * q[0]), (2.0f * q[1])},
+            {(2.0f * q[1]), (2.0f * q[0]), (2.0f * q[3]), (2.0f * q[2])},
+            {0.0f, (-4.0f * q[1]), (-4.0f * q[2]), 0.0f}
+        };
+        for (uint8_t i = 0U; i < 3U; i++) {
+            for (uint8_t k = 0U; k < 4U; k++) {
+                s[k] += (j_g[i][k] * f_g[i]);
+            }
+        }
+
+        //gradient of the error between the predicted and measured earth field directions
+        if (state->config.use_mag && state->mag_valid) {
+            const float *m = state->mag;
+            float b[2];
+            float w[3];
+            AHRS_Earth_Field(r, m, b, w);
+            float f_b[3]    = {(w[0] - m[0]), (w[1] - m[1]), (w[2] - m[2])};
+            float j_b[3][4] = {
+                {
+                    (-2.0f * b[1] * q[2]), (2.0f * b[1] * q[3]),
+                    ((-4.0f * b[0] * q[2]) - (2.0f * b[1] * q[0])),
+                    ((-4.0f * b[0] * q[3]) + (2.0f * b[1] * q[1]))
+                },
+                {
+                    ((-2.0f * b[0] * q[3]) + (2.0f * b[1] * q[1])),
+                    ((2.0f * b[0] * q[2]) + (2.0f * b[1] * q[0])),
+                    ((2.0f * b[0] * q[1]) + (2.0f * b[1] * q[3])),
+                    ((-2.0f * b[0] * q[0]) + (2.0f * b[1] * q[2]))
+                },
+                {
+                    (2.0f * b[0] * q[2]), ((2.0f * b[0] * q[3]) - (4.0f * b[1] * q[1])),
+                    ((2.0f * b[0] * q[0]) - (4.0f * b[1] * q[2])), (2.0f * b[0] * q[1])
+                }
+            };
+            for (uint8_t i = 0U; i < 3U; i++) {
+                for (uint8_t k = 0U; k < 4U; k++) {
+                    s[k] += (j_b[i][k] * f_b[i]);
+                }
+            }
+        }
+
+        //estimate the gyroscope bias from the angular rate error of the gradient step
+        if (AHRS_Normalise(s, 4U) && (state->config.bias_gain > 0.0f)) {
+            float error[3] = {
+                ((q[0] * s[1]) - (s[0] * q[1]) - ((q[2] * s[3]) - (q[3] * s[2]))),
+                ((q[0] * s[2]) - (s[0] * q[2]) - ((q[3] * s[1]) - (q[1] * s[3]))),
+                ((q[0] * s[3]) - (s[0] * q[3]) - ((q[1] * s[2]) - (q[2] * s[1])))
+            };
+            for (uint8_t i = 0U; i < 3U; i++) {
+                state->bias[i] += (2.0f * error[i] * state->config.bias_gain * dt);
+            }
+        }
+    }
+
+    //integrate the corrected rate, stepping down the gradient
+    float rate[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        rate[i] = (gyr[i] - state->bias[i]);
+    }
+    AHRS_Rate(q, rate, q_dot);
+    for (uint8_t k = 0U; k < 4U; k++) {
+        q_dot[k] -= (state->config.gain * s[k]);
+    }
+}
+
+/**
+ * @brief  Computes the quaternion rate of a Mahony update
+ * @param  state: Pointer to the AHRS state
+ * @param  gyr:   Pointer to the measured angular rate in rad/s
+ * @param  dt:    Time since the previous update in seconds
+ * @param  q_dot: Pointer to a 4-element array used to store the quaternion rate
+ * @retval None
+ */
+static void AHRS_Mahony(AHRS_State_t *state, const float *gyr, float dt, float *q_dot) {
+    const float *q = state->q;
+    float e[3] = {0.0f, 0.0f, 0.0f};
+
+    if (state->acc_valid) {
+        float r[3][3];
+        AHRS_Rotation(q, r);
+
+        //error between the measured and predicted gravity directions
+        const float *a = state->acc;
+        e[0] = ((a[1] * r[2][2]) - (a[2] * r[2][1]));
+        e[1] = ((a[2] * r[2][0]) - (a[0] * r[2][2]));
+        e[2] = ((a[0] * r[2][1]) - (a[1] * r[2][0]));
+
+        //error between the measured and predicted earth field directions
+        if (state->config.use_mag && state->mag_valid) {
+            const float *m = state->mag;
+            float b[2];
+            float w[3];
+            AHRS_Earth_Field(r, m, b, w);
+            e[0] += ((m[1] * w[2]) - (m[2] * w[1]));
+            e[1] += ((m[2] * w[0]) - (m[0] * w[2]));
+            e[2] += ((m[0] * w[1]) - (m[1] * w[0]));
+        }
+
+        //estimate the gyroscope bias from the integral of the error
+        for (uint8_t i = 0U; i < 3U; i++) {
+            state->bias[i] -= (state->config.bias_gain * e[i] * dt);
+        }
+    }
+
+    //integrate the corrected rate, with proportional feedback of the error
+    float rate[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        rate[i] = ((gyr[i] - state->bias[i]) + (state->config.gain * e[i]));
+    }
+    AHRS_Rate(q, rate, q_dot);
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the filter at the identity orientation
+ * @param  state:  Pointer to the AHRS state
+ * @param  config: Pointer to a struct containing the filter and its gains
+ * @retval Status indicating success or invalid parameters
+ * @note   A gain of 0 selects the default of the filter (AHRS_MADGWICK_BETA_DEFAULT or
+ *         AHRS_MAHONY_KP_DEFAULT). A bias_gain of 0 disables the gyroscope bias estimation
+ * @note   gyr_lsb_rad_s is the gyroscope scale in LSB per rad/s, and defaults to the BNO055 reset
+ *         unit selection (dps)
+ */
+Status AHRS_Init(AHRS_State_t *state, AHRS_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    CHECK_STATUS(Validate_Enum(config->filter, AHRS_FILTER_MADGWICK, AHRS_FILTER_MAHONY));
+    if ((config->gain < 0.0f) || (config->bias_gain < 0.0f) || (config->gyr_lsb_rad_s < 0.0f)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(AHRS_State_t));
+    state->config = *config;
+    if (state->config.gain == 0.0f) {
+        state->config.gain = (config->filter == AHRS_FILTER_MADGWICK)
+                           ? AHRS_MADGWICK_BETA_DEFAULT : AHRS_MAHONY_KP_DEFAULT;
+    }
+    if (state->config.gyr_lsb_rad_s == 0.0f) {
+        state->config.gyr_lsb_rad_s = AHRS_GYR_LSB_DEFAULT;
+    }
+    state->q[0] = 1.0f;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Updates the orientation with the channels of a frame
+ * @param  state: Pointer to the AHRS state
+ * @param  frame: Pointer to the frame, of which the ACC, MAG and GYR channels in
+ *                frame->updated_mask are used
+ * @retval Status indicating success or invalid parameters
+ * @note   The orientation is only propagated by frames containing a gyroscope sample that is not
+ *         flagged in frame->duplicate_mask. The first such frame, and any frame after a gap longer
+ *         than AHRS_DT_MAX_US, only restarts the time base, so frames must be passed in order of
+ *         their sample time
+ */
+Status AHRS_Update(AHRS_State_t *state, const IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    uint32_t start_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&start_cycles));
+
+    //hold the latest reference directions, only their direction is used
+    if ((frame->updated_mask >> IMU_CHANNEL_ACC) & 1U) {
+        for (uint8_t i = 0U; i < 3U; i++) {
+            state->acc[i] = (float) frame->data[IMU_CHANNEL_ACC][i];
+        }
+        state->acc_valid = AHRS_Normalise(state->acc, 3U);
+    }
+    if ((frame->updated_mask >> IMU_CHANNEL_MAG) & 1U) {
+        for (uint8_t i = 0U; i < 3U; i++) {
+            state->mag[i] = (float) frame->data[IMU_CHANNEL_MAG][i];
+        }
+        state->mag_valid = AHRS_Normalise(state->mag, 3U);
+    }
+    if (!((frame->updated_mask >> IMU_CHANNEL_GYR) & 1U)
+    ||  ((frame->duplicate_mask >> IMU_CHANNEL_GYR) & 1U)) {
+        return SUCCESS;
+    }
+
+    //restart the time base on the first sample or after a gap
+    uint64_t elapsed_us = (frame->sample_us - state->last_us);
+    state->last_us      = frame->sample_us;
+    if (!state->started || (elapsed_us == 0ULL) || (elapsed_us > AHRS_DT_MAX_US)) {
+        state->started = 1U;
+        return SUCCESS;
+    }
+    float dt = ((float) elapsed_us * 1.0e-6f);
+
+    //propagate the orientation
+    float gyr[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        gyr[i] = ((float) frame->data[IMU_CHANNEL_GYR][i] / state->config.gyr_lsb_rad_s);
+    }
+    float q_dot[4];
+    if (state->config.filter == AHRS_FILTER_MADGWICK) {
+        AHRS_Madgwick(state, gyr, dt, q_dot);
+    } else {
+        AHRS_Mahony(state, gyr, dt, q_dot);
+    }
+    for (uint8_t k = 0U; k < 4U; k++) {
+        state->q[k] += (q_dot[k] * dt);
+    }
+    if (!AHRS_Normalise(state->q, 4U)) {
+        state->q[0] = 1.0f;
+    }
+
+    //benchmark the update
+    uint32_t end_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&end_cycles));
+    state->cycles_last   = (end_cycles - start_cycles);
+    state->cycles_total += state->cycles_last;
+    if (state->cycles_last > state->cycles_max) {
+        state->cycles_max = state->cycles_last;
+    }
+    state->update_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the current orientation
+ * @param  state: Pointer to the AHRS state
+ * @param  q:     Pointer to a 4-element array used to store the unit quaternion (w, x, y, z)
+ * @retval Status indicating success or invalid parameters
+ */
+Status AHRS_Get_Quaternion(AHRS_State_t *state, float *q) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(q));
+
+    for (uint8_t k = 0U; k < 4U; k++) {
+        q[k] = state->q[k];
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the estimated gyroscope bias and the cycles per update
+ * @param  state:  Pointer to the AHRS state
+ * @param  report: Pointer to a struct used to store the report
+ * @retval Status indicating success or invalid parameters
+ * @note   The bias is in rad/s. The cycles only cover updates that propagated the orientation
+ */
+Status AHRS_Get_Report(AHRS_State_t *state, AHRS_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->update_count = state->update_count;
+    report->cycles_last  = state->cycles_last;
+    report->cycles_max   = state->cycles_max;
+    report->cycles_mean  = (state->update_count == 0UL)
+                         ? 0UL : (uint32_t) (state->cycles_total / state->update_count);
+    for (uint8_t i = 0U; i < 3U; i++) {
+        report->bias[i] = state->bias[i];
+    }
+
+    return SUCCESS;
+}
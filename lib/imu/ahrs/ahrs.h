@@ -0,0 +1,99 @@
+/**
+ * @file    ahrs.h
+ * @brief   Attitude and Heading Reference System
+ * @details This header file contains the public interface for the on-MCU sensor fusion engine. It
+ *          includes constants, enumerations, configuration, state and report structures and
+ *          function prototypes used to estimate orientation from raw AMG frames.
+ */
+
+
+#ifndef __AHRS_H
+#define __AHRS_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/bno055/bno.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define AHRS_RAD_TO_DEG             (57.2957795f)
+#define AHRS_GYR_LSB_DEFAULT        (BNO_GYR_DPS * AHRS_RAD_TO_DEG)
+#define AHRS_MADGWICK_BETA_DEFAULT  (0.1f)
+#define AHRS_MAHONY_KP_DEFAULT      (1.0f)
+#define AHRS_DT_MAX_US              100000UL
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    AHRS_FILTER_MADGWICK = 0,
+    AHRS_FILTER_MAHONY
+} AHRS_Filter;
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    AHRS_Filter filter;
+    /* Optional */
+    float       gain;
+    float       bias_gain;
+    float       gyr_lsb_rad_s;
+    uint8_t     use_mag;
+} AHRS_Config_t;
+
+typedef struct {
+    AHRS_Config_t config;
+    float         q[4];
+    float         bias[3];
+    float         acc[3];
+    float         mag[3];
+    uint8_t       acc_valid;
+    uint8_t       mag_valid;
+    uint8_t       started;
+    uint64_t      last_us;
+    uint32_t      update_count;
+    uint32_t      cycles_last;
+    uint32_t      cycles_max;
+    uint64_t      cycles_total;
+} AHRS_State_t;
+
+typedef struct {
+    uint32_t update_count;
+    uint32_t cycles_last;
+    uint32_t cycles_max;
+    uint32_t cycles_mean;
+    float    bias[3];
+} AHRS_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status AHRS_Init          (AHRS_State_t *state, AHRS_Config_t *config);
+Status AHRS_Update        (AHRS_State_t *state, const IMU_Frame_t *frame);
+Status AHRS_Get_Quaternion(AHRS_State_t *state, float *q);
+Status AHRS_Get_Report    (AHRS_State_t *state, AHRS_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
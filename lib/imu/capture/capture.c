@@ -0,0 +1,274 @@
+/**
+ * @file    capture.c
+ * @brief   Pre-Trigger Event Capture
+ * @details This source file captures the full-rate frames around a motion event (e.g. the BNO055
+ *          high-g or any-motion interrupt), which the link cannot carry continuously. The engine
+ *          cycles through three states:
+ *          - Armed: every frame is written to a circular buffer, which keeps the latest
+ *            pre_frames + post_frames, and is trimmed to pre_frames before the event on a trigger
+ *          - Triggered: after CAP_Trigger(), frames sampled at or after the trigger time are
+ *            appended until post_frames have been captured, while earlier frames still in flight
+ *            are kept as pre-trigger frames. Frames already held that were sampled after the
+ *            trigger time, because the event was handled late, count towards post_frames
+ *          - Frozen: the capture is held unchanged, and drained a frame at a time with CAP_Peek()
+ *            and CAP_Release(), after which the engine re-arms with an empty pre-trigger buffer
+ *
+ *          The trigger is matched to the frames by sample time rather than by arrival, so queued
+ *          frames sampled before the event are not counted as post-trigger frames. Draining is
+ *          paced by the caller, e.g. with the link capacity left unused by the governor, so the
+ *          capture never delays acquisition or the regular output.
+ *
+ * @par     Functions include:
+ *          - CAP_Init(): Initialises an armed capture engine
+ *          - CAP_Push(): Adds a frame to the pre-trigger buffer or the capture
+ *          - CAP_Trigger(): Starts a capture at the time of an event
+ *          - CAP_Peek(): Gets the next frame of a frozen capture
+ *          - CAP_Release(): Releases the frame returned by CAP_Peek()
+ *          - CAP_Get_Report(): Gets the capture state and counters
+ *
+ * @note    All functions must be called from the same context, e.g. the application loop and the
+ *          event handlers it dispatches. Events during a capture are merged into it, and events
+ *          while frozen are missed. Frames pushed while frozen are not recorded, and are counted
+ */
+
+
+#include "capture.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Appends a frame to the buffer
+ * @param  state: Pointer to the capture state
+ * @param  frame: Pointer to the frame
+ * @retval None
+ * @note   The buffer must not be full
+ */
+static void CAP_Append(CAP_State_t *state, const IMU_Frame_t *frame) {
+    state->frames[(state->head + state->count) % CAP_FRAMES_MAX] = *frame;
+    state->count++;
+}
+
+/**
+ * @brief  Drops the oldest frame of the buffer
+ * @param  state: Pointer to the capture state
+ * @retval None
+ */
+static void CAP_Drop(CAP_State_t *state) {
+    state->head = ((state->head + 1U) % CAP_FRAMES_MAX);
+    state->count--;
+}
+
+/**
+ * @brief  Appends a frame, dropping the oldest once a limit is held
+ * @param  state: Pointer to the capture state
+ * @param  frame: Pointer to the frame
+ * @param  limit: Maximum number of frames held
+ * @retval None
+ */
+static void CAP_Append_Limited(CAP_State_t *state, const IMU_Frame_t *frame, uint16_t limit) {
+    if (limit == 0U) {
+        return;
+    }
+    if (state->count == limit) {
+        CAP_Drop(state);
+    }
+    CAP_Append(state, frame);
+}
+
+/**
+ * @brief  Freezes the capture for draining
+ * @param  state: Pointer to the capture state
+ * @retval None
+ */
+static void CAP_Freeze(CAP_State_t *state) {
+    state->capture_state = CAP_STATE_FROZEN;
+    state->drain_index   = 0U;
+    state->capture_count++;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an armed capture engine
+ * @param  state:  Pointer to the capture state
+ * @param  config: Pointer to a struct containing the capture settings
+ * @retval Status indicating success or invalid parameters
+ * @note   pre_frames + post_frames must not exceed CAP_FRAMES_MAX, and post_frames must not be 0
+ */
+Status CAP_Init(CAP_State_t *state, CAP_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->post_frames == 0U)
+    ||  (((uint32_t) config->pre_frames + config->post_frames) > CAP_FRAMES_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(CAP_State_t));
+    state->config        = *config;
+    state->capture_state = CAP_STATE_ARMED;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds a frame to the pre-trigger buffer or the capture
+ * @param  state: Pointer to the capture state
+ * @param  frame: Pointer to the frame
+ * @retval Status indicating success or invalid parameters
+ * @note   The capture is frozen once post_frames frames sampled at or after the trigger time have
+ *         been appended
+ */
+Status CAP_Push(CAP_State_t *state, const IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    switch (state->capture_state) {
+        case CAP_STATE_ARMED: {
+            uint16_t limit = (state->config.pre_frames + state->config.post_frames);
+            CAP_Append_Limited(state, frame, limit);
+            break;
+        }
+        case CAP_STATE_TRIGGERED: {
+            if ((state->post_count == 0U) && (frame->sample_us < state->trigger_us)) {
+                CAP_Append_Limited(state, frame, state->config.pre_frames);
+                break;
+            }
+            CAP_Append(state, frame);
+            state->post_count++;
+            if (state->post_count == state->config.post_frames) {
+                CAP_Freeze(state);
+            }
+            break;
+        }
+        case CAP_STATE_FROZEN: {
+            state->blind_count++;
+            break;
+        }
+        default: return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Starts a capture at the time of an event
+ * @param  state:      Pointer to the capture state
+ * @param  irq:        Interrupt that caused the event, which is reported with the capture
+ * @param  trigger_us: Time of the event in micro-seconds, on the timeline of the frame sample times
+ * @retval Status indicating success or invalid parameters
+ * @note   Events while a capture is being completed are merged into it, and events while a capture
+ *         is frozen are missed, as the pre-trigger buffer holds the frozen capture
+ */
+Status CAP_Trigger(CAP_State_t *state, BNO_IRQ irq, uint64_t trigger_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    switch (state->capture_state) {
+        case CAP_STATE_ARMED: {
+            state->capture_state = CAP_STATE_TRIGGERED;
+            state->trigger_irq   = irq;
+            state->trigger_us    = trigger_us;
+
+            //frames already held that were sampled after the event belong to the post window
+            state->post_count = 0U;
+            while ((state->post_count < state->count)
+            &&     (state->post_count < state->config.post_frames)) {
+                uint16_t index = ((state->head + state->count - state->post_count - 1U)
+                               % CAP_FRAMES_MAX);
+                if (state->frames[index].sample_us < trigger_us) {
+                    break;
+                }
+                state->post_count++;
+            }
+            while ((state->count - state->post_count) > state->config.pre_frames) {
+                CAP_Drop(state);
+            }
+            if (state->post_count == state->config.post_frames) {
+                CAP_Freeze(state);
+            }
+            break;
+        }
+        case CAP_STATE_TRIGGERED: state->merged_count++; break;
+        case CAP_STATE_FROZEN:    state->missed_count++; break;
+        default: return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the next frame of a frozen capture
+ * @param  state: Pointer to the capture state
+ * @param  frame: Pointer to a variable used to store a pointer to the frame
+ * @param  index: Pointer to a variable used to store the index of the frame in the capture, of
+ *                which the first pre_count frames (see CAP_Get_Report) precede the trigger
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if no capture is frozen. The frame remains valid until CAP_Release()
+ */
+Status CAP_Peek(CAP_State_t *state, const IMU_Frame_t **frame, uint16_t *index) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(index));
+    if (state->capture_state != CAP_STATE_FROZEN) {
+        return ERROR;
+    }
+
+    *frame = &state->frames[(state->head + state->drain_index) % CAP_FRAMES_MAX];
+    *index = state->drain_index;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Releases the frame returned by CAP_Peek()
+ * @param  state: Pointer to the capture state
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Re-arms the engine with an empty pre-trigger buffer once the last frame is released.
+ *         Returns ERROR if no capture is frozen
+ */
+Status CAP_Release(CAP_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+    if (state->capture_state != CAP_STATE_FROZEN) {
+        return ERROR;
+    }
+
+    state->drain_index++;
+    if (state->drain_index == state->count) {
+        state->head          = 0U;
+        state->count         = 0U;
+        state->capture_state = CAP_STATE_ARMED;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the capture state and counters
+ * @param  state:  Pointer to the capture state
+ * @param  report: Pointer to a struct used to store the state and counters
+ * @retval Status indicating success or invalid parameters
+ * @note   The trigger, pre_count and frame_count describe the latest capture once it is frozen
+ */
+Status CAP_Get_Report(CAP_State_t *state, CAP_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->capture_state = state->capture_state;
+    report->trigger_irq   = state->trigger_irq;
+    report->trigger_us    = state->trigger_us;
+    report->pre_count     = (state->capture_state == CAP_STATE_FROZEN)
+                          ? (uint16_t) (state->count - state->post_count) : 0U;
+    report->frame_count   = (state->capture_state == CAP_STATE_FROZEN) ? state->count : 0U;
+    report->drain_index   = state->drain_index;
+    report->capture_count = state->capture_count;
+    report->merged_count  = state->merged_count;
+    report->missed_count  = state->missed_count;
+    report->blind_count   = state->blind_count;
+
+    return SUCCESS;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file    capture.h
+ * @brief   Pre-Trigger Event Capture
+ * @details This header file contains the public interface for the event capture engine. It
+ *          includes constants, enumerations, configuration, state and report structures and
+ *          function prototypes used to freeze the full-rate frames around a motion event.
+ */
+
+
+#ifndef __CAPTURE_H
+#define __CAPTURE_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/bno055/bno.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define CAP_FRAMES_MAX              128U
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    CAP_STATE_ARMED = 0,
+    CAP_STATE_TRIGGERED,
+    CAP_STATE_FROZEN
+} CAP_State;
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t pre_frames;
+    uint16_t post_frames;
+} CAP_Config_t;
+
+typedef struct {
+    CAP_Config_t config;
+    IMU_Frame_t  frames[CAP_FRAMES_MAX];
+    uint16_t     head;
+    uint16_t     count;
+    uint16_t     post_count;
+    uint16_t     drain_index;
+    CAP_State    capture_state;
+    BNO_IRQ      trigger_irq;
+    uint64_t     trigger_us;
+    uint32_t     capture_count;
+    uint32_t     merged_count;
+    uint32_t     missed_count;
+    uint32_t     blind_count;
+} CAP_State_t;
+
+typedef struct {
+    CAP_State capture_state;
+    BNO_IRQ   trigger_irq;
+    uint64_t  trigger_us;
+    uint16_t  pre_count;
+    uint16_t  frame_count;
+    uint16_t  drain_index;
+    uint32_t  capture_count;
+    uint32_t  merged_count;
+    uint32_t  missed_count;
+    uint32_t  blind_count;
+} CAP_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status CAP_Init      (CAP_State_t *state, CAP_Config_t *config);
+Status CAP_Push      (CAP_State_t *state, const IMU_Frame_t *frame);
+Status CAP_Trigger   (CAP_State_t *state, BNO_IRQ irq, uint64_t trigger_us);
+Status CAP_Peek      (CAP_State_t *state, const IMU_Frame_t **frame, uint16_t *index);
+Status CAP_Release   (CAP_State_t *state);
+Status CAP_Get_Report(CAP_State_t *state, CAP_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,367 @@
+/**
+ * @file    codec.c
+ * @brief   Lossless Delta Frame Codec
+ * @details This source file compresses raw frames for transmission in batches, as consecutive
+ *          samples at the acquisition rate differ by a small fraction of their 16-bit range. Each
+ *          frame is encoded as:
+ *          - A header varint holding a key flag, the mask of the channels present and a 4-bit
+ *            sequence number, from which the decoder detects lost frames
+ *          - The sample time as an unsigned varint delta from the previous frame
+ *          - Each value of the present channels as the zig-zag varint of its delta from the
+ *            previous value of the channel, so small changes of either sign take a single byte
+ *
+ *          Every key_interval frames, a key frame resets the references of both ends to 0, so the
+ *          times and values of a key frame are absolute and a decoder can (re)synchronise on it.
+ *          Deltas wrap in 16 bits, so every value round trips exactly.
+ *
+ *          The sequence number wraps every 16 frames, so a gap of a multiple of 16 frames is not
+ *          detected. Frames lost in units that may reach that size, e.g. whole lines of a link,
+ *          should be encoded with each unit starting on a key frame (see CODEC_Force_Key()), so
+ *          every unit decodes on its own.
+ *
+ * @par     Functions include:
+ *          - CODEC_Init(): Initialises an encoder or decoder for a set of channels
+ *          - CODEC_Force_Key(): Makes the next encoded frame a key frame
+ *          - CODEC_Encode(): Appends an encoded frame to a buffer
+ *          - CODEC_Decode(): Decodes a frame from a buffer
+ *          - CODEC_Get_Report(): Gets the frame, sample and byte counts
+ *
+ * @note    The codec uses no peripherals, so the same source decodes the frames on the host. The
+ *          encoder and decoder must be initialised with the same channel_mask. Only the sample
+ *          time of a frame is carried, and duplicate samples are not encoded
+ */
+
+
+#include "codec.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the number of values of a channel
+ * @param  channel: Channel
+ * @retval Number of values
+ */
+static uint8_t CODEC_Values(IMU_Channel channel) {
+    switch (channel) {
+        case IMU_CHANNEL_QUA:   return 4U;
+        case IMU_CHANNEL_TEMP:  return 1U;
+        case IMU_CHANNEL_CALIB: return 1U;
+        default:                return 3U;
+    }
+}
+
+/**
+ * @brief  Writes an unsigned varint, 7 bits per byte with the top bit marking continuation
+ * @param  buffer: Pointer to the buffer
+ * @param  index:  Pointer to the write index, which is advanced past the varint
+ * @param  value:  Value to be written
+ * @retval None
+ */
+static void CODEC_Put_Varint(uint8_t *buffer, uint16_t *index, uint64_t value) {
+    while (value >= 0x80U) {
+        buffer[(*index)++] = (uint8_t) (value | 0x80U);
+        value >>= 7;
+    }
+    buffer[(*index)++] = (uint8_t) value;
+}
+
+/**
+ * @brief  Reads an unsigned varint
+ * @param  buffer: Pointer to the buffer
+ * @param  length: Number of bytes in the buffer
+ * @param  index:  Pointer to the read index, which is advanced past the varint
+ * @param  value:  Pointer to a variable used to store the value
+ * @retval 1 if a varint was read, or 0 if it is truncated or longer than 64 bits
+ */
+static uint8_t CODEC_Get_Varint(
+    const uint8_t *buffer,
+    uint16_t      length,
+    uint16_t      *index,
+    uint64_t      *value
+) {
+    *value = 0ULL;
+    for (uint8_t shift = 0U; shift < 64U; shift += 7U) {
+        if (*index >= length) {
+            return 0U;
+        }
+        uint8_t byte = buffer[(*index)++];
+        *value |= ((uint64_t) (byte & 0x7FU) << shift);
+        if (!(byte & 0x80U)) {
+            return 1U;
+        }
+    }
+    return 0U;
+}
+
+/**
+ * @brief  Maps a signed delta to an unsigned value of similar size (0, -1, 1, -2 -> 0, 1, 2, 3)
+ * @param  delta: Delta
+ * @retval Zig-zag encoded delta
+ */
+static uint16_t CODEC_Zigzag(int16_t delta) {
+    return (uint16_t) (((uint16_t) delta << 1) ^ ((delta < 0) ? 0xFFFFU : 0U));
+}
+
+/**
+ * @brief  Reverses CODEC_Zigzag()
+ * @param  value: Zig-zag encoded delta
+ * @retval Delta
+ */
+static int16_t CODEC_Unzigzag(uint16_t value) {
+    return (int16_t) ((value >> 1) ^ ((value & 1U) ? 0xFFFFU : 0U));
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an encoder or decoder for a set of channels
+ * @param  state:  Pointer to the codec state
+ * @param  config: Pointer to a struct containing the codec settings
+ * @retval Status indicating success or invalid parameters
+ * @note   A key_interval of 0 selects CODEC_KEY_INTERVAL_DEFAULT. The first frame encoded is a key
+ *         frame, and the decoder skips frames until it has received one
+ */
+Status CODEC_Init(CODEC_State_t *state, CODEC_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->channel_mask == 0U) || (config->channel_mask >> IMU_CHANNEL_COUNT)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(CODEC_State_t));
+    state->config = *config;
+    if (state->config.key_interval == 0U) {
+        state->config.key_interval = CODEC_KEY_INTERVAL_DEFAULT;
+    }
+
+    //the worst case size of a frame bounds the room required to encode one
+    state->frame_bytes_max = (CODEC_HEADER_BYTES_MAX + CODEC_TIME_BYTES_MAX);
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if ((config->channel_mask >> i) & 1U) {
+            state->values[i]         = CODEC_Values((IMU_Channel) i);
+            state->frame_bytes_max  += (uint16_t) (state->values[i] * CODEC_VALUE_BYTES_MAX);
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Makes the next encoded frame a key frame
+ * @param  state: Pointer to the codec state
+ * @retval Status indicating success or invalid parameters
+ * @note   The key interval restarts from the forced key frame
+ */
+Status CODEC_Force_Key(CODEC_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    state->key_countdown = 0U;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends an encoded frame to a buffer
+ * @param  state:    Pointer to the codec state
+ * @param  frame:    Pointer to the frame, of which the configured channels in frame->updated_mask
+ *                   are encoded
+ * @param  buffer:   Pointer to the buffer
+ * @param  capacity: Size of the buffer in bytes
+ * @param  length:   Pointer to the number of bytes already in the buffer, which is advanced past
+ *                   the encoded frame
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR, without encoding the frame, if fewer than frame_bytes_max (see
+ *         CODEC_Get_Report) bytes are free
+ */
+Status CODEC_Encode(
+    CODEC_State_t     *state,
+    const IMU_Frame_t *frame,
+    uint8_t           *buffer,
+    uint16_t          capacity,
+    uint16_t          *length
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(buffer));
+    CHECK_STATUS(Validate_Ptr(length));
+    if (*length > capacity) {
+        return INVALID_PARAM;
+    }
+    if ((capacity - *length) < state->frame_bytes_max) {
+        return ERROR;
+    }
+
+    //reset the references of a key frame, so its contents are absolute
+    uint8_t key = (state->key_countdown == 0U);
+    if (key) {
+        memset(state->prev, 0, sizeof(state->prev));
+        state->prev_us       = 0ULL;
+        state->key_countdown = state->config.key_interval;
+        state->key_count++;
+    }
+    state->key_countdown--;
+
+    uint16_t mask   = (frame->updated_mask & (uint16_t) ~frame->duplicate_mask
+                    &  state->config.channel_mask);
+    uint32_t header = (((uint32_t) state->sequence << (IMU_CHANNEL_COUNT + 1U))
+                    |  ((uint32_t) mask << 1) | key);
+    uint16_t index  = *length;
+    CODEC_Put_Varint(buffer, &index, header);
+    CODEC_Put_Varint(buffer, &index, (frame->sample_us - state->prev_us));
+    state->prev_us = frame->sample_us;
+    state->raw_bytes += CODEC_RAW_TIME_BYTES;
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((mask >> i) & 1U)) {
+            continue;
+        }
+        for (uint8_t j = 0U; j < state->values[i]; j++) {
+            int16_t value = frame->data[i][j];
+            int16_t delta = (int16_t) (uint16_t) ((uint16_t) value - (uint16_t) state->prev[i][j]);
+            CODEC_Put_Varint(buffer, &index, CODEC_Zigzag(delta));
+            state->prev[i][j] = value;
+        }
+        state->sample_count += state->values[i];
+        state->raw_bytes    += (uint32_t) (state->values[i] * CODEC_RAW_VALUE_BYTES);
+    }
+
+    state->sequence     = ((state->sequence + 1U) & ((1U << CODEC_SEQUENCE_BITS) - 1U));
+    state->coded_bytes += (uint32_t) (index - *length);
+    state->frame_count++;
+    *length = index;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Decodes a frame from a buffer
+ * @param  state:    Pointer to the codec state
+ * @param  buffer:   Pointer to the encoded frames
+ * @param  length:   Number of bytes in the buffer
+ * @param  consumed: Pointer to a variable used to store the number of bytes of the frame
+ * @param  frame:    Pointer to the frame to be written, holding the latest values of every channel,
+ *                   with the decoded channels set in frame->updated_mask
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if the frame is truncated or malformed. Frames following a sequence gap
+ *         are skipped until the next key frame, and are returned with an updated_mask of 0. A gap
+ *         before a key frame is counted as lost, but nothing is skipped
+ */
+Status CODEC_Decode(
+    CODEC_State_t *state,
+    const uint8_t *buffer,
+    uint16_t      length,
+    uint16_t      *consumed,
+    IMU_Frame_t   *frame
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(buffer));
+    CHECK_STATUS(Validate_Ptr(consumed));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    //parse the whole frame before applying it, so a truncated frame leaves the state unchanged
+    uint16_t index    = 0U;
+    uint64_t header   = 0ULL;
+    uint64_t delta_us = 0ULL;
+    if (!CODEC_Get_Varint(buffer, length, &index, &header)
+    ||  (header >> (IMU_CHANNEL_COUNT + 1U + CODEC_SEQUENCE_BITS))
+    ||  !CODEC_Get_Varint(buffer, length, &index, &delta_us)) {
+        return ERROR;
+    }
+    uint8_t  key      = (uint8_t) (header & 1U);
+    uint16_t mask     = (uint16_t) ((header >> 1) & ((1U << IMU_CHANNEL_COUNT) - 1U));
+    uint8_t  sequence = (uint8_t) (header >> (IMU_CHANNEL_COUNT + 1U));
+    if (mask & (uint16_t) ~state->config.channel_mask) {
+        return ERROR;
+    }
+
+    int16_t deltas[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((mask >> i) & 1U)) {
+            continue;
+        }
+        for (uint8_t j = 0U; j < state->values[i]; j++) {
+            uint64_t value = 0ULL;
+            if (!CODEC_Get_Varint(buffer, length, &index, &value) || (value > 0xFFFFU)) {
+                return ERROR;
+            }
+            deltas[i][j] = CODEC_Unzigzag((uint16_t) value);
+        }
+    }
+    *consumed = index;
+
+    //synchronise on key frames, and skip the frames following a gap until the next one
+    uint8_t expected = state->sequence;
+    state->sequence  = ((sequence + 1U) & ((1U << CODEC_SEQUENCE_BITS) - 1U));
+    if (key) {
+        if (state->synced && (sequence != expected)) {
+            state->lost_count++;
+        }
+        memset(state->prev, 0, sizeof(state->prev));
+        state->prev_us = 0ULL;
+        state->synced  = 1U;
+        state->key_count++;
+    } else if (!state->synced || (sequence != expected)) {
+        if (state->synced) {
+            state->lost_count++;
+        }
+        state->synced       = 0U;
+        state->skipped_count++;
+        frame->updated_mask = 0U;
+        return SUCCESS;
+    }
+
+    state->prev_us   += delta_us;
+    state->raw_bytes += CODEC_RAW_TIME_BYTES;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((mask >> i) & 1U)) {
+            continue;
+        }
+        for (uint8_t j = 0U; j < state->values[i]; j++) {
+            state->prev[i][j] = (int16_t) (uint16_t) ((uint16_t) state->prev[i][j]
+                                                     + (uint16_t) deltas[i][j]);
+        }
+        state->sample_count += state->values[i];
+        state->raw_bytes    += (uint32_t) (state->values[i] * CODEC_RAW_VALUE_BYTES);
+    }
+
+    memcpy(frame->data, state->prev, sizeof(frame->data));
+    frame->updated_mask   = mask;
+    frame->duplicate_mask = 0U;
+    frame->start_us       = state->prev_us;
+    frame->complete_us    = state->prev_us;
+    frame->sample_us      = state->prev_us;
+    state->coded_bytes   += index;
+    state->frame_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the frame, sample and byte counts
+ * @param  state:  Pointer to the codec state
+ * @param  report: Pointer to a struct used to store the counts
+ * @retval Status indicating success or invalid parameters
+ * @note   raw_bytes counts 2 bytes per value and 8 bytes per sample time, so raw_bytes /
+ *         coded_bytes is the compression ratio against the binary frames
+ */
+Status CODEC_Get_Report(CODEC_State_t *state, CODEC_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->frame_bytes_max = state->frame_bytes_max;
+    report->frame_count     = state->frame_count;
+    report->key_count       = state->key_count;
+    report->sample_count    = state->sample_count;
+    report->raw_bytes       = state->raw_bytes;
+    report->coded_bytes     = state->coded_bytes;
+    report->lost_count      = state->lost_count;
+    report->skipped_count   = state->skipped_count;
+
+    return SUCCESS;
+}
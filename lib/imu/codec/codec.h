@@ -0,0 +1,104 @@
+/**
+ * @file    codec.h
+ * @brief   Lossless Delta Frame Codec
+ * @details This header file contains the public interface for the delta frame codec. It includes
+ *          constants, configuration, state and report structures and function prototypes used to
+ *          encode raw frames as zig-zag varint deltas, and to decode them on either end of a link.
+ */
+
+
+#ifndef __CODEC_H
+#define __CODEC_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define CODEC_KEY_INTERVAL_DEFAULT  32U
+#define CODEC_SEQUENCE_BITS         4U
+#define CODEC_HEADER_BYTES_MAX      2U
+#define CODEC_TIME_BYTES_MAX        10U
+#define CODEC_VALUE_BYTES_MAX       3U
+#define CODEC_RAW_TIME_BYTES        8U
+#define CODEC_RAW_VALUE_BYTES       2U
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t channel_mask;
+    /* Optional */
+    uint16_t key_interval;
+} CODEC_Config_t;
+
+typedef struct {
+    CODEC_Config_t config;
+    uint8_t        values[IMU_CHANNEL_COUNT];
+    uint16_t       frame_bytes_max;
+    int16_t        prev[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    uint64_t       prev_us;
+    uint8_t        sequence;
+    uint16_t       key_countdown;
+    uint8_t        synced;
+    uint32_t       frame_count;
+    uint32_t       key_count;
+    uint32_t       sample_count;
+    uint32_t       raw_bytes;
+    uint32_t       coded_bytes;
+    uint32_t       lost_count;
+    uint32_t       skipped_count;
+} CODEC_State_t;
+
+typedef struct {
+    uint16_t frame_bytes_max;
+    uint32_t frame_count;
+    uint32_t key_count;
+    uint32_t sample_count;
+    uint32_t raw_bytes;
+    uint32_t coded_bytes;
+    uint32_t lost_count;
+    uint32_t skipped_count;
+} CODEC_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status CODEC_Init      (CODEC_State_t *state, CODEC_Config_t *config);
+Status CODEC_Force_Key (CODEC_State_t *state);
+Status CODEC_Encode    (
+    CODEC_State_t     *state,
+    const IMU_Frame_t *frame,
+    uint8_t           *buffer,
+    uint16_t          capacity,
+    uint16_t          *length
+);
+Status CODEC_Decode    (
+    CODEC_State_t *state,
+    const uint8_t *buffer,
+    uint16_t      length,
+    uint16_t      *consumed,
+    IMU_Frame_t   *frame
+);
+Status CODEC_Get_Report(CODEC_State_t *state, CODEC_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file    convert.h
+ * @brief   Batch Raw to Unit Conversion
+ * @details This header file contains the public interface for the batch conversion stage. It
+ *          includes constants, configuration, block, state and report structures and function
+ *          prototypes used to convert blocks of raw frames to units with precomputed reciprocals.
+ */
+
+
+#ifndef __CONVERT_H
+#define __CONVERT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../ring/ring.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define CONV_FRAMES_MAX             RING_CAPACITY
+#define CONV_UNROLL                 4U
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t channel_mask;
+    float    scale[IMU_CHANNEL_COUNT];
+} CONV_Config_t;
+
+typedef struct {
+    uint16_t count;
+    int16_t  raw[IMU_CHANNEL_COUNT][IMU_VALUES_MAX][CONV_FRAMES_MAX];
+    float    value[IMU_CHANNEL_COUNT][IMU_VALUES_MAX][CONV_FRAMES_MAX];
+} CONV_Block_t;
+
+typedef struct {
+    CONV_Config_t config;
+    float         reciprocal[IMU_CHANNEL_COUNT];
+    uint8_t       values[IMU_CHANNEL_COUNT];
+    uint32_t      value_count;
+    uint64_t      cycles_total;
+    uint32_t      cycles_max;
+} CONV_State_t;
+
+typedef struct {
+    uint32_t value_count;
+    float    cycles_per_value;
+    uint32_t cycles_max;
+} CONV_Report_t;
+
+typedef struct {
+    uint16_t value_count;
+    float    divide_cycles;
+    float    batch_cycles;
+    float    error_max;
+} CONV_Bench_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status CONV_Init          (CONV_State_t *state, CONV_Config_t *config);
+Status CONV_Scale         (const int16_t *raw, float *value, uint16_t count, float reciprocal);
+Status CONV_Gather        (
+    CONV_State_t      *state,
+    const IMU_Frame_t *frames,
+    uint16_t          count,
+    CONV_Block_t      *block
+);
+Status CONV_Convert       (CONV_State_t *state, CONV_Block_t *block);
+Status CONV_Get_Reciprocal(CONV_State_t *state, IMU_Channel channel, float *reciprocal);
+Status CONV_Benchmark     (
+    CONV_State_t      *state,
+    const IMU_Frame_t *frames,
+    uint16_t          count,
+    CONV_Block_t      *block,
+    CONV_Bench_t      *bench
+);
+Status CONV_Get_Report    (CONV_State_t *state, CONV_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
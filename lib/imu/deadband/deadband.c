@@ -0,0 +1,213 @@
+/**
+ * @file    deadband.c
+ * @brief   Change-Driven Output Filter
+ * @details This source file suppresses channel records that carry no new information, so that
+ *          the output of a mostly static installation scales with its motion rather than with the
+ *          sample rate. A record that the governor has scheduled is output only if:
+ *          - Any of its values differs from the last output record by more than the threshold of
+ *            the channel, or
+ *          - The heartbeat interval of the channel has expired since the last output record, so
+ *            consumers can tell a static channel from a lost link
+ *
+ *          Records are compared with the last output record rather than the previous one, so a
+ *          slow drift is output once it has accumulated beyond the threshold. The first record of
+ *          each channel is always output.
+ *
+ * @par     Functions include:
+ *          - DBAND_Init(): Initialises the thresholds and heartbeat intervals of the channels
+ *          - DBAND_Filter(): Gets whether a channel record should be output
+ *          - DBAND_Commit(): Latches a channel record once it has been output
+ *          - DBAND_Get_Report(): Gets the output, heartbeat and suppressed record counts
+ *
+ * @note    Thresholds are in the units of the values passed to DBAND_Filter(), e.g. the scaled
+ *          means of the governor. A threshold of 0 disables the filter of the channel
+ * @note    DBAND_Filter() only decides, so a record that could not be sent, e.g. because the TX
+ *          buffer was busy, does not become the reference. DBAND_Commit() must be called with the
+ *          same record once it has been queued for output
+ */
+
+
+#include "deadband.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets whether any value differs from the last output record by more than a threshold
+ * @param  last:      Pointer to the values of the last output record
+ * @param  values:    Pointer to the values of the record
+ * @param  count:     Number of values
+ * @param  threshold: Threshold of the channel
+ * @retval 1 if the record has changed, or 0 otherwise
+ */
+static uint8_t DBAND_Changed(
+    const float *last,
+    const float *values,
+    uint8_t     count,
+    float       threshold
+) {
+    for (uint8_t i = 0U; i < count; i++) {
+        if (fabsf(values[i] - last[i]) > threshold) {
+            return 1U;
+        }
+    }
+    return 0U;
+}
+
+/**
+ * @brief  Gets whether a record differs from the last output record of its channel
+ * @param  state:   Pointer to the deadband state
+ * @param  channel: Channel the record belongs to
+ * @param  values:  Pointer to the values of the record
+ * @param  count:   Number of values
+ * @retval 1 if the record has changed, the filter is disabled or nothing has been output yet
+ */
+static uint8_t DBAND_Channel_Changed(
+    const DBAND_State_t *state,
+    IMU_Channel         channel,
+    const float         *values,
+    uint8_t             count
+) {
+    float threshold = state->config.threshold[channel];
+    return ((threshold == 0.0f) || !((state->primed_mask >> channel) & 1U)
+         ||  DBAND_Changed(state->last[channel], values, count, threshold));
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the thresholds and heartbeat intervals of the channels
+ * @param  state:  Pointer to the deadband state
+ * @param  config: Pointer to a struct containing the deadband settings
+ * @retval Status indicating success or invalid parameters
+ * @note   A heartbeat_us of 0 selects DBAND_HEARTBEAT_DEFAULT_US. Negative thresholds are invalid
+ */
+Status DBAND_Init(DBAND_State_t *state, DBAND_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (config->threshold[i] < 0.0f) {
+            return INVALID_PARAM;
+        }
+    }
+
+    memset(state, 0, sizeof(DBAND_State_t));
+    state->config = *config;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (state->config.heartbeat_us[i] == 0UL) {
+            state->config.heartbeat_us[i] = DBAND_HEARTBEAT_DEFAULT_US;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets whether a channel record should be output
+ * @param  state:   Pointer to the deadband state
+ * @param  channel: Channel the record belongs to
+ * @param  values:  Pointer to the values of the record
+ * @param  count:   Number of values (at most IMU_VALUES_MAX)
+ * @param  time_us: Sample time of the record
+ * @param  emit:    Pointer to a variable used to store the result (1 = output, 0 = suppress)
+ * @retval Status indicating success or invalid parameters
+ * @note   Should only be called for records that are due, e.g. scheduled by the governor, as
+ *         each suppressed call is counted. An emitted record is not latched until it is passed to
+ *         @ref DBAND_Commit
+ */
+Status DBAND_Filter(
+    DBAND_State_t *state,
+    IMU_Channel   channel,
+    const float   *values,
+    uint8_t       count,
+    uint64_t      time_us,
+    uint8_t       *emit
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(values));
+    CHECK_STATUS(Validate_Ptr(emit));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+    if ((count == 0U) || (count > IMU_VALUES_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    //output filtered channels on a change beyond the threshold or an expired heartbeat
+    uint8_t primed  = ((state->primed_mask >> channel) & 1U);
+    uint8_t changed = DBAND_Channel_Changed(state, channel, values, count);
+    uint8_t expired = (primed && ((time_us - state->last_us[channel])
+                                  >= state->config.heartbeat_us[channel]));
+    *emit = (changed || expired);
+
+    if (*emit == 0U) {
+        state->suppressed_count[channel]++;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Latches a channel record once it has been output
+ * @param  state:   Pointer to the deadband state
+ * @param  channel: Channel the record belongs to
+ * @param  values:  Pointer to the values of the record
+ * @param  count:   Number of values (at most IMU_VALUES_MAX)
+ * @param  time_us: Sample time of the record
+ * @retval Status indicating success or invalid parameters
+ * @note   Should only be called for records that @ref DBAND_Filter emitted and that have been
+ *         queued for output, as each call is counted as an output record
+ */
+Status DBAND_Commit(
+    DBAND_State_t *state,
+    IMU_Channel   channel,
+    const float   *values,
+    uint8_t       count,
+    uint64_t      time_us
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(values));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+    if ((count == 0U) || (count > IMU_VALUES_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    //records that were emitted without a change are heartbeats
+    if (!DBAND_Channel_Changed(state, channel, values, count)) {
+        state->heartbeat_count[channel]++;
+    }
+    state->emitted_count[channel]++;
+
+    //latch the record as the reference of the next comparison
+    for (uint8_t i = 0U; i < count; i++) {
+        state->last[channel][i] = values[i];
+    }
+    state->last_us[channel]  = time_us;
+    state->primed_mask      |= (uint16_t) (1U << channel);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the output, heartbeat and suppressed record counts
+ * @param  state:  Pointer to the deadband state
+ * @param  report: Pointer to a struct used to store the counts
+ * @retval Status indicating success or invalid parameters
+ * @note   heartbeat_count is the number of output records that were only sent as heartbeats, and
+ *         is included in emitted_count
+ */
+Status DBAND_Get_Report(DBAND_State_t *state, DBAND_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        report->emitted_count[i]    = state->emitted_count[i];
+        report->heartbeat_count[i]  = state->heartbeat_count[i];
+        report->suppressed_count[i] = state->suppressed_count[i];
+    }
+
+    return SUCCESS;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file    deadband.h
+ * @brief   Change-Driven Output Filter
+ * @details This header file contains the public interface for the deadband output filter. It
+ *          includes constants, configuration, state and report structures and function prototypes
+ *          used to output channels only when they change or a heartbeat interval expires.
+ */
+
+
+#ifndef __DEADBAND_H
+#define __DEADBAND_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define DBAND_HEARTBEAT_DEFAULT_US  1000000UL
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    float    threshold[IMU_CHANNEL_COUNT];
+    /* Optional */
+    uint32_t heartbeat_us[IMU_CHANNEL_COUNT];
+} DBAND_Config_t;
+
+typedef struct {
+    DBAND_Config_t config;
+    float          last[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    uint64_t       last_us[IMU_CHANNEL_COUNT];
+    uint16_t       primed_mask;
+    uint32_t       emitted_count[IMU_CHANNEL_COUNT];
+    uint32_t       heartbeat_count[IMU_CHANNEL_COUNT];
+    uint32_t       suppressed_count[IMU_CHANNEL_COUNT];
+} DBAND_State_t;
+
+typedef struct {
+    uint32_t emitted_count[IMU_CHANNEL_COUNT];
+    uint32_t heartbeat_count[IMU_CHANNEL_COUNT];
+    uint32_t suppressed_count[IMU_CHANNEL_COUNT];
+} DBAND_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status DBAND_Init      (DBAND_State_t *state, DBAND_Config_t *config);
+Status DBAND_Filter    (
+    DBAND_State_t *state,
+    IMU_Channel   channel,
+    const float   *values,
+    uint8_t       count,
+    uint64_t      time_us,
+    uint8_t       *emit
+);
+Status DBAND_Commit    (
+    DBAND_State_t *state,
+    IMU_Channel   channel,
+    const float   *values,
+    uint8_t       count,
+    uint64_t      time_us
+);
+Status DBAND_Get_Report(DBAND_State_t *state, DBAND_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * @file    decimate.c
+ * @brief   Anti-Aliased Decimator
+ * @details This source file reduces the rate of up to DEC_CHANNELS_MAX raw channels by a factor,
+ *          low-pass filtering them first, so vibration above the output Nyquist frequency is
+ *          attenuated rather than aliased into the output. Each value passes through two stages:
+ *          - A third order CIC filter decimating by factor / 2, made of integrators run over each
+ *            block of factor / 2 int16 samples and combs run once per block. It needs no
+ *            multiplications, but its passband droops as sinc^3
+ *          - A linear phase FIR decimating by 2, designed at initialisation as a Blackman windowed
+ *            low-pass whose passband inverts the CIC droop. Only the retained outputs are
+ *            computed, as in a polyphase decomposition, and the taps are applied two at a time
+ *            with the Cortex-M4 SMLAD instruction on a doubled delay line of int16 samples
+ *
+ *          The FIR cutoff is DEC_CUTOFF at its input rate, i.e. 0.44 of the output rate. With the
+ *          default 48 taps, the passband is within 0.05 dB up to a third of the output rate, and
+ *          components that would alias below 0.3 of the output rate are attenuated by over 80 dB
+ *          by the FIR stage. Near multiples of the CIC output rate, only the CIC stage attenuates
+ *          them, by at least 37 dB for a factor of 4 and 43 dB for factors of 8 or more, against
+ *          about 10 dB for the mean of the same samples.
+ *
+ * @par     Functions include:
+ *          - DEC_Init(): Initialises the decimator and designs its FIR stage
+ *          - DEC_Push(): Adds a frame, filtering the configured channels
+ *          - DEC_Get_Frame(): Gets the latest outputs of the decimated channels
+ *          - DEC_Get_Report(): Gets the filter delay and the cycles per output sample
+ *
+ * @note    Values are in the raw units of the channels. Every updated sample is used, including
+ *          duplicates, so the filter runs on the uniform grid of the acquisition ticks. The first
+ *          taps / 2 outputs of each channel are withheld while the FIR delay line fills
+ */
+
+
+#include "decimate.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the number of values of a channel
+ * @param  channel: Channel
+ * @retval Number of values
+ */
+static uint8_t DEC_Values(IMU_Channel channel) {
+    switch (channel) {
+        case IMU_CHANNEL_QUA:   return 4U;
+        case IMU_CHANNEL_TEMP:  return 1U;
+        case IMU_CHANNEL_CALIB: return 1U;
+        default:                return 3U;
+    }
+}
+
+/**
+ * @brief  Designs the compensating low-pass FIR stage
+ * @param  state: Pointer to the decimator state, with cic_rate and config.taps set
+ * @retval None
+ * @note   The desired response, the inverse of the CIC droop up to DEC_CUTOFF and 0 above, is
+ *         integrated on DEC_DESIGN_POINTS frequencies, then windowed and scaled to unit DC gain
+ */
+static void DEC_Design(DEC_State_t *state) {
+    uint8_t taps   = state->config.taps;
+    float   centre = ((float) (taps - 1U) * 0.5f);
+    float   rate   = (float) state->cic_rate;
+    float   design[DEC_TAPS_MAX];
+    float   sum    = 0.0f;
+
+    for (uint8_t n = 0U; n < taps; n++) {
+        float response = 0.0f;
+        for (uint16_t k = 0U; k < DEC_DESIGN_POINTS; k++) {
+            //frequency in cycles per FIR input sample, and the CIC gain at it
+            float f    = (((float) k + 0.5f) * (DEC_CUTOFF / (float) DEC_DESIGN_POINTS));
+            float gain = 1.0f;
+            if (state->cic_rate > 1U) {
+                float ratio = (sinf(DEC_PI * f) / (rate * sinf((DEC_PI * f) / rate)));
+                gain = (ratio * ratio * ratio);
+            }
+            response += (cosf(2.0f * DEC_PI * f * ((float) n - centre)) / gain);
+        }
+        float window = (0.42f - (0.5f * cosf((2.0f * DEC_PI * (float) n) / (float) (taps - 1U)))
+                     + (0.08f * cosf((4.0f * DEC_PI * (float) n) / (float) (taps - 1U))));
+        design[n] = (response * window);
+        sum      += design[n];
+    }
+
+    for (uint8_t n = 0U; n < taps; n++) {
+        float coeff = ((design[n] / sum) * 32768.0f);
+        coeff = (coeff >= 0.0f) ? (coeff + 0.5f) : (coeff - 0.5f);
+        state->coeffs[n] = (coeff >= 32767.0f)  ? INT16_MAX
+                         : (coeff <= -32768.0f) ? INT16_MIN : (int16_t) coeff;
+    }
+}
+
+/**
+ * @brief  Runs the CIC stage of a value over a block of cic_rate samples
+ * @param  state:  Pointer to the decimator state
+ * @param  stream: Pointer to the value stream
+ * @retval CIC output, normalised to the input range
+ * @note   The integrators wrap in 32 bits, which the combs undo exactly, as the output range
+ *         (the input range times cic_rate^3) fits in 32 bits
+ */
+static int16_t DEC_CIC(DEC_State_t *state, DEC_Stream_t *stream) {
+    uint32_t i0 = stream->integrator[0];
+    uint32_t i1 = stream->integrator[1];
+    uint32_t i2 = stream->integrator[2];
+    for (uint8_t k = 0U; k < state->cic_rate; k++) {
+        i0 += (uint32_t) (int32_t) stream->block[k];
+        i1 += i0;
+        i2 += i1;
+    }
+    stream->integrator[0] = i0;
+    stream->integrator[1] = i1;
+    stream->integrator[2] = i2;
+
+    uint32_t value = i2;
+    for (uint8_t k = 0U; k < DEC_CIC_ORDER; k++) {
+        uint32_t delayed = stream->comb[k];
+        stream->comb[k]  = value;
+        value           -= delayed;
+    }
+
+    int32_t output = (int32_t) (((int64_t) (int32_t) value * state->cic_scale) >> DEC_CIC_SHIFT);
+    return (output > INT16_MAX) ? INT16_MAX : (output < INT16_MIN) ? INT16_MIN : (int16_t) output;
+}
+
+/**
+ * @brief  Runs the FIR stage of a value over its delay line
+ * @param  state:  Pointer to the decimator state
+ * @param  stream: Pointer to the value stream
+ * @param  index:  Index of the oldest sample in the delay line
+ * @retval FIR output, saturated to the int16_t range
+ * @note   Each SMLAD multiplies two pairs of int16 samples and taps and adds both products to the
+ *         accumulator. With unit DC gain the sum of the absolute Q15 taps stays well below 2, so
+ *         the accumulator cannot overflow
+ */
+static int16_t DEC_FIR(DEC_State_t *state, DEC_Stream_t *stream, uint8_t index) {
+    const int16_t *x  = &stream->line[index];
+    int32_t       acc = 0L;
+    for (uint8_t k = 0U; k < state->config.taps; k += 2U) {
+        uint32_t samples = 0UL;
+        uint32_t coeffs  = 0UL;
+        memcpy(&samples, &x[k], sizeof(samples));
+        memcpy(&coeffs, &state->coeffs[k], sizeof(coeffs));
+        acc = SMLAD(samples, coeffs, acc);
+    }
+
+    int32_t output = ((acc + (1L << 14)) >> 15);
+    if ((output > INT16_MAX) || (output < INT16_MIN)) {
+        state->saturation_count++;
+        return (output > INT16_MAX) ? INT16_MAX : INT16_MIN;
+    }
+    return (int16_t) output;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the decimator and designs its FIR stage
+ * @param  state:  Pointer to the decimator state
+ * @param  config: Pointer to a struct containing the decimator settings
+ * @retval Status indicating success or invalid parameters
+ * @note   factor must be even and at most DEC_FACTOR_MAX, and at most DEC_CHANNELS_MAX channels
+ *         may be set in channel_mask. taps must be even and at most DEC_TAPS_MAX, and 0 selects
+ *         DEC_TAPS_DEFAULT. The design runs in floating point, taking a few milli-seconds
+ */
+Status DEC_Init(DEC_State_t *state, DEC_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->channel_mask == 0U) || (config->channel_mask >> IMU_CHANNEL_COUNT)
+    ||  (config->factor < DEC_FIR_RATE) || (config->factor > DEC_FACTOR_MAX)
+    ||  (config->factor % DEC_FIR_RATE) || (config->taps % 2U) || (config->taps > DEC_TAPS_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(DEC_State_t));
+    state->config = *config;
+    if (state->config.taps == 0U) {
+        state->config.taps = DEC_TAPS_DEFAULT;
+    }
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((config->channel_mask >> i) & 1U)) {
+            continue;
+        }
+        if (state->channel_count == DEC_CHANNELS_MAX) {
+            return INVALID_PARAM;
+        }
+        DEC_Channel_t *channel = &state->channels[state->channel_count++];
+        channel->channel = (IMU_Channel) i;
+        channel->values  = DEC_Values((IMU_Channel) i);
+    }
+
+    //the CIC gain is cic_rate^3, removed with a fixed-point reciprocal
+    state->cic_rate  = (uint8_t) (state->config.factor / DEC_FIR_RATE);
+    uint32_t gain    = ((uint32_t) state->cic_rate * state->cic_rate * state->cic_rate);
+    state->cic_scale = (((1UL << DEC_CIC_SHIFT) + (gain / 2UL)) / gain);
+    DEC_Design(state);
+
+    //group delay of both stages, in input samples
+    state->delay_samples = (((float) DEC_CIC_ORDER * (float) (state->cic_rate - 1U) * 0.5f)
+                         + ((float) state->cic_rate * (float) (state->config.taps - 1U) * 0.5f));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds a frame, filtering the configured channels
+ * @param  state:      Pointer to the decimator state
+ * @param  frame:      Pointer to the frame, of which the configured channels in
+ *                     frame->updated_mask are used
+ * @param  ready_mask: Pointer to a variable used to store the mask of the channels with a new
+ *                     output (see DEC_Get_Frame), or 0 if there is none
+ * @retval Status indicating success or invalid parameters
+ * @note   Each channel outputs once every factor updates. The output is stamped with the time of
+ *         the input at the centre of the filter response, from the delay_samples and the input
+ *         period measured between outputs
+ */
+Status DEC_Push(DEC_State_t *state, const IMU_Frame_t *frame, uint16_t *ready_mask) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(ready_mask));
+
+    uint32_t start_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&start_cycles));
+
+    *ready_mask = 0U;
+    for (uint8_t i = 0U; i < state->channel_count; i++) {
+        DEC_Channel_t *channel = &state->channels[i];
+        if (!((frame->updated_mask >> channel->channel) & 1U)) {
+            continue;
+        }
+
+        //collect a block of cic_rate samples of each value
+        for (uint8_t j = 0U; j < channel->values; j++) {
+            channel->stream[j].block[channel->phase] = frame->data[channel->channel][j];
+        }
+        if (++channel->phase < state->cic_rate) {
+            continue;
+        }
+        channel->phase = 0U;
+
+        //run the CIC stage over the block, writing its output twice so the delay line can be read
+        //in order from any index
+        uint8_t taps  = state->config.taps;
+        uint8_t index = channel->line_index;
+        for (uint8_t j = 0U; j < channel->values; j++) {
+            DEC_Stream_t *stream = &channel->stream[j];
+            int16_t      sample  = DEC_CIC(state, stream);
+            stream->line[index]        = sample;
+            stream->line[index + taps] = sample;
+        }
+        channel->line_index = (uint8_t) ((index + 1U) % taps);
+        if (channel->line_count < taps) {
+            channel->line_count++;
+        }
+
+        //run the FIR stage on every other CIC output, once the delay line is full
+        channel->fir_phase ^= 1U;
+        if (channel->fir_phase) {
+            continue;
+        }
+        uint64_t previous_us = channel->decision_us;
+        channel->decision_us = frame->sample_us;
+        if ((channel->line_count < taps) || (previous_us == 0ULL)) {
+            continue;
+        }
+        for (uint8_t j = 0U; j < channel->values; j++) {
+            channel->output[j] = DEC_FIR(state, &channel->stream[j], channel->line_index);
+        }
+
+        float    period_us = ((float) (frame->sample_us - previous_us)
+                           / (float) state->config.factor);
+        uint64_t delay_us  = (uint64_t) (state->delay_samples * period_us);
+        channel->output_us   = (frame->sample_us > delay_us) ? (frame->sample_us - delay_us) : 0ULL;
+        state->ready_us      = channel->output_us;
+        state->output_count += channel->values;
+        *ready_mask |= (uint16_t) (1U << channel->channel);
+    }
+    state->ready_mask = *ready_mask;
+
+    uint32_t end_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&end_cycles));
+    uint32_t cycles = (end_cycles - start_cycles);
+    state->cycles_total += cycles;
+    if (cycles > state->cycles_max) {
+        state->cycles_max = cycles;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the latest outputs of the decimated channels
+ * @param  state: Pointer to the decimator state
+ * @param  frame: Pointer to the frame to be written, with the channels output by the latest call to
+ *                DEC_Push() set in frame->updated_mask
+ * @retval Status indicating success or invalid parameters
+ * @note   frame->sample_us is the time of the latest output. Other channels are left unchanged
+ */
+Status DEC_Get_Frame(DEC_State_t *state, IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    for (uint8_t i = 0U; i < state->channel_count; i++) {
+        DEC_Channel_t *channel = &state->channels[i];
+        for (uint8_t j = 0U; j < channel->values; j++) {
+            frame->data[channel->channel][j] = channel->output[j];
+        }
+    }
+    frame->updated_mask   = state->ready_mask;
+    frame->duplicate_mask = 0U;
+    frame->sample_us      = state->ready_us;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the filter delay and the cycles per output sample
+ * @param  state:  Pointer to the decimator state
+ * @param  report: Pointer to a struct used to store the report
+ * @retval Status indicating success or invalid parameters
+ * @note   cycles_per_output includes the CIC work on every input, divided by the values output.
+ *         cycles_max is the longest call to DEC_Push()
+ */
+Status DEC_Get_Report(DEC_State_t *state, DEC_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->factor            = state->config.factor;
+    report->taps              = state->config.taps;
+    report->delay_samples     = state->delay_samples;
+    report->output_count      = state->output_count;
+    report->saturation_count  = state->saturation_count;
+    report->cycles_per_output = (state->output_count == 0UL)
+                              ? 0UL : (uint32_t) (state->cycles_total / state->output_count);
+    report->cycles_max        = state->cycles_max;
+
+    return SUCCESS;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file    decimate.h
+ * @brief   Anti-Aliased Decimator
+ * @details This header file contains the public interface for the decimation filter. It includes
+ *          constants, configuration, state and report structures and function prototypes used to
+ *          reduce the rate of raw channels with a CIC and a compensating FIR stage.
+ */
+
+
+#ifndef __DECIMATE_H
+#define __DECIMATE_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define DEC_CHANNELS_MAX            2U
+#define DEC_CIC_ORDER               3U
+#define DEC_CIC_RATE_MAX            16U
+#define DEC_CIC_SHIFT               24U
+#define DEC_FIR_RATE                2U
+#define DEC_FACTOR_MAX              (DEC_CIC_RATE_MAX * DEC_FIR_RATE)
+#define DEC_TAPS_MAX                64U
+#define DEC_TAPS_DEFAULT            48U
+#define DEC_CUTOFF                  (0.22f)
+#define DEC_DESIGN_POINTS           256U
+#define DEC_PI                      (3.14159265f)
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t channel_mask;
+    uint8_t  factor;
+    /* Optional */
+    uint8_t  taps;
+} DEC_Config_t;
+
+typedef struct {
+    uint32_t integrator[DEC_CIC_ORDER];
+    uint32_t comb[DEC_CIC_ORDER];
+    int16_t  block[DEC_CIC_RATE_MAX];
+    int16_t  line[2U * DEC_TAPS_MAX];
+} DEC_Stream_t;
+
+typedef struct {
+    IMU_Channel  channel;
+    uint8_t      values;
+    DEC_Stream_t stream[IMU_VALUES_MAX];
+    uint8_t      phase;
+    uint8_t      fir_phase;
+    uint8_t      line_index;
+    uint8_t      line_count;
+    uint64_t     decision_us;
+    uint64_t     output_us;
+    int16_t      output[IMU_VALUES_MAX];
+} DEC_Channel_t;
+
+typedef struct {
+    DEC_Config_t  config;
+    uint8_t       cic_rate;
+    uint32_t      cic_scale;
+    int16_t       coeffs[DEC_TAPS_MAX];
+    float         delay_samples;
+    DEC_Channel_t channels[DEC_CHANNELS_MAX];
+    uint8_t       channel_count;
+    uint16_t      ready_mask;
+    uint64_t      ready_us;
+    uint32_t      output_count;
+    uint32_t      saturation_count;
+    uint64_t      cycles_total;
+    uint32_t      cycles_max;
+} DEC_State_t;
+
+typedef struct {
+    uint8_t  factor;
+    uint8_t  taps;
+    float    delay_samples;
+    uint32_t output_count;
+    uint32_t saturation_count;
+    uint32_t cycles_per_output;
+    uint32_t cycles_max;
+} DEC_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status DEC_Init      (DEC_State_t *state, DEC_Config_t *config);
+Status DEC_Push      (DEC_State_t *state, const IMU_Frame_t *frame, uint16_t *ready_mask);
+Status DEC_Get_Frame (DEC_State_t *state, IMU_Frame_t *frame);
+Status DEC_Get_Report(DEC_State_t *state, DEC_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
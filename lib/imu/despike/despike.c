@@ -0,0 +1,253 @@
+/**
+ * @file    despike.c
+ * @brief   Streaming Spike Rejection
+ * @details This source file removes single-sample spikes from the raw channels, e.g. from UART
+ *          bit errors in unchecked reads or from EMI, before they reach the fusion, statistics and
+ *          output stages. Each value of a configured channel is passed through a causal Hampel
+ *          filter over the latest window samples, including itself:
+ *          - The median m of the window and its median absolute deviation (MAD) are found
+ *          - The value is rejected if it differs from m by more than sigma * 1.4826 * MAD, which is
+ *            sigma standard deviations for Gaussian noise, or by more than floor_lsb if greater,
+ *            so that a noiseless window does not reject every change
+ *          - A rejected value is replaced with m, and kept raw in the window, so an isolated spike
+ *            never moves the median
+ *
+ *          Each window is kept both in arrival order and sorted, so a sample costs one removal
+ *          and one insertion in the sorted copy, and the MAD is found by walking outwards from
+ *          the median, both O(window) with window at most SPIKE_WINDOW_MAX. The filter is causal,
+ *          so accepted values are not delayed, but a step is only accepted once it has moved the
+ *          median, i.e. after window / 2 samples.
+ *
+ * @par     Functions include:
+ *          - SPIKE_Init(): Initialises the windows and thresholds of the channels
+ *          - SPIKE_Filter(): Replaces the spikes of the updated channels of a frame in place
+ *          - SPIKE_Get_Report(): Gets the filtered, rejected and held value counts
+ *
+ * @note    Values are passed through until a window is full. Duplicate reads of a channel are held
+ *          at the last output values, so a repeated spike is not output either. Angle channels
+ *          (e.g. EUL) wrap, so their wrap would be rejected as a spike, and should not be filtered
+ */
+
+
+#include "despike.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the number of values of a channel
+ * @param  channel: Channel
+ * @retval Number of values
+ */
+static uint8_t SPIKE_Values(IMU_Channel channel) {
+    switch (channel) {
+        case IMU_CHANNEL_QUA:   return 4U;
+        case IMU_CHANNEL_TEMP:  return 1U;
+        case IMU_CHANNEL_CALIB: return 1U;
+        default:                return 3U;
+    }
+}
+
+/**
+ * @brief  Replaces a value of a sorted window with another, keeping it sorted
+ * @param  sorted: Pointer to the sorted window
+ * @param  count:  Number of values in the window
+ * @param  old:    Value to remove, which must be in the window
+ * @param  value:  Value to insert
+ * @retval None
+ */
+static void SPIKE_Replace(int16_t *sorted, uint8_t count, int16_t old, int16_t value) {
+    uint8_t i = 0U;
+    while ((i < (count - 1U)) && (sorted[i] != old)) {
+        i++;
+    }
+
+    //shift the neighbours into the slot of the old value until the new value fits
+    while ((i > 0U) && (sorted[i - 1U] > value)) {
+        sorted[i] = sorted[i - 1U];
+        i--;
+    }
+    while ((i < (count - 1U)) && (sorted[i + 1U] < value)) {
+        sorted[i] = sorted[i + 1U];
+        i++;
+    }
+    sorted[i] = value;
+}
+
+/**
+ * @brief  Inserts a value into a sorted window that is not full
+ * @param  sorted: Pointer to the sorted window
+ * @param  count:  Number of values in the window before the insertion
+ * @param  value:  Value to insert
+ * @retval None
+ */
+static void SPIKE_Insert(int16_t *sorted, uint8_t count, int16_t value) {
+    uint8_t i = count;
+    while ((i > 0U) && (sorted[i - 1U] > value)) {
+        sorted[i] = sorted[i - 1U];
+        i--;
+    }
+    sorted[i] = value;
+}
+
+/**
+ * @brief  Gets the median absolute deviation of a full sorted window
+ * @param  sorted: Pointer to the sorted window
+ * @param  count:  Number of values in the window, which must be odd
+ * @retval Median absolute deviation
+ * @note   The deviations below and above the median each grow away from it, so the smallest
+ *         count / 2 + 1 deviations are taken in order by merging the two sides
+ */
+static int32_t SPIKE_MAD(const int16_t *sorted, uint8_t count) {
+    uint8_t mid    = (count / 2U);
+    int32_t median = sorted[mid];
+    int32_t mad    = 0L;
+    uint8_t lo     = mid;
+    uint8_t hi     = mid;
+    for (uint8_t i = 0U; i < mid; i++) {
+        int32_t below = (lo > 0U) ? (median - sorted[lo - 1U]) : INT32_MAX;
+        int32_t above = (hi < (count - 1U)) ? (sorted[hi + 1U] - median) : INT32_MAX;
+        if (below <= above) {
+            mad = below;
+            lo--;
+        } else {
+            mad = above;
+            hi++;
+        }
+    }
+    return mad;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the windows and thresholds of the channels
+ * @param  state:  Pointer to the spike rejection state
+ * @param  config: Pointer to a struct containing the spike rejection settings
+ * @retval Status indicating success or invalid parameters
+ * @note   A window of 0 selects SPIKE_WINDOW_DEFAULT, a sigma of 0 SPIKE_SIGMA_DEFAULT and a
+ *         floor_lsb of 0 SPIKE_FLOOR_DEFAULT_LSB. Windows must be odd, from 3 to SPIKE_WINDOW_MAX,
+ *         and negative sigmas are invalid
+ */
+Status SPIKE_Init(SPIKE_State_t *state, SPIKE_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->channel_mask == 0U) || (config->channel_mask >> IMU_CHANNEL_COUNT)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(SPIKE_State_t));
+    state->config = *config;
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (state->config.window[i] == 0U) {
+            state->config.window[i] = SPIKE_WINDOW_DEFAULT;
+        }
+        if (state->config.sigma[i] == 0.0f) {
+            state->config.sigma[i] = SPIKE_SIGMA_DEFAULT;
+        }
+        if (state->config.floor_lsb[i] == 0U) {
+            state->config.floor_lsb[i] = SPIKE_FLOOR_DEFAULT_LSB;
+        }
+        uint8_t window = state->config.window[i];
+        if ((window < 3U) || (window > SPIKE_WINDOW_MAX) || ((window % 2U) == 0U)
+        ||  (state->config.sigma[i] < 0.0f)) {
+            return INVALID_PARAM;
+        }
+        state->scale[i]  = (state->config.sigma[i] * SPIKE_MAD_SIGMA);
+        state->values[i] = SPIKE_Values((IMU_Channel) i);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Replaces the spikes of the updated channels of a frame in place
+ * @param  state: Pointer to the spike rejection state
+ * @param  frame: Pointer to the frame, whose raw values are filtered
+ * @retval Status indicating success or invalid parameters
+ * @note   Intended to be called from the acquisition interrupt, before the frame is queued or
+ *         published. Costs O(window) per value of each configured channel updated in the frame
+ */
+Status SPIKE_Filter(SPIKE_State_t *state, IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    uint16_t mask = (state->config.channel_mask & frame->updated_mask);
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((mask >> i) & 1U)) {
+            continue;
+        }
+        SPIKE_Window_t *window = &state->windows[i];
+        uint8_t        size    = state->config.window[i];
+
+        //hold duplicate reads at the last output, rather than counting them twice in the window
+        if (((frame->duplicate_mask >> i) & 1U) && (window->count != 0U)) {
+            for (uint8_t j = 0U; j < state->values[i]; j++) {
+                frame->data[i][j] = window->last[j];
+            }
+            state->held_count[i] += state->values[i];
+            continue;
+        }
+
+        for (uint8_t j = 0U; j < state->values[i]; j++) {
+            int16_t value   = frame->data[i][j];
+            int16_t *sorted = window->sorted[j];
+            if (window->count < size) {
+                SPIKE_Insert(sorted, window->count, value);
+            } else {
+                SPIKE_Replace(sorted, size, window->history[j][window->index], value);
+            }
+            window->history[j][window->index] = value;
+
+            //test the value against the median once the window is full
+            if (window->count >= (size - 1U)) {
+                int32_t median    = sorted[size / 2U];
+                int32_t deviation = ((int32_t) value - median);
+                float   threshold = (state->scale[i] * (float) SPIKE_MAD(sorted, size));
+                if (threshold < (float) state->config.floor_lsb[i]) {
+                    threshold = (float) state->config.floor_lsb[i];
+                }
+                if ((float) ((deviation < 0L) ? -deviation : deviation) > threshold) {
+                    frame->data[i][j] = (int16_t) median;
+                    state->rejected_count[i]++;
+                }
+            }
+            window->last[j] = frame->data[i][j];
+        }
+        if (window->count < size) {
+            window->count++;
+        }
+        window->index = (uint8_t) ((window->index + 1U) % size);
+        state->sample_count[i] += state->values[i];
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the filtered, rejected and held value counts
+ * @param  state:  Pointer to the spike rejection state
+ * @param  report: Pointer to a struct used to store the counts of each channel
+ * @retval Status indicating success or invalid parameters
+ * @note   sample_count counts the values filtered, of which rejected_count were replaced with
+ *         the median. held_count counts the values of duplicate reads held at the last output.
+ *         The counts are read without locking, so they may be a frame apart from each other
+ */
+Status SPIKE_Get_Report(SPIKE_State_t *state, SPIKE_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        report->sample_count[i]   = state->sample_count[i];
+        report->rejected_count[i] = state->rejected_count[i];
+        report->held_count[i]     = state->held_count[i];
+    }
+
+    return SUCCESS;
+}
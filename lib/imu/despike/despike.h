@@ -0,0 +1,85 @@
+/**
+ * @file    despike.h
+ * @brief   Streaming Spike Rejection
+ * @details This header file contains the public interface for the spike rejection stage. It
+ *          includes constants, configuration, state and report structures and function prototypes
+ *          used to replace single-sample outliers of the raw channels with a rolling median.
+ */
+
+
+#ifndef __DESPIKE_H
+#define __DESPIKE_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define SPIKE_WINDOW_MAX            9U
+#define SPIKE_WINDOW_DEFAULT        5U
+#define SPIKE_SIGMA_DEFAULT         (3.0f)
+#define SPIKE_FLOOR_DEFAULT_LSB     16U
+#define SPIKE_MAD_SIGMA             (1.4826f)
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t channel_mask;
+    /* Optional */
+    uint8_t  window[IMU_CHANNEL_COUNT];
+    float    sigma[IMU_CHANNEL_COUNT];
+    uint16_t floor_lsb[IMU_CHANNEL_COUNT];
+} SPIKE_Config_t;
+
+typedef struct {
+    int16_t history[IMU_VALUES_MAX][SPIKE_WINDOW_MAX];
+    int16_t sorted[IMU_VALUES_MAX][SPIKE_WINDOW_MAX];
+    int16_t last[IMU_VALUES_MAX];
+    uint8_t index;
+    uint8_t count;
+} SPIKE_Window_t;
+
+typedef struct {
+    SPIKE_Config_t config;
+    SPIKE_Window_t windows[IMU_CHANNEL_COUNT];
+    float          scale[IMU_CHANNEL_COUNT];
+    uint8_t        values[IMU_CHANNEL_COUNT];
+    uint32_t       sample_count[IMU_CHANNEL_COUNT];
+    uint32_t       rejected_count[IMU_CHANNEL_COUNT];
+    uint32_t       held_count[IMU_CHANNEL_COUNT];
+} SPIKE_State_t;
+
+typedef struct {
+    uint32_t sample_count[IMU_CHANNEL_COUNT];
+    uint32_t rejected_count[IMU_CHANNEL_COUNT];
+    uint32_t held_count[IMU_CHANNEL_COUNT];
+} SPIKE_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status SPIKE_Init      (SPIKE_State_t *state, SPIKE_Config_t *config);
+Status SPIKE_Filter    (SPIKE_State_t *state, IMU_Frame_t *frame);
+Status SPIKE_Get_Report(SPIKE_State_t *state, SPIKE_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file    events.c
+ * @brief   BNO055 Interrupt Event Engine
+ * @details This source file dispatches BNO055 interrupts (any/no motion, high-g, gyro high rate,
+ *          data ready) to handlers registered per interrupt. The EXTI callback of the INT pin only
+ *          records the edge and its DWT time in micro-seconds via EVT_Signal(). EVT_Poll() then
+ *          services the edge from the application loop: INT_STA is read once, the INT pin is
+ *          released straight after, and every set status bit is passed to its handler with the
+ *          time of the edge.
+ *
+ *          Reading INT_STA once matters because it is cleared on read: polling each interrupt with
+ *          BNO_Get_IRQ_Status() loses every bit other than the one being polled. Edges signalled
+ *          while an earlier edge is being serviced are counted and serviced by the next poll, and
+ *          an INT pin that is already asserted without an edge (e.g. at start-up) is also
+ *          serviced, so the pin can never stay latched. The reaction time, from the edge to the
+ *          dispatch after the INT_STA read, is bounded by the period of the application loop plus
+ *          the read, and its maximum is reported in micro-seconds.
+ *
+ * @par     Functions include:
+ *          - EVT_Init(): Initialises the event engine
+ *          - EVT_Register_Handler(): Registers the handler of a BNO055 interrupt
+ *          - EVT_Signal(): Signals an INT pin edge
+ *          - EVT_Get_Pending(): Checks whether an edge or an asserted INT pin awaits service
+ *          - EVT_Poll(): Services a signalled edge and dispatches its interrupts
+ *          - EVT_Get_Report(): Gets the event statistics
+ *
+ * @note    The engine assumes register page 0 is selected
+ * @note    An interrupt raised between the INT_STA read and the INT release of the same service
+ *          is cleared by the release. This window is a single register write
+ */
+
+
+#include "events.h"
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the event engine
+ * @param  state:  Pointer to the event engine state
+ * @param  config: Pointer to a struct containing the INT pin settings
+ * @param  usart:  Pointer to a struct containing the settings of the USART connected to the BNO055
+ * @retval Status indicating success or invalid parameters
+ * @note   The INT pin must be configured as an input and its EXTI callback must call
+ *         @ref EVT_Signal
+ */
+Status EVT_Init(EVT_State_t *state, EVT_Config_t *config, USART_Config_t *usart) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    CHECK_STATUS(Validate_Ptr(config->int_port));
+    CHECK_STATUS(Validate_Ptr(usart));
+    CHECK_STATUS(Validate_Enum(config->int_pin, GPIO_PIN_0, GPIO_PIN_15));
+
+    memset(state, 0, sizeof(EVT_State_t));
+    state->config = *config;
+    state->usart  = usart;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Registers the handler of a BNO055 interrupt
+ * @param  state:   Pointer to the event engine state
+ * @param  irq:     BNO055 interrupt
+ * @param  handler: Function called from @ref EVT_Poll when the interrupt is set, or NULL to
+ *                  unregister the interrupt
+ * @param  context: Pointer passed to the handler
+ * @retval Status indicating success or invalid parameters
+ * @note   The interrupt must also be enabled and masked to the INT pin in the BNO055
+ */
+Status EVT_Register_Handler(EVT_State_t *state, BNO_IRQ irq, EVT_Handler_t handler, void *context) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Enum(irq, BNO_IRQ_ACC_BSX_DRDY, BNO_IRQ_ACC_NM));
+
+    state->handler[irq] = handler;
+    state->context[irq] = context;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Signals an INT pin edge
+ * @param  state:  Pointer to the event engine state
+ * @param  now_us: Current time in micro-seconds, from @ref DWT_Get_Time_US
+ * @retval Status indicating success or invalid parameters
+ * @note   Intended to be called from the EXTI callback of the BNO055 INT pin. Only the edge
+ *         counter and the low word of the time are written, each in a single access, so no
+ *         locking is needed against @ref EVT_Poll
+ */
+Status EVT_Signal(EVT_State_t *state, uint64_t now_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    state->edge_time_us = (uint32_t) now_us;
+    state->edge_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Checks whether an edge or an asserted INT pin awaits service
+ * @param  state:   Pointer to the event engine state
+ * @param  pending: Pointer to a variable set to 1U if @ref EVT_Poll has work to do, otherwise 0U
+ * @retval Status indicating success or invalid parameters
+ * @note   Does not use the bus, so it can be used to reserve the bus only when needed
+ */
+Status EVT_Get_Pending(EVT_State_t *state, uint8_t *pending) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(pending));
+
+    uint8_t asserted = (GPIO_Read_Pin(state->config.int_port, state->config.int_pin) == BIT_SET);
+    *pending = ((state->edge_count != state->handled_edges) || asserted);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Services a signalled edge and dispatches its interrupts
+ * @param  state:  Pointer to the event engine state
+ * @param  now_us: Current time in micro-seconds, from @ref DWT_Get_Time_US
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Handlers are called in interrupt bit order, with the time of the edge, or now_us for an
+ *         INT pin asserted without an edge. Set bits without a registered handler are counted as
+ *         unhandled
+ * @note   A failed INT_STA read is counted, and leaves the edge and the INT pin pending, so the
+ *         next poll retries it
+ * @note   Should be called at least once per application loop, as the loop period bounds the
+ *         reaction time
+ */
+Status EVT_Poll(EVT_State_t *state, uint64_t now_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    //service new edges, or an INT pin that is asserted without an edge
+    uint32_t edge_count = state->edge_count;
+    uint8_t  asserted   = (GPIO_Read_Pin(state->config.int_port, state->config.int_pin) == BIT_SET);
+    if ((edge_count == state->handled_edges) && !asserted) {
+        return SUCCESS;
+    }
+
+    //extend the time of the edge to 64 bits from its age, which is below 2^31 micro-seconds, or
+    //negative for an edge signalled since now_us was read
+    uint64_t timestamp_us = now_us;
+    if (edge_count != state->handled_edges) {
+        uint32_t age_us = ((uint32_t) now_us - state->edge_time_us);
+        timestamp_us   -= (((int32_t) age_us > 0L) ? age_us : 0UL);
+    }
+
+    //read INT_STA once, then release the INT pin so the next interrupt produces a new edge
+    uint8_t irq_status = 0U;
+    if (BNO_Get_IRQ_Status_All(state->usart, &irq_status) != SUCCESS) {
+        state->read_error_count++;
+        return SUCCESS;
+    }
+    state->handled_edges = edge_count;
+    CHECK_STATUS(BNO_Clear_INT(state->usart));
+    if (irq_status == 0U) {
+        state->empty_count++;
+        return SUCCESS;
+    }
+
+    //record the delay between the INT edge and the dispatch
+    uint64_t dispatch_us = 0ULL;
+    CHECK_STATUS(DWT_Get_Time_US(&dispatch_us));
+    uint32_t reaction = (uint32_t) (dispatch_us - timestamp_us);
+    if (reaction > state->reaction_max_us) {
+        state->reaction_max_us = reaction;
+    }
+
+    //dispatch every set bit
+    for (uint8_t i = 0U; i < EVT_IRQ_COUNT; i++) {
+        if (!((irq_status >> i) & 1U)) {
+            continue;
+        }
+        state->event_count[i]++;
+        if (state->handler[i] == NULL) {
+            state->unhandled_count++;
+            continue;
+        }
+        state->handler[i]((BNO_IRQ) i, timestamp_us, state->context[i]);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the event statistics
+ * @param  state:  Pointer to the event engine state
+ * @param  report: Pointer to a struct used to store the event statistics
+ * @retval Status indicating success or invalid parameters
+ */
+Status EVT_Get_Report(EVT_State_t *state, EVT_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    for (uint8_t i = 0U; i < EVT_IRQ_COUNT; i++) {
+        report->event_count[i] = state->event_count[i];
+    }
+    report->edge_count       = state->edge_count;
+    report->unhandled_count  = state->unhandled_count;
+    report->empty_count      = state->empty_count;
+    report->read_error_count = state->read_error_count;
+    report->reaction_max_us  = state->reaction_max_us;
+
+    return SUCCESS;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file    events.h
+ * @brief   BNO055 Interrupt Event Engine
+ * @details This header file contains the public interface for the interrupt event engine. It
+ *          includes constants, configuration, state and report structures and function prototypes
+ *          used to dispatch every BNO055 interrupt signalled on the INT pin to its handler.
+ */
+
+
+#ifndef __EVENTS_H
+#define __EVENTS_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../../drivers/gpio/gpio.h"
+#include "../../drivers/bno055/bno.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define EVT_IRQ_COUNT               (BNO_IRQ_ACC_NM + 1U)
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef void (*EVT_Handler_t)(BNO_IRQ irq, uint64_t timestamp_us, void *context);
+
+typedef struct {
+    /* Required */
+    GPIO_t   *int_port;
+    GPIO_Pin int_pin;
+} EVT_Config_t;
+
+typedef struct {
+    EVT_Config_t      config;
+    USART_Config_t    *usart;
+    EVT_Handler_t     handler[EVT_IRQ_COUNT];
+    void              *context[EVT_IRQ_COUNT];
+    volatile uint32_t edge_count;
+    volatile uint32_t edge_time_us;
+    uint32_t          handled_edges;
+    uint32_t          event_count[EVT_IRQ_COUNT];
+    uint32_t          unhandled_count;
+    uint32_t          empty_count;
+    uint32_t          read_error_count;
+    uint32_t          reaction_max_us;
+} EVT_State_t;
+
+typedef struct {
+    uint32_t event_count[EVT_IRQ_COUNT];
+    uint32_t edge_count;
+    uint32_t unhandled_count;
+    uint32_t empty_count;
+    uint32_t read_error_count;
+    uint32_t reaction_max_us;
+} EVT_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status EVT_Init            (EVT_State_t *state, EVT_Config_t *config, USART_Config_t *usart);
+Status EVT_Register_Handler(EVT_State_t *state, BNO_IRQ irq, EVT_Handler_t handler, void *context);
+Status EVT_Signal          (EVT_State_t *state, uint64_t now_us);
+Status EVT_Get_Pending     (EVT_State_t *state, uint8_t *pending);
+Status EVT_Poll            (EVT_State_t *state, uint64_t now_us);
+Status EVT_Get_Report      (EVT_State_t *state, EVT_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
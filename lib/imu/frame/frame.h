@@ -0,0 +1,69 @@
+/**
+ * @file    frame.h
+ * @brief   IMU Frame Definitions
+ * @details This header file contains the channel enumeration and the raw frame structure shared
+ *          by the IMU data pipeline modules (acquisition, processing and output). Each channel
+ *          corresponds to one BNO055 output data block. Frames are stamped with the 64-bit
+ *          micro-second time (see dwt.h) at the start and completion of their bus transactions,
+ *          and the midpoint of the two is used as the sample time. Channels read with the same
+ *          values as their previous read are flagged as duplicates.
+ */
+
+
+#ifndef __FRAME_H
+#define __FRAME_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../../utils/utils.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define IMU_VALUES_MAX              4U
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    IMU_CHANNEL_ACC = 0,
+    IMU_CHANNEL_MAG,
+    IMU_CHANNEL_GYR,
+    IMU_CHANNEL_LIA,
+    IMU_CHANNEL_GRV,
+    IMU_CHANNEL_EUL,
+    IMU_CHANNEL_QUA,
+    IMU_CHANNEL_TEMP,
+    IMU_CHANNEL_CALIB,
+    IMU_CHANNEL_COUNT
+} IMU_Channel;
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    int16_t  data[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    uint16_t updated_mask;
+    uint16_t duplicate_mask;
+    uint64_t start_us;
+    uint64_t complete_us;
+    uint64_t sample_us;
+} IMU_Frame_t;
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,399 @@
+/**
+ * @file    governor.c
+ * @brief   Output Bandwidth Governor
+ * @details This source file fits the output data rate of the application to the capacity of a
+ *          serial link, so that acquisition can run at full rate regardless of link speed. The
+ *          link capacity is derived from the baud rate, the framing overhead (bits per character)
+ *          and a target utilisation. When the full-rate output does not fit, channels are
+ *          decimated in power-of-two steps, lowest priority first. If every channel is already at
+ *          the maximum decimation, the governor switches to a summary representation. Decimated
+ *          channels report the mean of the samples accumulated since their last emission.
+ *
+ *          The TX queue depth is sampled at the start of every frame. If output is due while the
+ *          previous frame is still being transmitted, the frame's output is dropped (acquisition
+ *          continues) and the budget is halved. The budget is relaxed again after a run of frames
+ *          without backlog.
+ *
+ * @par     Functions include:
+ *          - GOV_Init(): Initialises the governor and computes the initial output plan
+ *          - GOV_Begin_Frame(): Updates the governor at the start of an acquisition frame
+ *          - GOV_Emit_Channel(): Gets whether a channel should be output in the current frame
+ *          - GOV_Emit_Summary(): Gets whether a summary should be output in the current frame
+ *          - GOV_Accumulate(): Accumulates channel values for decimated/summary output
+ *          - GOV_Get_Mean(): Gets the mean of the accumulated channel values
+ *          - GOV_Get_Report(): Gets the current decimation plan and the reason for it
+ *          - GOV_Clear_Changed(): Acknowledges a reported change of the plan
+ */
+
+
+#include "governor.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Computes the output data rate of a decimation plan
+ * @param  state:      Pointer to the governor state
+ * @param  decimation: Pointer to the per-channel decimation factors
+ * @retval Output data rate in bytes per second
+ */
+static uint32_t GOV_Demand(GOV_State_t *state, const uint8_t *decimation) {
+    uint32_t frame_rate     = state->config.frame_rate_hz;
+    uint32_t demand         = 0UL;
+    uint8_t  min_decimation = GOV_DECIMATION_MAX;
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (state->config.record_bytes[i] == 0U) {
+            continue;
+        }
+        //a channel cannot be output faster than it is acquired
+        uint32_t record_rate  = (frame_rate / decimation[i]);
+        uint32_t channel_rate = state->config.channel_rate_hz[i];
+        if ((channel_rate != 0UL) && (channel_rate < record_rate)) {
+            record_rate = channel_rate;
+        }
+        demand += (record_rate * state->config.record_bytes[i]);
+        if (decimation[i] < min_decimation) {
+            min_decimation = decimation[i];
+        }
+    }
+
+    //frames containing at least one record also carry the frame overhead
+    demand += ((frame_rate * state->config.frame_overhead_bytes) / min_decimation);
+
+    return demand;
+}
+
+/**
+ * @brief  Computes the decimation plan for the current budget
+ * @param  state:  Pointer to the governor state
+ * @param  reason: Reason reported if the plan differs from full-rate output
+ * @retval None
+ * @note   The channel with the smallest (priority * decimation) product is decimated next, so low
+ *         priority channels are decimated first without starving any single channel
+ * @note   state->changed is set if the mode or any decimation factor changes
+ */
+static void GOV_Plan(GOV_State_t *state, GOV_Reason reason) {
+    uint8_t decimation[IMU_CHANNEL_COUNT];
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        decimation[i] = 1U;
+    }
+
+    //greedily decimate channels until the output fits the budget
+    uint32_t demand = GOV_Demand(state, decimation);
+    while (demand > state->budget_bps) {
+        uint8_t  selected   = IMU_CHANNEL_COUNT;
+        uint32_t best_score = 0xFFFFFFFFUL;
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if ((state->config.record_bytes[i] == 0U) || (decimation[i] >= GOV_DECIMATION_MAX)) {
+                continue;
+            }
+            uint32_t score = ((uint32_t) state->config.priority[i] * decimation[i]);
+            if ((score < best_score) || ((score == best_score)
+            && (state->config.record_bytes[i] > state->config.record_bytes[selected]))) {
+                best_score = score;
+                selected   = i;
+            }
+        }
+        if (selected == IMU_CHANNEL_COUNT) {
+            break;
+        }
+        decimation[selected] <<= 1U;
+        demand = GOV_Demand(state, decimation);
+    }
+
+    //select the output mode
+    GOV_Mode mode           = GOV_MODE_FULL;
+    uint16_t summary_period = 0U;
+    if (demand > state->budget_bps) {
+        mode = GOV_MODE_SUMMARY;
+        uint32_t summary_rate = (((uint32_t) state->config.summary_bytes
+                              + state->config.frame_overhead_bytes)
+                              * state->config.frame_rate_hz);
+        uint32_t period       = ((summary_rate + state->budget_bps - 1UL) / state->budget_bps);
+        summary_period = (uint16_t) ((period > 0xFFFFUL) ? 0xFFFFUL : period);
+        if (summary_period == 0U) {
+            summary_period = 1U;
+        }
+        demand = (summary_rate / summary_period);
+    } else {
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if (decimation[i] > 1U) {
+                mode = GOV_MODE_DECIMATED;
+            }
+        }
+    }
+
+    //record the new plan and flag any changes
+    if ((mode != state->mode) || (summary_period != state->summary_period)) {
+        state->changed = 1U;
+    }
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (decimation[i] != state->decimation[i]) {
+            state->changed = 1U;
+        }
+        state->decimation[i] = decimation[i];
+    }
+    state->mode           = mode;
+    state->summary_period = summary_period;
+    state->demand_bps     = demand;
+    state->reason         = (mode == GOV_MODE_FULL) ? GOV_REASON_NONE : reason;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the governor and computes the initial output plan
+ * @param  state:  Pointer to the governor state
+ * @param  config: Pointer to a struct containing governor settings
+ * @retval Status indicating success or invalid parameters
+ * @note   record_bytes is the size of one formatted record per channel. Channels with a size of 0
+ *         are never output
+ * @note   priority must be at least 1. Higher values are decimated later
+ * @note   channel_rate_hz is the acquisition rate of channels slower than the frame rate. A rate of
+ *         0 means the channel is acquired every frame
+ */
+Status GOV_Init(GOV_State_t *state, GOV_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->baud_rate == 0UL) || (config->frame_rate_hz == 0U)) {
+        return INVALID_PARAM;
+    }
+    if (config->utilisation_pct > 100U) {
+        return INVALID_PARAM;
+    }
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if ((config->record_bytes[i] != 0U) && (config->priority[i] == 0U)) {
+            return INVALID_PARAM;
+        }
+    }
+
+    //apply defaults to optional settings
+    memset(state, 0, sizeof(GOV_State_t));
+    state->config = *config;
+    if (state->config.bits_per_char == 0U) {
+        state->config.bits_per_char = GOV_BITS_PER_CHAR_DEFAULT;
+    }
+    if (state->config.utilisation_pct == 0U) {
+        state->config.utilisation_pct = GOV_UTILISATION_DEFAULT;
+    }
+    if (state->config.relax_frames == 0U) {
+        state->config.relax_frames = GOV_RELAX_FRAMES_DEFAULT;
+    }
+
+    //link capacity in bytes per second at the target utilisation
+    state->capacity_bps = ((config->baud_rate / state->config.bits_per_char)
+                        * state->config.utilisation_pct) / 100UL;
+    if (state->capacity_bps == 0UL) {
+        return INVALID_PARAM;
+    }
+    state->budget_bps = state->capacity_bps;
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        state->decimation[i] = 1U;
+    }
+    GOV_Plan(state, GOV_REASON_LINK_CAPACITY);
+    state->changed = 1U;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Updates the governor at the start of an acquisition frame
+ * @param  state:      Pointer to the governor state
+ * @param  tx_pending: Number of bytes still queued on the output link
+ * @retval Status indicating success or invalid parameters
+ * @note   Must be called once per acquisition frame, after the frame's samples have been passed
+ *         to @ref GOV_Accumulate and before @ref GOV_Emit_Channel and @ref GOV_Emit_Summary
+ * @note   Channels with no samples accumulated since their last output are not output
+ */
+Status GOV_Begin_Frame(GOV_State_t *state, uint16_t tx_pending) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    //find the channels due in this frame
+    uint32_t frame = state->frame_count++;
+    state->emit_mask    = 0U;
+    state->emit_summary = 0U;
+    if (state->mode == GOV_MODE_SUMMARY) {
+        state->emit_summary = ((frame % state->summary_period) == 0UL);
+    } else {
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if ((state->config.record_bytes[i] != 0U) && (state->sum_count[i] != 0UL)
+            &&  ((frame & (state->decimation[i] - 1U)) == 0UL)) {
+                state->emit_mask |= (uint16_t) (1U << i);
+            }
+        }
+    }
+
+    uint8_t output_due = ((state->emit_mask != 0U) || (state->emit_summary != 0U));
+    if (output_due && (tx_pending > 0U)) {
+        //previous output has not drained: drop this output and tighten the budget
+        state->emit_mask    = 0U;
+        state->emit_summary = 0U;
+        state->stall_count++;
+        state->idle_frames  = 0U;
+        if (state->backoff < GOV_BACKOFF_MAX) {
+            state->backoff++;
+            state->budget_bps = (state->capacity_bps >> state->backoff);
+            GOV_Plan(state, GOV_REASON_TX_BACKLOG);
+        }
+    } else if ((tx_pending == 0U) && (state->backoff > 0U)) {
+        //relax the budget after a run of frames without backlog
+        if (++state->idle_frames >= state->config.relax_frames) {
+            state->idle_frames = 0U;
+            state->backoff--;
+            state->budget_bps = (state->capacity_bps >> state->backoff);
+            GOV_Plan(state, (state->backoff > 0U) ? GOV_REASON_TX_BACKLOG
+                                                  : GOV_REASON_LINK_CAPACITY);
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets whether a channel should be output in the current frame
+ * @param  state:   Pointer to the governor state
+ * @param  channel: Channel to be checked
+ * @param  emit:    Pointer to a variable used to store the result (1 = output, 0 = skip)
+ * @retval Status indicating success or invalid parameters
+ */
+Status GOV_Emit_Channel(GOV_State_t *state, IMU_Channel channel, uint8_t *emit) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(emit));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+
+    *emit = ((state->emit_mask >> channel) & 1U);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets whether a summary should be output in the current frame
+ * @param  state: Pointer to the governor state
+ * @param  emit:  Pointer to a variable used to store the result (1 = output, 0 = skip)
+ * @retval Status indicating success or invalid parameters
+ */
+Status GOV_Emit_Summary(GOV_State_t *state, uint8_t *emit) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(emit));
+
+    *emit = state->emit_summary;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Accumulates channel values for decimated/summary output
+ * @param  state:   Pointer to the governor state
+ * @param  channel: Channel the values belong to
+ * @param  values:  Pointer to the values to be accumulated
+ * @param  count:   Number of values (at most IMU_VALUES_MAX)
+ * @retval Status indicating success or invalid parameters
+ * @note   Should be called for every acquired sample, so that decimated output is the mean of
+ *         the samples it replaces rather than a single (aliased) sample. Samples beyond 2^32 - 1
+ *         since the last mean are ignored
+ */
+Status GOV_Accumulate(
+    GOV_State_t *state,
+    IMU_Channel channel,
+    const float *values,
+    uint8_t     count
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(values));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+    if ((count == 0U) || (count > IMU_VALUES_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    //stop accumulating once the count is full, so the sums always match the count
+    if (state->sum_count[channel] == 0xFFFFFFFFUL) {
+        return SUCCESS;
+    }
+    for (uint8_t i = 0U; i < count; i++) {
+        state->sum[channel][i] += values[i];
+    }
+    state->sum_count[channel]++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the mean of the accumulated channel values
+ * @param  state:   Pointer to the governor state
+ * @param  channel: Channel to be read
+ * @param  values:  Pointer to an array used to store the mean values
+ * @param  count:   Number of values (at most IMU_VALUES_MAX)
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if nothing has been accumulated. The accumulator is reset on success
+ */
+Status GOV_Get_Mean(GOV_State_t *state, IMU_Channel channel, float *values, uint8_t count) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(values));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+    if ((count == 0U) || (count > IMU_VALUES_MAX)) {
+        return INVALID_PARAM;
+    }
+    if (state->sum_count[channel] == 0UL) {
+        return ERROR;
+    }
+
+    float scale = (1.0f / (float) state->sum_count[channel]);
+    for (uint8_t i = 0U; i < count; i++) {
+        values[i] = (state->sum[channel][i] * scale);
+    }
+    for (uint8_t i = 0U; i < IMU_VALUES_MAX; i++) {
+        state->sum[channel][i] = 0.0f;
+    }
+    state->sum_count[channel] = 0UL;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the current decimation plan and the reason for it
+ * @param  state:  Pointer to the governor state
+ * @param  report: Pointer to a struct used to store the report
+ * @retval Status indicating success or invalid parameters
+ * @note   report->changed is set if the plan has changed since it was last acknowledged with
+ *         @ref GOV_Clear_Changed, so a change is reported until its report has been output
+ */
+Status GOV_Get_Report(GOV_State_t *state, GOV_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->mode           = state->mode;
+    report->reason         = state->reason;
+    report->changed        = state->changed;
+    report->budget_bps     = state->budget_bps;
+    report->demand_bps     = state->demand_bps;
+    report->summary_period = state->summary_period;
+    report->frame_count    = state->frame_count;
+    report->stall_count    = state->stall_count;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        report->decimation[i] = state->decimation[i];
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Acknowledges a reported change of the plan
+ * @param  state: Pointer to the governor state
+ * @retval Status indicating success or invalid parameters
+ * @note   Should be called once the report of the change has been queued for output, e.g. after
+ *         the frame carrying it has been handed to the transmitter
+ */
+Status GOV_Clear_Changed(GOV_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    state->changed = 0U;
+
+    return SUCCESS;
+}
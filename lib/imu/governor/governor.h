@@ -0,0 +1,126 @@
+/**
+ * @file    governor.h
+ * @brief   Output Bandwidth Governor
+ * @details This header file contains the public interface for the output governor. It includes
+ *          constants, enumerations, configuration and state structures and function prototypes
+ *          used to fit the output data rate to the capacity of a serial link.
+ */
+
+
+#ifndef __GOVERNOR_H
+#define __GOVERNOR_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define GOV_DECIMATION_MAX          64U
+#define GOV_BITS_PER_CHAR_DEFAULT   10U
+#define GOV_UTILISATION_DEFAULT     80U
+#define GOV_BACKOFF_MAX             4U
+#define GOV_RELAX_FRAMES_DEFAULT    100U
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    GOV_MODE_FULL = 0,
+    GOV_MODE_DECIMATED,
+    GOV_MODE_SUMMARY
+} GOV_Mode;
+
+typedef enum {
+    GOV_REASON_NONE = 0,
+    GOV_REASON_LINK_CAPACITY,
+    GOV_REASON_TX_BACKLOG
+} GOV_Reason;
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint32_t baud_rate;
+    uint16_t frame_rate_hz;
+    uint16_t record_bytes[IMU_CHANNEL_COUNT];
+    uint8_t  priority[IMU_CHANNEL_COUNT];
+    uint16_t summary_bytes;
+    /* Optional */
+    uint8_t  bits_per_char;
+    uint8_t  utilisation_pct;
+    uint16_t frame_overhead_bytes;
+    uint16_t relax_frames;
+    uint16_t channel_rate_hz[IMU_CHANNEL_COUNT];
+} GOV_Config_t;
+
+typedef struct {
+    GOV_Config_t config;
+    uint32_t     capacity_bps;
+    uint32_t     budget_bps;
+    uint32_t     demand_bps;
+    uint8_t      decimation[IMU_CHANNEL_COUNT];
+    uint16_t     summary_period;
+    uint8_t      backoff;
+    uint16_t     idle_frames;
+    uint32_t     frame_count;
+    uint16_t     emit_mask;
+    uint8_t      emit_summary;
+    GOV_Mode     mode;
+    GOV_Reason   reason;
+    uint8_t      changed;
+    uint32_t     stall_count;
+    float        sum[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    uint32_t     sum_count[IMU_CHANNEL_COUNT];
+} GOV_State_t;
+
+typedef struct {
+    GOV_Mode   mode;
+    GOV_Reason reason;
+    uint8_t    changed;
+    uint32_t   budget_bps;
+    uint32_t   demand_bps;
+    uint8_t    decimation[IMU_CHANNEL_COUNT];
+    uint16_t   summary_period;
+    uint32_t   frame_count;
+    uint32_t   stall_count;
+} GOV_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status GOV_Init         (GOV_State_t *state, GOV_Config_t *config);
+Status GOV_Begin_Frame  (GOV_State_t *state, uint16_t tx_pending);
+Status GOV_Emit_Channel (GOV_State_t *state, IMU_Channel channel, uint8_t *emit);
+Status GOV_Emit_Summary (GOV_State_t *state, uint8_t *emit);
+Status GOV_Accumulate   (
+    GOV_State_t *state,
+    IMU_Channel channel,
+    const float *values,
+    uint8_t     count
+);
+Status GOV_Get_Mean     (GOV_State_t *state, IMU_Channel channel, float *values, uint8_t count);
+Status GOV_Get_Report   (GOV_State_t *state, GOV_Report_t *report);
+Status GOV_Clear_Changed(GOV_State_t *state);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,432 @@
+/**
+ * @file    magcal.c
+ * @brief   Magnetometer Hard and Soft-Iron Calibration
+ * @details This source file calibrates the magnetometer on the MCU from the raw samples taken
+ *          while the device is moved, rather than waiting for the BNO055 to calibrate itself. The
+ *          samples lie on an ellipsoid, whose centre is the hard-iron offset and whose shape is the
+ *          soft-iron distortion, so the calibrator:
+ *          - Fits x^T A x + 2 b^T x + c = 0 by linear least squares, with the trace of A fixed so
+ *            9 unknowns remain and the fit cannot collapse to the trivial solution
+ *          - Accumulates the fit incrementally in constant memory, as the upper triangular factor
+ *            R of the normal equations (R^T R = D^T D), updated by Givens rotations for each
+ *            sample. Unlike summing D^T D, this does not square the condition number, so single
+ *            precision is sufficient
+ *          - Solves on demand by back substitution, then moves the quadric to its centre and
+ *            takes the symmetric square root of its shape, scaled to a unit determinant, as the
+ *            soft-iron matrix, so the field strength is kept
+ *
+ *          Samples closer than step_lsb to the previous one are skipped, so a device at rest does
+ *          not outweigh the motion. A solution is converged once its offset has settled between
+ *          solves, the field strengths of the samples pushed since the previous solve, as
+ *          corrected by it, deviate by less than residual_max, and the corrected field has pointed
+ *          closest to coverage_min of the 6 axis directions, as a fit to part of the sphere can
+ *          settle away from the true offset. A few seconds of rotation through varied
+ *          orientations are typically enough.
+ *
+ * @par     Functions include:
+ *          - MAGCAL_Init(): Initialises an empty calibration
+ *          - MAGCAL_Push(): Adds the magnetometer sample of a frame to the fit
+ *          - MAGCAL_Solve(): Solves the fit for the offset and soft-iron matrix
+ *          - MAGCAL_Registers(): Converts a solution to the BNO055 register format
+ *
+ * @note    Samples are in the raw units of the magnetometer (16 LSB per uT), and the corrected
+ *          field is soft_iron * (raw - offset). The fit assumes uncompensated samples, e.g. in the
+ *          non-fusion modes
+ */
+
+
+#include "magcal.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Corrects a sample with a solution
+ * @param  result:    Pointer to the solution
+ * @param  raw:       Pointer to the raw sample
+ * @param  corrected: Pointer to an array used to store the corrected sample
+ * @retval None
+ */
+static void MAGCAL_Correct(const MAGCAL_Result_t *result, const int16_t *raw, float *corrected) {
+    float centred[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        centred[i] = ((float) raw[i] - result->offset[i]);
+    }
+
+    for (uint8_t i = 0U; i < 3U; i++) {
+        corrected[i] = ((result->soft_iron[i][0] * centred[0])
+                     +  (result->soft_iron[i][1] * centred[1])
+                     +  (result->soft_iron[i][2] * centred[2]));
+    }
+}
+
+/**
+ * @brief  Gets the sector of the sphere containing a direction
+ * @param  v: Pointer to the direction
+ * @retval Sector, i.e. the face of the enclosing cube crossed by the direction
+ */
+static uint8_t MAGCAL_Sector(const float *v) {
+    float   x    = fabsf(v[0]);
+    float   y    = fabsf(v[1]);
+    float   z    = fabsf(v[2]);
+    uint8_t axis = ((x >= y) && (x >= z)) ? 0U : ((y >= z) ? 1U : 2U);
+
+    return (uint8_t) ((axis * 2U) + ((v[axis] < 0.0f) ? 1U : 0U));
+}
+
+/**
+ * @brief  Gets the eigenvalues and eigenvectors of a symmetric 3x3 matrix
+ * @param  m:       Symmetric matrix, which is overwritten
+ * @param  lambda:  Pointer to an array used to store the eigenvalues
+ * @param  vectors: Matrix used to store the eigenvectors as columns
+ * @retval None
+ * @note   Uses cyclic Jacobi rotations, which converge in a few sweeps for a 3x3 matrix
+ */
+static void MAGCAL_Eigen(float m[3][3], float *lambda, float vectors[3][3]) {
+    for (uint8_t i = 0U; i < 3U; i++) {
+        for (uint8_t j = 0U; j < 3U; j++) {
+            vectors[i][j] = (i == j) ? 1.0f : 0.0f;
+        }
+    }
+
+    for (uint8_t sweep = 0U; sweep < MAGCAL_JACOBI_SWEEPS; sweep++) {
+        for (uint8_t p = 0U; p < 2U; p++) {
+            for (uint8_t q = (uint8_t) (p + 1U); q < 3U; q++) {
+                if (fabsf(m[p][q]) < 1.0e-12f) {
+                    continue;
+                }
+
+                //rotate the plane (p, q) so m[p][q] becomes 0
+                float theta = ((m[q][q] - m[p][p]) / (2.0f * m[p][q]));
+                float t     = (((theta >= 0.0f) ? 1.0f : -1.0f)
+                            / (fabsf(theta) + sqrtf((theta * theta) + 1.0f)));
+                float c     = (1.0f / sqrtf((t * t) + 1.0f));
+                float s     = (t * c);
+                for (uint8_t k = 0U; k < 3U; k++) {
+                    float mkp = m[k][p];
+                    float mkq = m[k][q];
+                    m[k][p] = ((c * mkp) - (s * mkq));
+                    m[k][q] = ((s * mkp) + (c * mkq));
+                }
+                for (uint8_t k = 0U; k < 3U; k++) {
+                    float mpk = m[p][k];
+                    float mqk = m[q][k];
+                    m[p][k] = ((c * mpk) - (s * mqk));
+                    m[q][k] = ((s * mpk) + (c * mqk));
+                }
+                for (uint8_t k = 0U; k < 3U; k++) {
+                    float vkp = vectors[k][p];
+                    float vkq = vectors[k][q];
+                    vectors[k][p] = ((c * vkp) - (s * vkq));
+                    vectors[k][q] = ((s * vkp) + (c * vkq));
+                }
+            }
+        }
+    }
+
+    for (uint8_t i = 0U; i < 3U; i++) {
+        lambda[i] = m[i][i];
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an empty calibration
+ * @param  state:  Pointer to the calibrator state
+ * @param  config: Pointer to a struct containing the calibrator settings
+ * @retval Status indicating success or invalid parameters
+ * @note   Settings left at 0 select MAGCAL_STEP_DEFAULT_LSB, MAGCAL_SAMPLES_DEFAULT,
+ *         MAGCAL_SETTLE_DEFAULT_LSB, MAGCAL_COVERAGE_DEFAULT, MAGCAL_RESIDUAL_DEFAULT and
+ *         MAGCAL_RATIO_DEFAULT
+ */
+Status MAGCAL_Init(MAGCAL_State_t *state, MAGCAL_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->coverage_min > MAGCAL_SECTORS) || (config->residual_max < 0.0f)
+    ||  ((config->axis_ratio_max != 0.0f) && (config->axis_ratio_max < 1.0f))) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(MAGCAL_State_t));
+    state->config = *config;
+    if (state->config.step_lsb == 0U) {
+        state->config.step_lsb = MAGCAL_STEP_DEFAULT_LSB;
+    }
+    if (state->config.min_samples == 0U) {
+        state->config.min_samples = MAGCAL_SAMPLES_DEFAULT;
+    }
+    if (state->config.settle_lsb == 0U) {
+        state->config.settle_lsb = MAGCAL_SETTLE_DEFAULT_LSB;
+    }
+    if (state->config.coverage_min == 0U) {
+        state->config.coverage_min = MAGCAL_COVERAGE_DEFAULT;
+    }
+    if (state->config.residual_max == 0.0f) {
+        state->config.residual_max = MAGCAL_RESIDUAL_DEFAULT;
+    }
+    if (state->config.axis_ratio_max == 0.0f) {
+        state->config.axis_ratio_max = MAGCAL_RATIO_DEFAULT;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds the magnetometer sample of a frame to the fit
+ * @param  state: Pointer to the calibrator state
+ * @param  frame: Pointer to the frame, which is skipped unless IMU_CHANNEL_MAG is set in
+ *                frame->updated_mask and not in frame->duplicate_mask
+ * @retval Status indicating success or invalid parameters
+ * @note   The samples are taken relative to the first one and normalised by MAGCAL_NORM_LSB, which
+ *         keeps the terms of the fit close to 1
+ */
+Status MAGCAL_Push(MAGCAL_State_t *state, const IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+    if (!((frame->updated_mask >> IMU_CHANNEL_MAG) & 1U)
+    ||  ((frame->duplicate_mask >> IMU_CHANNEL_MAG) & 1U)) {
+        return SUCCESS;
+    }
+    const int16_t *raw = frame->data[IMU_CHANNEL_MAG];
+
+    //skip the samples that barely moved from the previous one
+    if (state->sample_count == 0UL) {
+        memcpy(state->reference, raw, sizeof(state->reference));
+    } else {
+        uint16_t step = 0U;
+        for (uint8_t i = 0U; i < 3U; i++) {
+            int32_t delta = ((int32_t) raw[i] - state->last[i]);
+            delta = (delta < 0) ? -delta : delta;
+            step  = ((uint32_t) delta > step) ? (uint16_t) delta : step;
+        }
+        if (step < state->config.step_lsb) {
+            state->skipped_count++;
+            return SUCCESS;
+        }
+    }
+    memcpy(state->last, raw, sizeof(state->last));
+
+    //check the latest solution against the new sample, and mark its sector as covered
+    if (state->solved) {
+        float corrected[3];
+        MAGCAL_Correct(&state->result, raw, corrected);
+        float norm      = sqrtf((corrected[0] * corrected[0]) + (corrected[1] * corrected[1])
+                        + (corrected[2] * corrected[2]));
+        float deviation = ((norm / state->result.field_lsb) - 1.0f);
+        state->check_sum   += (deviation * deviation);
+        state->check_count++;
+        state->sector_mask |= (1UL << MAGCAL_Sector(corrected));
+    }
+
+    //compose the row of the fit, with the trace constrained terms first and the target last
+    float x = ((float) (raw[0] - state->reference[0]) / MAGCAL_NORM_LSB);
+    float y = ((float) (raw[1] - state->reference[1]) / MAGCAL_NORM_LSB);
+    float z = ((float) (raw[2] - state->reference[2]) / MAGCAL_NORM_LSB);
+    float row[MAGCAL_COLUMNS] = {
+        ((x * x) + (y * y) - (2.0f * z * z)), ((x * x) + (z * z) - (2.0f * y * y)),
+        (2.0f * x * y), (2.0f * x * z), (2.0f * y * z),
+        (2.0f * x), (2.0f * y), (2.0f * z), 1.0f,
+        ((x * x) + (y * y) + (z * z))
+    };
+
+    //rotate the row into the triangular factor. The last diagonal accumulates the residual norm
+    for (uint8_t i = 0U; i < MAGCAL_COLUMNS; i++) {
+        if (row[i] == 0.0f) {
+            continue;
+        }
+        float h = hypotf(state->r[i][i], row[i]);
+        float c = (state->r[i][i] / h);
+        float s = (row[i] / h);
+        state->r[i][i] = h;
+        for (uint8_t j = (uint8_t) (i + 1U); j < MAGCAL_COLUMNS; j++) {
+            float t = state->r[i][j];
+            state->r[i][j] = ((c * t) + (s * row[j]));
+            row[j]         = ((c * row[j]) - (s * t));
+        }
+    }
+    state->sample_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Solves the fit for the offset and soft-iron matrix
+ * @param  state:  Pointer to the calibrator state
+ * @param  result: Pointer to a struct used to store the solution
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR while the samples do not determine an ellipsoid, e.g. before the device
+ *         has been rotated about at least two axes, although the rounding of the samples can leave
+ *         such a fit barely determined, in which case its axis ratio holds it unconverged.
+ *         result->converged is set once min_samples samples have been fitted, the offset moved by
+ *         at most settle_lsb since the previous solve, the samples pushed since then deviate by at
+ *         most residual_max in RMS from the field strength, coverage_min sectors have been
+ *         covered, and the longest axis is at most axis_ratio_max times the shortest
+ */
+Status MAGCAL_Solve(MAGCAL_State_t *state, MAGCAL_Result_t *result) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(result));
+    if (state->sample_count < MAGCAL_COLUMNS) {
+        return ERROR;
+    }
+
+    //reject a rank deficient fit, where the motion has not covered the ellipsoid
+    float pivot_max = 0.0f;
+    for (uint8_t i = 0U; i < MAGCAL_TERMS; i++) {
+        pivot_max = fmaxf(pivot_max, fabsf(state->r[i][i]));
+    }
+    for (uint8_t i = 0U; i < MAGCAL_TERMS; i++) {
+        if (fabsf(state->r[i][i]) < (MAGCAL_PIVOT_MIN * pivot_max)) {
+            return ERROR;
+        }
+    }
+
+    //solve R u = Q^T e, the triangular form of the normal equations, by back substitution
+    float u[MAGCAL_TERMS];
+    for (int8_t i = (int8_t) (MAGCAL_TERMS - 1U); i >= 0; i--) {
+        float sum = state->r[i][MAGCAL_TERMS];
+        for (uint8_t j = (uint8_t) (i + 1); j < MAGCAL_TERMS; j++) {
+            sum -= (state->r[i][j] * u[j]);
+        }
+        u[i] = (sum / state->r[i][i]);
+    }
+
+    //recover the quadric x^T A x + 2 b^T x + u[8] = 0
+    float a[3][3] = {
+        {(u[0] + u[1] - 1.0f), u[2],                          u[3]},
+        {u[2],                 (u[0] - (2.0f * u[1]) - 1.0f), u[4]},
+        {u[3],                 u[4],                          (u[1] - (2.0f * u[0]) - 1.0f)}
+    };
+    float b[3] = {u[5], u[6], u[7]};
+
+    //the centre solves A c = -b, by the adjugate of A
+    float cof[3][3] = {
+        {((a[1][1] * a[2][2]) - (a[1][2] * a[2][1])), ((a[0][2] * a[2][1]) - (a[0][1] * a[2][2])),
+         ((a[0][1] * a[1][2]) - (a[0][2] * a[1][1]))},
+        {((a[1][2] * a[2][0]) - (a[1][0] * a[2][2])), ((a[0][0] * a[2][2]) - (a[0][2] * a[2][0])),
+         ((a[0][2] * a[1][0]) - (a[0][0] * a[1][2]))},
+        {((a[1][0] * a[2][1]) - (a[1][1] * a[2][0])), ((a[0][1] * a[2][0]) - (a[0][0] * a[2][1])),
+         ((a[0][0] * a[1][1]) - (a[0][1] * a[1][0]))}
+    };
+    float det = ((a[0][0] * cof[0][0]) + (a[0][1] * cof[1][0]) + (a[0][2] * cof[2][0]));
+    if (fabsf(det) < 1.0e-12f) {
+        return ERROR;
+    }
+    float centre[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        centre[i] = (-((cof[i][0] * b[0]) + (cof[i][1] * b[1]) + (cof[i][2] * b[2])) / det);
+    }
+
+    //moved to its centre, the quadric is (x - c)^T A (x - c) = k, so its shape is A / k
+    float k = -u[8];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        for (uint8_t j = 0U; j < 3U; j++) {
+            k += (centre[i] * a[i][j] * centre[j]);
+        }
+    }
+    if (k == 0.0f) {
+        return ERROR;
+    }
+    float shape[3][3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        for (uint8_t j = 0U; j < 3U; j++) {
+            shape[i][j] = (a[i][j] / k);
+        }
+    }
+
+    //the semi-axes are the inverse square roots of the eigenvalues, which must all be positive
+    float lambda[3];
+    float vectors[3][3];
+    MAGCAL_Eigen(shape, lambda, vectors);
+    if ((lambda[0] <= 0.0f) || (lambda[1] <= 0.0f) || (lambda[2] <= 0.0f)) {
+        return ERROR;
+    }
+    float axis_min = 1.0f / sqrtf(fmaxf(fmaxf(lambda[0], lambda[1]), lambda[2]));
+    float axis_max = 1.0f / sqrtf(fminf(fminf(lambda[0], lambda[1]), lambda[2]));
+    float radius   = cbrtf(1.0f / sqrtf(lambda[0] * lambda[1] * lambda[2]));
+
+    //map the ellipsoid onto a sphere of the mean radius, with a unit determinant
+    MAGCAL_Result_t solution;
+    for (uint8_t i = 0U; i < 3U; i++) {
+        for (uint8_t j = 0U; j < 3U; j++) {
+            float sum = 0.0f;
+            for (uint8_t n = 0U; n < 3U; n++) {
+                sum += (vectors[i][n] * sqrtf(lambda[n]) * vectors[j][n]);
+            }
+            solution.soft_iron[i][j] = (sum * radius);
+        }
+        solution.offset[i] = ((float) state->reference[i] + (centre[i] * MAGCAL_NORM_LSB));
+    }
+    solution.field_lsb    = (radius * MAGCAL_NORM_LSB);
+    solution.axis_ratio   = (axis_max / axis_min);
+    solution.sample_count = state->sample_count;
+    solution.residual     = (state->check_count == 0UL)
+                          ? 0.0f : sqrtf(state->check_sum / (float) state->check_count);
+    solution.coverage     = 0U;
+    for (uint8_t i = 0U; i < MAGCAL_SECTORS; i++) {
+        solution.coverage += (uint8_t) ((state->sector_mask >> i) & 1U);
+    }
+
+    //converged once the offset settled and the previous solution predicted the new samples
+    float settle = 0.0f;
+    for (uint8_t i = 0U; i < 3U; i++) {
+        settle = fmaxf(settle, fabsf(solution.offset[i] - state->result.offset[i]));
+    }
+    solution.converged = (state->solved
+                      && (state->sample_count >= state->config.min_samples)
+                      && (state->check_count >= MAGCAL_CHECK_MIN)
+                      && (settle <= (float) state->config.settle_lsb)
+                      && (solution.coverage >= state->config.coverage_min)
+                      && (solution.residual <= state->config.residual_max)
+                      && (solution.axis_ratio <= state->config.axis_ratio_max));
+
+    state->result      = solution;
+    state->solved      = 1U;
+    state->check_sum   = 0.0f;
+    state->check_count = 0UL;
+    *result = solution;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Converts a solution to the BNO055 register format
+ * @param  result: Pointer to the solution
+ * @param  sic:    Pointer to a struct used to store the soft-iron matrix, where BNO_SIC_ONE is 1.0
+ * @param  offset: Pointer to a struct used to store the offset in LSB
+ * @retval Status indicating success or invalid parameters
+ * @note   Returns INVALID_PARAM if a value does not fit the int16_t registers
+ */
+Status MAGCAL_Registers(
+    const MAGCAL_Result_t *result,
+    BNO_SIC_Matrix_t      *sic,
+    BNO_Offset_t          *offset
+) {
+    CHECK_STATUS(Validate_Ptr(result));
+    CHECK_STATUS(Validate_Ptr(sic));
+    CHECK_STATUS(Validate_Ptr(offset));
+
+    for (uint8_t i = 0U; i < 9U; i++) {
+        float value = roundf(result->soft_iron[i / 3U][i % 3U] * BNO_SIC_ONE);
+        if ((value < (float) INT16_MIN) || (value > (float) INT16_MAX)) {
+            return INVALID_PARAM;
+        }
+        sic->sic[i] = (int16_t) value;
+    }
+
+    int16_t *axes[3] = {&offset->offset_x, &offset->offset_y, &offset->offset_z};
+    for (uint8_t i = 0U; i < 3U; i++) {
+        float value = roundf(result->offset[i]);
+        if ((value < (float) INT16_MIN) || (value > (float) INT16_MAX)) {
+            return INVALID_PARAM;
+        }
+        *axes[i] = (int16_t) value;
+    }
+
+    return SUCCESS;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file    magcal.h
+ * @brief   Magnetometer Hard and Soft-Iron Calibration
+ * @details This header file contains the public interface for the magnetometer calibrator. It
+ *          includes constants, configuration, state and result structures and function prototypes
+ *          used to fit an ellipsoid to the raw magnetometer samples incrementally.
+ */
+
+
+#ifndef __MAGCAL_H
+#define __MAGCAL_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/bno055/bno.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define MAGCAL_TERMS                9U
+#define MAGCAL_COLUMNS              (MAGCAL_TERMS + 1U)
+#define MAGCAL_NORM_LSB             (1024.0f)
+#define MAGCAL_STEP_DEFAULT_LSB     24U
+#define MAGCAL_SAMPLES_DEFAULT      64U
+#define MAGCAL_SETTLE_DEFAULT_LSB   8U
+#define MAGCAL_CHECK_MIN            16U
+#define MAGCAL_SECTORS              6U
+#define MAGCAL_COVERAGE_DEFAULT     5U
+#define MAGCAL_RESIDUAL_DEFAULT     (0.02f)
+#define MAGCAL_RATIO_DEFAULT        (1.5f)
+#define MAGCAL_PIVOT_MIN            (1.0e-4f)
+#define MAGCAL_JACOBI_SWEEPS        8U
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Optional */
+    uint16_t step_lsb;
+    uint16_t min_samples;
+    uint16_t settle_lsb;
+    uint8_t  coverage_min;
+    float    residual_max;
+    float    axis_ratio_max;
+} MAGCAL_Config_t;
+
+typedef struct {
+    float    offset[3];
+    float    soft_iron[3][3];
+    float    field_lsb;
+    float    axis_ratio;
+    float    residual;
+    uint8_t  coverage;
+    uint32_t sample_count;
+    uint8_t  converged;
+} MAGCAL_Result_t;
+
+typedef struct {
+    MAGCAL_Config_t config;
+    float           r[MAGCAL_COLUMNS][MAGCAL_COLUMNS];
+    int16_t         reference[3];
+    int16_t         last[3];
+    uint32_t        sample_count;
+    uint32_t        skipped_count;
+    MAGCAL_Result_t result;
+    uint8_t         solved;
+    float           check_sum;
+    uint32_t        check_count;
+    uint32_t        sector_mask;
+} MAGCAL_State_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status MAGCAL_Init     (MAGCAL_State_t *state, MAGCAL_Config_t *config);
+Status MAGCAL_Push     (MAGCAL_State_t *state, const IMU_Frame_t *frame);
+Status MAGCAL_Solve    (MAGCAL_State_t *state, MAGCAL_Result_t *result);
+Status MAGCAL_Registers(
+    const MAGCAL_Result_t *result,
+    BNO_SIC_Matrix_t      *sic,
+    BNO_Offset_t          *offset
+);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
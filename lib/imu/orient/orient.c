@@ -0,0 +1,482 @@
+/**
+ * @file    orient.c
+ * @brief   Orientation Math
+ * @details This source file provides the quaternion operations used by the IMU pipeline, and
+ *          derives the Euler angles (EUL), gravity vector (GRV) and linear acceleration (LIA)
+ *          channels of the BNO055 from its quaternion (QUA) and, for LIA, its accelerometer (ACC).
+ *          Deriving these channels locally means only QUA and ACC need to be read from the sensor,
+ *          which more than halves the bytes and transactions per frame when all of them are used.
+ *
+ *          Quaternions are stored as 4-element arrays (w, x, y, z) and rotate the sensor frame
+ *          into the earth frame, as output by the BNO055. All arithmetic is single precision so it
+ *          runs on the Cortex-M4F FPU.
+ *
+ *          Derived channels are stored in the raw units of the BNO055 registers for the selected
+ *          unit settings, so they are indistinguishable from channels read from the sensor:
+ *          - EUL: heading in [0, 360) degrees, increasing clockwise, roll in [-90, 90] and pitch in
+ *            [-180, 180], with the sign of the pitch inverted in the Android orientation format
+ *          - GRV: the gravity vector in the sensor frame, in the accelerometer unit
+ *          - LIA: the accelerometer minus the gravity vector, in the accelerometer unit
+ *
+ * @par     Functions include:
+ *          - ORIENT_Quat_Normalise(): Normalises a quaternion to unit length
+ *          - ORIENT_Quat_Multiply(): Computes the Hamilton product of two quaternions
+ *          - ORIENT_Quat_Conjugate(): Computes the conjugate (inverse rotation) of a quaternion
+ *          - ORIENT_Quat_To_Matrix(): Computes the rotation matrix of a quaternion
+ *          - ORIENT_Quat_Slerp(): Interpolates between two orientations at constant angular rate
+ *          - ORIENT_Quat_Integrate(): Rotates an orientation by a constant angular rate
+ *          - ORIENT_Quat_Pack(): Packs a quaternion into its smallest three components
+ *          - ORIENT_Quat_Unpack(): Unpacks a quaternion packed by ORIENT_Quat_Pack()
+ *          - ORIENT_Get_Euler(): Computes the heading, roll and pitch of a quaternion
+ *          - ORIENT_Get_Gravity(): Computes the gravity direction in the sensor frame
+ *          - ORIENT_Get_Linear_Acc(): Removes gravity from an acceleration
+ *          - ORIENT_Derive_Channels(): Derives the EUL, GRV and LIA channels of a frame
+ */
+
+
+#include "orient.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Rounds a value in raw units to a register value
+ * @param  value: Value in raw units
+ * @retval Value rounded to the nearest integer, and saturated to the int16_t range
+ */
+static int16_t ORIENT_To_Raw(float value) {
+    if (value >= 32767.0f) {
+        return INT16_MAX;
+    }
+    if (value <= -32768.0f) {
+        return INT16_MIN;
+    }
+    return (int16_t) ((value >= 0.0f) ? (value + 0.5f) : (value - 0.5f));
+}
+
+/**
+ * @brief  Gets the gravity magnitude in raw accelerometer units
+ * @param  units: Pointer to the unit settings
+ * @retval Gravity in LSB
+ */
+static float ORIENT_Gravity_Raw(const ORIENT_Units_t *units) {
+    if (units->acc_unit == BNO_UNIT_ACC_MG) {
+        return (ORIENT_GRAVITY_MG * BNO_ACC_MG);
+    }
+    return (ORIENT_GRAVITY_MS * BNO_ACC_MS);
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Normalises a quaternion to unit length
+ * @param  q: Pointer to the quaternion (w, x, y, z)
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if the quaternion has zero length (e.g. QUA read outside a fusion mode),
+ *         or if any component is not finite
+ */
+Status ORIENT_Quat_Normalise(float *q) {
+    CHECK_STATUS(Validate_Ptr(q));
+
+    float norm_sq = ((q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]));
+    if (!isfinite(norm_sq) || (norm_sq <= 0.0f)) {
+        return ERROR;
+    }
+
+    float inv_norm = (1.0f / sqrtf(norm_sq));
+    for (uint8_t k = 0U; k < 4U; k++) {
+        q[k] *= inv_norm;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Computes the Hamilton product of two quaternions
+ * @param  a: Pointer to the left quaternion
+ * @param  b: Pointer to the right quaternion
+ * @param  q: Pointer to a 4-element array used to store a * b, which may alias neither input
+ * @retval Status indicating success or invalid parameters
+ * @note   The product applies the rotation b first, then a
+ */
+Status ORIENT_Quat_Multiply(const float *a, const float *b, float *q) {
+    CHECK_STATUS(Validate_Ptr(a));
+    CHECK_STATUS(Validate_Ptr(b));
+    CHECK_STATUS(Validate_Ptr(q));
+
+    q[0] = ((a[0] * b[0]) - (a[1] * b[1]) - (a[2] * b[2]) - (a[3] * b[3]));
+    q[1] = ((a[0] * b[1]) + (a[1] * b[0]) + (a[2] * b[3]) - (a[3] * b[2]));
+    q[2] = ((a[0] * b[2]) - (a[1] * b[3]) + (a[2] * b[0]) + (a[3] * b[1]));
+    q[3] = ((a[0] * b[3]) + (a[1] * b[2]) - (a[2] * b[1]) + (a[3] * b[0]));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Computes the conjugate (inverse rotation) of a quaternion
+ * @param  q:         Pointer to the unit quaternion
+ * @param  conjugate: Pointer to a 4-element array used to store the conjugate, which may alias q
+ * @retval Status indicating success or invalid parameters
+ */
+Status ORIENT_Quat_Conjugate(const float *q, float *conjugate) {
+    CHECK_STATUS(Validate_Ptr(q));
+    CHECK_STATUS(Validate_Ptr(conjugate));
+
+    conjugate[0] = q[0];
+    conjugate[1] = -q[1];
+    conjugate[2] = -q[2];
+    conjugate[3] = -q[3];
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Computes the rotation matrix of a quaternion
+ * @param  q: Pointer to the unit quaternion
+ * @param  r: Matrix used to store the rotation from the sensor frame to the earth frame, whose
+ *            transpose rotates the earth frame into the sensor frame
+ * @retval Status indicating success or invalid parameters
+ */
+Status ORIENT_Quat_To_Matrix(const float *q, float r[3][3]) {
+    CHECK_STATUS(Validate_Ptr(q));
+    CHECK_STATUS(Validate_Ptr(r));
+
+    float q0q1 = (q[0] * q[1]);
+    float q0q2 = (q[0] * q[2]);
+    float q0q3 = (q[0] * q[3]);
+    float q1q1 = (q[1] * q[1]);
+    float q1q2 = (q[1] * q[2]);
+    float q1q3 = (q[1] * q[3]);
+    float q2q2 = (q[2] * q[2]);
+    float q2q3 = (q[2] * q[3]);
+    float q3q3 = (q[3] * q[3]);
+
+    r[0][0] = (1.0f - (2.0f * (q2q2 + q3q3)));
+    r[0][1] = (2.0f * (q1q2 - q0q3));
+    r[0][2] = (2.0f * (q1q3 + q0q2));
+    r[1][0] = (2.0f * (q1q2 + q0q3));
+    r[1][1] = (1.0f - (2.0f * (q1q1 + q3q3)));
+    r[1][2] = (2.0f * (q2q3 - q0q1));
+    r[2][0] = (2.0f * (q1q3 - q0q2));
+    r[2][1] = (2.0f * (q2q3 + q0q1));
+    r[2][2] = (1.0f - (2.0f * (q1q1 + q2q2)));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Interpolates between two orientations at constant angular rate
+ * @param  a: Pointer to the unit quaternion at t = 0
+ * @param  b: Pointer to the unit quaternion at t = 1
+ * @param  t: Interpolation fraction, usually in [0, 1] (values outside extrapolate)
+ * @param  q: Pointer to a 4-element array used to store the interpolated unit quaternion
+ * @retval Status indicating success or invalid parameters
+ * @note   The shorter of the two arcs between a and b is followed. Nearly identical orientations
+ *         (dot product above ORIENT_SLERP_DOT_MAX) are interpolated linearly and normalised, as
+ *         the sine of the angle between them is too small to divide by
+ */
+Status ORIENT_Quat_Slerp(const float *a, const float *b, float t, float *q) {
+    CHECK_STATUS(Validate_Ptr(a));
+    CHECK_STATUS(Validate_Ptr(b));
+    CHECK_STATUS(Validate_Ptr(q));
+
+    //q and -q are the same rotation, so take the one closer to a
+    float dot  = ((a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]) + (a[3] * b[3]));
+    float sign = 1.0f;
+    if (dot < 0.0f) {
+        dot  = -dot;
+        sign = -1.0f;
+    }
+
+    float weight_a = (1.0f - t);
+    float weight_b = t;
+    if (dot < ORIENT_SLERP_DOT_MAX) {
+        float angle   = acosf(dot);
+        float inv_sin = (1.0f / sinf(angle));
+        weight_a = (sinf(weight_a * angle) * inv_sin);
+        weight_b = (sinf(weight_b * angle) * inv_sin);
+    }
+    weight_b *= sign;
+    for (uint8_t k = 0U; k < 4U; k++) {
+        q[k] = ((weight_a * a[k]) + (weight_b * b[k]));
+    }
+
+    return ORIENT_Quat_Normalise(q);
+}
+
+/**
+ * @brief  Rotates an orientation by a constant angular rate
+ * @param  q:      Pointer to the unit quaternion
+ * @param  rate:   Pointer to the angular rate in rad/s, in the sensor frame
+ * @param  dt:     Duration of the rotation in seconds (negative values rotate backwards)
+ * @param  result: Pointer to a 4-element array used to store the rotated unit quaternion, which
+ *                 may not alias q
+ * @retval Status indicating success or invalid parameters
+ * @note   The rotation is exact for a constant rate, rather than a first-order step, so it stays
+ *         accurate over prediction horizons of many sample periods
+ */
+Status ORIENT_Quat_Integrate(const float *q, const float *rate, float dt, float *result) {
+    CHECK_STATUS(Validate_Ptr(rate));
+
+    //rotation of angle |rate| * dt about the rate axis
+    float norm  = sqrtf((rate[0] * rate[0]) + (rate[1] * rate[1]) + (rate[2] * rate[2]));
+    float angle = (norm * dt);
+    float delta[4];
+    if ((angle < ORIENT_ANGLE_MIN) && (angle > -ORIENT_ANGLE_MIN)) {
+        delta[0] = 1.0f;
+        for (uint8_t i = 0U; i < 3U; i++) {
+            delta[i + 1U] = (0.5f * rate[i] * dt);
+        }
+    } else {
+        float scale = (sinf(0.5f * angle) / norm);
+        delta[0] = cosf(0.5f * angle);
+        for (uint8_t i = 0U; i < 3U; i++) {
+            delta[i + 1U] = (scale * rate[i]);
+        }
+    }
+
+    //rates are in the sensor frame, so the rotation is applied on the right
+    CHECK_STATUS(ORIENT_Quat_Multiply(q, delta, result));
+
+    return ORIENT_Quat_Normalise(result);
+}
+
+/**
+ * @brief  Packs a quaternion into its smallest three components
+ * @param  q:      Pointer to the quaternion, which is normalised before packing
+ * @param  bits:   Bits per component (ORIENT_PACK_BITS_MIN - ORIENT_PACK_BITS_MAX)
+ * @param  packed: Pointer to a variable used to store the packed quaternion, holding the index of
+ *                 the largest component in bits [3 * bits + 1 : 3 * bits] and the other three
+ *                 components in order from bits [3 * bits - 1 : 2 * bits] down
+ * @retval Status indicating success, invalid parameters or error
+ * @note   A unit quaternion has three degrees of freedom, so the largest component is dropped and
+ *         recovered as sqrt(1 - sum of the others squared). As q and -q are the same rotation, the
+ *         sign is chosen to make it positive. The others then lie in [-1/sqrt(2), 1/sqrt(2)], and
+ *         are quantised to 2^bits - 1 levels, which include 0 so a level orientation is exact.
+ *         Each is then off by at most e = 1 / (sqrt(2) * (2^bits - 2))
+ * @note   As the dropped component is at least 1/2, the rotation error is at most 4 * sqrt(3) * e
+ *         radians, i.e. 0.27 degrees with 10 bits (0.25 degrees measured over 10^6 random
+ *         orientations) and 1.1 degrees with 8 bits (0.99 degrees measured). Returns ERROR if q has
+ *         zero length or a component that is not finite
+ */
+Status ORIENT_Quat_Pack(const float *q, uint8_t bits, uint32_t *packed) {
+    CHECK_STATUS(Validate_Ptr(q));
+    CHECK_STATUS(Validate_Ptr(packed));
+    if ((bits < ORIENT_PACK_BITS_MIN) || (bits > ORIENT_PACK_BITS_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    float unit[4] = {q[0], q[1], q[2], q[3]};
+    CHECK_STATUS(ORIENT_Quat_Normalise(unit));
+
+    uint8_t largest = 0U;
+    for (uint8_t k = 1U; k < 4U; k++) {
+        if (fabsf(unit[k]) > fabsf(unit[largest])) {
+            largest = k;
+        }
+    }
+    float sign = (unit[largest] < 0.0f) ? -1.0f : 1.0f;
+
+    //map each remaining component from [-1/sqrt(2), 1/sqrt(2)] to the nearest of the levels
+    uint32_t levels = ((1UL << bits) - 2UL);
+    float    scale  = ((float) levels / (2.0f * ORIENT_SQRT1_2));
+    *packed = largest;
+    for (uint8_t k = 0U; k < 4U; k++) {
+        if (k == largest) {
+            continue;
+        }
+        float level = (((sign * unit[k]) + ORIENT_SQRT1_2) * scale) + 0.5f;
+        if (level < 0.0f) {
+            level = 0.0f;
+        }
+        uint32_t code = (uint32_t) level;
+        *packed = ((*packed << bits) | ((code > levels) ? levels : code));
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Unpacks a quaternion packed by ORIENT_Quat_Pack()
+ * @param  packed: Packed quaternion
+ * @param  bits:   Bits per component used to pack it
+ * @param  q:      Pointer to a 4-element array used to store the unit quaternion, whose largest
+ *                 component is positive
+ * @retval Status indicating success or invalid parameters
+ */
+Status ORIENT_Quat_Unpack(uint32_t packed, uint8_t bits, float *q) {
+    CHECK_STATUS(Validate_Ptr(q));
+    if ((bits < ORIENT_PACK_BITS_MIN) || (bits > ORIENT_PACK_BITS_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    uint32_t levels  = ((1UL << bits) - 2UL);
+    float    step    = ((2.0f * ORIENT_SQRT1_2) / (float) levels);
+    uint8_t  largest = (uint8_t) ((packed >> (3U * bits)) & 3U);
+    float    sum_sq  = 0.0f;
+    for (int8_t k = 3; k >= 0; k--) {
+        if (k == largest) {
+            continue;
+        }
+        q[k]     = (((float) (packed & ((1UL << bits) - 1UL)) * step) - ORIENT_SQRT1_2);
+        sum_sq  += (q[k] * q[k]);
+        packed >>= bits;
+    }
+    q[largest] = (sum_sq < 1.0f) ? sqrtf(1.0f - sum_sq) : 0.0f;
+
+    return ORIENT_Quat_Normalise(q);
+}
+
+/**
+ * @brief  Computes the heading, roll and pitch of a quaternion
+ * @param  q:     Pointer to the unit quaternion
+ * @param  units: Pointer to the unit settings, of which eul_unit and ori_unit are used
+ * @param  hrp:   Pointer to a 3-element array used to store the heading, roll and pitch, in the
+ *                order of the BNO055 EUL registers
+ * @retval Status indicating success or invalid parameters
+ * @note   Angles are in degrees unless eul_unit is BNO_UNIT_EUL_RADIANS
+ */
+Status ORIENT_Get_Euler(const float *q, const ORIENT_Units_t *units, float *hrp) {
+    CHECK_STATUS(Validate_Ptr(q));
+    CHECK_STATUS(Validate_Ptr(units));
+    CHECK_STATUS(Validate_Ptr(hrp));
+
+    //heading increases clockwise seen from above, i.e. about -z
+    float heading = -atan2f((2.0f * ((q[0] * q[3]) + (q[1] * q[2]))),
+                            (1.0f - (2.0f * ((q[2] * q[2]) + (q[3] * q[3])))));
+    if (heading < 0.0f) {
+        heading += (2.0f * ORIENT_PI);
+    }
+
+    //clamp the sine, as rounding can push it out of range near +/-90 degrees
+    float sin_roll = (2.0f * ((q[0] * q[2]) - (q[3] * q[1])));
+    sin_roll = (sin_roll > 1.0f) ? 1.0f : ((sin_roll < -1.0f) ? -1.0f : sin_roll);
+    float roll = asinf(sin_roll);
+
+    float pitch = atan2f((2.0f * ((q[0] * q[1]) + (q[2] * q[3]))),
+                         (1.0f - (2.0f * ((q[1] * q[1]) + (q[2] * q[2])))));
+    if (units->ori_unit == BNO_UNIT_ORI_ANDROID) {
+        pitch = -pitch;
+    }
+
+    float scale = (units->eul_unit == BNO_UNIT_EUL_RADIANS) ? 1.0f : ORIENT_RAD_TO_DEG;
+    hrp[BNO_EUL_HEADING] = (heading * scale);
+    hrp[BNO_EUL_ROLL]    = (roll * scale);
+    hrp[BNO_EUL_PITCH]   = (pitch * scale);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Computes the gravity direction in the sensor frame
+ * @param  q:       Pointer to the unit quaternion
+ * @param  gravity: Pointer to a 3-element array used to store the unit gravity vector, which
+ *                  points up as measured by an accelerometer at rest
+ * @retval Status indicating success or invalid parameters
+ */
+Status ORIENT_Get_Gravity(const float *q, float *gravity) {
+    CHECK_STATUS(Validate_Ptr(q));
+    CHECK_STATUS(Validate_Ptr(gravity));
+
+    //last row of the rotation matrix, i.e. the earth z axis in the sensor frame
+    gravity[0] = (2.0f * ((q[1] * q[3]) - (q[0] * q[2])));
+    gravity[1] = (2.0f * ((q[2] * q[3]) + (q[0] * q[1])));
+    gravity[2] = (1.0f - (2.0f * ((q[1] * q[1]) + (q[2] * q[2]))));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Removes gravity from an acceleration
+ * @param  q:   Pointer to the unit quaternion
+ * @param  acc: Pointer to the measured acceleration, in the sensor frame
+ * @param  g:   Gravity magnitude in the unit of acc (e.g. ORIENT_GRAVITY_MS)
+ * @param  lia: Pointer to a 3-element array used to store the linear acceleration, which may
+ *              alias acc
+ * @retval Status indicating success or invalid parameters
+ */
+Status ORIENT_Get_Linear_Acc(const float *q, const float *acc, float g, float *lia) {
+    CHECK_STATUS(Validate_Ptr(acc));
+    CHECK_STATUS(Validate_Ptr(lia));
+
+    float gravity[3];
+    CHECK_STATUS(ORIENT_Get_Gravity(q, gravity));
+    for (uint8_t i = 0U; i < 3U; i++) {
+        lia[i] = (acc[i] - (g * gravity[i]));
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Derives the EUL, GRV and LIA channels of a frame
+ * @param  units:       Pointer to the unit settings of the BNO055 (e.g. as set via BNO_Set_Unit)
+ * @param  derive_mask: Mask of the channels to be derived, within ORIENT_DERIVABLE_MASK
+ * @param  frame:       Pointer to the frame, whose QUA channel and, for LIA, ACC channel must be
+ *                      in frame->updated_mask
+ * @retval Status indicating success or invalid parameters
+ * @note   Derived channels are added to frame->updated_mask. A channel whose sources are not in
+ *         the frame, or whose quaternion has zero length, is not derived
+ * @note   A zero unit setting selects the BNO055 reset value (m/s^2, degrees, Windows format)
+ */
+Status ORIENT_Derive_Channels(
+    const ORIENT_Units_t *units,
+    uint16_t             derive_mask,
+    IMU_Frame_t          *frame
+) {
+    CHECK_STATUS(Validate_Ptr(units));
+    CHECK_STATUS(Validate_Ptr(frame));
+    if (derive_mask & ~ORIENT_DERIVABLE_MASK) {
+        return INVALID_PARAM;
+    }
+    if (!((frame->updated_mask >> IMU_CHANNEL_QUA) & 1U)) {
+        return SUCCESS;
+    }
+    if (!((frame->updated_mask >> IMU_CHANNEL_ACC) & 1U)) {
+        derive_mask &= (uint16_t) ~(1U << IMU_CHANNEL_LIA);
+    }
+
+    float q[4];
+    for (uint8_t k = 0U; k < 4U; k++) {
+        q[k] = ((float) frame->data[IMU_CHANNEL_QUA][k] / BNO_QUA_QUATERNIONS);
+    }
+    if (ORIENT_Quat_Normalise(q) != SUCCESS) {
+        return SUCCESS;
+    }
+
+    //Euler angles in the EUL register units
+    if ((derive_mask >> IMU_CHANNEL_EUL) & 1U) {
+        float hrp[3];
+        CHECK_STATUS(ORIENT_Get_Euler(q, units, hrp));
+        float scale = (units->eul_unit == BNO_UNIT_EUL_RADIANS) ? BNO_EUL_RADIANS : BNO_EUL_DEGREES;
+        for (uint8_t i = 0U; i < 3U; i++) {
+            frame->data[IMU_CHANNEL_EUL][i] = ORIENT_To_Raw(hrp[i] * scale);
+        }
+    }
+
+    //gravity in the accelerometer register units, and the acceleration left once it is removed
+    if (derive_mask & ((1U << IMU_CHANNEL_GRV) | (1U << IMU_CHANNEL_LIA))) {
+        float gravity[3];
+        CHECK_STATUS(ORIENT_Get_Gravity(q, gravity));
+        float g_raw = ORIENT_Gravity_Raw(units);
+        for (uint8_t i = 0U; i < 3U; i++) {
+            int16_t grv = ORIENT_To_Raw(gravity[i] * g_raw);
+            if ((derive_mask >> IMU_CHANNEL_GRV) & 1U) {
+                frame->data[IMU_CHANNEL_GRV][i] = grv;
+            }
+            if ((derive_mask >> IMU_CHANNEL_LIA) & 1U) {
+                frame->data[IMU_CHANNEL_LIA][i] = ORIENT_To_Raw(
+                    (float) frame->data[IMU_CHANNEL_ACC][i] - (float) grv
+                );
+            }
+        }
+    }
+    frame->updated_mask |= derive_mask;
+
+    return SUCCESS;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file    orient.h
+ * @brief   Orientation Math
+ * @details This header file contains the public interface for the orientation math module. It
+ *          includes constants, unit structures and function prototypes used to operate on
+ *          quaternions and to derive the Euler angles, gravity and linear acceleration channels.
+ */
+
+
+#ifndef __ORIENT_H
+#define __ORIENT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/bno055/bno.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define ORIENT_PI                   (3.14159265f)
+#define ORIENT_RAD_TO_DEG           (57.2957795f)
+#define ORIENT_GRAVITY_MS           (9.80665f)
+#define ORIENT_GRAVITY_MG           (1000.0f)
+#define ORIENT_SLERP_DOT_MAX        (0.9995f)
+#define ORIENT_ANGLE_MIN            (1.0e-6f)
+#define ORIENT_SQRT1_2              (0.70710678f)
+#define ORIENT_PACK_BITS_MIN        2U
+#define ORIENT_PACK_BITS_MAX        10U
+#define ORIENT_DERIVABLE_MASK       ((uint16_t) ((1U << IMU_CHANNEL_LIA) | (1U << IMU_CHANNEL_GRV) \
+                                                | (1U << IMU_CHANNEL_EUL)))
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Optional */
+    BNO_Unit acc_unit;
+    BNO_Unit eul_unit;
+    BNO_Unit ori_unit;
+} ORIENT_Units_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status ORIENT_Quat_Normalise (float *q);
+Status ORIENT_Quat_Multiply  (const float *a, const float *b, float *q);
+Status ORIENT_Quat_Conjugate (const float *q, float *conjugate);
+Status ORIENT_Quat_To_Matrix (const float *q, float r[3][3]);
+Status ORIENT_Quat_Slerp     (const float *a, const float *b, float t, float *q);
+Status ORIENT_Quat_Integrate (const float *q, const float *rate, float dt, float *result);
+Status ORIENT_Quat_Pack      (const float *q, uint8_t bits, uint32_t *packed);
+Status ORIENT_Quat_Unpack    (uint32_t packed, uint8_t bits, float *q);
+Status ORIENT_Get_Euler      (const float *q, const ORIENT_Units_t *units, float *hrp);
+Status ORIENT_Get_Gravity    (const float *q, float *gravity);
+Status ORIENT_Get_Linear_Acc (const float *q, const float *acc, float g, float *lia);
+Status ORIENT_Derive_Channels(
+    const ORIENT_Units_t *units,
+    uint16_t             derive_mask,
+    IMU_Frame_t          *frame
+);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * @file    predict.c
+ * @brief   Orientation Predictor
+ * @details This source file serves the orientation at any requested time, from the two latest
+ *          fused quaternions and the latest gyroscope rate. A fused orientation is already several
+ *          milli-seconds old when it is used, because of the UART round-trip and queueing, and it
+ *          is only updated at the fusion rate. The predictor compensates for both:
+ *          - Times after the latest fused sample are predicted by rotating the latest quaternion
+ *            by the latest gyroscope rate over the elapsed time, bounded by horizon_max_us, so
+ *            consumers get the current orientation rather than the one at the sample time
+ *          - Times between the two latest fused samples are interpolated (slerp), so consumers
+ *            running faster than the fusion (e.g. a servo output at the TIM1 rate) get a smooth
+ *            orientation rather than a staircase
+ *
+ *          Fused quaternions are taken from the QUA channel of the frames, or, if external_fusion
+ *          is set, pushed via PRED_Push_Quaternion() from an on-MCU filter (see ahrs.h). Frames
+ *          whose QUA channel is flagged as a duplicate are not new fused samples and are ignored.
+ *
+ *          The history is protected by a sequence counter, as in snapshot.c, so the writer (the
+ *          application loop) never blocks and readers may run in interrupt handlers.
+ *
+ * @par     Functions include:
+ *          - PRED_Init(): Initialises an empty predictor
+ *          - PRED_Update(): Updates the gyroscope rate and fused quaternion from a frame
+ *          - PRED_Push_Quaternion(): Adds a fused quaternion computed outside the frames
+ *          - PRED_Get_Quaternion(): Gets the orientation at a requested time
+ *          - PRED_Get_Report(): Gets the prediction statistics
+ *
+ * @note    There must be a single writer. The gyroscope rate is not corrected for bias, so the
+ *          prediction error grows with the horizon at the bias rate
+ */
+
+
+#include "predict.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Appends a fused quaternion to the history
+ * @param  state:     Pointer to the predictor state
+ * @param  q:         Pointer to the unit quaternion
+ * @param  sample_us: Sample time of the quaternion
+ * @retval None
+ * @note   Must be called within a publication of the sequence counter
+ */
+static void PRED_Store(PRED_State_t *state, const float *q, uint64_t sample_us) {
+    if (state->q_count > 0U) {
+        for (uint8_t k = 0U; k < 4U; k++) {
+            state->q[0][k] = state->q[1][k];
+        }
+        state->q_us[0] = state->q_us[1];
+    }
+    for (uint8_t k = 0U; k < 4U; k++) {
+        state->q[1][k] = q[k];
+    }
+    state->q_us[1] = sample_us;
+    if (state->q_count < 2U) {
+        state->q_count++;
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an empty predictor
+ * @param  state:  Pointer to the predictor state
+ * @param  config: Pointer to a struct containing the predictor settings
+ * @retval Status indicating success or invalid parameters
+ * @note   A horizon_max_us of 0 selects PRED_HORIZON_US_DEFAULT, and a gyr_lsb_rad_s of 0 selects
+ *         the BNO055 reset unit selection (dps)
+ */
+Status PRED_Init(PRED_State_t *state, PRED_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if (config->gyr_lsb_rad_s < 0.0f) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(PRED_State_t));
+    state->config = *config;
+    if (state->config.horizon_max_us == 0UL) {
+        state->config.horizon_max_us = PRED_HORIZON_US_DEFAULT;
+    }
+    if (state->config.gyr_lsb_rad_s == 0.0f) {
+        state->config.gyr_lsb_rad_s = PRED_GYR_LSB_DEFAULT;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Updates the gyroscope rate and fused quaternion from a frame
+ * @param  state: Pointer to the predictor state
+ * @param  frame: Pointer to the frame, of which the GYR and QUA channels in frame->updated_mask
+ *                are used
+ * @retval Status indicating success or invalid parameters
+ * @note   The QUA channel is ignored if external_fusion is set, if it is a duplicate, or if it has
+ *         zero length (i.e. it was read outside a fusion mode)
+ */
+Status PRED_Update(PRED_State_t *state, const IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    float   q[4];
+    uint8_t q_new = (!state->config.external_fusion
+                  && ((frame->updated_mask >> IMU_CHANNEL_QUA) & 1U)
+                  && !((frame->duplicate_mask >> IMU_CHANNEL_QUA) & 1U));
+    if (q_new) {
+        for (uint8_t k = 0U; k < 4U; k++) {
+            q[k] = ((float) frame->data[IMU_CHANNEL_QUA][k] / BNO_QUA_QUATERNIONS);
+        }
+        q_new = (ORIENT_Quat_Normalise(q) == SUCCESS);
+    }
+
+    //mark the publication in progress before touching the history
+    state->sequence++;
+    DMB();
+
+    if ((frame->updated_mask >> IMU_CHANNEL_GYR) & 1U) {
+        float scale = (1.0f / state->config.gyr_lsb_rad_s);
+        for (uint8_t i = 0U; i < 3U; i++) {
+            state->rate[i] = ((float) frame->data[IMU_CHANNEL_GYR][i] * scale);
+        }
+        state->rate_valid = 1U;
+    }
+    if (q_new) {
+        PRED_Store(state, q, frame->sample_us);
+    }
+
+    //mark the publication complete once the history is written
+    DMB();
+    state->sequence++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds a fused quaternion computed outside the frames
+ * @param  state:     Pointer to the predictor state
+ * @param  q:         Pointer to the quaternion (w, x, y, z)
+ * @param  sample_us: Sample time of the quaternion, e.g. the sample time of the frame it was
+ *                    computed from
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if the quaternion has zero length
+ */
+Status PRED_Push_Quaternion(PRED_State_t *state, const float *q, uint64_t sample_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(q));
+
+    float unit_q[4] = {q[0], q[1], q[2], q[3]};
+    CHECK_STATUS(ORIENT_Quat_Normalise(unit_q));
+
+    state->sequence++;
+    DMB();
+    PRED_Store(state, unit_q, sample_us);
+    DMB();
+    state->sequence++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the orientation at a requested time
+ * @param  state:   Pointer to the predictor state
+ * @param  time_us: Requested time in micro-seconds (e.g. from DWT_Get_Time_US)
+ * @param  q:       Pointer to a 4-element array used to store the unit quaternion (w, x, y, z)
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Times before the latest fused sample are interpolated, clamped to the oldest sample of
+ *         the history. Times after it are predicted from the gyroscope rate, over at most
+ *         horizon_max_us, beyond which the prediction is held and counted as clamped
+ * @note   Returns ERROR if no fused quaternion has been received, or if no consistent copy of the
+ *         history could be taken within PRED_READ_ATTEMPTS_MAX attempts (i.e. the reader preempts
+ *         the writer)
+ */
+Status PRED_Get_Quaternion(PRED_State_t *state, uint64_t time_us, float *q) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(q));
+
+    //take a consistent copy of the history
+    float    history[2][4] = {{0.0f}};
+    uint64_t history_us[2] = {0ULL};
+    float    rate[3]       = {0.0f};
+    uint8_t  count         = 0U;
+    uint8_t  rate_valid    = 0U;
+    uint8_t  copied        = 0U;
+    for (uint8_t attempt = 0U; (attempt < PRED_READ_ATTEMPTS_MAX) && !copied; attempt++) {
+        uint32_t sequence = state->sequence;
+        if (sequence & 1UL) {
+            continue;
+        }
+        DMB();
+
+        count      = state->q_count;
+        rate_valid = state->rate_valid;
+        for (uint8_t j = 0U; j < 2U; j++) {
+            for (uint8_t k = 0U; k < 4U; k++) {
+                history[j][k] = state->q[j][k];
+            }
+            history_us[j] = state->q_us[j];
+        }
+        for (uint8_t i = 0U; i < 3U; i++) {
+            rate[i] = state->rate[i];
+        }
+
+        DMB();
+        copied = (state->sequence == sequence);
+    }
+    if (!copied || (count == 0U)) {
+        return ERROR;
+    }
+
+    //record the age of the latest fused sample at the requested time, i.e. the sensor latency
+    state->age_last_us = (time_us > history_us[1]) ? (uint32_t) (time_us - history_us[1]) : 0UL;
+
+    //interpolate between the fused samples
+    if (time_us <= history_us[1]) {
+        state->interpolation_count++;
+        if ((count < 2U) || (time_us <= history_us[0])) {
+            uint8_t index = (count < 2U) ? 1U : 0U;
+            for (uint8_t k = 0U; k < 4U; k++) {
+                q[k] = history[index][k];
+            }
+            return SUCCESS;
+        }
+        float fraction = ((float) (time_us - history_us[0])
+                       / (float) (history_us[1] - history_us[0]));
+        return ORIENT_Quat_Slerp(history[0], history[1], fraction, q);
+    }
+
+    //predict beyond the latest fused sample
+    uint64_t horizon_us = (time_us - history_us[1]);
+    if (horizon_us > state->config.horizon_max_us) {
+        horizon_us = state->config.horizon_max_us;
+        state->clamp_count++;
+    }
+    state->prediction_count++;
+    state->horizon_last_us = (uint32_t) horizon_us;
+    if (!rate_valid) {
+        for (uint8_t k = 0U; k < 4U; k++) {
+            q[k] = history[1][k];
+        }
+        return SUCCESS;
+    }
+
+    return ORIENT_Quat_Integrate(history[1], rate, ((float) horizon_us * 1.0e-6f), q);
+}
+
+/**
+ * @brief  Gets the prediction statistics
+ * @param  state:  Pointer to the predictor state
+ * @param  report: Pointer to a struct used to store the statistics
+ * @retval Status indicating success or invalid parameters
+ * @note   The counters are updated by the readers, so they are only exact with a single reader.
+ *         sample_period_us is the interval between the two latest fused samples, and age_last_us
+ *         is the age of the latest fused sample at the last requested time, before clamping
+ */
+Status PRED_Get_Report(PRED_State_t *state, PRED_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->prediction_count    = state->prediction_count;
+    report->interpolation_count = state->interpolation_count;
+    report->clamp_count         = state->clamp_count;
+    report->horizon_last_us     = state->horizon_last_us;
+    report->age_last_us         = state->age_last_us;
+    report->sample_period_us    = (state->q_count < 2U)
+                                ? 0UL : (uint32_t) (state->q_us[1] - state->q_us[0]);
+
+    return SUCCESS;
+}
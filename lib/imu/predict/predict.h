@@ -0,0 +1,84 @@
+/**
+ * @file    predict.h
+ * @brief   Orientation Predictor
+ * @details This header file contains the public interface for the orientation predictor. It
+ *          includes constants, configuration, state and report structures and function prototypes
+ *          used to serve the orientation at any requested time from the latest fused samples.
+ */
+
+
+#ifndef __PREDICT_H
+#define __PREDICT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../orient/orient.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define PRED_READ_ATTEMPTS_MAX      4U
+#define PRED_HORIZON_US_DEFAULT     50000UL
+#define PRED_GYR_LSB_DEFAULT        (BNO_GYR_DPS * ORIENT_RAD_TO_DEG)
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Optional */
+    uint32_t horizon_max_us;
+    float    gyr_lsb_rad_s;
+    uint8_t  external_fusion;
+} PRED_Config_t;
+
+typedef struct {
+    PRED_Config_t     config;
+    float             q[2][4];
+    uint64_t          q_us[2];
+    uint8_t           q_count;
+    float             rate[3];
+    uint8_t           rate_valid;
+    volatile uint32_t sequence;
+    volatile uint32_t prediction_count;
+    volatile uint32_t interpolation_count;
+    volatile uint32_t clamp_count;
+    volatile uint32_t horizon_last_us;
+    volatile uint32_t age_last_us;
+} PRED_State_t;
+
+typedef struct {
+    uint32_t prediction_count;
+    uint32_t interpolation_count;
+    uint32_t clamp_count;
+    uint32_t horizon_last_us;
+    uint32_t age_last_us;
+    uint32_t sample_period_us;
+} PRED_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status PRED_Init           (PRED_State_t *state, PRED_Config_t *config);
+Status PRED_Update         (PRED_State_t *state, const IMU_Frame_t *frame);
+Status PRED_Push_Quaternion(PRED_State_t *state, const float *q, uint64_t sample_us);
+Status PRED_Get_Quaternion (PRED_State_t *state, uint64_t time_us, float *q);
+Status PRED_Get_Report     (PRED_State_t *state, PRED_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file    ring.c
+ * @brief   Lock-Free IMU Frame Ring
+ * @details This source file implements a fixed-capacity ring of timestamped frames between a
+ *          single producer (the acquisition interrupt) and a single consumer (the application
+ *          loop). Acquisition can then run at full rate while slow consumers, such as formatting
+ *          and transmission, catch up in bulk.
+ *
+ *          No lock is needed: the head index is only written by the producer and the tail index
+ *          only by the consumer. Both are free-running counters, so the occupancy is their
+ *          difference and the capacity is a power of two so the slot is found by masking. A memory
+ *          barrier orders the slot accesses before the publication of each index. The consumer
+ *          reads the oldest frames in place, as a contiguous batch, and releases them once done.
+ *
+ *          A frame pushed into a full ring is dropped and counted as an overflow, so frames
+ *          already queued are never overwritten while being read. The highest occupancy observed
+ *          is kept as a high-water mark, which is used to size RING_CAPACITY.
+ *
+ * @par     Functions include:
+ *          - RING_Init(): Initialises an empty ring
+ *          - RING_Push(): Queues a copy of a frame
+ *          - RING_Peek_Batch(): Gets the oldest queued frames, without removing them
+ *          - RING_Release(): Removes the oldest queued frames
+ *          - RING_Get_Report(): Gets the occupancy and overflow statistics
+ *
+ * @note    Each of RING_Push() and RING_Peek_Batch()/RING_Release() must only be called from a
+ *          single context
+ */
+
+
+#include "ring.h"
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an empty ring
+ * @param  state: Pointer to the ring state
+ * @retval Status indicating success or invalid parameters
+ */
+Status RING_Init(RING_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    memset(state, 0, sizeof(RING_State_t));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Queues a copy of a frame
+ * @param  state: Pointer to the ring state
+ * @param  frame: Pointer to the frame to be queued
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Intended to be called from the acquisition interrupt. Returns ERROR if the ring is full,
+ *         in which case the frame is dropped and counted as an overflow
+ */
+Status RING_Push(RING_State_t *state, const IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    uint32_t head = state->head;
+    if ((head - state->tail) >= RING_CAPACITY) {
+        state->overflow_count++;
+        return ERROR;
+    }
+
+    //fill the slot before publishing it
+    state->frames[head & RING_INDEX_MASK] = *frame;
+    DMB();
+    state->head = (head + 1UL);
+    state->push_count++;
+
+    uint32_t occupancy = ((head + 1UL) - state->tail);
+    if (occupancy > state->high_water) {
+        state->high_water = occupancy;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the oldest queued frames, without removing them
+ * @param  state:  Pointer to the ring state
+ * @param  frames: Pointer to a variable used to store a pointer to the oldest frame
+ * @param  count:  Pointer to a variable used to store the number of frames in the batch
+ * @retval Status indicating success or invalid parameters
+ * @note   The batch is contiguous, so it ends at the last slot of the ring even if more frames
+ *         are queued after it. Frames remain valid until released via @ref RING_Release
+ */
+Status RING_Peek_Batch(RING_State_t *state, const IMU_Frame_t **frames, uint16_t *count) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frames));
+    CHECK_STATUS(Validate_Ptr(count));
+
+    //read the published index before the slots it covers
+    uint32_t tail      = state->tail;
+    uint32_t occupancy = (state->head - tail);
+    DMB();
+
+    uint32_t contiguous = (RING_CAPACITY - (tail & RING_INDEX_MASK));
+    *frames = &state->frames[tail & RING_INDEX_MASK];
+    *count  = (uint16_t) ((occupancy < contiguous) ? occupancy : contiguous);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Removes the oldest queued frames
+ * @param  state: Pointer to the ring state
+ * @param  count: Number of frames to be removed
+ * @retval Status indicating success or invalid parameters
+ * @note   Returns INVALID_PARAM if fewer than count frames are queued
+ */
+Status RING_Release(RING_State_t *state, uint16_t count) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    uint32_t tail = state->tail;
+    if (count > (state->head - tail)) {
+        return INVALID_PARAM;
+    }
+
+    //finish reading the slots before handing them back to the producer
+    DMB();
+    state->tail = (tail + count);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the occupancy and overflow statistics
+ * @param  state:  Pointer to the ring state
+ * @param  report: Pointer to a struct used to store the statistics
+ * @retval Status indicating success or invalid parameters
+ */
+Status RING_Get_Report(RING_State_t *state, RING_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->occupancy      = (state->head - state->tail);
+    report->high_water     = state->high_water;
+    report->push_count     = state->push_count;
+    report->overflow_count = state->overflow_count;
+
+    return SUCCESS;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file    ring.h
+ * @brief   Lock-Free IMU Frame Ring
+ * @details This header file contains the public interface for the single-producer/single-consumer
+ *          frame ring. It includes constants, state and report structures and function prototypes
+ *          used to pass timestamped frames from the acquisition interrupt to the application loop.
+ */
+
+
+#ifndef __RING_H
+#define __RING_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define RING_CAPACITY               16U
+#define RING_INDEX_MASK             (RING_CAPACITY - 1U)
+
+#if ((RING_CAPACITY == 0U) || ((RING_CAPACITY & RING_INDEX_MASK) != 0U))
+    #error "RING_CAPACITY must be a power of two"
+#endif
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    IMU_Frame_t       frames[RING_CAPACITY];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t push_count;
+    volatile uint32_t overflow_count;
+    volatile uint32_t high_water;
+} RING_State_t;
+
+typedef struct {
+    uint32_t occupancy;
+    uint32_t high_water;
+    uint32_t push_count;
+    uint32_t overflow_count;
+} RING_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status RING_Init      (RING_State_t *state);
+Status RING_Push      (RING_State_t *state, const IMU_Frame_t *frame);
+Status RING_Peek_Batch(RING_State_t *state, const IMU_Frame_t **frames, uint16_t *count);
+Status RING_Release   (RING_State_t *state, uint16_t count);
+Status RING_Get_Report(RING_State_t *state, RING_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
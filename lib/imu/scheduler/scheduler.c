@@ -0,0 +1,788 @@
+/**
+ * @file    scheduler.c
+ * @brief   Per-Channel Acquisition Scheduler
+ * @details This source file reads each BNO055 channel at its own rate, as declared in the
+ *          scheduler configuration. Time is divided into ticks of a fixed rate. On every tick the
+ *          channels that are due are sorted by register address and coalesced into burst reads:
+ *          neighbouring channels are read in one transaction when the bytes between them are
+ *          cheaper to read than the overhead of a second transaction. The scheduler also keeps
+ *          an estimate of the bus time spent on reads, reported as a utilisation over one second.
+ *
+ *          Ticks are either timed (SCHED_MODE_TIMED), derived from a millisecond time base, or
+ *          triggered (SCHED_MODE_TRIGGERED), where every BNO055 INT edge signalled via
+ *          SCHED_Trigger() starts a tick. In triggered mode the INT pin is released after the
+ *          reads, unless int_release_external is set because another module (e.g. the interrupt
+ *          event engine) owns the INT pin, and tick_rate_hz is the expected interrupt rate.
+ *
+ *          In triggered mode the edge is stamped with the DWT time in the EXTI callback, but the
+ *          reads run blocking from SCHED_Poll() in the application loop rather than from the edge.
+ *          The latency from the edge to the start of the reads is therefore bounded by the period
+ *          of the application loop, and its maximum is reported in micro-seconds. The sample time,
+ *          the midpoint of the reads, adds half their duration, about 1.5 ms for a 6-byte burst
+ *          at 115200 baud with a 2 ms turnaround. Sub-millisecond latency from the edge to the
+ *          start of the reads needs a loop period below 1 ms.
+ *
+ *          In timer mode (SCHED_MODE_TIMER), each tick is launched from the TIM1 update interrupt
+ *          via SCHED_Launch(), so the start of every frame is fixed to the timer rather than to
+ *          the application loop. The due channels are coalesced into the same spans as in the
+ *          other modes, and read in a chain of non-blocking transactions: SCHED_Launch() starts
+ *          the first, and each SCHED_Poll() that finds a span complete decodes it and starts the
+ *          next, until the last completes the frame. The scheduled and actual start of each frame
+ *          are recorded, and a tick whose transaction cannot be launched because the previous
+ *          frame has not completed is counted as an overrun.
+ *
+ *          Every frame read is stamped with the DWT time at the start and completion of its
+ *          transactions, and their midpoint is stored as the sample time. In timer mode the
+ *          completion time is when SCHED_Poll() observes the response, so it includes the delay
+ *          until the next poll (e.g. the next TIM1 update, if polled from the update callback).
+ *
+ *          Every channel read is compared with its previous read: unchanged values are flagged in
+ *          frame->duplicate_mask and counted, as they mean the channel was polled before the
+ *          BNO055 updated it. The sample times of the changes of a reference channel
+ *          (phase_channel) give an estimate of the true update period of the sensor. In timer mode
+ *          with phase_lock set, and once the estimated period matches the tick period, launches
+ *          are also phase-locked to the updates: each fresh frame advances the launch time by
+ *          phase_step_us, and each duplicate retards it by SCHED_PHASE_RETARD_US. Launches then
+ *          settle just after each update, and about phase_step_us / SCHED_PHASE_RETARD_US of the
+ *          reads are spent as duplicates to keep tracking the phase.
+ *
+ *          Channels in derive_mask (EUL, GRV and LIA) are not read from the BNO055 but derived
+ *          from the quaternion and accelerometer via ORIENT_Derive_Channels(), in the units given
+ *          by derive_units. When a derived channel is due, QUA (and ACC for LIA) is read in its
+ *          place, so a frame of all fusion outputs only reads QUA and ACC.
+ *
+ * @par     Functions include:
+ *          - SCHED_Init(): Initialises the scheduler from a declarative schedule
+ *          - SCHED_Poll(): Runs the channels due in the current tick
+ *          - SCHED_Trigger(): Signals a tick in triggered mode
+ *          - SCHED_Launch(): Launches the transaction of a tick in timer mode
+ *          - SCHED_Lock_Bus(): Reserves the bus for reads outside of the schedule
+ *          - SCHED_Unlock_Bus(): Releases the bus reserved via SCHED_Lock_Bus()
+ *          - SCHED_Get_Report(): Gets the bus utilisation and tick statistics
+ *
+ * @note    The scheduler assumes register page 0 is selected
+ * @note    The DWT cycle counter must be initialised via DWT_Init() before the first tick
+ * @note    The phase resolution is the period of the calls to SCHED_Launch() (1 ms for TIM1)
+ */
+
+
+#include "scheduler.h"
+
+
+/**************************************************************************************************/
+/*                                        Static Constants                                        */
+/**************************************************************************************************/
+
+/** @brief First data register of each channel */
+static const uint8_t SCHED_CHANNEL_REG[IMU_CHANNEL_COUNT] = {
+    BNO_ACC_DATA_X_LSB_REG,
+    BNO_MAG_DATA_X_LSB_REG,
+    BNO_GYR_DATA_X_LSB_REG,
+    BNO_LIA_DATA_X_LSB_REG,
+    BNO_GRV_DATA_X_LSB_REG,
+    BNO_EUL_HEADING_LSB_REG,
+    BNO_QUA_DATA_W_LSB_REG,
+    BNO_TEMP_REG,
+    BNO_CALIB_STAT_REG
+};
+
+/** @brief Number of data bytes of each channel */
+static const uint8_t SCHED_CHANNEL_LENGTH[IMU_CHANNEL_COUNT] = {6U, 6U, 6U, 6U, 6U, 6U, 8U, 1U, 1U};
+
+/** @brief Channels sorted by register address */
+static const IMU_Channel SCHED_REG_ORDER[IMU_CHANNEL_COUNT] = {
+    IMU_CHANNEL_ACC,
+    IMU_CHANNEL_MAG,
+    IMU_CHANNEL_GYR,
+    IMU_CHANNEL_EUL,
+    IMU_CHANNEL_QUA,
+    IMU_CHANNEL_LIA,
+    IMU_CHANNEL_GRV,
+    IMU_CHANNEL_TEMP,
+    IMU_CHANNEL_CALIB
+};
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the channels to be read in a tick
+ * @param  state:       Pointer to the scheduler state
+ * @param  tick:        Tick number
+ * @param  derive_mask: Pointer to a variable used to store the mask of the due derived channels
+ * @retval Mask of the due channels, where the derived channels are replaced by their sources
+ * @note   The channels are only marked as read by @ref SCHED_Commit_Due_Mask, so a tick whose
+ *         read cannot be started leaves them due
+ */
+static uint16_t SCHED_Get_Due_Mask(SCHED_State_t *state, uint32_t tick, uint16_t *derive_mask) {
+    uint16_t due_mask = 0U;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (state->period_ticks[i] == 0U) {
+            continue;
+        }
+        uint32_t elapsed = (tick - state->last_tick[i]);
+        if ((tick == 0UL) || (elapsed >= state->period_ticks[i])) {
+            due_mask |= (uint16_t) (1U << i);
+        }
+    }
+
+    //read the sources of the due derived channels instead of the channels themselves
+    *derive_mask = (due_mask & state->config.derive_mask);
+    if (*derive_mask != 0U) {
+        due_mask |= (uint16_t) (1U << IMU_CHANNEL_QUA);
+    }
+    if ((*derive_mask >> IMU_CHANNEL_LIA) & 1U) {
+        due_mask |= (uint16_t) (1U << IMU_CHANNEL_ACC);
+    }
+    return (due_mask & (uint16_t) ~state->config.derive_mask);
+}
+
+/**
+ * @brief  Marks the channels due in a tick as read in that tick
+ * @param  state: Pointer to the scheduler state
+ * @param  tick:  Tick number
+ * @retval None
+ * @note   Marks the same channels as @ref SCHED_Get_Due_Mask finds due in the tick, including
+ *         derived channels, but not the sources read in their place
+ */
+static void SCHED_Commit_Due_Mask(SCHED_State_t *state, uint32_t tick) {
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (state->period_ticks[i] == 0U) {
+            continue;
+        }
+        uint32_t elapsed = (tick - state->last_tick[i]);
+        if ((tick == 0UL) || (elapsed >= state->period_ticks[i])) {
+            state->last_tick[i] = tick;
+        }
+    }
+}
+
+/**
+ * @brief  Coalesces the due channels into register spans, in register order
+ * @param  state:    Pointer to the scheduler state
+ * @param  due_mask: Mask of the channels to be read
+ * @param  starts:   Pointer to an array of IMU_CHANNEL_COUNT first registers of the spans
+ * @param  ends:     Pointer to an array of IMU_CHANNEL_COUNT registers following the spans
+ * @retval Number of spans
+ * @note   Neighbouring channels share a span when at most merge_gap_bytes separate them
+ */
+static uint8_t SCHED_Get_Spans(
+    SCHED_State_t *state,
+    uint16_t      due_mask,
+    uint8_t       *starts,
+    uint8_t       *ends
+) {
+    uint8_t count = 0U;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        IMU_Channel channel = SCHED_REG_ORDER[i];
+        if (!((due_mask >> channel) & 1U)) {
+            continue;
+        }
+        uint8_t reg = SCHED_CHANNEL_REG[channel];
+        uint8_t end = (reg + SCHED_CHANNEL_LENGTH[channel]);
+        if ((count > 0U) && ((reg - ends[count - 1U]) <= state->config.merge_gap_bytes)) {
+            ends[count - 1U] = end;
+            continue;
+        }
+        starts[count] = reg;
+        ends[count]   = end;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief  Decodes the due channels contained in a register span read from the BNO055
+ * @param  state:    Pointer to the scheduler state
+ * @param  start:    First register of the span
+ * @param  end:      Register following the last register of the span
+ * @param  due_mask: Mask of the channels due in the current tick
+ * @param  data:     Pointer to the read response, including the response header
+ * @param  frame:    Pointer to the frame used to store the decoded values
+ * @retval None
+ */
+static void SCHED_Decode_Span(
+    SCHED_State_t *state,
+    uint8_t       start,
+    uint8_t       end,
+    uint16_t      due_mask,
+    const uint8_t *data,
+    IMU_Frame_t   *frame
+) {
+    uint8_t length = (end - start);
+
+    //decode every due channel within the span
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((due_mask >> i) & 1U)) {
+            continue;
+        }
+        uint8_t reg = SCHED_CHANNEL_REG[i];
+        if ((reg < start) || (reg >= end)) {
+            continue;
+        }
+        const uint8_t *src = &data[BNO_RESPONSE_HEADER_LENGTH + (reg - start)];
+        int16_t values[IMU_VALUES_MAX] = {0};
+        if (i == IMU_CHANNEL_TEMP) {
+            values[0] = (int16_t) ((int8_t) src[0]);
+        } else if (i == IMU_CHANNEL_CALIB) {
+            values[0] = (int16_t) src[0];
+        } else {
+            for (uint8_t j = 0U; j < (SCHED_CHANNEL_LENGTH[i] / 2U); j++) {
+                values[j] = (int16_t) ((src[(2U * j) + 1U] << 8U) | src[2U * j]);
+            }
+        }
+
+        //flag values identical to the previous read of the channel
+        uint8_t duplicate = ((state->seen_mask >> i) & 1U);
+        for (uint8_t j = 0U; j < IMU_VALUES_MAX; j++) {
+            if (values[j] != state->previous[i][j]) {
+                duplicate = 0U;
+            }
+            state->previous[i][j] = values[j];
+            frame->data[i][j]     = values[j];
+        }
+        state->seen_mask |= (uint16_t) (1U << i);
+        if (duplicate) {
+            state->duplicate_count[i]++;
+            frame->duplicate_mask |= (uint16_t) (1U << i);
+        } else {
+            state->fresh_count[i]++;
+        }
+        frame->updated_mask |= (uint16_t) (1U << i);
+    }
+
+    //estimate bus time: command, response header and data, plus the fixed turnaround
+    uint32_t bytes = (SCHED_CMD_BYTES + BNO_RESPONSE_HEADER_LENGTH + length);
+    state->window_transactions++;
+    state->window_bytes   += bytes;
+    state->window_busy_us += (((bytes * state->char_time_ns) / 1000UL)
+                           + state->config.transaction_latency_us);
+    state->last_transactions++;
+}
+
+/**
+ * @brief  Reads a register span and decodes the due channels it contains
+ * @param  state:    Pointer to the scheduler state
+ * @param  start:    First register of the span
+ * @param  end:      Register following the last register of the span
+ * @param  due_mask: Mask of the channels due in the current tick
+ * @param  frame:    Pointer to the frame used to store the decoded values
+ * @retval Status indicating success, invalid parameters or error
+ */
+static Status SCHED_Read_Span(
+    SCHED_State_t *state,
+    uint8_t       start,
+    uint8_t       end,
+    uint16_t      due_mask,
+    IMU_Frame_t   *frame
+) {
+    uint8_t data[BNO_RESPONSE_HEADER_LENGTH + SCHED_BURST_MAX] = {0};
+    CHECK_STATUS(BNO_Read_Reg(state->usart, start, (end - start), data));
+    SCHED_Decode_Span(state, start, end, due_mask, data, frame);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Estimates the update period of the sensor and requests the phase correction of launches
+ * @param  state: Pointer to the scheduler state
+ * @param  frame: Pointer to the frame just read, with its sample time
+ * @retval None
+ * @note   The estimate averages the interval over SCHED_PERIOD_CHANGES changes of the reference
+ *         channel, so it is only valid while the channel is polled at least as fast as the sensor
+ *         updates it (slower polling aliases to a multiple of the poll period)
+ */
+static void SCHED_Track_Updates(SCHED_State_t *state, const IMU_Frame_t *frame) {
+    IMU_Channel channel = state->config.phase_channel;
+    if (!((frame->updated_mask >> channel) & 1U)) {
+        return;
+    }
+    uint8_t duplicate = ((frame->duplicate_mask >> channel) & 1U);
+
+    //average the interval between changes of the reference channel
+    if (!duplicate) {
+        if (state->period_changes == 0U) {
+            state->period_start_us = frame->sample_us;
+        } else if (state->period_changes > SCHED_PERIOD_CHANGES) {
+            state->update_period_us = (uint32_t) ((frame->sample_us - state->period_start_us)
+                                    / SCHED_PERIOD_CHANGES);
+            state->period_start_us  = frame->sample_us;
+            state->period_changes   = 0U;
+        }
+        state->period_changes++;
+    }
+
+    //lock the phase only when the tick period matches the update period of the sensor
+    uint32_t tolerance = (state->tick_period_us / SCHED_PERIOD_TOLERANCE_DIV);
+    uint32_t error     = (state->update_period_us > state->tick_period_us)
+                       ? (state->update_period_us - state->tick_period_us)
+                       : (state->tick_period_us - state->update_period_us);
+    state->phase_locked = ((state->config.mode == SCHED_MODE_TIMER) && state->config.phase_lock
+                        && (state->update_period_us != 0UL) && (error <= tolerance));
+    if (!state->phase_locked) {
+        return;
+    }
+
+    //creep earlier while reads are fresh, back off after a read that came before the update
+    if (duplicate) {
+        state->phase_shift_us += SCHED_PHASE_RETARD_US;
+    } else {
+        state->phase_shift_us -= state->config.phase_step_us;
+    }
+}
+
+/**
+ * @brief  Ends the current tick and closes the utilisation window once per second
+ * @param  state: Pointer to the scheduler state
+ * @retval None
+ */
+static void SCHED_Close_Tick(SCHED_State_t *state) {
+    state->tick++;
+    if (++state->window_ticks >= state->config.tick_rate_hz) {
+        uint32_t window_us = (state->window_ticks * state->tick_period_ms * 1000UL);
+        uint32_t pct       = ((state->window_busy_us / 10UL) / (window_us / 1000UL));
+        state->report_transactions    = state->window_transactions;
+        state->report_bytes           = state->window_bytes;
+        state->report_busy_us         = state->window_busy_us;
+        state->report_utilisation_pct = (uint8_t) ((pct > 255UL) ? 255UL : pct);
+        state->window_ticks           = 0UL;
+        state->window_transactions    = 0UL;
+        state->window_bytes           = 0UL;
+        state->window_busy_us         = 0UL;
+    }
+}
+
+/**
+ * @brief  Completes the transactions launched via @ref SCHED_Launch and decodes their frame
+ * @param  state: Pointer to the scheduler state
+ * @param  frame: Pointer to the frame used to store the values read
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Each completed span is decoded and the next span of the tick is started, so the frame
+ *         is only stored once its last span completes. A failed read, or a frame without a
+ *         response after SCHED_TIMEOUT_TICKS ticks, is counted as a read error and the frame is
+ *         dropped
+ */
+static Status SCHED_Complete_Launch(SCHED_State_t *state, IMU_Frame_t *frame) {
+    if (!state->in_flight) {
+        return SUCCESS;
+    }
+
+    //wait for the response, aborting it once the timeout has elapsed
+    uint8_t complete    = 0U;
+    Status  read_status = BNO_Read_Reg_Poll(state->usart, state->rx_data, &complete);
+    if (read_status == INVALID_PARAM) {
+        return INVALID_PARAM;
+    }
+    if (!complete) {
+        if ((state->launch_tick - state->flight_tick) <= SCHED_TIMEOUT_TICKS) {
+            return SUCCESS;
+        }
+        CHECK_STATUS(BNO_Read_Reg_Abort(state->usart));
+        read_status = ERROR;
+    }
+
+    //decode the span, then chain the next span of the tick, if any
+    IMU_Frame_t *flight_frame = &state->flight_frame;
+    if (read_status == SUCCESS) {
+        uint8_t index = state->flight_span_index;
+        SCHED_Decode_Span(
+            state, state->flight_span_start[index], state->flight_span_end[index],
+            state->flight_due_mask, state->rx_data, flight_frame
+        );
+        if (++index < state->flight_span_count) {
+            state->flight_span_index = index;
+            uint8_t start = state->flight_span_start[index];
+            uint8_t end   = state->flight_span_end[index];
+            read_status   = BNO_Read_Reg_Start(state->usart, start, (end - start), state->rx_data);
+            if (read_status == SUCCESS) {
+                return SUCCESS;
+            }
+        }
+    }
+
+    //store the frame once its last span has been decoded
+    state->last_due_mask = state->flight_due_mask;
+    if (read_status == SUCCESS) {
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if ((flight_frame->updated_mask >> i) & 1U) {
+                memcpy(frame->data[i], flight_frame->data[i], sizeof(frame->data[i]));
+            }
+        }
+        frame->updated_mask   = flight_frame->updated_mask;
+        frame->duplicate_mask = flight_frame->duplicate_mask;
+        frame->start_us       = state->flight_start_time_us;
+        CHECK_STATUS(DWT_Get_Time_US(&frame->complete_us));
+        frame->sample_us = (frame->start_us + ((frame->complete_us - frame->start_us) / 2ULL));
+        CHECK_STATUS(
+            ORIENT_Derive_Channels(&state->config.derive_units, state->flight_derive_mask, frame)
+        );
+        SCHED_Track_Updates(state, frame);
+    } else {
+        state->read_errors++;
+    }
+    state->last_scheduled_us = state->flight_scheduled_us;
+    state->last_start_us     = state->flight_start_us;
+    state->tick              = state->flight_tick;
+    SCHED_Close_Tick(state);
+
+    //hand the receive buffer back to the launching interrupt
+    state->in_flight = 0U;
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the scheduler from a declarative schedule
+ * @param  state:  Pointer to the scheduler state
+ * @param  config: Pointer to a struct containing the channel rates and scheduler settings
+ * @param  usart:  Pointer to a struct containing the settings of the USART connected to the BNO055
+ * @retval Status indicating success or invalid parameters
+ * @note   A channel rate of 0 disables the channel. Rates are rounded to a whole number of ticks,
+ *         so channels with rates that divide the tick rate are read in the same tick and coalesced
+ * @note   If merge_gap_bytes is 0, the gap is derived from the cost of a transaction, i.e. the
+ *         number of bytes that can be transferred in the time of the command, response header and
+ *         transaction_latency_us
+ * @note   Channels in derive_mask keep their own rates, but are computed from QUA (and ACC for LIA)
+ *         rather than read, so the BNO055 must be in a fusion mode
+ */
+Status SCHED_Init(SCHED_State_t *state, SCHED_Config_t *config, USART_Config_t *usart) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    CHECK_STATUS(Validate_Ptr(usart));
+    if ((config->tick_rate_hz == 0U) || (config->tick_rate_hz > SCHED_TICK_RATE_MAX)) {
+        return INVALID_PARAM;
+    }
+    CHECK_STATUS(Validate_Enum(config->mode, SCHED_MODE_TIMED, SCHED_MODE_TIMER));
+    CHECK_STATUS(Validate_Enum(config->phase_channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+    if (config->derive_mask & ~ORIENT_DERIVABLE_MASK) {
+        return INVALID_PARAM;
+    }
+    if (usart->baud_rate == 0UL) {
+        return INVALID_PARAM;
+    }
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (config->rate_hz[i] > config->tick_rate_hz) {
+            return INVALID_PARAM;
+        }
+    }
+
+    memset(state, 0, sizeof(SCHED_State_t));
+    state->config         = *config;
+    state->usart          = usart;
+    state->tick_period_ms = (1000UL / config->tick_rate_hz);
+    state->tick_period_us = (1000000UL / config->tick_rate_hz);
+    state->char_time_ns   = ((1000000000UL / usart->baud_rate) * SCHED_BITS_PER_CHAR);
+    if (state->config.phase_step_us == 0U) {
+        state->config.phase_step_us = SCHED_PHASE_STEP_US_DEFAULT;
+    }
+
+    //convert channel rates to periods in ticks
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (config->rate_hz[i] == 0U) {
+            state->period_ticks[i] = 0U;
+        } else {
+            state->period_ticks[i] = (uint16_t) ((config->tick_rate_hz + (config->rate_hz[i] / 2U))
+                                   / config->rate_hz[i]);
+        }
+    }
+
+    //merge neighbouring channels when the gap costs less than a new transaction
+    if (state->config.merge_gap_bytes == 0U) {
+        uint32_t gap = (SCHED_CMD_BYTES + BNO_RESPONSE_HEADER_LENGTH
+                     + ((config->transaction_latency_us * 1000UL) / state->char_time_ns));
+        state->config.merge_gap_bytes = (uint8_t) ((gap > SCHED_BURST_MAX) ? SCHED_BURST_MAX : gap);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Runs the channels due in the current tick
+ * @param  state:  Pointer to the scheduler state
+ * @param  now_ms: Current time in milli-seconds (e.g. g_tim1_time)
+ * @param  frame:  Pointer to the frame used to store the values read
+ * @retval Status indicating success, invalid parameters or error
+ * @note   frame->updated_mask is 0 if no tick was due, otherwise it holds the channels read. The
+ *         values of other channels are left unchanged
+ * @note   If ticks are missed because the caller was late, they are counted and skipped rather
+ *         than run back to back
+ * @note   In triggered mode, a tick is run for each call to @ref SCHED_Trigger, and now_ms is
+ *         unused
+ * @note   In timer mode, the transaction launched via @ref SCHED_Launch is completed instead, and
+ *         now_ms is unused
+ */
+Status SCHED_Poll(SCHED_State_t *state, uint32_t now_ms, IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    frame->updated_mask   = 0U;
+    frame->duplicate_mask = 0U;
+    if (state->config.mode == SCHED_MODE_TIMER) {
+        return SCHED_Complete_Launch(state, frame);
+    }
+
+    uint32_t missed          = 0UL;
+    uint32_t trigger_time_us = 0UL;
+    if (state->config.mode == SCHED_MODE_TRIGGERED) {
+        //a tick is due for every trigger not yet handled. The time is read first, so an edge
+        //between both reads can only lengthen the measured latency
+        trigger_time_us        = state->trigger_time_us;
+        uint32_t trigger_count = state->trigger_count;
+        if (trigger_count == state->handled_count) {
+            return SUCCESS;
+        }
+        missed = (trigger_count - state->handled_count - 1UL);
+        state->handled_count = trigger_count;
+    } else {
+        if (!state->started) {
+            state->started      = 1U;
+            state->next_tick_ms = now_ms;
+        }
+        if ((int32_t) (now_ms - state->next_tick_ms) < 0) {
+            return SUCCESS;
+        }
+        missed = ((now_ms - state->next_tick_ms) / state->tick_period_ms);
+        state->next_tick_ms += ((missed + 1UL) * state->tick_period_ms);
+    }
+
+    //skip missed ticks
+    state->late_ticks += missed;
+    state->tick       += missed;
+
+    //find the channels due in this tick
+    uint16_t derive_mask = 0U;
+    uint16_t due_mask    = SCHED_Get_Due_Mask(state, state->tick, &derive_mask);
+    SCHED_Commit_Due_Mask(state, state->tick);
+    state->last_due_mask     = due_mask;
+    state->last_transactions = 0U;
+
+    //stamp the start of the first read
+    if (due_mask != 0U) {
+        CHECK_STATUS(DWT_Get_Time_US(&frame->start_us));
+    }
+
+    //record the delay between the INT edge and the start of the reads
+    if ((state->config.mode == SCHED_MODE_TRIGGERED) && (due_mask != 0U)) {
+        uint32_t latency = ((uint32_t) frame->start_us - trigger_time_us);
+        if (latency > state->trigger_latency_max_us) {
+            state->trigger_latency_max_us = latency;
+        }
+    }
+
+    //coalesce due channels into register spans, and read them in register order
+    uint8_t span_start[IMU_CHANNEL_COUNT];
+    uint8_t span_end[IMU_CHANNEL_COUNT];
+    uint8_t span_count = SCHED_Get_Spans(state, due_mask, span_start, span_end);
+    for (uint8_t i = 0U; i < span_count; i++) {
+        CHECK_STATUS(SCHED_Read_Span(state, span_start[i], span_end[i], due_mask, frame));
+    }
+
+    //stamp the completion of the last read, and use the midpoint as the sample time
+    if (due_mask != 0U) {
+        CHECK_STATUS(DWT_Get_Time_US(&frame->complete_us));
+        frame->sample_us = (frame->start_us + ((frame->complete_us - frame->start_us) / 2ULL));
+        CHECK_STATUS(ORIENT_Derive_Channels(&state->config.derive_units, derive_mask, frame));
+        SCHED_Track_Updates(state, frame);
+    }
+
+    //release the INT pin so the next event produces a new edge
+    if ((state->config.mode == SCHED_MODE_TRIGGERED) && !state->config.int_release_external) {
+        CHECK_STATUS(BNO_Clear_INT(state->usart));
+        state->window_transactions++;
+        state->window_bytes   += SCHED_CLEAR_INT_BYTES;
+        state->window_busy_us += (((SCHED_CLEAR_INT_BYTES * state->char_time_ns) / 1000UL)
+                               + state->config.transaction_latency_us);
+        state->last_transactions++;
+    }
+
+    SCHED_Close_Tick(state);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Signals a tick in triggered mode
+ * @param  state:  Pointer to the scheduler state
+ * @param  now_us: Time of the INT edge in micro-seconds, from @ref DWT_Get_Time_US
+ * @retval Status indicating success or invalid parameters
+ * @note   Intended to be called from the EXTI callback of the BNO055 INT pin. Only the trigger
+ *         counter and the low word of the time are written, each in a single access, so no
+ *         locking is needed against @ref SCHED_Poll
+ */
+Status SCHED_Trigger(SCHED_State_t *state, uint64_t now_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    state->trigger_time_us = (uint32_t) now_us;
+    state->trigger_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Launches the transaction of a tick in timer mode
+ * @param  state:  Pointer to the scheduler state
+ * @param  now_us: Current time in micro-seconds (e.g. from @ref TIM1_MS_Base_Get_US)
+ * @retval Status indicating success or invalid parameters
+ * @note   Intended to be called from the TIM1 update callback. The due channels are coalesced
+ *         into spans, and the first span is started without waiting for the response. The others
+ *         are started by @ref SCHED_Poll as each previous span completes
+ * @note   If the previous frame has not been completed via @ref SCHED_Poll, the bus is locked
+ *         via @ref SCHED_Lock_Bus, or the first read cannot be started, the tick is counted as an
+ *         overrun and its channels are read in the next tick instead
+ */
+Status SCHED_Launch(SCHED_State_t *state, uint32_t now_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+    if (state->config.mode != SCHED_MODE_TIMER) {
+        return INVALID_PARAM;
+    }
+
+    if (!state->launch_started) {
+        state->launch_started = 1U;
+        state->next_launch_us = now_us;
+    }
+
+    //apply the phase correction requested since the last launch
+    uint32_t phase_shift_us  = state->phase_shift_us;
+    state->next_launch_us   += (phase_shift_us - state->applied_shift_us);
+    state->applied_shift_us  = phase_shift_us;
+    if ((int32_t) (now_us - state->next_launch_us) < 0) {
+        return SUCCESS;
+    }
+
+    //skip missed ticks
+    uint32_t missed       = ((now_us - state->next_launch_us) / state->tick_period_us);
+    uint32_t scheduled_us = (state->next_launch_us + (missed * state->tick_period_us));
+    state->next_launch_us = (scheduled_us + state->tick_period_us);
+    state->late_ticks    += missed;
+    state->launch_tick   += missed;
+    uint32_t tick = state->launch_tick++;
+
+    //the previous frame is still being read or decoded, or the bus is reserved
+    if (state->in_flight || state->bus_locked) {
+        state->overrun_count++;
+        return SUCCESS;
+    }
+
+    //coalesce the due channels into spans, as in the other modes
+    uint16_t derive_mask = 0U;
+    uint16_t due_mask    = SCHED_Get_Due_Mask(state, tick, &derive_mask);
+    if (due_mask == 0U) {
+        return SUCCESS;
+    }
+    state->flight_span_count = SCHED_Get_Spans(
+        state, due_mask, state->flight_span_start, state->flight_span_end
+    );
+    state->flight_span_index = 0U;
+
+    //stamp and start the first span, leaving the channels due if it cannot be started
+    uint8_t  start         = state->flight_span_start[0];
+    uint8_t  end           = state->flight_span_end[0];
+    uint64_t start_time_us = 0ULL;
+    CHECK_STATUS(DWT_Get_Time_US(&start_time_us));
+    if (BNO_Read_Reg_Start(state->usart, start, (end - start), state->rx_data) != SUCCESS) {
+        state->overrun_count++;
+        return SUCCESS;
+    }
+    SCHED_Commit_Due_Mask(state, tick);
+    state->flight_frame.updated_mask   = 0U;
+    state->flight_frame.duplicate_mask = 0U;
+    state->last_transactions           = 0U;
+
+    //record the scheduled and actual start of the frame
+    uint32_t lag_us = (now_us - scheduled_us);
+    if (lag_us > state->start_lag_max_us) {
+        state->start_lag_max_us = lag_us;
+    }
+    state->flight_tick          = tick;
+    state->flight_due_mask      = due_mask;
+    state->flight_derive_mask   = derive_mask;
+    state->flight_scheduled_us  = scheduled_us;
+    state->flight_start_us      = now_us;
+    state->flight_start_time_us = start_time_us;
+    state->in_flight            = 1U;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Reserves the bus for reads outside of the schedule
+ * @param  state: Pointer to the scheduler state
+ * @retval Status indicating success, invalid parameters or error
+ * @note   In timer mode, returns ERROR if a frame is in flight, in which case the caller should
+ *         retry after the next @ref SCHED_Poll. Ticks occurring while the bus is reserved are
+ *         counted as overruns, so the bus should only be reserved when there is work to do
+ * @note   In other modes the scheduler only uses the bus from @ref SCHED_Poll, so this always
+ *         succeeds
+ */
+Status SCHED_Lock_Bus(SCHED_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+    if (state->config.mode != SCHED_MODE_TIMER) {
+        return SUCCESS;
+    }
+
+    //reserve first, so a launch between the two accesses sees the reservation
+    state->bus_locked = 1U;
+    if (state->in_flight) {
+        state->bus_locked = 0U;
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Releases the bus reserved via @ref SCHED_Lock_Bus
+ * @param  state: Pointer to the scheduler state
+ * @retval Status indicating success or invalid parameters
+ */
+Status SCHED_Unlock_Bus(SCHED_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    state->bus_locked = 0U;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the bus utilisation and tick statistics
+ * @param  state:  Pointer to the scheduler state
+ * @param  report: Pointer to a struct used to store the report
+ * @retval Status indicating success or invalid parameters
+ * @note   Transactions, bytes, bus time and utilisation cover the last complete one second window.
+ *         Utilisation above 100 % means the schedule cannot be met at the configured tick rate
+ */
+Status SCHED_Get_Report(SCHED_State_t *state, SCHED_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->tick_count             = state->tick;
+    report->late_ticks             = state->late_ticks;
+    report->transactions           = state->report_transactions;
+    report->bytes                  = state->report_bytes;
+    report->busy_us                = state->report_busy_us;
+    report->utilisation_pct        = state->report_utilisation_pct;
+    report->last_due_mask          = state->last_due_mask;
+    report->last_transactions      = state->last_transactions;
+    report->trigger_latency_max_us = state->trigger_latency_max_us;
+    report->overrun_count          = state->overrun_count;
+    report->read_errors            = state->read_errors;
+    report->last_scheduled_us      = state->last_scheduled_us;
+    report->last_start_us          = state->last_start_us;
+    report->start_lag_max_us       = state->start_lag_max_us;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        report->fresh_count[i]     = state->fresh_count[i];
+        report->duplicate_count[i] = state->duplicate_count[i];
+    }
+    report->update_period_us       = state->update_period_us;
+    report->phase_locked           = state->phase_locked;
+    report->phase_shift_us         = (int32_t) state->phase_shift_us;
+
+    return SUCCESS;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file    scheduler.h
+ * @brief   Per-Channel Acquisition Scheduler
+ * @details This header file contains the public interface for the acquisition scheduler. It
+ *          includes constants, configuration, state and report structures and function prototypes
+ *          used to read each BNO055 channel at its own rate with coalesced burst reads.
+ */
+
+
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../orient/orient.h"
+#include "../../drivers/bno055/bno.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define SCHED_BURST_MAX             (BNO_CALIB_STAT_REG + 1U - BNO_ACC_DATA_X_LSB_REG)
+#define SCHED_CMD_BYTES             4U
+#define SCHED_TICK_RATE_MAX         1000U
+#define SCHED_BITS_PER_CHAR         10U
+#define SCHED_CLEAR_INT_BYTES       7U
+#define SCHED_TIMEOUT_TICKS         2U
+#define SCHED_PHASE_STEP_US_DEFAULT 50U
+#define SCHED_PHASE_RETARD_US       1000U
+#define SCHED_PERIOD_CHANGES        16U
+#define SCHED_PERIOD_TOLERANCE_DIV  8U
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    SCHED_MODE_TIMED = 0,
+    SCHED_MODE_TRIGGERED,
+    SCHED_MODE_TIMER
+} SCHED_Mode;
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t       tick_rate_hz;
+    uint16_t       rate_hz[IMU_CHANNEL_COUNT];
+    /* Optional */
+    SCHED_Mode     mode;
+    uint32_t       transaction_latency_us;
+    uint8_t        merge_gap_bytes;
+    uint8_t        int_release_external;
+    uint8_t        phase_lock;
+    IMU_Channel    phase_channel;
+    uint16_t       phase_step_us;
+    uint16_t       derive_mask;
+    ORIENT_Units_t derive_units;
+} SCHED_Config_t;
+
+typedef struct {
+    SCHED_Config_t    config;
+    USART_Config_t    *usart;
+    uint16_t          period_ticks[IMU_CHANNEL_COUNT];
+    uint32_t          last_tick[IMU_CHANNEL_COUNT];
+    uint32_t          tick_period_ms;
+    uint32_t          char_time_ns;
+    uint32_t          tick;
+    uint32_t          next_tick_ms;
+    uint8_t           started;
+    uint32_t          late_ticks;
+    uint32_t          window_ticks;
+    uint32_t          window_transactions;
+    uint32_t          window_bytes;
+    uint32_t          window_busy_us;
+    uint16_t          last_due_mask;
+    uint8_t           last_transactions;
+    uint32_t          report_transactions;
+    uint32_t          report_bytes;
+    uint32_t          report_busy_us;
+    uint8_t           report_utilisation_pct;
+    volatile uint32_t trigger_count;
+    volatile uint32_t trigger_time_us;
+    uint32_t          handled_count;
+    uint32_t          trigger_latency_max_us;
+    uint32_t          tick_period_us;
+    volatile uint8_t  launch_started;
+    volatile uint32_t next_launch_us;
+    volatile uint32_t launch_tick;
+    volatile uint8_t  bus_locked;
+    volatile uint8_t  in_flight;
+    volatile uint32_t flight_tick;
+    volatile uint16_t flight_due_mask;
+    volatile uint16_t flight_derive_mask;
+    uint8_t           flight_span_start[IMU_CHANNEL_COUNT];
+    uint8_t           flight_span_end[IMU_CHANNEL_COUNT];
+    uint8_t           flight_span_count;
+    uint8_t           flight_span_index;
+    IMU_Frame_t       flight_frame;
+    volatile uint32_t flight_scheduled_us;
+    volatile uint32_t flight_start_us;
+    volatile uint64_t flight_start_time_us;
+    volatile uint32_t overrun_count;
+    volatile uint32_t start_lag_max_us;
+    uint32_t          read_errors;
+    uint32_t          last_scheduled_us;
+    uint32_t          last_start_us;
+    uint8_t           rx_data[BNO_RESPONSE_HEADER_LENGTH + SCHED_BURST_MAX];
+    int16_t           previous[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    uint16_t          seen_mask;
+    uint32_t          fresh_count[IMU_CHANNEL_COUNT];
+    uint32_t          duplicate_count[IMU_CHANNEL_COUNT];
+    uint64_t          period_start_us;
+    uint16_t          period_changes;
+    uint32_t          update_period_us;
+    uint8_t           phase_locked;
+    volatile uint32_t phase_shift_us;
+    uint32_t          applied_shift_us;
+} SCHED_State_t;
+
+typedef struct {
+    uint32_t tick_count;
+    uint32_t late_ticks;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t busy_us;
+    uint8_t  utilisation_pct;
+    uint16_t last_due_mask;
+    uint8_t  last_transactions;
+    uint32_t trigger_latency_max_us;
+    uint32_t overrun_count;
+    uint32_t read_errors;
+    uint32_t last_scheduled_us;
+    uint32_t last_start_us;
+    uint32_t start_lag_max_us;
+    uint32_t fresh_count[IMU_CHANNEL_COUNT];
+    uint32_t duplicate_count[IMU_CHANNEL_COUNT];
+    uint32_t update_period_us;
+    uint8_t  phase_locked;
+    int32_t  phase_shift_us;
+} SCHED_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status SCHED_Init      (SCHED_State_t *state, SCHED_Config_t *config, USART_Config_t *usart);
+Status SCHED_Poll      (SCHED_State_t *state, uint32_t now_ms, IMU_Frame_t *frame);
+Status SCHED_Trigger   (SCHED_State_t *state, uint64_t now_us);
+Status SCHED_Launch    (SCHED_State_t *state, uint32_t now_us);
+Status SCHED_Lock_Bus  (SCHED_State_t *state);
+Status SCHED_Unlock_Bus(SCHED_State_t *state);
+Status SCHED_Get_Report(SCHED_State_t *state, SCHED_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
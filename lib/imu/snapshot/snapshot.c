@@ -0,0 +1,156 @@
+/**
+ * @file    snapshot.c
+ * @brief   Latest Sample Snapshot
+ * @details This source file keeps the latest value of every channel, published by the acquisition
+ *          interrupt, so that any number of readers (e.g. a servo loop, telemetry or a health
+ *          monitor) can use the current orientation without issuing their own bus transactions.
+ *          Bus traffic is therefore independent of the number of consumers.
+ *
+ *          The snapshot is protected by a sequence counter (seqlock), so the writer never blocks.
+ *          The counter is odd while a publication is in progress: a reader copies the values
+ *          between two reads of the counter and retries if the counter was odd or has changed,
+ *          which means its copy may be torn. Each channel is stamped with the sample time of the
+ *          frame that last updated it, so readers can query its age and reject stale values.
+ *
+ * @par     Functions include:
+ *          - SNAP_Init(): Initialises an empty snapshot
+ *          - SNAP_Publish(): Publishes the channels updated by a frame
+ *          - SNAP_Read_Channel(): Gets a consistent copy of the latest values of a channel
+ *          - SNAP_Get_Age(): Gets the time elapsed since a channel was sampled
+ *
+ * @note    There must be a single writer. A reader that preempts the writer cannot see the
+ *          publication complete, so its attempts are bounded by SNAP_READ_ATTEMPTS_MAX rather than
+ *          spinning, and it gets ERROR instead of a torn copy
+ */
+
+
+#include "snapshot.h"
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises an empty snapshot
+ * @param  state: Pointer to the snapshot state
+ * @retval Status indicating success or invalid parameters
+ */
+Status SNAP_Init(SNAP_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    memset(state, 0, sizeof(SNAP_State_t));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Publishes the channels updated by a frame
+ * @param  state: Pointer to the snapshot state
+ * @param  frame: Pointer to the frame, of which only the channels in frame->updated_mask are
+ *                published
+ * @retval Status indicating success or invalid parameters
+ * @note   Intended to be called from the acquisition interrupt. Never blocks
+ */
+Status SNAP_Publish(SNAP_State_t *state, const IMU_Frame_t *frame) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    //mark the publication in progress before touching the values
+    state->sequence++;
+    DMB();
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((frame->updated_mask >> i) & 1U)) {
+            continue;
+        }
+        for (uint8_t j = 0U; j < IMU_VALUES_MAX; j++) {
+            state->data[i][j] = frame->data[i][j];
+        }
+        state->sample_us[i] = frame->sample_us;
+    }
+    state->valid_mask |= frame->updated_mask;
+
+    //mark the publication complete once the values are written
+    DMB();
+    state->sequence++;
+    state->publish_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets a consistent copy of the latest values of a channel
+ * @param  state:     Pointer to the snapshot state
+ * @param  channel:   Channel to be read
+ * @param  values:    Pointer to an array of IMU_VALUES_MAX values used to store the copy
+ * @param  sample_us: Pointer to a variable used to store the sample time of the values, or NULL
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if the channel has never been published, or if no consistent copy could
+ *         be taken within SNAP_READ_ATTEMPTS_MAX attempts (i.e. the reader preempts the writer)
+ */
+Status SNAP_Read_Channel(
+    SNAP_State_t *state,
+    IMU_Channel  channel,
+    int16_t      *values,
+    uint64_t     *sample_us
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(values));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+
+    for (uint8_t attempt = 0U; attempt < SNAP_READ_ATTEMPTS_MAX; attempt++) {
+        //skip the copy while a publication is in progress
+        uint32_t sequence = state->sequence;
+        if (sequence & 1UL) {
+            continue;
+        }
+        DMB();
+
+        uint16_t valid_mask = state->valid_mask;
+        uint64_t time_us    = state->sample_us[channel];
+        for (uint8_t j = 0U; j < IMU_VALUES_MAX; j++) {
+            values[j] = state->data[channel][j];
+        }
+
+        //the copy is consistent if no publication started in the meantime
+        DMB();
+        if (state->sequence != sequence) {
+            continue;
+        }
+        if (!((valid_mask >> channel) & 1U)) {
+            return ERROR;
+        }
+        if (sample_us != NULL) {
+            *sample_us = time_us;
+        }
+        return SUCCESS;
+    }
+
+    return ERROR;
+}
+
+/**
+ * @brief  Gets the time elapsed since a channel was sampled
+ * @param  state:   Pointer to the snapshot state
+ * @param  channel: Channel to be checked
+ * @param  age_us:  Pointer to a variable used to store the age in micro-seconds
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if the channel has never been published. A reader can treat values older
+ *         than its own bound (e.g. twice the channel period) as stale
+ */
+Status SNAP_Get_Age(SNAP_State_t *state, IMU_Channel channel, uint64_t *age_us) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(age_us));
+    CHECK_STATUS(Validate_Enum(channel, IMU_CHANNEL_ACC, IMU_CHANNEL_COUNT - 1));
+
+    int16_t  values[IMU_VALUES_MAX];
+    uint64_t sample_us = 0ULL;
+    CHECK_STATUS(SNAP_Read_Channel(state, channel, values, &sample_us));
+
+    uint64_t now_us = 0ULL;
+    CHECK_STATUS(DWT_Get_Time_US(&now_us));
+    *age_us = (now_us > sample_us) ? (now_us - sample_us) : 0ULL;
+
+    return SUCCESS;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file    snapshot.h
+ * @brief   Latest Sample Snapshot
+ * @details This header file contains the public interface for the latest sample snapshot. It
+ *          includes constants, state structures and function prototypes used to share the latest
+ *          value of every channel between the acquisition interrupt and any number of readers.
+ */
+
+
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define SNAP_READ_ATTEMPTS_MAX      4U
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    int16_t           data[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+    uint64_t          sample_us[IMU_CHANNEL_COUNT];
+    uint16_t          valid_mask;
+    volatile uint32_t sequence;
+    volatile uint32_t publish_count;
+} SNAP_State_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status SNAP_Init        (SNAP_State_t *state);
+Status SNAP_Publish     (SNAP_State_t *state, const IMU_Frame_t *frame);
+Status SNAP_Read_Channel(
+    SNAP_State_t *state,
+    IMU_Channel  channel,
+    int16_t      *values,
+    uint64_t     *sample_us
+);
+Status SNAP_Get_Age     (SNAP_State_t *state, IMU_Channel channel, uint64_t *age_us);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
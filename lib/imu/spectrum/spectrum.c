@@ -0,0 +1,397 @@
+/**
+ * @file    spectrum.c
+ * @brief   Vibration Spectrum Analyser
+ * @details This source file reduces a 3-axis channel (the accelerometer by default) to its
+ *          amplitude spectrum on the MCU, so only the spectrum or its peaks have to be sent
+ *          instead of the raw samples. Samples are collected in blocks of 128 - 1024 points per
+ *          axis, stamped with the sample time of the first and last sample, and each complete block
+ *          is processed as follows:
+ *          - The block mean (e.g. gravity) is removed and the window is applied
+ *          - The N-point real FFT is computed as an N/2-point complex FFT of the even and odd
+ *            samples, followed by a split step, which halves the work of a complex FFT
+ *          - The single-sided amplitude spectrum is computed, corrected for the window gain
+ *          - The highest local maxima are located, with parabolic interpolation between bins
+ *
+ *          The window and twiddle factors are computed once at initialisation, so the FFT only
+ *          uses single-precision multiply-adds, which the Cortex-M4 FPU executes in a single
+ *          cycle each. The cycles per block are measured with the DWT cycle counter as a
+ *          benchmark.
+ *
+ * @par     Functions include:
+ *          - SPEC_Init(): Initialises the analyser and its tables
+ *          - SPEC_Push(): Adds a frame to the block, processing the block once complete
+ *          - SPEC_Get_Magnitude(): Gets the amplitude spectrum of an axis
+ *          - SPEC_Get_Peaks(): Gets the highest peaks of an axis
+ *          - SPEC_Get_Report(): Gets the block statistics and cycles per block
+ *
+ * @note    Blocks are processed within SPEC_Push(), so it should be called from the application
+ *          loop rather than from an interrupt handler. Duplicate samples are skipped, as they would
+ *          distort the spectrum
+ */
+
+
+#include "spectrum.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Computes an in-place radix-2 complex FFT
+ * @param  state: Pointer to the analyser state, whose twiddle tables are used
+ * @param  data:  Pointer to the interleaved complex data (real, imaginary)
+ * @param  size:  Number of complex points (points / 2)
+ * @retval None
+ */
+static void SPEC_Complex_FFT(const SPEC_State_t *state, float *data, uint16_t size) {
+    //reorder the points by bit-reversed index
+    for (uint16_t i = 1U, j = 0U; i < size; i++) {
+        uint16_t bit = (size >> 1U);
+        for (; j & bit; bit >>= 1U) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float re = data[2U * i];
+            float im = data[(2U * i) + 1U];
+            data[2U * i]        = data[2U * j];
+            data[(2U * i) + 1U] = data[(2U * j) + 1U];
+            data[2U * j]        = re;
+            data[(2U * j) + 1U] = im;
+        }
+    }
+
+    //combine the butterflies, loading each twiddle factor once per stage
+    for (uint16_t length = 2U; length <= size; length <<= 1U) {
+        uint16_t half   = (length >> 1U);
+        uint16_t stride = (state->config.points / length);
+        for (uint16_t j = 0U; j < half; j++) {
+            float w_re = state->cos_table[j * stride];
+            float w_im = -state->sin_table[j * stride];
+            for (uint16_t a = j; a < size; a += length) {
+                uint16_t b    = (a + half);
+                float    t_re = ((data[2U * b] * w_re) - (data[(2U * b) + 1U] * w_im));
+                float    t_im = ((data[2U * b] * w_im) + (data[(2U * b) + 1U] * w_re));
+                data[2U * b]        = (data[2U * a] - t_re);
+                data[(2U * b) + 1U] = (data[(2U * a) + 1U] - t_im);
+                data[2U * a]        += t_re;
+                data[(2U * a) + 1U] += t_im;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Computes the amplitude spectrum of an axis from the complex FFT of its packed samples
+ * @param  state: Pointer to the analyser state
+ * @param  axis:  Index of the axis
+ * @retval None
+ * @note   Splits the N/2-point FFT Z of the packed samples into the N-point FFT X of the real
+ *         samples, X[k] = E[k] + W^k O[k], where E and O are the FFTs of the even and odd samples
+ */
+static void SPEC_Amplitude(SPEC_State_t *state, uint8_t axis) {
+    const float *z         = state->samples[axis];
+    float       *magnitude = state->magnitude[axis];
+    uint16_t    size       = (state->config.points / 2U);
+    float       scale      = state->amplitude_scale;
+
+    //the DC and Nyquist bins are real, and are not doubled in the single-sided spectrum
+    magnitude[0]    = (fabsf(z[0] + z[1]) * scale * 0.5f);
+    magnitude[size] = (fabsf(z[0] - z[1]) * scale * 0.5f);
+
+    for (uint16_t k = 1U; k < size; k++) {
+        float a = z[2U * k];
+        float b = z[(2U * k) + 1U];
+        float c = z[2U * (size - k)];
+        float d = z[(2U * (size - k)) + 1U];
+
+        float e_re = (0.5f * (a + c));
+        float e_im = (0.5f * (b - d));
+        float o_re = (0.5f * (b + d));
+        float o_im = (-0.5f * (a - c));
+
+        float w_re = state->cos_table[k];
+        float w_im = -state->sin_table[k];
+        float x_re = (e_re + ((w_re * o_re) - (w_im * o_im)));
+        float x_im = (e_im + ((w_re * o_im) + (w_im * o_re)));
+        magnitude[k] = (sqrtf((x_re * x_re) + (x_im * x_im)) * scale);
+    }
+}
+
+/**
+ * @brief  Locates the highest local maxima of the amplitude spectrum of an axis
+ * @param  state: Pointer to the analyser state
+ * @param  axis:  Index of the axis
+ * @retval None
+ * @note   The DC and Nyquist bins are excluded. Peaks are sorted by descending amplitude, and their
+ *         frequency and amplitude are refined by fitting a parabola through the three bins
+ */
+static void SPEC_Find_Peaks(SPEC_State_t *state, uint8_t axis) {
+    const float *magnitude = state->magnitude[axis];
+    SPEC_Peak_t *peaks     = state->peaks[axis];
+    uint16_t    size       = (state->config.points / 2U);
+    float       bin_hz     = (state->sample_rate_hz / (float) state->config.points);
+    uint8_t     found      = 0U;
+
+    for (uint16_t k = 1U; k < size; k++) {
+        float left   = magnitude[k - 1U];
+        float centre = magnitude[k];
+        float right  = magnitude[k + 1U];
+        if ((centre <= left) || (centre < right) || (centre <= 0.0f)) {
+            continue;
+        }
+
+        //interpolate the peak between the bins
+        float curvature = (left - (2.0f * centre) + right);
+        float delta     = (curvature < 0.0f) ? ((0.5f * (left - right)) / curvature) : 0.0f;
+        SPEC_Peak_t peak = {
+            .frequency_hz = (((float) k + delta) * bin_hz),
+            .amplitude    = (centre - (0.25f * (left - right) * delta))
+        };
+
+        //insert the peak in order, dropping the lowest once the list is full
+        uint8_t index = found;
+        if (found < state->config.peak_count) {
+            found++;
+        } else if (peak.amplitude <= peaks[found - 1U].amplitude) {
+            continue;
+        } else {
+            index = (found - 1U);
+        }
+        while ((index > 0U) && (peaks[index - 1U].amplitude < peak.amplitude)) {
+            peaks[index] = peaks[index - 1U];
+            index--;
+        }
+        peaks[index] = peak;
+    }
+    state->peaks_found[axis] = found;
+}
+
+/**
+ * @brief  Processes a complete block
+ * @param  state: Pointer to the analyser state
+ * @retval Status indicating success or error
+ */
+static Status SPEC_Process(SPEC_State_t *state) {
+    uint32_t start_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&start_cycles));
+
+    uint16_t points   = state->config.points;
+    uint64_t span_us  = (state->end_us - state->start_us);
+    state->sample_rate_hz = (span_us == 0ULL)
+                          ? 0.0f : (((float) (points - 1U) * 1.0e6f) / (float) span_us);
+
+    for (uint8_t axis = 0U; axis < SPEC_AXES; axis++) {
+        float *samples = state->samples[axis];
+
+        //remove the mean, then apply the window
+        float mean = 0.0f;
+        for (uint16_t n = 0U; n < points; n++) {
+            mean += samples[n];
+        }
+        mean /= (float) points;
+        for (uint16_t n = 0U; n < points; n++) {
+            samples[n] = ((samples[n] - mean) * state->window[n]);
+        }
+
+        //pack the even and odd samples as the real and imaginary parts of N/2 complex points
+        SPEC_Complex_FFT(state, samples, (points / 2U));
+        SPEC_Amplitude(state, axis);
+        SPEC_Find_Peaks(state, axis);
+    }
+    state->block_count++;
+
+    uint32_t end_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&end_cycles));
+    state->cycles_last   = (end_cycles - start_cycles);
+    state->cycles_total += state->cycles_last;
+    if (state->cycles_last > state->cycles_max) {
+        state->cycles_max = state->cycles_last;
+    }
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the analyser and its tables
+ * @param  state:  Pointer to the analyser state
+ * @param  config: Pointer to a struct containing the analyser settings
+ * @retval Status indicating success or invalid parameters
+ * @note   points must be a power of two between SPEC_POINTS_MIN and SPEC_POINTS_MAX, and channel
+ *         a 3-axis channel. A peak_count of 0 selects SPEC_PEAKS_DEFAULT
+ */
+Status SPEC_Init(SPEC_State_t *state, SPEC_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    CHECK_STATUS(Validate_Enum(config->channel, IMU_CHANNEL_ACC, IMU_CHANNEL_EUL));
+    CHECK_STATUS(Validate_Enum(config->window, SPEC_WINDOW_HANN, SPEC_WINDOW_RECTANGULAR));
+    if ((config->points < SPEC_POINTS_MIN) || (config->points > SPEC_POINTS_MAX)
+    ||  (config->points & (config->points - 1U)) || (config->peak_count > SPEC_PEAKS_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(SPEC_State_t));
+    state->config = *config;
+    if (state->config.peak_count == 0U) {
+        state->config.peak_count = SPEC_PEAKS_DEFAULT;
+    }
+
+    //compute the window, and its gain so amplitudes are those of the input sinusoids
+    uint16_t points     = state->config.points;
+    float    window_sum = 0.0f;
+    for (uint16_t n = 0U; n < points; n++) {
+        float phase = ((2.0f * SPEC_PI * (float) n) / (float) (points - 1U));
+        switch (state->config.window) {
+            case SPEC_WINDOW_HANN:        state->window[n] = (0.5f - (0.5f * cosf(phase))); break;
+            case SPEC_WINDOW_HAMMING:     state->window[n] = (0.54f - (0.46f * cosf(phase))); break;
+            case SPEC_WINDOW_RECTANGULAR: state->window[n] = 1.0f; break;
+            default: return INVALID_PARAM;
+        }
+        window_sum += state->window[n];
+    }
+    state->amplitude_scale = (2.0f / window_sum);
+
+    //compute the twiddle factors of the N-point transform
+    for (uint16_t k = 0U; k < (points / 2U); k++) {
+        float phase = ((2.0f * SPEC_PI * (float) k) / (float) points);
+        state->cos_table[k] = cosf(phase);
+        state->sin_table[k] = sinf(phase);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds a frame to the block, processing the block once complete
+ * @param  state: Pointer to the analyser state
+ * @param  frame: Pointer to the frame, of which the configured channel is used if it is set in
+ *                frame->updated_mask
+ * @param  ready: Pointer to a variable set to 1 if a block was processed, or 0 otherwise
+ * @retval Status indicating success, invalid parameters or error
+ * @note   The spectrum and peaks of a processed block remain valid until the next block is
+ *         processed
+ */
+Status SPEC_Push(SPEC_State_t *state, const IMU_Frame_t *frame, uint8_t *ready) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(ready));
+
+    *ready = 0U;
+    IMU_Channel channel = state->config.channel;
+    if (!((frame->updated_mask >> channel) & 1U)) {
+        return SUCCESS;
+    }
+    if ((frame->duplicate_mask >> channel) & 1U) {
+        state->duplicate_count++;
+        return SUCCESS;
+    }
+
+    //append the sample, stamping the block with its first and last sample times
+    for (uint8_t axis = 0U; axis < SPEC_AXES; axis++) {
+        state->samples[axis][state->count] = (float) frame->data[channel][axis];
+    }
+    if (state->count == 0U) {
+        state->start_us = frame->sample_us;
+    }
+    state->end_us = frame->sample_us;
+    state->count++;
+
+    if (state->count == state->config.points) {
+        state->count = 0U;
+        CHECK_STATUS(SPEC_Process(state));
+        *ready = 1U;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the amplitude spectrum of an axis
+ * @param  state:     Pointer to the analyser state
+ * @param  axis:      Index of the axis (0 - 2)
+ * @param  magnitude: Pointer to a variable used to store a pointer to the amplitudes, in the raw
+ *                    units of the channel, of bins 0 to points / 2
+ * @param  bins:      Pointer to a variable used to store the number of bins
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Bin k is at k * sample_rate_hz / points. Returns ERROR if no block has been processed
+ */
+Status SPEC_Get_Magnitude(
+    SPEC_State_t *state,
+    uint8_t      axis,
+    const float  **magnitude,
+    uint16_t     *bins
+) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(magnitude));
+    CHECK_STATUS(Validate_Ptr(bins));
+    if (axis >= SPEC_AXES) {
+        return INVALID_PARAM;
+    }
+    if (state->block_count == 0UL) {
+        return ERROR;
+    }
+
+    *magnitude = state->magnitude[axis];
+    *bins      = ((state->config.points / 2U) + 1U);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the highest peaks of an axis
+ * @param  state: Pointer to the analyser state
+ * @param  axis:  Index of the axis (0 - 2)
+ * @param  peaks: Pointer to an array of at least peak_count peaks used to store the peaks, by
+ *                descending amplitude
+ * @param  count: Pointer to a variable used to store the number of peaks found
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Returns ERROR if no block has been processed
+ */
+Status SPEC_Get_Peaks(SPEC_State_t *state, uint8_t axis, SPEC_Peak_t *peaks, uint8_t *count) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(peaks));
+    CHECK_STATUS(Validate_Ptr(count));
+    if (axis >= SPEC_AXES) {
+        return INVALID_PARAM;
+    }
+    if (state->block_count == 0UL) {
+        return ERROR;
+    }
+
+    *count = state->peaks_found[axis];
+    for (uint8_t i = 0U; i < *count; i++) {
+        peaks[i] = state->peaks[axis][i];
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the block statistics and cycles per block
+ * @param  state:  Pointer to the analyser state
+ * @param  report: Pointer to a struct used to store the statistics
+ * @retval Status indicating success or invalid parameters
+ * @note   The sample rate is measured from the sample times of the latest block, and the cycles
+ *         cover the window, FFT, amplitude and peak search of all three axes
+ */
+Status SPEC_Get_Report(SPEC_State_t *state, SPEC_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    report->block_count     = state->block_count;
+    report->duplicate_count = state->duplicate_count;
+    report->sample_rate_hz  = state->sample_rate_hz;
+    report->resolution_hz   = (state->sample_rate_hz / (float) state->config.points);
+    report->cycles_last     = state->cycles_last;
+    report->cycles_max      = state->cycles_max;
+    report->cycles_mean     = (state->block_count == 0UL)
+                            ? 0UL : (uint32_t) (state->cycles_total / state->block_count);
+
+    return SUCCESS;
+}
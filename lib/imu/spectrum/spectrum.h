@@ -0,0 +1,118 @@
+/**
+ * @file    spectrum.h
+ * @brief   Vibration Spectrum Analyser
+ * @details This header file contains the public interface for the vibration spectrum analyser. It
+ *          includes constants, enumerations, configuration, state and report structures and
+ *          function prototypes used to reduce blocks of 3-axis samples to spectra and peaks.
+ */
+
+
+#ifndef __SPECTRUM_H
+#define __SPECTRUM_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define SPEC_AXES                   3U
+#define SPEC_POINTS_MIN             128U
+#define SPEC_POINTS_MAX             1024U
+#define SPEC_BINS_MAX               ((SPEC_POINTS_MAX / 2U) + 1U)
+#define SPEC_PEAKS_MAX              8U
+#define SPEC_PEAKS_DEFAULT          4U
+#define SPEC_PI                     (3.14159265f)
+
+
+/**************************************************************************************************/
+/*                                          Enumerations                                          */
+/**************************************************************************************************/
+
+typedef enum {
+    SPEC_WINDOW_HANN = 0,
+    SPEC_WINDOW_HAMMING,
+    SPEC_WINDOW_RECTANGULAR
+} SPEC_Window;
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t    points;
+    /* Optional */
+    IMU_Channel channel;
+    SPEC_Window window;
+    uint8_t     peak_count;
+} SPEC_Config_t;
+
+typedef struct {
+    float frequency_hz;
+    float amplitude;
+} SPEC_Peak_t;
+
+typedef struct {
+    SPEC_Config_t config;
+    float         samples[SPEC_AXES][SPEC_POINTS_MAX];
+    float         magnitude[SPEC_AXES][SPEC_BINS_MAX];
+    float         window[SPEC_POINTS_MAX];
+    float         cos_table[SPEC_POINTS_MAX / 2U];
+    float         sin_table[SPEC_POINTS_MAX / 2U];
+    float         amplitude_scale;
+    uint16_t      count;
+    uint64_t      start_us;
+    uint64_t      end_us;
+    float         sample_rate_hz;
+    SPEC_Peak_t   peaks[SPEC_AXES][SPEC_PEAKS_MAX];
+    uint8_t       peaks_found[SPEC_AXES];
+    uint32_t      block_count;
+    uint32_t      duplicate_count;
+    uint32_t      cycles_last;
+    uint32_t      cycles_max;
+    uint64_t      cycles_total;
+} SPEC_State_t;
+
+typedef struct {
+    uint32_t block_count;
+    uint32_t duplicate_count;
+    float    sample_rate_hz;
+    float    resolution_hz;
+    uint32_t cycles_last;
+    uint32_t cycles_max;
+    uint32_t cycles_mean;
+} SPEC_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status SPEC_Init         (SPEC_State_t *state, SPEC_Config_t *config);
+Status SPEC_Push         (SPEC_State_t *state, const IMU_Frame_t *frame, uint8_t *ready);
+Status SPEC_Get_Magnitude(
+    SPEC_State_t *state,
+    uint8_t      axis,
+    const float  **magnitude,
+    uint16_t     *bins
+);
+Status SPEC_Get_Peaks    (SPEC_State_t *state, uint8_t axis, SPEC_Peak_t *peaks, uint8_t *count);
+Status SPEC_Get_Report   (SPEC_State_t *state, SPEC_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
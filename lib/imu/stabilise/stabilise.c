@@ -0,0 +1,324 @@
+/**
+ * @file    stabilise.c
+ * @brief   Servo Stabilisation
+ * @details This source file closes the loop from the orientation to up to STAB_AXES_MAX servos on
+ *          TIM1 channels. Each servo frame (1/servo_rate_hz), a per-axis PID controller drives an
+ *          Euler angle to its setpoint, and its output is converted to a servo pulse width.
+ *
+ *          The servo outputs share the milli-second time base of TIM1 (see TIM1_MS_Base_PWM_Init),
+ *          so acquisition keeps its tick. The servo pulse, which is longer than a time base period,
+ *          is synthesised one period at a time: on every update event, STAB_Update() writes the
+ *          compare value of the next period, which the preload latches at the next update event.
+ *          Every compare value therefore takes effect on a PWM period boundary, and the pulse
+ *          starts on the update event that begins the servo frame, independent of the interrupt
+ *          latency and of the time taken by the controller.
+ *
+ *          Because the actuation time is known when the controller runs, the orientation is
+ *          requested from the predictor (see predict.h) at the actuation time rather than at the
+ *          time of computation. Every cycle measures the sensor-to-actuator latency, i.e. the age
+ *          of the latest fused sample when the pulse starts, and the lead from computation to
+ *          actuation.
+ *
+ * @par     Functions include:
+ *          - STAB_Init(): Initialises the servo outputs and controllers
+ *          - STAB_Update(): Runs the stabilisation loop on a TIM1 update event
+ *          - STAB_Set_Setpoint(): Sets the angle an axis is held at
+ *          - STAB_Get_Report(): Gets the latency and controller statistics
+ *
+ * @note    STAB_Update() must be called from every TIM1 update event, e.g. from the TIM1 update
+ *          callback. If no orientation is available, the outputs hold their previous pulse width
+ */
+
+
+#include "stabilise.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Wraps an angle into the range -180 to 180 degrees
+ * @param  degrees: Angle in degrees
+ * @retval The wrapped angle
+ */
+static float STAB_Wrap(float degrees) {
+    while (degrees > 180.0f) {
+        degrees -= 360.0f;
+    }
+    while (degrees < -180.0f) {
+        degrees += 360.0f;
+    }
+    return degrees;
+}
+
+/**
+ * @brief  Runs the controllers for the servo frame starting at the next update event
+ * @param  state: Pointer to the stabilisation state
+ * @retval Status indicating success or error
+ * @note   Must be called from the TIM1 update interrupt, so the current period began at the update
+ *         event of g_tim1_time
+ */
+static Status STAB_Control(STAB_State_t *state) {
+    uint32_t start_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&start_cycles));
+
+    //find the time of the next update event, at which the new pulse starts
+    uint32_t base_us = 0UL;
+    uint64_t now_us  = 0ULL;
+    CHECK_STATUS(TIM1_MS_Base_Get_US(&base_us));
+    CHECK_STATUS(DWT_Get_Time_US(&now_us));
+    uint32_t elapsed_us = (base_us - (g_tim1_time * TIM1_MS_BASE_PERIOD_US));
+    if (elapsed_us > TIM1_MS_BASE_PERIOD_US) {
+        elapsed_us = TIM1_MS_BASE_PERIOD_US;
+    }
+    uint32_t lead_us      = (TIM1_MS_BASE_PERIOD_US - elapsed_us);
+    uint64_t actuation_us = (now_us + lead_us);
+
+    //hold the outputs until the predictor has an orientation
+    float q[4];
+    if (PRED_Get_Quaternion(state->pred_state, actuation_us, q) != SUCCESS) {
+        state->hold_count++;
+        return SUCCESS;
+    }
+    uint32_t latency_us = state->pred_state->age_last_us;
+
+    float          hrp[3];
+    ORIENT_Units_t units = {
+        .eul_unit = BNO_UNIT_EUL_DEGREES,
+        .ori_unit = state->config.ori_unit
+    };
+    CHECK_STATUS(ORIENT_Get_Euler(q, &units, hrp));
+
+    //run the controller of each axis over the servo frame
+    float dt = ((float) (state->frame_ticks * TIM1_MS_BASE_PERIOD_US) * 1.0e-6f);
+    for (uint8_t i = 0U; i < state->config.axis_count; i++) {
+        STAB_Axis_Config_t *axis = &state->config.axis[i];
+
+        float angle = hrp[axis->angle];
+        float error = STAB_Wrap(state->setpoint[i] - angle);
+        float rate  = state->primed ? (STAB_Wrap(angle - state->previous[i]) / dt) : 0.0f;
+        state->previous[i] = angle;
+        state->angle[i]    = angle;
+
+        //bound the integral, so saturation does not wind it up
+        state->integral[i] += (axis->ki * error * dt);
+        if (state->integral[i] > axis->integral_limit) {
+            state->integral[i] = axis->integral_limit;
+        } else if (state->integral[i] < -axis->integral_limit) {
+            state->integral[i] = -axis->integral_limit;
+        }
+
+        //differentiate the measurement rather than the error, so setpoint steps do not kick
+        float output = ((axis->kp * error) + state->integral[i] - (axis->kd * rate));
+        if (output > axis->output_limit) {
+            output = axis->output_limit;
+            state->saturation_count++;
+        } else if (output < -axis->output_limit) {
+            output = -axis->output_limit;
+            state->saturation_count++;
+        }
+        state->pulse_us[i] = (uint16_t) roundf((float) axis->neutral_us
+                                               + (output * axis->us_per_degree));
+    }
+    state->primed = 1U;
+
+    //record the latency of this cycle
+    state->cycle_count++;
+    state->latency_last_us   = latency_us;
+    state->latency_total_us += latency_us;
+    if (latency_us < state->latency_min_us) {
+        state->latency_min_us = latency_us;
+    }
+    if (latency_us > state->latency_max_us) {
+        state->latency_max_us = latency_us;
+    }
+    if ((state->config.latency_budget_us != 0UL)
+    &&  (latency_us > state->config.latency_budget_us)) {
+        state->over_budget_count++;
+    }
+    state->lead_last_us = lead_us;
+
+    uint32_t end_cycles = 0UL;
+    CHECK_STATUS(DWT_Get_Cycles(&end_cycles));
+    state->cycles_last = (end_cycles - start_cycles);
+    if (state->cycles_last > state->cycles_max) {
+        state->cycles_max = state->cycles_last;
+    }
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the servo outputs and controllers
+ * @param  state:      Pointer to the stabilisation state
+ * @param  config:     Pointer to a struct containing the stabilisation settings
+ * @param  pred_state: Pointer to the predictor serving the orientation
+ * @retval Status indicating success or invalid parameters
+ * @note   Assumes TIM1 has been configured as a time base unit via @ref TIM1_MS_Base_Init, and the
+ *         GPIO of each channel configured in its TIM1 alternate function
+ * @note   A servo_rate_hz of 0 selects STAB_SERVO_RATE_HZ_DEFAULT. For each axis, a neutral_us,
+ *         us_per_degree or output_limit of 0 selects the FS5109M defaults, and an integral_limit
+ *         of 0 selects the output limit. Gains of 0 hold the servo at its neutral position
+ * @note   Returns INVALID_PARAM if the pulse range does not fit within the servo frame
+ */
+Status STAB_Init(STAB_State_t *state, STAB_Config_t *config, PRED_State_t *pred_state) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    CHECK_STATUS(Validate_Ptr(pred_state));
+    if ((config->axis_count == 0U) || (config->axis_count > STAB_AXES_MAX)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(STAB_State_t));
+    state->config     = *config;
+    state->pred_state = pred_state;
+    if (state->config.servo_rate_hz == 0U) {
+        state->config.servo_rate_hz = STAB_SERVO_RATE_HZ_DEFAULT;
+    }
+    uint32_t base_rate_hz = (SEC_TO_USEC / TIM1_MS_BASE_PERIOD_US);
+    if (state->config.servo_rate_hz > base_rate_hz) {
+        return INVALID_PARAM;
+    }
+    state->frame_ticks    = (uint16_t) (base_rate_hz / state->config.servo_rate_hz);
+    state->latency_min_us = UINT32_MAX;
+
+    uint32_t frame_us = (state->frame_ticks * TIM1_MS_BASE_PERIOD_US);
+    for (uint8_t i = 0U; i < state->config.axis_count; i++) {
+        STAB_Axis_Config_t *axis = &state->config.axis[i];
+        CHECK_STATUS(TIM1_Validate_Channel(axis->channel));
+        CHECK_STATUS(Validate_Enum(axis->angle, BNO_EUL_HEADING, BNO_EUL_PITCH));
+        if ((axis->output_limit < 0.0f) || (axis->integral_limit < 0.0f)
+        ||  (axis->us_per_degree < 0.0f)) {
+            return INVALID_PARAM;
+        }
+
+        if (axis->neutral_us == 0U) {
+            axis->neutral_us = STAB_NEUTRAL_US_DEFAULT;
+        }
+        if (axis->us_per_degree == 0.0f) {
+            axis->us_per_degree = STAB_US_PER_DEGREE_DEFAULT;
+        }
+        if (axis->output_limit == 0.0f) {
+            axis->output_limit = STAB_OUTPUT_LIMIT_DEFAULT;
+        }
+        if (axis->integral_limit == 0.0f) {
+            axis->integral_limit = axis->output_limit;
+        }
+
+        //the pulse must end within the servo frame
+        float swing_us = (axis->output_limit * axis->us_per_degree);
+        if ((swing_us > (float) axis->neutral_us)
+        ||  (((float) axis->neutral_us + swing_us) >= (float) frame_us)) {
+            return INVALID_PARAM;
+        }
+
+        state->setpoint[i] = axis->setpoint;
+        state->pulse_us[i] = axis->neutral_us;
+    }
+
+    //configure the outputs once every axis is valid
+    for (uint8_t i = 0U; i < state->config.axis_count; i++) {
+        CHECK_STATUS(TIM1_MS_Base_PWM_Init(state->config.axis[i].channel));
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Runs the stabilisation loop on a TIM1 update event
+ * @param  state: Pointer to the stabilisation state
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Must be called from every TIM1 update interrupt. On the period before each servo frame,
+ *         the controllers are run for the orientation predicted at the start of the frame. On
+ *         every period, the compare values of the next period are written, and are latched by
+ *         the preload at the next update event
+ */
+Status STAB_Update(STAB_State_t *state) {
+    CHECK_STATUS(Validate_Ptr(state));
+
+    if (state->next_phase == 0U) {
+        CHECK_STATUS(STAB_Control(state));
+    }
+
+    //write the part of each pulse that falls within the next period
+    uint32_t offset_us = (state->next_phase * TIM1_MS_BASE_PERIOD_US);
+    for (uint8_t i = 0U; i < state->config.axis_count; i++) {
+        uint32_t compare = 0UL;
+        if (state->pulse_us[i] > offset_us) {
+            compare = (state->pulse_us[i] - offset_us);
+            if (compare > TIM1_MS_BASE_PERIOD_US) {
+                compare = TIM1_MS_BASE_PERIOD_US;
+            }
+        }
+        CHECK_STATUS(TIM1_Set_Compare(state->config.axis[i].channel, (uint16_t) compare));
+    }
+
+    state->next_phase++;
+    if (state->next_phase == state->frame_ticks) {
+        state->next_phase = 0U;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Sets the angle an axis is held at
+ * @param  state:    Pointer to the stabilisation state
+ * @param  axis:     Index of the axis in the configuration
+ * @param  setpoint: Euler angle in degrees
+ * @retval Status indicating success or invalid parameters
+ * @note   Takes effect from the next servo frame
+ */
+Status STAB_Set_Setpoint(STAB_State_t *state, uint8_t axis, float setpoint) {
+    CHECK_STATUS(Validate_Ptr(state));
+    if (axis >= state->config.axis_count) {
+        return INVALID_PARAM;
+    }
+
+    state->setpoint[axis] = setpoint;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the latency and controller statistics
+ * @param  state:  Pointer to the stabilisation state
+ * @param  report: Pointer to a struct used to store the statistics
+ * @retval Status indicating success or invalid parameters
+ * @note   The latency is the age of the latest fused sample at the start of the pulse, and the
+ *         lead is the time from computation to the start of the pulse. Both are measured every
+ *         cycle. The statistics are copied with interrupts masked, as the loop updates them from
+ *         the TIM1 update interrupt
+ */
+Status STAB_Get_Report(STAB_State_t *state, STAB_Report_t *report) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(report));
+
+    uint32_t primask = GET_PRIMASK();
+    DISABLE_IRQ();
+    report->cycle_count       = state->cycle_count;
+    report->hold_count        = state->hold_count;
+    report->saturation_count  = state->saturation_count;
+    report->over_budget_count = state->over_budget_count;
+    report->latency_last_us   = state->latency_last_us;
+    report->latency_min_us    = (state->cycle_count == 0UL) ? 0UL : state->latency_min_us;
+    report->latency_max_us    = state->latency_max_us;
+    report->latency_mean_us   = (state->cycle_count == 0UL)
+                              ? 0UL : (uint32_t) (state->latency_total_us / state->cycle_count);
+    report->lead_last_us      = state->lead_last_us;
+    report->cycles_last       = state->cycles_last;
+    report->cycles_max        = state->cycles_max;
+    for (uint8_t i = 0U; i < STAB_AXES_MAX; i++) {
+        report->angle[i]    = state->angle[i];
+        report->pulse_us[i] = state->pulse_us[i];
+    }
+    SET_PRIMASK(primask);
+
+    return SUCCESS;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file    stabilise.h
+ * @brief   Servo Stabilisation
+ * @details This header file contains the public interface for the servo stabilisation loop. It
+ *          includes constants, configuration, state and report structures and function prototypes
+ *          used to drive TIM1 servo outputs from the predicted orientation with a fixed latency.
+ */
+
+
+#ifndef __STABILISE_H
+#define __STABILISE_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../predict/predict.h"
+#include "../orient/orient.h"
+#include "../../drivers/tim1/tim1.h"
+#include "../../drivers/dwt/dwt.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define STAB_AXES_MAX               3U
+#define STAB_SERVO_RATE_HZ_DEFAULT  50U
+#define STAB_NEUTRAL_US_DEFAULT     1500U
+#define STAB_US_PER_DEGREE_DEFAULT  (2000.0f / 180.0f)
+#define STAB_OUTPUT_LIMIT_DEFAULT   (90.0f)
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    TIM1_Channel  channel;
+    BNO_EUL_Angle angle;
+    /* Optional */
+    float         setpoint;
+    float         kp;
+    float         ki;
+    float         kd;
+    float         integral_limit;
+    float         output_limit;
+    float         us_per_degree;
+    uint16_t      neutral_us;
+} STAB_Axis_Config_t;
+
+typedef struct {
+    /* Required */
+    STAB_Axis_Config_t axis[STAB_AXES_MAX];
+    uint8_t            axis_count;
+    /* Optional */
+    uint16_t           servo_rate_hz;
+    BNO_Unit           ori_unit;
+    uint32_t           latency_budget_us;
+} STAB_Config_t;
+
+typedef struct {
+    STAB_Config_t     config;
+    PRED_State_t      *pred_state;
+    uint16_t          frame_ticks;
+    uint16_t          next_phase;
+    volatile float    setpoint[STAB_AXES_MAX];
+    float             integral[STAB_AXES_MAX];
+    float             previous[STAB_AXES_MAX];
+    float             angle[STAB_AXES_MAX];
+    uint16_t          pulse_us[STAB_AXES_MAX];
+    uint8_t           primed;
+    volatile uint32_t cycle_count;
+    volatile uint32_t hold_count;
+    volatile uint32_t saturation_count;
+    volatile uint32_t over_budget_count;
+    volatile uint32_t latency_last_us;
+    volatile uint32_t latency_min_us;
+    volatile uint32_t latency_max_us;
+    uint64_t          latency_total_us;
+    volatile uint32_t lead_last_us;
+    volatile uint32_t cycles_last;
+    volatile uint32_t cycles_max;
+} STAB_State_t;
+
+typedef struct {
+    uint32_t cycle_count;
+    uint32_t hold_count;
+    uint32_t saturation_count;
+    uint32_t over_budget_count;
+    uint32_t latency_last_us;
+    uint32_t latency_min_us;
+    uint32_t latency_max_us;
+    uint32_t latency_mean_us;
+    uint32_t lead_last_us;
+    uint32_t cycles_last;
+    uint32_t cycles_max;
+    float    angle[STAB_AXES_MAX];
+    uint16_t pulse_us[STAB_AXES_MAX];
+} STAB_Report_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status STAB_Init        (STAB_State_t *state, STAB_Config_t *config, PRED_State_t *pred_state);
+Status STAB_Update      (STAB_State_t *state);
+Status STAB_Set_Setpoint(STAB_State_t *state, uint8_t axis, float setpoint);
+Status STAB_Get_Report  (STAB_State_t *state, STAB_Report_t *report);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
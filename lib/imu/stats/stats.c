@@ -0,0 +1,307 @@
+/**
+ * @file    stats.c
+ * @brief   Windowed Channel Statistics
+ * @details This source file summarises up to STATS_CHANNELS_MAX channels over a sliding window of
+ *          window_us, so consumers can receive per-window summaries instead of the raw samples
+ *          while every sample is still used on the MCU. For each value of each channel:
+ *          - The mean and variance are updated with Welford's algorithm, which adds the newest
+ *            sample and removes the samples leaving the window in constant time
+ *          - The minimum and maximum are kept at the front of monotonic deques of sample indices,
+ *            which each sample enters and leaves once, so they cost constant amortised time
+ *          - The RMS is derived from the mean and variance, so it needs no separate sum
+ *
+ *          A summary of every channel is latched on each window boundary, i.e. every hop_us at
+ *          multiples of hop_us of the sample time, so with a hop_us of 1 s, summaries cover whole
+ *          seconds. A hop_us smaller than window_us gives overlapping windows.
+ *
+ * @par     Functions include:
+ *          - STATS_Init(): Initialises the statistics of the configured channels
+ *          - STATS_Push(): Adds a frame, latching the summaries on window boundaries
+ *          - STATS_Get_Summary(): Gets the latest summary of a channel
+ *
+ * @note    Values are in the raw units of the channels. Duplicate samples are skipped, and at most
+ *          STATS_SAMPLES_MAX samples are held per channel, beyond which the oldest samples leave
+ *          the window early and are counted as overflows
+ */
+
+
+#include "stats.h"
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the number of values of a channel
+ * @param  channel: Channel
+ * @retval Number of values
+ */
+static uint8_t STATS_Values(IMU_Channel channel) {
+    switch (channel) {
+        case IMU_CHANNEL_QUA:   return 4U;
+        case IMU_CHANNEL_TEMP:  return 1U;
+        case IMU_CHANNEL_CALIB: return 1U;
+        default:                return 3U;
+    }
+}
+
+/**
+ * @brief  Removes the oldest sample of a channel from its window
+ * @param  channel: Pointer to the channel statistics
+ * @retval None
+ */
+static void STATS_Remove(STATS_Channel_t *channel) {
+    uint16_t index = channel->head;
+    float    count = (float) channel->count;
+
+    for (uint8_t i = 0U; i < channel->values; i++) {
+        STATS_Axis_t *axis = &channel->axis[i];
+        float        x     = (float) channel->data[index][i];
+
+        //reverse the Welford update of the sample
+        if (channel->count <= 1U) {
+            axis->mean = 0.0f;
+            axis->m2   = 0.0f;
+        } else {
+            float mean = (axis->mean - ((x - axis->mean) / (count - 1.0f)));
+            axis->m2  -= ((x - axis->mean) * (x - mean));
+            axis->mean = mean;
+            if (axis->m2 < 0.0f) {
+                axis->m2 = 0.0f;
+            }
+        }
+
+        //the sample can only be at the front of the deques, being the oldest
+        if ((axis->min_count > 0U) && (axis->min_index[axis->min_head] == index)) {
+            axis->min_head = ((axis->min_head + 1U) % STATS_SAMPLES_MAX);
+            axis->min_count--;
+        }
+        if ((axis->max_count > 0U) && (axis->max_index[axis->max_head] == index)) {
+            axis->max_head = ((axis->max_head + 1U) % STATS_SAMPLES_MAX);
+            axis->max_count--;
+        }
+    }
+
+    channel->head = ((channel->head + 1U) % STATS_SAMPLES_MAX);
+    channel->count--;
+}
+
+/**
+ * @brief  Removes the samples of a channel at or before a time from its window
+ * @param  channel: Pointer to the channel statistics
+ * @param  time_us: Samples stamped at or before this time are removed
+ * @retval None
+ */
+static void STATS_Expire(STATS_Channel_t *channel, uint64_t time_us) {
+    while ((channel->count > 0U) && (channel->time_us[channel->head] <= time_us)) {
+        STATS_Remove(channel);
+    }
+}
+
+/**
+ * @brief  Adds a sample of a channel to its window
+ * @param  channel: Pointer to the channel statistics
+ * @param  frame:   Pointer to the frame containing the sample
+ * @retval None
+ * @note   The window must not be full
+ */
+static void STATS_Add(STATS_Channel_t *channel, const IMU_Frame_t *frame) {
+    uint16_t index = ((channel->head + channel->count) % STATS_SAMPLES_MAX);
+    channel->time_us[index] = frame->sample_us;
+    channel->count++;
+    float count = (float) channel->count;
+
+    for (uint8_t i = 0U; i < channel->values; i++) {
+        STATS_Axis_t *axis = &channel->axis[i];
+        int16_t      value = frame->data[channel->channel][i];
+        float        x     = (float) value;
+        channel->data[index][i] = value;
+
+        float delta = (x - axis->mean);
+        axis->mean += (delta / count);
+        axis->m2   += (delta * (x - axis->mean));
+
+        //drop the samples the new one dominates, so the fronts stay the window extremes
+        while ((axis->min_count > 0U)
+        &&     (channel->data[axis->min_index[(axis->min_head + axis->min_count - 1U)
+                                              % STATS_SAMPLES_MAX]][i] >= value)) {
+            axis->min_count--;
+        }
+        axis->min_index[(axis->min_head + axis->min_count) % STATS_SAMPLES_MAX] = index;
+        axis->min_count++;
+
+        while ((axis->max_count > 0U)
+        &&     (channel->data[axis->max_index[(axis->max_head + axis->max_count - 1U)
+                                              % STATS_SAMPLES_MAX]][i] <= value)) {
+            axis->max_count--;
+        }
+        axis->max_index[(axis->max_head + axis->max_count) % STATS_SAMPLES_MAX] = index;
+        axis->max_count++;
+    }
+}
+
+/**
+ * @brief  Summarises the window of a channel, then resynchronises its running moments
+ * @param  channel: Pointer to the channel statistics
+ * @param  end_us:  End time of the window
+ * @param  summary: Pointer to the summary to be written
+ * @retval None
+ * @note   The moments are recomputed from the held samples after each summary, so the rounding
+ *         of the removals cannot accumulate. This costs one pass per hop, i.e. constant amortised
+ *         time per sample while the hop is comparable to the window
+ */
+static void STATS_Summarise(STATS_Channel_t *channel, uint64_t end_us, STATS_Summary_t *summary) {
+    summary->channel = channel->channel;
+    summary->values  = channel->values;
+    summary->count   = channel->count;
+    summary->end_us  = end_us;
+
+    float count = (float) channel->count;
+    for (uint8_t i = 0U; i < channel->values; i++) {
+        STATS_Axis_t *axis = &channel->axis[i];
+        if (channel->count == 0U) {
+            summary->min[i]      = 0.0f;
+            summary->max[i]      = 0.0f;
+            summary->mean[i]     = 0.0f;
+            summary->rms[i]      = 0.0f;
+            summary->variance[i] = 0.0f;
+            continue;
+        }
+
+        summary->min[i]      = (float) channel->data[axis->min_index[axis->min_head]][i];
+        summary->max[i]      = (float) channel->data[axis->max_index[axis->max_head]][i];
+        summary->mean[i]     = axis->mean;
+        summary->rms[i]      = sqrtf((axis->mean * axis->mean) + (axis->m2 / count));
+        summary->variance[i] = (channel->count < 2U) ? 0.0f : (axis->m2 / (count - 1.0f));
+
+        axis->mean = 0.0f;
+        axis->m2   = 0.0f;
+        for (uint16_t n = 0U; n < channel->count; n++) {
+            float x     = (float) channel->data[(channel->head + n) % STATS_SAMPLES_MAX][i];
+            float delta = (x - axis->mean);
+            axis->mean += (delta / (float) (n + 1U));
+            axis->m2   += (delta * (x - axis->mean));
+        }
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                         Core Functions                                         */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises the statistics of the configured channels
+ * @param  state:  Pointer to the statistics state
+ * @param  config: Pointer to a struct containing the statistics settings
+ * @retval Status indicating success or invalid parameters
+ * @note   At most STATS_CHANNELS_MAX channels may be set in channel_mask, and the summaries are
+ *         indexed in channel order. A hop_us of 0 selects window_us, i.e. consecutive windows
+ */
+Status STATS_Init(STATS_State_t *state, STATS_Config_t *config) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(config));
+    if ((config->channel_mask == 0U) || (config->channel_mask >> IMU_CHANNEL_COUNT)
+    ||  (config->window_us == 0UL) || (config->hop_us > config->window_us)) {
+        return INVALID_PARAM;
+    }
+
+    memset(state, 0, sizeof(STATS_State_t));
+    state->config = *config;
+    if (state->config.hop_us == 0UL) {
+        state->config.hop_us = state->config.window_us;
+    }
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((config->channel_mask >> i) & 1U)) {
+            continue;
+        }
+        if (state->channel_count == STATS_CHANNELS_MAX) {
+            return INVALID_PARAM;
+        }
+        STATS_Channel_t *channel = &state->channels[state->channel_count++];
+        channel->channel = (IMU_Channel) i;
+        channel->values  = STATS_Values((IMU_Channel) i);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds a frame, latching the summaries on window boundaries
+ * @param  state: Pointer to the statistics state
+ * @param  frame: Pointer to the frame, of which the configured channels in frame->updated_mask
+ *                are used
+ * @param  ready: Pointer to a variable set to 1 if new summaries were latched, or 0 otherwise
+ * @retval Status indicating success or invalid parameters
+ * @note   A boundary is closed by the first frame sampled at or after it, before its samples are
+ *         added, so each summary covers the window_us up to the boundary. If several boundaries
+ *         passed without a frame, only the latest is summarised
+ */
+Status STATS_Push(STATS_State_t *state, const IMU_Frame_t *frame, uint8_t *ready) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(ready));
+
+    //close the window ending at the latest boundary reached
+    *ready = 0U;
+    uint64_t hop_us = state->config.hop_us;
+    if (frame->sample_us >= state->next_boundary_us) {
+        uint64_t boundary_us = ((frame->sample_us / hop_us) * hop_us);
+        if (state->next_boundary_us != 0ULL) {
+            for (uint8_t i = 0U; i < state->channel_count; i++) {
+                STATS_Channel_t *channel = &state->channels[i];
+                if (boundary_us > state->config.window_us) {
+                    STATS_Expire(channel, (boundary_us - state->config.window_us));
+                }
+                STATS_Summarise(channel, boundary_us, &state->summary[i]);
+            }
+            state->summary_count++;
+            *ready = 1U;
+        }
+        state->next_boundary_us = (boundary_us + hop_us);
+    }
+
+    //slide the window of each updated channel to the new sample
+    for (uint8_t i = 0U; i < state->channel_count; i++) {
+        STATS_Channel_t *channel = &state->channels[i];
+        if (!((frame->updated_mask >> channel->channel) & 1U)
+        ||  ((frame->duplicate_mask >> channel->channel) & 1U)) {
+            continue;
+        }
+        if (frame->sample_us > state->config.window_us) {
+            STATS_Expire(channel, (frame->sample_us - state->config.window_us));
+        }
+        if (channel->count == STATS_SAMPLES_MAX) {
+            STATS_Remove(channel);
+            channel->overflow_count++;
+        }
+        STATS_Add(channel, frame);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the latest summary of a channel
+ * @param  state:   Pointer to the statistics state
+ * @param  index:   Index of the channel among the channels set in channel_mask, in channel order
+ * @param  summary: Pointer to a struct used to store the summary
+ * @retval Status indicating success, invalid parameters or error
+ * @note   The variance is the sample variance. Returns ERROR if no boundary has been reached
+ */
+Status STATS_Get_Summary(STATS_State_t *state, uint8_t index, STATS_Summary_t *summary) {
+    CHECK_STATUS(Validate_Ptr(state));
+    CHECK_STATUS(Validate_Ptr(summary));
+    if (index >= state->channel_count) {
+        return INVALID_PARAM;
+    }
+    if (state->summary_count == 0UL) {
+        return ERROR;
+    }
+
+    *summary = state->summary[index];
+
+    return SUCCESS;
+}
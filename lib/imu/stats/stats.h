@@ -0,0 +1,100 @@
+/**
+ * @file    stats.h
+ * @brief   Windowed Channel Statistics
+ * @details This header file contains the public interface for the windowed statistics stage. It
+ *          includes constants, configuration, state and summary structures and function prototypes
+ *          used to summarise channels over sliding time windows in constant time per sample.
+ */
+
+
+#ifndef __STATS_H
+#define __STATS_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "../frame/frame.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define STATS_CHANNELS_MAX          4U
+#define STATS_SAMPLES_MAX           128U
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    /* Required */
+    uint16_t channel_mask;
+    uint32_t window_us;
+    /* Optional */
+    uint32_t hop_us;
+} STATS_Config_t;
+
+typedef struct {
+    float    mean;
+    float    m2;
+    uint16_t min_index[STATS_SAMPLES_MAX];
+    uint16_t max_index[STATS_SAMPLES_MAX];
+    uint16_t min_head;
+    uint16_t min_count;
+    uint16_t max_head;
+    uint16_t max_count;
+} STATS_Axis_t;
+
+typedef struct {
+    IMU_Channel  channel;
+    uint8_t      values;
+    int16_t      data[STATS_SAMPLES_MAX][IMU_VALUES_MAX];
+    uint64_t     time_us[STATS_SAMPLES_MAX];
+    uint16_t     head;
+    uint16_t     count;
+    STATS_Axis_t axis[IMU_VALUES_MAX];
+    uint32_t     overflow_count;
+} STATS_Channel_t;
+
+typedef struct {
+    IMU_Channel channel;
+    uint8_t     values;
+    uint16_t    count;
+    uint64_t    end_us;
+    float       min[IMU_VALUES_MAX];
+    float       max[IMU_VALUES_MAX];
+    float       mean[IMU_VALUES_MAX];
+    float       rms[IMU_VALUES_MAX];
+    float       variance[IMU_VALUES_MAX];
+} STATS_Summary_t;
+
+typedef struct {
+    STATS_Config_t  config;
+    STATS_Channel_t channels[STATS_CHANNELS_MAX];
+    uint8_t         channel_count;
+    uint64_t        next_boundary_us;
+    STATS_Summary_t summary[STATS_CHANNELS_MAX];
+    uint32_t        summary_count;
+} STATS_State_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+Status STATS_Init       (STATS_State_t *state, STATS_Config_t *config);
+Status STATS_Push       (STATS_State_t *state, const IMU_Frame_t *frame, uint8_t *ready);
+Status STATS_Get_Summary(STATS_State_t *state, uint8_t index, STATS_Summary_t *summary);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
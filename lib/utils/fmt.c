@@ -0,0 +1,513 @@
+/**
+ * @file    fmt.c
+ * @brief   Fixed-Precision Number Formatting Functions
+ * @details This source file provides float-to-ASCII and integer-to-ASCII conversion, along with a
+ *          small frame builder that appends formatted values directly into a caller supplied
+ *          buffer (e.g. the USART TX buffer). No intermediate strings are created and the newlib
+ *          printf family is not used, so float printf support does not need to be linked.
+ *
+ * @par     Functions include:
+ *          - FMT_Float(): Converts a float to a right-justified fixed-precision string
+ *          - FMT_Int(): Converts a signed integer to a right-justified string
+ *          - FMT_Uint(): Converts an unsigned integer to a right-justified string
+ *          - FMT_Frame_Init(): Initialises a frame builder over a buffer
+ *          - FMT_Frame_Append_Str(): Appends a string to a frame
+ *          - FMT_Frame_Append_Float(): Appends a fixed-precision float to a frame
+ *          - FMT_Frame_Append_Int(): Appends a signed integer to a frame
+ *          - FMT_Frame_Append_Uint(): Appends an unsigned integer to a frame
+ *          - FMT_Frame_Append_Floats(): Appends an array of floats joined by a separator
+ *          - FMT_Frame_Append_Base64(): Appends binary data as base64 text
+ *
+ * @note    FMT_Float() produces the same output as "%<width>.<precision>f". The fraction is
+ *          extracted from the float's mantissa with integer arithmetic, so rounding is exact and
+ *          ties are rounded to even, matching newlib's printf.
+ */
+
+
+#include "fmt.h"
+
+
+/**************************************************************************************************/
+/*                                        Static Constants                                        */
+/**************************************************************************************************/
+
+/** @brief Powers of ten used to scale the fractional part of a float */
+static const uint32_t FMT_POW10[FMT_FLOAT_PRECISION_MAX + 1U] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL
+};
+
+/** @brief Base64 alphabet (RFC 4648) */
+static const char FMT_BASE64[64] = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
+
+
+/**************************************************************************************************/
+/*                                      Core Helper Functions                                     */
+/**************************************************************************************************/
+
+/**
+ * @brief  Writes reversed digits into a buffer, right-justified within a field width
+ * @param  dst:        Pointer to the destination buffer
+ * @param  space:      Number of bytes available in the destination buffer
+ * @param  rev_digits: Pointer to the characters to be written, stored in reverse order
+ * @param  count:      Number of characters in rev_digits
+ * @param  width:      Minimum field width. Shorter values are padded with leading spaces
+ * @param  length:     Pointer to a variable used to store the number of bytes written
+ * @retval Status indicating success or error
+ * @note   The output is not null terminated
+ */
+static Status FMT_Emit(
+    char       *dst,
+    uint16_t   space,
+    const char *rev_digits,
+    uint8_t    count,
+    uint8_t    width,
+    uint16_t   *length
+) {
+    uint16_t total = (count < width) ? width : count;
+    if (total > space) {
+        return ERROR;
+    }
+
+    //pad with leading spaces, then copy the digits in the correct order
+    uint16_t index = 0U;
+    while ((index + count) < total) {
+        dst[index++] = ' ';
+    }
+    while (count > 0U) {
+        dst[index++] = rev_digits[--count];
+    }
+
+    *length = total;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Stores the decimal digits of an unsigned value in reverse order
+ * @param  rev_digits: Pointer to the array used to store the digits
+ * @param  value:      Value to be converted
+ * @param  min_digits: Minimum number of digits. Shorter values are padded with zeros
+ * @retval Number of digits stored
+ */
+static uint8_t FMT_Reverse_Digits(char *rev_digits, uint64_t value, uint8_t min_digits) {
+    uint8_t count = 0U;
+
+    //use 32-bit division where possible, since 64-bit division is a library call on the M4
+    while (value > 0xFFFFFFFFULL) {
+        rev_digits[count++] = (char) ('0' + (value % 10ULL));
+        value /= 10ULL;
+    }
+    uint32_t value_32 = (uint32_t) value;
+    do {
+        rev_digits[count++] = (char) ('0' + (value_32 % 10UL));
+        value_32 /= 10UL;
+    } while (value_32 > 0UL);
+
+    while (count < min_digits) {
+        rev_digits[count++] = '0';
+    }
+
+    return count;
+}
+
+/**
+ * @brief  Converts a float to fixed-precision ASCII without null termination
+ * @param  dst:       Pointer to the destination buffer
+ * @param  space:     Number of bytes available in the destination buffer
+ * @param  value:     Float to be converted
+ * @param  width:     Minimum field width
+ * @param  precision: Number of digits after the decimal point
+ * @param  length:    Pointer to a variable used to store the number of bytes written
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Magnitudes of 2^63 and above are not supported. The digits of the largest magnitude at
+ *         FMT_FLOAT_PRECISION_MAX, with the sign and point, fit FMT_NUMBER_LENGTH_MAX - 1 bytes
+ */
+static Status FMT_Write_Float(
+    char     *dst,
+    uint16_t space,
+    float    value,
+    uint8_t  width,
+    uint8_t  precision,
+    uint16_t *length
+) {
+    if (precision > FMT_FLOAT_PRECISION_MAX) {
+        return INVALID_PARAM;
+    }
+
+    //split the float into its fields
+    uint32_t bits = 0UL;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t  negative = (uint8_t) (bits >> 31U);
+    uint32_t exponent = ((bits >> 23U) & SET_EIGHT);
+    uint32_t mantissa = (bits & 0x7FFFFFUL);
+
+    char    rev_digits[FMT_NUMBER_LENGTH_MAX];
+    uint8_t count = 0U;
+
+    //handle infinity and NaN
+    if (exponent == SET_EIGHT) {
+        const char *text = (mantissa) ? "nan" : "inf";
+        rev_digits[count++] = text[2];
+        rev_digits[count++] = text[1];
+        rev_digits[count++] = text[0];
+        if (negative) {
+            rev_digits[count++] = '-';
+        }
+        return FMT_Emit(dst, space, rev_digits, count, width, length);
+    }
+
+    //value = mantissa * 2^(-shift)
+    int32_t shift = 0;
+    if (exponent == 0UL) {
+        shift = 149;
+    } else {
+        mantissa |= 0x800000UL;
+        shift = (150 - ((int32_t) exponent));
+    }
+
+    //extract integer part and rounded fraction using exact integer arithmetic
+    uint64_t int_part  = 0ULL;
+    uint32_t frac_part = 0UL;
+    if (shift <= 0) {
+        if (shift < -39) {
+            return ERROR;
+        }
+        int_part = (((uint64_t) mantissa) << ((uint32_t) -shift));
+    } else if (shift < 64) {
+        uint64_t mask      = ((1ULL << shift) - 1ULL);
+        uint64_t half      = (1ULL << (shift - 1));
+        uint64_t scaled    = ((((uint64_t) mantissa) & mask) * FMT_POW10[precision]);
+        uint64_t remainder = (scaled & mask);
+        int_part  = (((uint64_t) mantissa) >> shift);
+        frac_part = (uint32_t) (scaled >> shift);
+
+        //round to nearest, ties to even
+        uint32_t last_digit = (precision == 0U) ? ((uint32_t) int_part) : frac_part;
+        if ((remainder > half) || ((remainder == half) && (last_digit & 1UL))) {
+            frac_part++;
+        }
+        if (frac_part >= FMT_POW10[precision]) {
+            frac_part -= FMT_POW10[precision];
+            int_part++;
+        }
+    }
+
+    //compose the digits in reverse order
+    if (precision > 0U) {
+        count = FMT_Reverse_Digits(rev_digits, frac_part, precision);
+        rev_digits[count++] = '.';
+    }
+    count += FMT_Reverse_Digits(&rev_digits[count], int_part, 1U);
+    if (negative) {
+        rev_digits[count++] = '-';
+    }
+
+    return FMT_Emit(dst, space, rev_digits, count, width, length);
+}
+
+/**
+ * @brief  Converts a signed integer to ASCII without null termination
+ * @param  dst:    Pointer to the destination buffer
+ * @param  space:  Number of bytes available in the destination buffer
+ * @param  value:  Integer to be converted
+ * @param  width:  Minimum field width
+ * @param  length: Pointer to a variable used to store the number of bytes written
+ * @retval Status indicating success or error
+ */
+static Status FMT_Write_Int(
+    char     *dst,
+    uint16_t space,
+    int32_t  value,
+    uint8_t  width,
+    uint16_t *length
+) {
+    char     rev_digits[FMT_NUMBER_LENGTH_MAX];
+    uint32_t magnitude = (value < 0) ? (0UL - ((uint32_t) value)) : ((uint32_t) value);
+
+    uint8_t count = FMT_Reverse_Digits(rev_digits, magnitude, 1U);
+    if (value < 0) {
+        rev_digits[count++] = '-';
+    }
+
+    return FMT_Emit(dst, space, rev_digits, count, width, length);
+}
+
+
+/**************************************************************************************************/
+/*                                   Number Conversion Functions                                  */
+/**************************************************************************************************/
+
+/**
+ * @brief  Converts a float to a right-justified fixed-precision string
+ * @param  buffer:    Pointer to the array used to store the null terminated string
+ * @param  size:      Size of buffer in bytes
+ * @param  value:     Float to be converted
+ * @param  width:     Minimum field width
+ * @param  precision: Number of digits after the decimal point (0 - FMT_FLOAT_PRECISION_MAX)
+ * @param  length:    Pointer to a variable used to store the string length (excluding \0)
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Equivalent to snprintf(buffer, size, "%*.*f", width, precision, value)
+ */
+Status FMT_Float(
+    char     *buffer,
+    uint16_t size,
+    float    value,
+    uint8_t  width,
+    uint8_t  precision,
+    uint16_t *length
+) {
+    CHECK_STATUS(Validate_Ptr(buffer));
+    CHECK_STATUS(Validate_Ptr(length));
+    if (size == 0U) {
+        return INVALID_PARAM;
+    }
+
+    CHECK_STATUS(FMT_Write_Float(buffer, size - 1U, value, width, precision, length));
+    buffer[*length] = '\0';
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Converts a signed integer to a right-justified string
+ * @param  buffer: Pointer to the array used to store the null terminated string
+ * @param  size:   Size of buffer in bytes
+ * @param  value:  Integer to be converted
+ * @param  width:  Minimum field width
+ * @param  length: Pointer to a variable used to store the string length (excluding \0)
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Equivalent to snprintf(buffer, size, "%*i", width, value)
+ */
+Status FMT_Int(char *buffer, uint16_t size, int32_t value, uint8_t width, uint16_t *length) {
+    CHECK_STATUS(Validate_Ptr(buffer));
+    CHECK_STATUS(Validate_Ptr(length));
+    if (size == 0U) {
+        return INVALID_PARAM;
+    }
+
+    CHECK_STATUS(FMT_Write_Int(buffer, size - 1U, value, width, length));
+    buffer[*length] = '\0';
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Converts an unsigned integer to a right-justified string
+ * @param  buffer: Pointer to the array used to store the null terminated string
+ * @param  size:   Size of buffer in bytes
+ * @param  value:  Integer to be converted
+ * @param  width:  Minimum field width
+ * @param  length: Pointer to a variable used to store the string length (excluding \0)
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Equivalent to snprintf(buffer, size, "%*u", width, value)
+ */
+Status FMT_Uint(char *buffer, uint16_t size, uint32_t value, uint8_t width, uint16_t *length) {
+    CHECK_STATUS(Validate_Ptr(buffer));
+    CHECK_STATUS(Validate_Ptr(length));
+    if (size == 0U) {
+        return INVALID_PARAM;
+    }
+
+    char    rev_digits[FMT_NUMBER_LENGTH_MAX];
+    uint8_t count = FMT_Reverse_Digits(rev_digits, value, 1U);
+    CHECK_STATUS(FMT_Emit(buffer, size - 1U, rev_digits, count, width, length));
+    buffer[*length] = '\0';
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************************************/
+/*                                     Frame Builder Functions                                    */
+/**************************************************************************************************/
+
+/**
+ * @brief  Initialises a frame builder over a buffer
+ * @param  frame:    Pointer to the frame builder
+ * @param  buffer:   Pointer to the buffer that formatted output is written to
+ * @param  capacity: Size of buffer in bytes
+ * @retval Status indicating success or invalid parameters
+ * @note   Frames are not null terminated. frame->length holds the number of bytes written
+ */
+Status FMT_Frame_Init(FMT_Frame_t *frame, uint8_t *buffer, uint16_t capacity) {
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(buffer));
+    if (capacity == 0U) {
+        return INVALID_PARAM;
+    }
+
+    frame->buffer   = buffer;
+    frame->capacity = capacity;
+    frame->length   = 0U;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends a string to a frame
+ * @param  frame: Pointer to the frame builder
+ * @param  str:   Null terminated string to be appended
+ * @retval Status indicating success, invalid parameters or error
+ * @note   If the string does not fit, the frame is left unchanged and ERROR is returned
+ */
+Status FMT_Frame_Append_Str(FMT_Frame_t *frame, const char *str) {
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(str));
+
+    size_t str_length = strlen(str);
+    if (str_length > (size_t) (frame->capacity - frame->length)) {
+        return ERROR;
+    }
+
+    memcpy(&frame->buffer[frame->length], str, str_length);
+    frame->length += (uint16_t) str_length;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends a fixed-precision float to a frame
+ * @param  frame:     Pointer to the frame builder
+ * @param  value:     Float to be appended
+ * @param  width:     Minimum field width
+ * @param  precision: Number of digits after the decimal point (0 - FMT_FLOAT_PRECISION_MAX)
+ * @retval Status indicating success, invalid parameters or error
+ */
+Status FMT_Frame_Append_Float(FMT_Frame_t *frame, float value, uint8_t width, uint8_t precision) {
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    uint16_t written = 0U;
+    CHECK_STATUS(FMT_Write_Float(
+        (char *) &frame->buffer[frame->length],
+        frame->capacity - frame->length,
+        value,
+        width,
+        precision,
+        &written
+    ));
+    frame->length += written;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends a signed integer to a frame
+ * @param  frame: Pointer to the frame builder
+ * @param  value: Integer to be appended
+ * @param  width: Minimum field width
+ * @retval Status indicating success, invalid parameters or error
+ */
+Status FMT_Frame_Append_Int(FMT_Frame_t *frame, int32_t value, uint8_t width) {
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    uint16_t written = 0U;
+    CHECK_STATUS(FMT_Write_Int(
+        (char *) &frame->buffer[frame->length],
+        frame->capacity - frame->length,
+        value,
+        width,
+        &written
+    ));
+    frame->length += written;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends an unsigned integer to a frame
+ * @param  frame: Pointer to the frame builder
+ * @param  value: Integer to be appended
+ * @param  width: Minimum field width
+ * @retval Status indicating success, invalid parameters or error
+ */
+Status FMT_Frame_Append_Uint(FMT_Frame_t *frame, uint64_t value, uint8_t width) {
+    CHECK_STATUS(Validate_Ptr(frame));
+
+    char    rev_digits[FMT_NUMBER_LENGTH_MAX];
+    uint8_t count   = FMT_Reverse_Digits(rev_digits, value, 1U);
+    uint16_t written = 0U;
+    CHECK_STATUS(FMT_Emit(
+        (char *) &frame->buffer[frame->length],
+        frame->capacity - frame->length,
+        rev_digits,
+        count,
+        width,
+        &written
+    ));
+    frame->length += written;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends an array of fixed-precision floats joined by a separator
+ * @param  frame:     Pointer to the frame builder
+ * @param  values:    Pointer to the floats to be appended
+ * @param  count:     Number of floats to be appended
+ * @param  separator: Null terminated string placed between consecutive values
+ * @param  width:     Minimum field width of each value
+ * @param  precision: Number of digits after the decimal point (0 - FMT_FLOAT_PRECISION_MAX)
+ * @retval Status indicating success, invalid parameters or error
+ */
+Status FMT_Frame_Append_Floats(
+    FMT_Frame_t *frame,
+    const float *values,
+    uint8_t     count,
+    const char  *separator,
+    uint8_t     width,
+    uint8_t     precision
+) {
+    CHECK_STATUS(Validate_Ptr(values));
+    CHECK_STATUS(Validate_Ptr(separator));
+
+    for (uint8_t i = 0U; i < count; i++) {
+        if (i > 0U) {
+            CHECK_STATUS(FMT_Frame_Append_Str(frame, separator));
+        }
+        CHECK_STATUS(FMT_Frame_Append_Float(frame, values[i], width, precision));
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends binary data as base64 text
+ * @param  frame:  Pointer to the frame builder
+ * @param  data:   Pointer to the data to be appended
+ * @param  length: Number of bytes to be appended
+ * @retval Status indicating success, invalid parameters or error
+ * @note   Appends 4 characters per 3 bytes, padded with '=' (RFC 4648). Nothing is appended if
+ *         the frame cannot hold the whole text
+ */
+Status FMT_Frame_Append_Base64(FMT_Frame_t *frame, const uint8_t *data, uint16_t length) {
+    CHECK_STATUS(Validate_Ptr(frame));
+    CHECK_STATUS(Validate_Ptr(data));
+
+    uint32_t text_length = ((((uint32_t) length + 2UL) / 3UL) * 4UL);
+    if (text_length > (uint32_t) (frame->capacity - frame->length)) {
+        return ERROR;
+    }
+
+    uint8_t *text = &frame->buffer[frame->length];
+    for (uint16_t i = 0U; i < length; i += 3U) {
+        uint16_t remaining = (length - i);
+        uint32_t bits      = ((uint32_t) data[i] << 16);
+        if (remaining > 1U) {
+            bits |= ((uint32_t) data[i + 1U] << 8);
+        }
+        if (remaining > 2U) {
+            bits |= data[i + 2U];
+        }
+        *text++ = (uint8_t) FMT_BASE64[(bits >> 18) & 0x3FU];
+        *text++ = (uint8_t) FMT_BASE64[(bits >> 12) & 0x3FU];
+        *text++ = (remaining > 1U) ? (uint8_t) FMT_BASE64[(bits >> 6) & 0x3FU] : (uint8_t) '=';
+        *text++ = (remaining > 2U) ? (uint8_t) FMT_BASE64[bits & 0x3FU] : (uint8_t) '=';
+    }
+    frame->length += (uint16_t) text_length;
+
+    return SUCCESS;
+}
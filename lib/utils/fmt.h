@@ -0,0 +1,80 @@
+/**
+ * @file    fmt.h
+ * @brief   Fixed-Precision Number Formatting Functions
+ * @details This header file contains the public interface for the number formatting module. It
+ *          includes constants, the frame builder structure and function prototypes used to convert
+ *          floats and integers to ASCII without the newlib printf family.
+ */
+
+
+#ifndef __FMT_H
+#define __FMT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+#include "utils.h"
+
+
+/**************************************************************************************************/
+/*                                         Constant Macros                                        */
+/**************************************************************************************************/
+
+#define FMT_FLOAT_PRECISION_MAX     6U
+#define FMT_INTEGER_DIGITS_MAX      20U
+#define FMT_NUMBER_LENGTH_MAX       (FMT_INTEGER_DIGITS_MAX + FMT_FLOAT_PRECISION_MAX + 3U)
+
+
+/**************************************************************************************************/
+/*                                           Structures                                           */
+/**************************************************************************************************/
+
+typedef struct {
+    uint8_t  *buffer;
+    uint16_t capacity;
+    uint16_t length;
+} FMT_Frame_t;
+
+
+/**************************************************************************************************/
+/*                                       Function Prototypes                                      */
+/**************************************************************************************************/
+
+/************************************* Number Conversion Functions ********************************/
+Status FMT_Float(
+    char     *buffer,
+    uint16_t size,
+    float    value,
+    uint8_t  width,
+    uint8_t  precision,
+    uint16_t *length
+);
+Status FMT_Int  (char *buffer, uint16_t size, int32_t value, uint8_t width, uint16_t *length);
+Status FMT_Uint (char *buffer, uint16_t size, uint32_t value, uint8_t width, uint16_t *length);
+
+/*************************************** Frame Builder Functions **********************************/
+Status FMT_Frame_Init        (FMT_Frame_t *frame, uint8_t *buffer, uint16_t capacity);
+Status FMT_Frame_Append_Str  (FMT_Frame_t *frame, const char *str);
+Status FMT_Frame_Append_Float(FMT_Frame_t *frame, float value, uint8_t width, uint8_t precision);
+Status FMT_Frame_Append_Int  (FMT_Frame_t *frame, int32_t value, uint8_t width);
+Status FMT_Frame_Append_Uint (FMT_Frame_t *frame, uint64_t value, uint8_t width);
+Status FMT_Frame_Append_Floats(
+    FMT_Frame_t *frame,
+    const float *values,
+    uint8_t     count,
+    const char  *separator,
+    uint8_t     width,
+    uint8_t     precision
+);
+Status FMT_Frame_Append_Base64(FMT_Frame_t *frame, const uint8_t *data, uint16_t length);
+
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
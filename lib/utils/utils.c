@@ -29,6 +29,7 @@
 
 
 #include "utils.h"
+#include "fmt.h"
 
 
 /**************************************************************************************************/
@@ -502,11 +503,13 @@ void SysTick_Handler(void) {
     g_systick_time++;
 }
 
-// !! This function is under development
 //if message is a uint8_t array, it should be passed as ((char *) message)
 void Append_Float_To_String(char *message, size_t message_size, float data) {
-    char temp[32];
-    snprintf(temp, sizeof(temp), "%f", data);
+    char     temp[FMT_NUMBER_LENGTH_MAX];
+    uint16_t length = 0U;
+    if (FMT_Float(temp, sizeof(temp), data, 0U, FMT_FLOAT_PRECISION_MAX, &length) != SUCCESS) {
+        return;
+    }
     size_t used = strlen(message);
     size_t remaining = message_size - used;
     strncat(message, temp, remaining - 1);
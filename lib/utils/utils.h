@@ -298,6 +298,15 @@ static inline __attribute__((always_inline)) void DSB(void) {
     __asm__ volatile("dsb":::"memory");
 }
 
+static inline __attribute__((always_inline)) void DMB(void) {
+#if defined(__arm__)
+    __asm__ volatile("dmb":::"memory");
+#else
+    //full fence for host builds, e.g. the unit tests
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
 static inline __attribute__((always_inline)) void ENABLE_IRQ(void) {
     __asm__ volatile("cpsie i":::"memory");
 }
@@ -306,6 +315,29 @@ static inline __attribute__((always_inline)) void DISABLE_IRQ(void) {
     __asm__ volatile("cpsid i":::"memory");
 }
 
+static inline __attribute__((always_inline)) uint32_t GET_PRIMASK(void) {
+    uint32_t primask;
+    __asm__ volatile("mrs %0, primask":"=r"(primask)::"memory");
+    return primask;
+}
+
+static inline __attribute__((always_inline)) void SET_PRIMASK(uint32_t primask) {
+    __asm__ volatile("msr primask, %0"::"r"(primask):"memory");
+}
+
+static inline __attribute__((always_inline)) int32_t SMLAD(uint32_t x, uint32_t y, int32_t acc) {
+#if defined(__ARM_FEATURE_DSP)
+    int32_t result;
+    __asm__("smlad %0, %1, %2, %3":"=r"(result):"r"(x), "r"(y), "r"(acc));
+    return result;
+#else
+    //dual 16-bit multiply-accumulate of the low and high halves, wrapping as the instruction does
+    int32_t low  = ((int32_t) (int16_t) (x & 0xFFFFUL) * (int32_t) (int16_t) (y & 0xFFFFUL));
+    int32_t high = ((int32_t) (int16_t) (x >> 16) * (int32_t) (int16_t) (y >> 16));
+    return (int32_t) ((uint32_t) acc + (uint32_t) low + (uint32_t) high);
+#endif
+}
+
 
 
 
@@ -9,6 +9,9 @@
  *          - Pin A10 (USART1 RX) connects to FT232 TXD
  *          - Pin A2 (USART2 TX) connects to BNO055 SCL
  *          - Pin A3 (USART2 RX) connects to BNO055 SDA
+ *          - Pin B0 connects to BNO055 INT
+ *          - Pin A8 (TIM1 CH1) connects to the roll servo signal
+ *          - Pin A11 (TIM1 CH4) connects to the pitch servo signal
  *          - PS0 is connected to GND
  *          - PS1 is connected to 3.3/5V
  * 
@@ -21,18 +24,172 @@
 #include "main.h"
 
 
-int main(void) {
-    //reset all peripherals
-    Peripheral_Reset();
+/** @brief Length of a capture line before its base64 block */
+#define CAP_HEADER_BYTES    24U
 
-    //configure system clock
-    CHECK_STATUS(Sys_Clock_Init(HSI_CLOCK));
+/** @brief Age bound of the acceleration read at a motion interrupt, one ACC update at 100 Hz */
+#define EVT_ACC_MAX_AGE_US  10000UL
 
-    //configure systick time-base
-    CHECK_STATUS(Systick_Init(SYSTICK_UNIT_MSEC));
+/** @brief Latest motion interrupts, recorded by the event engine handlers */
+typedef struct {
+    uint8_t         pending_mask;
+    uint64_t        time_us[EVT_IRQ_COUNT];
+    BNO_ODR_Float_t acc;
+    CAP_State_t     *cap_state;
+} Motion_Events_t;
 
-    GPIO_Reset_Pin(GPIOC, GPIO_PIN_13);
+/** @brief Diagnostic reports, each emitted in its own output frame to bound the frame length */
+typedef enum {
+    REPORT_BUS = 0,
+    REPORT_AHRS,
+    REPORT_PRED,
+    REPORT_STAB,
+    REPORT_SPEC,
+    REPORT_STATS,
+    REPORT_DBAND,
+    REPORT_CODEC,
+    REPORT_CONV,
+    REPORT_MAGCAL,
+    REPORT_SPIKE,
+    REPORT_COUNT
+} Report_Line;
+
+/** @brief Acquisition state owned by the TIM1 update interrupt */
+typedef struct {
+    SCHED_State_t *sched_state;
+    RING_State_t  *ring_state;
+    SNAP_State_t  *snap_state;
+    STAB_State_t  *stab_state;
+    SPIKE_State_t *spike_state;
+    IMU_Frame_t   frame;
+} Acq_Context_t;
+
+/** @brief Records selected for output in a frame */
+typedef struct {
+    uint16_t emit_mask;
+    uint8_t  emit_summary;
+    uint32_t qua_packed;
+    float    mean_values[IMU_CHANNEL_COUNT][IMU_VALUES_MAX];
+} Output_Records_t;
+
+/** @brief Application state, shared by the setup helpers, the application loop and the reports */
+typedef struct {
+    USART_Config_t   usart_term_config;
+    USART_Config_t   usart_bno_config;
+    uint8_t          bno_fusion;
+    SCHED_Config_t   sched_config;
+    SCHED_State_t    sched_state;
+    EVT_State_t      evt_state;
+    Motion_Events_t  motion_events;
+    GOV_Config_t     gov_config;
+    GOV_State_t      gov_state;
+    IMU_Channel      summary_channel;
+    DEC_Config_t     dec_config;
+    DEC_State_t      dec_state;
+    CONV_State_t     conv_state;
+    CONV_Block_t     conv_block;
+    CONV_Bench_t     conv_bench;
+    DBAND_State_t    dband_state;
+    AHRS_State_t     ahrs_state;
+    PRED_State_t     pred_state;
+    STAB_State_t     stab_state;
+    SPEC_State_t     spec_state;
+    STATS_State_t    stats_state;
+    CAP_State_t      cap_state;
+    uint8_t          cap_block[(TX_BUFFER_SIZE / 4U) * 3U];
+    uint16_t         cap_line_bytes;
+    uint32_t         cap_credit;
+    uint64_t         cap_cycles;
+    CODEC_State_t    codec_state;
+    MAGCAL_State_t   magcal_state;
+    MAGCAL_Result_t  magcal_result;
+    BNO_SIC_Matrix_t magcal_sic;
+    BNO_Offset_t     magcal_offset;
+    uint8_t          magcal_pending;
+    uint8_t          magcal_done;
+    SPIKE_Config_t   spike_config;
+    SPIKE_State_t    spike_state;
+    RING_State_t     ring_state;
+    SNAP_State_t     snap_state;
+    Acq_Context_t    acq_context;
+    uint32_t         report_s;
+    uint16_t         report_mask;
+} App_State_t;
+
+/** @brief Label, number of values and LSB per unit of each channel */
+static const char *channel_labels[IMU_CHANNEL_COUNT] = {
+    "ACC", "MAG", "GYR", "LIA", "GRV", "EUL", "QUA", "TMP", "CAL"
+};
+static const uint8_t channel_values[IMU_CHANNEL_COUNT] = {3U, 3U, 3U, 3U, 3U, 3U, 4U, 1U, 1U};
+static const float channel_scale[IMU_CHANNEL_COUNT] = {
+    BNO_ACC_MS, BNO_MAG_UT, BNO_GYR_DPS, BNO_LIA_MS, BNO_GRV_MS, BNO_EUL_DEGREES,
+    BNO_QUA_QUATERNIONS, BNO_TEMP_CEL, 1.0f
+};
+
+
+/**
+ * @brief  Signals each BNO055 INT edge to the interrupt event engine
+ * @param  line:    EXTI line of the INT pin
+ * @param  context: Pointer to the event engine state
+ * @retval None
+ * @note   The edge is stamped here with the DWT time, so its reaction time is measured in
+ *         micro-seconds from the edge itself rather than from the next TIM1 milli-second
+ */
+static void BNO_INT_Callback(EXTI_Line line, void *context) {
+    (void) line;
+    uint64_t now_us = 0ULL;
+    DWT_Get_Time_US(&now_us);
+    EVT_Signal((EVT_State_t *) context, now_us);
+}
+
+/**
+ * @brief  Completes the frame in flight and launches the next one on each TIM1 update event
+ * @param  context: Pointer to the acquisition context
+ * @retval None
+ * @note   Completed frames are cleared of spikes, then queued in the frame ring for the
+ *         application loop, and published to the latest sample snapshot for other readers. The
+ *         context frame keeps the latest values of every channel, so each queued frame is complete
+ * @note   The servo outputs are updated first, so their compare values are written well within
+ *         the period regardless of the bus traffic
+ */
+static void Acq_Launch_Callback(void *context) {
+    Acq_Context_t *acq = (Acq_Context_t *) context;
+
+    STAB_Update(acq->stab_state);
+
+    //queue and publish the frame launched by a previous tick once its response has arrived
+    if ((SCHED_Poll(acq->sched_state, g_tim1_time, &acq->frame) == SUCCESS)
+    &&  (acq->frame.updated_mask != 0U)) {
+        SPIKE_Filter(acq->spike_state, &acq->frame);
+        SNAP_Publish(acq->snap_state, &acq->frame);
+        RING_Push(acq->ring_state, &acq->frame);
+    }
+
+    uint32_t now_us = 0UL;
+    TIM1_MS_Base_Get_US(&now_us);
+    SCHED_Launch(acq->sched_state, now_us);
+}
+
+/**
+ * @brief  Records a motion interrupt, to be reported in the next output frame, and triggers a
+ *         capture of the frames around it
+ * @param  irq:          BNO055 interrupt
+ * @param  timestamp_us: DWT time of the INT edge, on the timeline of the frame sample times
+ * @param  context:      Pointer to the latest motion interrupts
+ * @retval None
+ */
+static void Motion_Event_Handler(BNO_IRQ irq, uint64_t timestamp_us, void *context) {
+    Motion_Events_t *motion_events = (Motion_Events_t *) context;
+    motion_events->pending_mask |= (uint8_t) (1U << irq);
+    motion_events->time_us[irq]  = timestamp_us;
+    CAP_Trigger(motion_events->cap_state, irq, timestamp_us);
+}
 
+/**
+ * @brief  Configures the GPIO pins of the terminal and BNO055 links, the servos and BNO055 INT
+ * @retval Status indicating success or error
+ */
+static Status App_GPIO_Init(void) {
     //configure GPIO for USART1 TX
     GPIO_Config_t term_tx_config = {
         .port         = GPIOA,
@@ -75,99 +232,1354 @@ int main(void) {
     };
     CHECK_STATUS(GPIO_Init(&bno_rx_config));
 
-    //configure USART1 to communicate with the terminal
-    USART_Config_t usart_term_config = {
-        .instance         = USART1,
-        .baud_rate        = 115200,
-        .irq_priority     = 1
+    //configure GPIO for the servo outputs on TIM1 CH1 and CH4
+    GPIO_Config_t servo_roll_config = {
+        .port         = GPIOA,
+        .pin          = GPIO_PIN_8,
+        .mode         = GPIO_MODE_AF,
+        .alt_function = GPIO_AF_1,
+        .output_speed = GPIO_OSPEED_HIGH,
+        .output_type  = GPIO_OTYPE_PUSH_PULL
+    };
+    CHECK_STATUS(GPIO_Init(&servo_roll_config));
+    GPIO_Config_t servo_pitch_config = {
+        .port         = GPIOA,
+        .pin          = GPIO_PIN_11,
+        .mode         = GPIO_MODE_AF,
+        .alt_function = GPIO_AF_1,
+        .output_speed = GPIO_OSPEED_HIGH,
+        .output_type  = GPIO_OTYPE_PUSH_PULL
     };
-    CHECK_STATUS(USART_Init(&usart_term_config));
+    CHECK_STATUS(GPIO_Init(&servo_pitch_config));
 
-    //configure USART2 to communicate with BNO055
-    USART_Config_t usart_bno_config = {
-        .instance         = USART2,
-        .baud_rate        = 115200,
-        .irq_priority     = 2
+    //configure GPIO for BNO055 INT
+    GPIO_Config_t bno_int_config = {
+        .port         = GPIOB,
+        .pin          = GPIO_PIN_0,
+        .mode         = GPIO_MODE_INPUT,
+        .pupd         = GPIO_PUPD_PULLDOWN
     };
-    CHECK_STATUS(USART_Init(&usart_bno_config));
+    CHECK_STATUS(GPIO_Init(&bno_int_config));
 
-    Delay_Loop(2000);
+    return SUCCESS;
+}
+
+/**
+ * @brief  Initialises the BNO055, reports its calibration profile and routes its motion
+ *         interrupts to the INT pin
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ * @note   Returns ERROR if the BNO055 fails its power-on self test
+ */
+static Status App_BNO_Init(App_State_t *app) {
+    USART_Config_t *usart_bno_config = &app->usart_bno_config;
 
     // initialise BNO055
     BNO_Config_t bno_config = {
         .pwr_mode = BNO_PWR_NORMAL_MODE,
         .opr_mode = BNO_OPR_AMG_MODE
     };
-    CHECK_STATUS(BNO_Init(&usart_bno_config, &bno_config));
+    CHECK_STATUS(BNO_Init(usart_bno_config, &bno_config));
+    app->bno_fusion = (bno_config.opr_mode >= BNO_OPR_IMU_MODE);
+
+    //outside the fusion modes, raise the gyroscope output rate from 100 Hz to 200 Hz for the AHRS
+    if (!app->bno_fusion) {
+        BNO_GYR_Config_t gyr_config = {
+            .gyr_range    = BNO_GYR_RANGE_2000_DPS,
+            .gyr_bw       = BNO_GYR_BW_64_HZ,
+            .gyr_pwr_mode = BNO_GYR_PWR_MODE_NORMAL
+        };
+        CHECK_STATUS(BNO_GYR_Init(usart_bno_config, &gyr_config));
+    }
 
     //check POST result
     uint8_t post_result = 0U;
-    CHECK_STATUS(BNO_Get_MCU_POST_Result(&usart_bno_config, &post_result));
+    CHECK_STATUS(BNO_Get_MCU_POST_Result(usart_bno_config, &post_result));
     if (post_result == 0U) {
         return ERROR;
     }
 
-    //wait for system to calibrate
-    uint8_t sys_calib_status = 0;
-    CHECK_STATUS(BNO_Get_Sys_Calib_Status(&usart_bno_config, &sys_calib_status));
-    while (sys_calib_status == 0) {
-        NOP();
-    }
-
     //read calibration profile
     BNO_Calib_Profile_t calib_profile = {0};
-    CHECK_STATUS(BNO_Get_Calib_Profile(&usart_bno_config, &calib_profile));
+    CHECK_STATUS(BNO_Get_Calib_Profile(usart_bno_config, &calib_profile));
 
     //transmit calibration profile to terminal
-    CHECK_STATUS(BNO_Transmit_Calib_Profile(&usart_term_config, &calib_profile));
+    CHECK_STATUS(BNO_Transmit_Calib_Profile(&app->usart_term_config, &calib_profile));
 
     //for subsequent programs, write the offset values
-    // CHECK_STATUS(BNO_Write_Calib_Profile(&usart_bno_config, &calib_profile));
+    // CHECK_STATUS(BNO_Write_Calib_Profile(usart_bno_config, &calib_profile));
 
-    while (1) {
-        //initialise storage variables
-        BNO_ODR_Float_t acc_data = {0.0f, 0.0f, 0.0f};
-        BNO_ODR_Float_t mag_data = {0.0f, 0.0f, 0.0f};
-        BNO_ODR_Float_t gyr_data = {0.0f, 0.0f, 0.0f};
-        BNO_ODR_Float_t lia_data = {0.0f, 0.0f, 0.0f};
-        BNO_ODR_Float_t grv_data = {0.0f, 0.0f, 0.0f};
-        BNO_ODR_Float_t eul_data = {0.0f, 0.0f, 0.0f};
-        BNO_QUA_Float_t qua_data = {0.0f, 0.0f, 0.0f, 0.0f};
-
-        //get sensor data
-        CHECK_STATUS(BNO_Get_ACC_XYZ(&usart_bno_config, &acc_data));
-        CHECK_STATUS(BNO_Get_MAG_XYZ(&usart_bno_config, &mag_data));
-        CHECK_STATUS(BNO_Get_GYR_XYZ(&usart_bno_config, &gyr_data));
-        CHECK_STATUS(BNO_Get_LIA_XYZ(&usart_bno_config, &lia_data));
-        CHECK_STATUS(BNO_Get_GRV_XYZ(&usart_bno_config, &grv_data));
-        CHECK_STATUS(BNO_Get_EUL_HRP(&usart_bno_config, &eul_data));
-        CHECK_STATUS(BNO_Get_QUA_WXYZ(&usart_bno_config, &qua_data));
-
-        // compose message
-        uint8_t data_read_msg[TX_BUFFER_SIZE] = {0};
-        snprintf(
-            (char *) data_read_msg, sizeof(data_read_msg), 
-            "ACC -> %8.4f | %8.4f | %8.4f\n\r"
-            "MAG -> %8.4f | %8.4f | %8.4f\n\r"
-            "GYR -> %8.4f | %8.4f | %8.4f\n\r"
-            "LIA -> %8.4f | %8.4f | %8.4f\n\r"
-            "GRV -> %8.4f | %8.4f | %8.4f\n\r"
-            "EUL -> %8.4f | %8.4f | %8.4f\n\r"
-            "QUA -> %8.4f | %8.4f | %8.4f | %8.4f\n\n\r", 
-            acc_data.x_float, acc_data.y_float, acc_data.z_float,
-            mag_data.x_float, mag_data.y_float, mag_data.z_float,
-            gyr_data.x_float, gyr_data.y_float, gyr_data.z_float,
-            lia_data.x_float, lia_data.y_float, lia_data.z_float,
-            grv_data.x_float, grv_data.y_float, grv_data.z_float,
-            eul_data.x_float, eul_data.y_float, eul_data.z_float,
-            qua_data.w_float, qua_data.x_float, qua_data.y_float, qua_data.z_float
-        );
+    //route the any motion and high-g interrupts to the INT pin
+    BNO_ACC_AM_Config_t am_config = {
+        .thres        = 100.0f,
+        .slope_points = 2U,
+        .x_axis       = BNO_IRQ_AXIS_ENABLED,
+        .y_axis       = BNO_IRQ_AXIS_ENABLED,
+        .z_axis       = BNO_IRQ_AXIS_ENABLED
+    };
+    CHECK_STATUS(BNO_ACC_AM_Config(usart_bno_config, &am_config));
+    CHECK_STATUS(BNO_Enable_IRQ_Msk(usart_bno_config, BNO_IRQ_ACC_AM));
+    BNO_ACC_HG_Config_t hg_config = {
+        .thres  = 1500.0f,
+        .dur_ms = 10U,
+        .x_axis = BNO_IRQ_AXIS_ENABLED,
+        .y_axis = BNO_IRQ_AXIS_ENABLED,
+        .z_axis = BNO_IRQ_AXIS_ENABLED
+    };
+    CHECK_STATUS(BNO_ACC_HG_Config(usart_bno_config, &hg_config));
+    CHECK_STATUS(BNO_Enable_IRQ_Msk(usart_bno_config, BNO_IRQ_ACC_HIGH_G));
+
+    //return to page 0 by reading the interrupt status, then release the INT pin
+    uint8_t am_status = 0U;
+    CHECK_STATUS(BNO_Get_IRQ_Status(usart_bno_config, BNO_IRQ_ACC_AM, &am_status));
+    CHECK_STATUS(BNO_Clear_INT(usart_bno_config));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Initialises the acquisition scheduler on the TIM1 millisecond time base
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ * @note   Each frame is launched by the TIM1 update event. QUA is only read in the fusion modes, as
+ *         it is all zeros otherwise, and the AHRS supplies it in the others. Launched reads are
+ *         non-blocking, so the turnaround is the BNO055 response time rather than the fixed delay
+ *         of BNO_Read_Reg. Launches are phase-locked to the updates of the fastest channel once
+ *         its update period matches the tick period
+ * @note   Outside the fusion modes the tick follows the 200 Hz gyroscope, with the accelerometer
+ *         and magnetometer read in every other tick. A tick of ACC to GYR takes about 4.1 ms of
+ *         the 5 ms tick at 115200 baud, so TEMP and CALIB, whose registers are too far to share
+ *         the transaction, are only read in the fusion modes, where the BNO055 also maintains the
+ *         calibration status
+ * @note   No channel is derived, as derive_mask is left at 0: the reports and the stabiliser
+ *         take the orientation from QUA and its prediction, and the governor has no record for
+ *         EUL, GRV or LIA. Scheduling one of them with its bit in derive_mask derives it from the
+ *         QUA and ACC already read, without adding to the bus time of the tick
+ */
+static Status App_Sched_Init(App_State_t *app) {
+    CHECK_STATUS(TIM1_MS_Base_Init());
+
+    uint16_t       gyr_rate_hz  = (app->bno_fusion ? 100U : 200U);
+    SCHED_Config_t sched_config = {
+        .mode         = SCHED_MODE_TIMER,
+        .tick_rate_hz = gyr_rate_hz,
+        .rate_hz      = {
+            [IMU_CHANNEL_ACC]   = 100U,
+            [IMU_CHANNEL_MAG]   = 20U,
+            [IMU_CHANNEL_GYR]   = gyr_rate_hz,
+            [IMU_CHANNEL_QUA]   = (app->bno_fusion ? 100U : 0U),
+            [IMU_CHANNEL_TEMP]  = (app->bno_fusion ? 1U : 0U),
+            [IMU_CHANNEL_CALIB] = (app->bno_fusion ? 2U : 0U)
+        },
+        .transaction_latency_us = 2000UL,
+        .phase_lock             = 1U,
+        .phase_channel          = (app->bno_fusion ? IMU_CHANNEL_ACC : IMU_CHANNEL_GYR)
+    };
+    app->sched_config = sched_config;
+    CHECK_STATUS(SCHED_Init(&app->sched_state, &app->sched_config, &app->usart_bno_config));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Dispatches the BNO055 motion interrupts, signalled by each rising edge of its INT pin,
+ *         to the motion event record
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ */
+static Status App_Events_Init(App_State_t *app) {
+    EVT_Config_t evt_config = {
+        .int_port = GPIOB,
+        .int_pin  = GPIO_PIN_0
+    };
+    CHECK_STATUS(EVT_Init(&app->evt_state, &evt_config, &app->usart_bno_config));
+    CHECK_STATUS(
+        EVT_Register_Handler(
+            &app->evt_state, BNO_IRQ_ACC_AM, Motion_Event_Handler, &app->motion_events
+        )
+    );
+    CHECK_STATUS(
+        EVT_Register_Handler(
+            &app->evt_state, BNO_IRQ_ACC_HIGH_G, Motion_Event_Handler, &app->motion_events
+        )
+    );
+
+    EXTI_Config_t bno_int_exti_config = {
+        .port         = EXTI_PORT_B,
+        .line         = EXTI_LINE_0,
+        .trigger      = EXTI_TRIGGER_RISING,
+        .irq_priority = 3,
+        .callback     = BNO_INT_Callback,
+        .context      = &app->evt_state
+    };
+    CHECK_STATUS(EXTI_Init(&bno_int_exti_config));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Initialises the output path, from the decimator to the governor and the deadband
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ * @note   The accelerometer and gyroscope are reduced to a quarter of their rate with an
+ *         anti-aliasing CIC and FIR decimator before the governor, so vibration above the reduced
+ *         Nyquist frequency is removed rather than folded into the output
+ * @note   Each batch of frames is converted to units in one pass over a struct-of-arrays block,
+ *         multiplying by the reciprocals of the channel scales rather than dividing each value.
+ *         The decimated channels are converted from the decimator outputs instead
+ */
+static Status App_Output_Init(App_State_t *app) {
+    const SCHED_Config_t *sched_config = &app->sched_config;
+
+    //configure the output governor to fit the terminal link
+    GOV_Config_t gov_config = {
+        .baud_rate            = app->usart_term_config.baud_rate,
+        .frame_rate_hz        = sched_config->tick_rate_hz,
+        .record_bytes         = {
+            [IMU_CHANNEL_ACC]  = 39U,
+            [IMU_CHANNEL_MAG]  = 39U,
+            [IMU_CHANNEL_GYR]  = 39U,
+            [IMU_CHANNEL_QUA]  = 19U,
+            [IMU_CHANNEL_TEMP] = 17U
+        },
+        .priority             = {
+            [IMU_CHANNEL_ACC]  = 4U,
+            [IMU_CHANNEL_MAG]  = 1U,
+            [IMU_CHANNEL_GYR]  = 2U,
+            [IMU_CHANNEL_QUA]  = 8U,
+            [IMU_CHANNEL_TEMP] = 1U
+        },
+        .summary_bytes        = 65U,
+        .frame_overhead_bytes = 2U
+    };
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        gov_config.channel_rate_hz[i] = sched_config->rate_hz[i];
+    }
+    if (!app->bno_fusion) {
+        gov_config.channel_rate_hz[IMU_CHANNEL_QUA] = sched_config->rate_hz[IMU_CHANNEL_GYR];
+    }
+
+    //decimate the accelerometer and gyroscope ahead of the governor
+    DEC_Config_t dec_config = {
+        .channel_mask = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_GYR)),
+        .factor       = 4U
+    };
+    app->dec_config = dec_config;
+    CHECK_STATUS(DEC_Init(&app->dec_state, &app->dec_config));
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if ((dec_config.channel_mask >> i) & 1U) {
+            gov_config.channel_rate_hz[i] = (sched_config->rate_hz[i] / dec_config.factor);
+        }
+    }
+    app->gov_config = gov_config;
+    CHECK_STATUS(GOV_Init(&app->gov_state, &app->gov_config));
+
+    //summarise the highest priority channel that is output and has a source in this mode
+    app->summary_channel = IMU_CHANNEL_ACC;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        uint8_t sourced = ((sched_config->rate_hz[i] != 0U)
+                        || ((i == IMU_CHANNEL_QUA) && !app->bno_fusion));
+        if (sourced && (gov_config.record_bytes[i] != 0U)
+        &&  (gov_config.priority[i] > gov_config.priority[app->summary_channel])) {
+            app->summary_channel = (IMU_Channel) i;
+        }
+    }
+
+    //convert the channels that are not decimated, the first batch also with a division per
+    //value, to compare both paths
+    CONV_Config_t conv_config = {0};
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        conv_config.scale[i] = channel_scale[i];
+        if ((sched_config->rate_hz[i] != 0U) && !((dec_config.channel_mask >> i) & 1U)) {
+            conv_config.channel_mask |= (uint16_t) (1U << i);
+        }
+    }
+    CHECK_STATUS(CONV_Init(&app->conv_state, &conv_config));
+
+    //only output the scheduled records that changed beyond the deadband of their channel, or
+    //once per second as a heartbeat, so static installations use the link in proportion to motion
+    DBAND_Config_t dband_config = {
+        .threshold = {
+            [IMU_CHANNEL_ACC]  = 0.05f,
+            [IMU_CHANNEL_MAG]  = 0.5f,
+            [IMU_CHANNEL_GYR]  = 0.2f,
+            [IMU_CHANNEL_QUA]  = 0.001f,
+            [IMU_CHANNEL_TEMP] = 1.0f
+        }
+    };
+    CHECK_STATUS(DBAND_Init(&app->dband_state, &dband_config));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Initialises the on-MCU orientation, its prediction and the platform stabiliser
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ * @note   The raw AMG channels are fused on every new gyroscope sample, i.e. at the 200 Hz
+ *         gyroscope output rate set in App_BNO_Init(), twice the 100 Hz fusion rate of the BNO055
+ *         and one read after the sample rather than after its fusion delay. The magnetometer is
+ *         not compensated in AMG mode, so only the accelerometer corrects the gyroscope drift
+ */
+static Status App_Fusion_Init(App_State_t *app) {
+    AHRS_Config_t ahrs_config = {
+        .filter    = AHRS_FILTER_MADGWICK,
+        .bias_gain = 0.01f
+    };
+    CHECK_STATUS(AHRS_Init(&app->ahrs_state, &ahrs_config));
+
+    //serve the AHRS orientation at the time of use, predicted forward from its sample time
+    PRED_Config_t pred_config = {
+        .external_fusion = 1U
+    };
+    CHECK_STATUS(PRED_Init(&app->pred_state, &pred_config));
+
+    //hold the platform level with the roll and pitch servos, driven by the orientation predicted
+    //to the start of each servo pulse
+    STAB_Config_t stab_config = {
+        .axis       = {
+            {
+                .channel = TIM1_CHANNEL_1,
+                .angle   = BNO_EUL_ROLL,
+                .kp      = 1.0f,
+                .ki      = 0.5f,
+                .kd      = 0.05f
+            },
+            {
+                .channel = TIM1_CHANNEL_4,
+                .angle   = BNO_EUL_PITCH,
+                .kp      = 1.0f,
+                .ki      = 0.5f,
+                .kd      = 0.05f
+            }
+        },
+        .axis_count        = 2U,
+        .ori_unit          = BNO_UNIT_ORI_WINDOWS,
+        .latency_budget_us = 20000UL
+    };
+    CHECK_STATUS(STAB_Init(&app->stab_state, &stab_config, &app->pred_state));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Initialises the vibration spectrum, the windowed statistics, the motion capture with
+ *         its codec and the magnetometer calibration
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ * @note   Captures are drained as blocks of zig-zag varint deltas in base64, which carry several
+ *         frames in the space of a single ASCII record. A block line is only started once the
+ *         credit covers its header and one worst case frame. Each block starts on a key frame, so
+ *         every line decodes on its own, even after a lost line of as many frames as the 4-bit
+ *         sequence number wraps at
+ */
+static Status App_Analysis_Init(App_State_t *app) {
+    //reduce the accelerometer to its vibration peaks on blocks of 256 samples (2.56 s at 100 Hz),
+    //rather than streaming the raw samples
+    SPEC_Config_t spec_config = {
+        .points     = 256U,
+        .channel    = IMU_CHANNEL_ACC,
+        .window     = SPEC_WINDOW_HANN,
+        .peak_count = 3U
+    };
+    CHECK_STATUS(SPEC_Init(&app->spec_state, &spec_config));
+
+    //summarise the accelerometer and gyroscope over each second from every sample
+    STATS_Config_t stats_config = {
+        .channel_mask = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_GYR)),
+        .window_us    = SEC_TO_USEC
+    };
+    CHECK_STATUS(STATS_Init(&app->stats_state, &stats_config));
+
+    //capture the 50 full-rate frames before to the 50 after each motion interrupt, and
+    //drain each capture with the link capacity left unused by the governor
+    CAP_Config_t cap_config = {
+        .pre_frames  = 50U,
+        .post_frames = 50U
+    };
+    CHECK_STATUS(CAP_Init(&app->cap_state, &cap_config));
+    app->motion_events.cap_state = &app->cap_state;
+
+    //calibrate the magnetometer on the MCU from the first seconds of motion, rather than waiting
+    //for the BNO055 to calibrate itself, then write the soft-iron matrix and offset to the BNO055
+    MAGCAL_Config_t magcal_config = {0};
+    CHECK_STATUS(MAGCAL_Init(&app->magcal_state, &magcal_config));
+
+    CODEC_Config_t codec_config = {
+        .channel_mask = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_MAG)
+                      |  (1U << IMU_CHANNEL_GYR))
+    };
+    CHECK_STATUS(CODEC_Init(&app->codec_state, &codec_config));
+    CODEC_Report_t codec_report;
+    CHECK_STATUS(CODEC_Get_Report(&app->codec_state, &codec_report));
+    app->cap_line_bytes = (CAP_HEADER_BYTES + (((codec_report.frame_bytes_max + 2U) / 3U) * 4U));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Runs acquisition from the TIM1 update interrupt, which clears the frames of spikes,
+ *         queues them in the frame ring and publishes the latest values of each channel to the
+ *         snapshot
+ * @param  app: Pointer to the application state
+ * @retval Status indicating success or error
+ * @note   Single-sample spikes of the accelerometer and magnetometer are replaced with the median
+ *         of their latest 5 samples as they are acquired, so no later stage needs heavier smoothing
+ */
+static Status App_Acq_Init(App_State_t *app) {
+    SPIKE_Config_t spike_config = {
+        .channel_mask = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_MAG))
+    };
+    app->spike_config = spike_config;
+    CHECK_STATUS(SPIKE_Init(&app->spike_state, &app->spike_config));
+
+    CHECK_STATUS(RING_Init(&app->ring_state));
+    CHECK_STATUS(SNAP_Init(&app->snap_state));
+    Acq_Context_t acq_context = {
+        .sched_state = &app->sched_state,
+        .ring_state  = &app->ring_state,
+        .snap_state  = &app->snap_state,
+        .stab_state  = &app->stab_state,
+        .spike_state = &app->spike_state
+    };
+    app->acq_context = acq_context;
+    CHECK_STATUS(TIM1_Set_Update_Callback(Acq_Launch_Callback, &app->acq_context));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Runs a frame through the processing stages, and queues the reports they complete
+ * @param  app:         Pointer to the application state
+ * @param  imu_frame:   Pointer to the frame
+ * @param  frame_index: Index of the frame in the converted batch
+ * @retval Status indicating success or error
+ * @note   Every sample is accumulated, so decimated output reports the mean of the skipped samples.
+ *         The decimated channels only accumulate the outputs of the decimator
+ */
+static Status App_Process_Frame(
+    App_State_t       *app,
+    const IMU_Frame_t *imu_frame,
+    uint16_t          frame_index
+) {
+    uint16_t    dec_ready = 0U;
+    IMU_Frame_t dec_frame;
+    CHECK_STATUS(DEC_Push(&app->dec_state, imu_frame, &dec_ready));
+    if (dec_ready) {
+        CHECK_STATUS(DEC_Get_Frame(&app->dec_state, &dec_frame));
+    }
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        uint8_t  decimated   = ((app->dec_config.channel_mask >> i) & 1U);
+        uint16_t sample_mask = decimated ? dec_ready : imu_frame->updated_mask;
+        if (!((sample_mask >> i) & 1U)) {
+            continue;
+        }
+        float sample_values[IMU_VALUES_MAX];
+        if (decimated) {
+            float reciprocal = 0.0f;
+            CHECK_STATUS(CONV_Get_Reciprocal(&app->conv_state, i, &reciprocal));
+            CHECK_STATUS(
+                CONV_Scale(dec_frame.data[i], sample_values, channel_values[i], reciprocal)
+            );
+        } else {
+            for (uint8_t j = 0U; j < channel_values[i]; j++) {
+                sample_values[j] = app->conv_block.value[i][j][frame_index];
+            }
+        }
+        CHECK_STATUS(GOV_Accumulate(&app->gov_state, i, sample_values, channel_values[i]));
+    }
+
+    //fuse each new gyroscope sample, and output the fused orientation as QUA outside the fusion
+    //modes
+    CHECK_STATUS(AHRS_Update(&app->ahrs_state, imu_frame));
+    CHECK_STATUS(PRED_Update(&app->pred_state, imu_frame));
+    if (((imu_frame->updated_mask & (uint16_t) ~imu_frame->duplicate_mask)
+         >> IMU_CHANNEL_GYR) & 1U) {
+        float fused_q[4];
+        CHECK_STATUS(AHRS_Get_Quaternion(&app->ahrs_state, fused_q));
+        CHECK_STATUS(PRED_Push_Quaternion(&app->pred_state, fused_q, imu_frame->sample_us));
+        if (!app->bno_fusion) {
+            CHECK_STATUS(GOV_Accumulate(&app->gov_state, IMU_CHANNEL_QUA, fused_q, 4U));
+        }
+    }
+    uint8_t spec_ready = 0U;
+    CHECK_STATUS(SPEC_Push(&app->spec_state, imu_frame, &spec_ready));
+    uint8_t stats_ready = 0U;
+    CHECK_STATUS(STATS_Push(&app->stats_state, imu_frame, &stats_ready));
+    CHECK_STATUS(CAP_Push(&app->cap_state, imu_frame));
+    if (!app->magcal_done) {
+        CHECK_STATUS(MAGCAL_Push(&app->magcal_state, imu_frame));
+    }
+
+    //queue the diagnostic reports once per second, the spectrum once per block and the
+    //statistics once per window
+    if ((uint32_t) (imu_frame->sample_us / SEC_TO_USEC) != app->report_s) {
+        app->report_s     = (uint32_t) (imu_frame->sample_us / SEC_TO_USEC);
+        app->report_mask |= (uint16_t) ((1U << REPORT_BUS) | (1U << REPORT_AHRS)
+                                      | (1U << REPORT_PRED) | (1U << REPORT_STAB)
+                                      | (1U << REPORT_DBAND) | (1U << REPORT_CONV)
+                                      | (1U << REPORT_SPIKE));
+
+        //solve the magnetometer calibration once per second until it converges
+        if (!app->magcal_done && !app->magcal_pending
+        &&  (MAGCAL_Solve(&app->magcal_state, &app->magcal_result) == SUCCESS)
+        &&  app->magcal_result.converged) {
+            app->magcal_pending = (MAGCAL_Registers(&app->magcal_result, &app->magcal_sic,
+                                                    &app->magcal_offset) == SUCCESS);
+        }
+    }
+    if (spec_ready) {
+        app->report_mask |= (uint16_t) (1U << REPORT_SPEC);
+    }
+    if (stats_ready) {
+        app->report_mask |= (uint16_t) (1U << REPORT_STATS);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Selects the records output in this frame
+ * @param  app:       Pointer to the application state
+ * @param  imu_frame: Pointer to the latest frame
+ * @param  records:   Pointer to a struct used to store the selected records
+ * @retval Status indicating success or error
+ * @note   Takes the means of the scheduled channels, dropping those within their deadband. QUA is
+ *         sent as its smallest three components in 32 bits, and is the AHRS orientation outside
+ *         the fusion modes
+ */
+static Status App_Select_Records(
+    App_State_t       *app,
+    const IMU_Frame_t *imu_frame,
+    Output_Records_t  *records
+) {
+    CHECK_STATUS(GOV_Emit_Summary(&app->gov_state, &records->emit_summary));
+    records->emit_mask  = 0U;
+    records->qua_packed = 0UL;
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        float   *mean_values = records->mean_values[i];
+        uint8_t emit         = 0U;
+        CHECK_STATUS(GOV_Emit_Channel(&app->gov_state, i, &emit));
+        if (emit) {
+            CHECK_STATUS(GOV_Get_Mean(&app->gov_state, i, mean_values, channel_values[i]));
+            if (i == IMU_CHANNEL_QUA) {
+                emit = (ORIENT_Quat_Pack(mean_values, ORIENT_PACK_BITS_MAX, &records->qua_packed)
+                     == SUCCESS);
+            }
+        }
+        if (emit) {
+            CHECK_STATUS(
+                DBAND_Filter(
+                    &app->dband_state, i, mean_values, channel_values[i], imu_frame->sample_us,
+                    &emit
+                )
+            );
+        }
+        records->emit_mask |= (uint16_t) (emit << i);
+    }
+
+    return SUCCESS;
+}
 
-        //transmit message
+/**
+ * @brief  Appends when and why the output is being decimated
+ * @param  app:        Pointer to the application state
+ * @param  frame:      Pointer to the output frame
+ * @param  gov_report: Pointer to the governor report
+ * @retval Status indicating success or error
+ */
+static Status App_Report_GOV(
+    App_State_t        *app,
+    FMT_Frame_t        *frame,
+    const GOV_Report_t *gov_report
+) {
+    static const char *mode_labels[]   = {"FULL", "DECIMATED", "SUMMARY"};
+    static const char *reason_labels[] = {"NONE", "LINK CAPACITY", "TX BACKLOG"};
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "GOV -> "));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, mode_labels[gov_report->mode]));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, reason_labels[gov_report->reason]));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | frame "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, gov_report->frame_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, gov_report->demand_bps, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, gov_report->budget_bps, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " B/s |"));
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (app->gov_config.record_bytes[i] == 0U) {
+            continue;
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " "));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[i]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, gov_report->decimation[i], 0U));
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the pending motion interrupts with the time of their INT edge and the
+ *         acceleration read at them, and clears them
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_EVT(App_State_t *app, FMT_Frame_t *frame) {
+    static const BNO_IRQ motion_irqs[] = {BNO_IRQ_ACC_AM, BNO_IRQ_ACC_HIGH_G};
+    static const char *motion_labels[] = {"AM", "HG"};
+    Motion_Events_t    *motion_events  = &app->motion_events;
+    float              acc[3]          = {
+        motion_events->acc.x_float, motion_events->acc.y_float, motion_events->acc.z_float
+    };
+    EVT_Report_t       evt_report;
+    CHECK_STATUS(EVT_Get_Report(&app->evt_state, &evt_report));
+    for (uint8_t i = 0U; i < 2U; i++) {
+        if (!((motion_events->pending_mask >> motion_irqs[i]) & 1U)) {
+            continue;
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "EVT -> "));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, motion_labels[i]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, motion_events->time_us[motion_irqs[i]], 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " us | acc "));
+        CHECK_STATUS(FMT_Frame_Append_Floats(frame, acc, 3U, " ", 0U, 2U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " m/s^2 | count "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, evt_report.event_count[motion_irqs[i]], 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " | reaction max "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, evt_report.reaction_max_us, 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " us | err "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, evt_report.read_error_count, 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+    }
+    motion_events->pending_mask = 0U;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the bus utilisation of the acquisition schedule, the frame ring, the cost of
+ *         the decimator and the hits and misses of the ACC cache
+ * @param  app:       Pointer to the application state
+ * @param  frame:     Pointer to the output frame
+ * @param  imu_frame: Pointer to the latest frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_BUS(App_State_t *app, FMT_Frame_t *frame, const IMU_Frame_t *imu_frame) {
+    IMU_Channel       phase_channel = app->sched_config.phase_channel;
+    uint64_t          phase_age_us  = 0ULL;
+    SCHED_Report_t    sched_report;
+    RING_Report_t     ring_report;
+    DEC_Report_t      dec_report;
+    BNO_Cache_Stats_t cache_stats;
+    CHECK_STATUS(SCHED_Get_Report(&app->sched_state, &sched_report));
+    CHECK_STATUS(RING_Get_Report(&app->ring_state, &ring_report));
+    CHECK_STATUS(DEC_Get_Report(&app->dec_state, &dec_report));
+    CHECK_STATUS(BNO_Get_Cache_Stats(&cache_stats));
+    CHECK_STATUS(SNAP_Get_Age(&app->snap_state, phase_channel, &phase_age_us));
+
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "BUS -> "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.utilisation_pct, 3U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " % | "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.transactions, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " reads/s | "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.bytes, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " B/s | late "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.late_ticks, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | overrun "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.overrun_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | err "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.read_errors, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | lag max "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.start_lag_max_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us | dup "));
+    CHECK_STATUS(
+        FMT_Frame_Append_Uint(frame, sched_report.duplicate_count[IMU_CHANNEL_ACC], 0U)
+    );
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | upd "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, sched_report.update_period_us, 0U));
+    CHECK_STATUS(
+        FMT_Frame_Append_Str(frame, (sched_report.phase_locked ? " us lock" : " us"))
+    );
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | ring "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, ring_report.occupancy, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, ring_report.high_water, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | drop "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, ring_report.overflow_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[phase_channel]));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " age "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, phase_age_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us"));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | CAL "));
+    CHECK_STATUS(
+        FMT_Frame_Append_Uint(frame, (uint8_t) imu_frame->data[IMU_CHANNEL_CALIB][0], 0U)
+    );
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | DEC /"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, dec_report.factor, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " cyc "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, dec_report.cycles_per_output, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, dec_report.cycles_max, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | sat "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, dec_report.saturation_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | ACC cache "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, cache_stats.hits[BNO_CACHE_ACC], 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, cache_stats.misses[BNO_CACHE_ACC], 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the on-MCU orientation and the cost of the fusion update
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_AHRS(App_State_t *app, FMT_Frame_t *frame) {
+    static const ORIENT_Units_t ahrs_units = {
+        .eul_unit = BNO_UNIT_EUL_DEGREES,
+        .ori_unit = BNO_UNIT_ORI_WINDOWS
+    };
+    float         ahrs_q[4];
+    float         ahrs_hrp[3];
+    AHRS_Report_t ahrs_report;
+    CHECK_STATUS(AHRS_Get_Quaternion(&app->ahrs_state, ahrs_q));
+    CHECK_STATUS(AHRS_Get_Report(&app->ahrs_state, &ahrs_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "AHR -> "));
+    CHECK_STATUS(FMT_Frame_Append_Floats(frame, ahrs_q, 4U, " | ", 8U, 4U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | EUL "));
+    CHECK_STATUS(ORIENT_Get_Euler(ahrs_q, &ahrs_units, ahrs_hrp));
+    CHECK_STATUS(FMT_Frame_Append_Floats(frame, ahrs_hrp, 3U, " | ", 8U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | cyc "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, ahrs_report.cycles_mean, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, ahrs_report.cycles_max, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the orientation predicted to the time of output, once a prediction is available
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_PRED(App_State_t *app, FMT_Frame_t *frame) {
+    float         pred_q[4];
+    uint64_t      now_us = 0ULL;
+    PRED_Report_t pred_report;
+    CHECK_STATUS(DWT_Get_Time_US(&now_us));
+    if (PRED_Get_Quaternion(&app->pred_state, now_us, pred_q) != SUCCESS) {
+        return SUCCESS;
+    }
+    CHECK_STATUS(PRED_Get_Report(&app->pred_state, &pred_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "PRD -> "));
+    CHECK_STATUS(FMT_Frame_Append_Floats(frame, pred_q, 4U, " | ", 8U, 4U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | ahead "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, pred_report.horizon_last_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the servo outputs and the sensor-to-actuator latency measured every cycle
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_STAB(App_State_t *app, FMT_Frame_t *frame) {
+    STAB_Report_t stab_report;
+    CHECK_STATUS(STAB_Get_Report(&app->stab_state, &stab_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "STB -> "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.pulse_us[0], 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.pulse_us[1], 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us | lat "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.latency_last_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us min/mean/max "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.latency_min_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.latency_mean_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.latency_max_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | lead "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.lead_last_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us | over "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.over_budget_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | hold "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.hold_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | sat "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, stab_report.saturation_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the accelerometer vibration peaks (frequency @ amplitude) of the latest block
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_SPEC(App_State_t *app, FMT_Frame_t *frame) {
+    static const char *axis_labels[SPEC_AXES] = {" | X", " | Y", " | Z"};
+    SPEC_Report_t spec_report;
+    CHECK_STATUS(SPEC_Get_Report(&app->spec_state, &spec_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "FFT -> "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, spec_report.resolution_hz, 0U, 3U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " Hz"));
+    for (uint8_t axis = 0U; axis < SPEC_AXES; axis++) {
+        SPEC_Peak_t peaks[SPEC_PEAKS_MAX];
+        uint8_t     peak_count = 0U;
+        CHECK_STATUS(SPEC_Get_Peaks(&app->spec_state, axis, peaks, &peak_count));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, axis_labels[axis]));
+        for (uint8_t i = 0U; i < peak_count; i++) {
+            float amplitude = (peaks[i].amplitude / channel_scale[IMU_CHANNEL_ACC]);
+            CHECK_STATUS(FMT_Frame_Append_Str(frame, " "));
+            CHECK_STATUS(FMT_Frame_Append_Float(frame, peaks[i].frequency_hz, 0U, 2U));
+            CHECK_STATUS(FMT_Frame_Append_Str(frame, "@"));
+            CHECK_STATUS(FMT_Frame_Append_Float(frame, amplitude, 0U, 3U));
+        }
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | cyc "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, spec_report.cycles_mean, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, spec_report.cycles_max, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the min/max/mean/rms/variance of each value over the latest window
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_STATS(App_State_t *app, FMT_Frame_t *frame) {
+    for (uint8_t i = 0U; i < app->stats_state.channel_count; i++) {
+        STATS_Summary_t summary;
+        CHECK_STATUS(STATS_Get_Summary(&app->stats_state, i, &summary));
+        float scale = channel_scale[summary.channel];
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "STA -> "));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[summary.channel]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " n "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, summary.count, 0U));
+        for (uint8_t j = 0U; j < summary.values; j++) {
+            float values[5] = {
+                (summary.min[j] / scale), (summary.max[j] / scale),
+                (summary.mean[j] / scale), (summary.rms[j] / scale),
+                (summary.variance[j] / (scale * scale))
+            };
+            CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+            CHECK_STATUS(FMT_Frame_Append_Floats(frame, values, 5U, "/", 0U, 2U));
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the records output and suppressed by the deadband, with the heartbeats among
+ *         them
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_DBAND(App_State_t *app, FMT_Frame_t *frame) {
+    DBAND_Report_t dband_report;
+    CHECK_STATUS(DBAND_Get_Report(&app->dband_state, &dband_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "DBD ->"));
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (app->gov_config.record_bytes[i] == 0U) {
+            continue;
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[i]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, dband_report.emitted_count[i], 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, dband_report.suppressed_count[i], 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " hb "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, dband_report.heartbeat_count[i], 0U));
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the values replaced as spikes and held as duplicates, of those filtered
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_SPIKE(App_State_t *app, FMT_Frame_t *frame) {
+    SPIKE_Report_t spike_report;
+    CHECK_STATUS(SPIKE_Get_Report(&app->spike_state, &spike_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "SPK ->"));
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((app->spike_config.channel_mask >> i) & 1U)) {
+            continue;
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[i]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, spike_report.rejected_count[i], 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, spike_report.sample_count[i], 0U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " held "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, spike_report.held_count[i], 0U));
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the compression ratio of the capture blocks and the encoding cost per value
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_CODEC(App_State_t *app, FMT_Frame_t *frame) {
+    CODEC_Report_t codec_report;
+    CHECK_STATUS(CODEC_Get_Report(&app->codec_state, &codec_report));
+    float ratio      = (codec_report.coded_bytes == 0UL) ? 0.0f
+                     : ((float) codec_report.raw_bytes / (float) codec_report.coded_bytes);
+    float cyc_sample = (codec_report.sample_count == 0UL) ? 0.0f
+                     : ((float) app->cap_cycles / (float) codec_report.sample_count);
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "ZIP -> ratio "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, ratio, 0U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, codec_report.coded_bytes, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " B | frames "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, codec_report.frame_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | key "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, codec_report.key_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | cyc/value "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, cyc_sample, 0U, 1U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the cost of the batch conversions, against both paths on the first batch
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_CONV(App_State_t *app, FMT_Frame_t *frame) {
+    const CONV_Bench_t *conv_bench = &app->conv_bench;
+    CONV_Report_t      conv_report;
+    CHECK_STATUS(CONV_Get_Report(&app->conv_state, &conv_report));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "CNV -> "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, conv_report.value_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " values | cyc/value "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, conv_report.cycles_per_value, 0U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | max "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, conv_report.cycles_max, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | bench "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, conv_bench->value_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " values div/batch "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, conv_bench->divide_cycles, 0U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "/"));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, conv_bench->batch_cycles, 0U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " cyc | err "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, (conv_bench->error_max * 1.0e6f), 0U, 3U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " ppm\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends the magnetometer calibration written to the BNO055
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_MAGCAL(App_State_t *app, FMT_Frame_t *frame) {
+    const MAGCAL_Result_t *magcal_result = &app->magcal_result;
+    float                 offset_ut[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        offset_ut[i] = (magcal_result->offset[i] / BNO_MAG_UT);
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "MCL -> offset "));
+    CHECK_STATUS(FMT_Frame_Append_Floats(frame, offset_ut, 3U, "/", 0U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " uT | field "));
+    CHECK_STATUS(
+        FMT_Frame_Append_Float(frame, (magcal_result->field_lsb / BNO_MAG_UT), 0U, 2U)
+    );
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " uT | ratio "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, magcal_result->axis_ratio, 0U, 3U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | res "));
+    CHECK_STATUS(FMT_Frame_Append_Float(frame, (magcal_result->residual * 100.0f), 0U, 2U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " % | n "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, magcal_result->sample_count, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, app->report_s, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " s\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends a diagnostic report
+ * @param  app:         Pointer to the application state
+ * @param  frame:       Pointer to the output frame
+ * @param  report_line: Report to append, of which REPORT_COUNT appends nothing
+ * @param  imu_frame:   Pointer to the latest frame
+ * @retval Status indicating success or error
+ */
+static Status App_Report_Line(
+    App_State_t       *app,
+    FMT_Frame_t       *frame,
+    Report_Line       report_line,
+    const IMU_Frame_t *imu_frame
+) {
+    switch (report_line) {
+        case REPORT_BUS:    return App_Report_BUS(app, frame, imu_frame);
+        case REPORT_AHRS:   return App_Report_AHRS(app, frame);
+        case REPORT_PRED:   return App_Report_PRED(app, frame);
+        case REPORT_STAB:   return App_Report_STAB(app, frame);
+        case REPORT_SPEC:   return App_Report_SPEC(app, frame);
+        case REPORT_STATS:  return App_Report_STATS(app, frame);
+        case REPORT_DBAND:  return App_Report_DBAND(app, frame);
+        case REPORT_CODEC:  return App_Report_CODEC(app, frame);
+        case REPORT_CONV:   return App_Report_CONV(app, frame);
+        case REPORT_MAGCAL: return App_Report_MAGCAL(app, frame);
+        case REPORT_SPIKE:  return App_Report_SPIKE(app, frame);
+        default:            return SUCCESS;
+    }
+}
+
+/**
+ * @brief  Appends the timestamp and the selected records, or a summary of the highest priority
+ *         channel unless nothing has been accumulated for it since the last summary
+ * @param  app:        Pointer to the application state
+ * @param  frame:      Pointer to the output frame
+ * @param  imu_frame:  Pointer to the latest frame
+ * @param  records:    Pointer to the selected records
+ * @param  gov_report: Pointer to the governor report
+ * @retval Status indicating success or error
+ */
+static Status App_Report_Records(
+    App_State_t            *app,
+    FMT_Frame_t            *frame,
+    const IMU_Frame_t      *imu_frame,
+    const Output_Records_t *records,
+    const GOV_Report_t     *gov_report
+) {
+    if (!records->emit_mask && !records->emit_summary) {
+        return SUCCESS;
+    }
+
+    //timestamp the output with the sample time of the latest frame
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "TS -> "));
+    CHECK_STATUS(FMT_Frame_Append_Uint(frame, imu_frame->sample_us, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us | acq "));
+    CHECK_STATUS(
+        FMT_Frame_Append_Uint(frame, (imu_frame->complete_us - imu_frame->start_us), 0U)
+    );
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " us\n\r"));
+
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((records->emit_mask >> i) & 1U)) {
+            continue;
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[i]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " -> "));
+        if (i == IMU_CHANNEL_QUA) {
+            CHECK_STATUS(FMT_Frame_Append_Uint(frame, records->qua_packed, 0U));
+        } else {
+            CHECK_STATUS(
+                FMT_Frame_Append_Floats(
+                    frame, records->mean_values[i], channel_values[i], " | ", 8U, 4U
+                )
+            );
+        }
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+    }
+
+    IMU_Channel summary_channel = app->summary_channel;
+    uint8_t     summary_count   = channel_values[summary_channel];
+    float       summary_values[IMU_VALUES_MAX];
+    if (records->emit_summary
+    &&  (GOV_Get_Mean(&app->gov_state, summary_channel, summary_values, summary_count)
+         == SUCCESS)) {
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "SUM "));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, channel_labels[summary_channel]));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " -> "));
+        CHECK_STATUS(FMT_Frame_Append_Uint(frame, gov_report->frame_count, 8U));
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
         CHECK_STATUS(
-            USART_Transmit_IRQ(&usart_term_config, data_read_msg, strlen((char *) data_read_msg))
+            FMT_Frame_Append_Floats(frame, summary_values, summary_count, " | ", 8U, 4U)
+        );
+        CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+    }
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+
+    return SUCCESS;
+}
+
+/**
+ * @brief  Appends a block of the frozen capture, of the frames that fit both the credit and the
+ *         output frame, after the trigger and the offset of its first frame from the trigger
+ * @param  app:   Pointer to the application state
+ * @param  frame: Pointer to the output frame
+ * @retval Status indicating success or error
+ * @note   Appends nothing unless the credit and the room left in the frame both cover a line of
+ *         one worst case frame. The compression is reported once the capture has been drained
+ */
+static Status App_Report_CAP(App_State_t *app, FMT_Frame_t *frame) {
+    uint16_t cap_room = (uint16_t) (frame->capacity - frame->length);
+    if (app->cap_credit < cap_room) {
+        cap_room = (uint16_t) app->cap_credit;
+    }
+    if (cap_room < app->cap_line_bytes) {
+        return SUCCESS;
+    }
+
+    CAP_Report_t cap_report;
+    CHECK_STATUS(CAP_Get_Report(&app->cap_state, &cap_report));
+    uint16_t cap_block_capacity = (((cap_room - CAP_HEADER_BYTES) / 4U) * 3U);
+    uint16_t cap_block_length   = 0U;
+    int32_t  cap_offset         = 0L;
+    while (1) {
+        const IMU_Frame_t *cap_frame = NULL;
+        uint16_t          cap_index  = 0U;
+        if (CAP_Peek(&app->cap_state, &cap_frame, &cap_index) != SUCCESS) {
+            break;
+        }
+        if (cap_block_length == 0U) {
+            cap_offset = ((int32_t) cap_index - cap_report.pre_count);
+            CHECK_STATUS(CODEC_Force_Key(&app->codec_state));
+        }
+        uint32_t start_cycles = 0UL;
+        uint32_t end_cycles   = 0UL;
+        CHECK_STATUS(DWT_Get_Cycles(&start_cycles));
+        Status codec_status = CODEC_Encode(
+            &app->codec_state, cap_frame, app->cap_block, cap_block_capacity, &cap_block_length
         );
-        
-        Delay_Loop(20);
+        CHECK_STATUS(DWT_Get_Cycles(&end_cycles));
+        if (codec_status != SUCCESS) {
+            break;
+        }
+        app->cap_cycles += (end_cycles - start_cycles);
+        CHECK_STATUS(CAP_Release(&app->cap_state));
+    }
+
+    uint16_t line_start = frame->length;
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "CAP -> "));
+    CHECK_STATUS(
+        FMT_Frame_Append_Str(
+            frame, ((cap_report.trigger_irq == BNO_IRQ_ACC_HIGH_G) ? "HG " : "AM ")
+        )
+    );
+    CHECK_STATUS(FMT_Frame_Append_Int(frame, cap_offset, 0U));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, " | "));
+    CHECK_STATUS(FMT_Frame_Append_Base64(frame, app->cap_block, cap_block_length));
+    CHECK_STATUS(FMT_Frame_Append_Str(frame, "\n\r"));
+    app->cap_credit -= (uint32_t) (frame->length - line_start);
+
+    //report the compression once the capture has been drained
+    CHECK_STATUS(CAP_Get_Report(&app->cap_state, &cap_report));
+    if (cap_report.capture_state != CAP_STATE_FROZEN) {
+        app->report_mask |= (uint16_t) (1U << REPORT_CODEC);
+    }
+
+    return SUCCESS;
+}
+
+
+int main(void) {
+    static App_State_t app;
+
+    //reset all peripherals
+    Peripheral_Reset();
+
+    //configure system clock
+    CHECK_STATUS(Sys_Clock_Init(HSI_CLOCK));
+
+    //configure systick time-base
+    CHECK_STATUS(Systick_Init(SYSTICK_UNIT_MSEC));
+
+    //configure 64-bit micro-second timestamps
+    CHECK_STATUS(DWT_Init());
+
+    GPIO_Reset_Pin(GPIOC, GPIO_PIN_13);
+    CHECK_STATUS(App_GPIO_Init());
+
+    //configure USART1 to communicate with the terminal
+    USART_Config_t usart_term_config = {
+        .instance         = USART1,
+        .baud_rate        = 115200,
+        .irq_priority     = 1
+    };
+    app.usart_term_config = usart_term_config;
+    CHECK_STATUS(USART_Init(&app.usart_term_config));
+
+    //configure USART2 to communicate with BNO055
+    USART_Config_t usart_bno_config = {
+        .instance         = USART2,
+        .baud_rate        = 115200,
+        .irq_priority     = 2
+    };
+    app.usart_bno_config = usart_bno_config;
+    CHECK_STATUS(USART_Init(&app.usart_bno_config));
+
+    Delay_Loop(2000);
+
+    //bring up the BNO055, then each feature in the order of the data through it
+    CHECK_STATUS(App_BNO_Init(&app));
+    CHECK_STATUS(App_Sched_Init(&app));
+    CHECK_STATUS(App_Events_Init(&app));
+    CHECK_STATUS(App_Output_Init(&app));
+    CHECK_STATUS(App_Fusion_Init(&app));
+    CHECK_STATUS(App_Analysis_Init(&app));
+    CHECK_STATUS(App_Acq_Init(&app));
+
+    const IMU_Frame_t *batch      = NULL;
+    uint16_t          batch_count = 0U;
+    uint16_t          batch_index = 0U;
+    while (1) {
+        //service motion interrupts while no frame is using the bus
+        uint8_t evt_pending = 0U;
+        CHECK_STATUS(EVT_Get_Pending(&app.evt_state, &evt_pending));
+        if (evt_pending && (SCHED_Lock_Bus(&app.sched_state) == SUCCESS)) {
+            uint64_t now_us = 0ULL;
+            CHECK_STATUS(DWT_Get_Time_US(&now_us));
+            Status evt_status = EVT_Poll(&app.evt_state, now_us);
+
+            //read the acceleration at the events through the cache, as a burst of interrupts
+            //within one accelerometer update would otherwise read the same values again
+            if ((evt_status == SUCCESS) && app.motion_events.pending_mask) {
+                evt_status = BNO_Get_ACC_XYZ_Cached(
+                    &app.usart_bno_config, EVT_ACC_MAX_AGE_US, &app.motion_events.acc
+                );
+            }
+            CHECK_STATUS(SCHED_Unlock_Bus(&app.sched_state));
+            CHECK_STATUS(evt_status);
+        }
+
+        //write a converged magnetometer calibration while no frame is using the bus
+        if (app.magcal_pending && (SCHED_Lock_Bus(&app.sched_state) == SUCCESS)) {
+            Status magcal_status = BNO_Set_MAG_SIC_Offset(
+                &app.usart_bno_config, &app.magcal_sic, &app.magcal_offset
+            );
+            CHECK_STATUS(SCHED_Unlock_Bus(&app.sched_state));
+            CHECK_STATUS(magcal_status);
+            app.magcal_pending = 0U;
+            app.magcal_done    = 1U;
+            app.report_mask   |= (uint16_t) (1U << REPORT_MAGCAL);
+        }
+
+        //release the processed batch, then take the frames queued since in a single batch
+        if (batch_index == batch_count) {
+            CHECK_STATUS(RING_Release(&app.ring_state, batch_count));
+            CHECK_STATUS(RING_Peek_Batch(&app.ring_state, &batch, &batch_count));
+            batch_index = 0U;
+            if (batch_count == 0U) {
+                continue;
+            }
+            if (app.conv_bench.value_count == 0U) {
+                CHECK_STATUS(
+                    CONV_Benchmark(
+                        &app.conv_state, batch, batch_count, &app.conv_block, &app.conv_bench
+                    )
+                );
+            } else {
+                CHECK_STATUS(CONV_Gather(&app.conv_state, batch, batch_count, &app.conv_block));
+                CHECK_STATUS(CONV_Convert(&app.conv_state, &app.conv_block));
+            }
+        }
+        uint16_t          frame_index = batch_index++;
+        const IMU_Frame_t *imu_frame  = &batch[frame_index];
+        CHECK_STATUS(App_Process_Frame(&app, imu_frame, frame_index));
+
+        //let the governor decide what fits the link in this frame
+        uint16_t tx_pending = 0U;
+        CHECK_STATUS(USART_Get_TX_Pending(&app.usart_term_config, &tx_pending));
+        CHECK_STATUS(GOV_Begin_Frame(&app.gov_state, tx_pending));
+        GOV_Report_t gov_report;
+        CHECK_STATUS(GOV_Get_Report(&app.gov_state, &gov_report));
+        Output_Records_t records;
+        CHECK_STATUS(App_Select_Records(&app, imu_frame, &records));
+
+        //accumulate the unused link capacity for a frozen capture, one frame period at a time
+        CAP_Report_t cap_report;
+        CHECK_STATUS(CAP_Get_Report(&app.cap_state, &cap_report));
+        if (cap_report.capture_state != CAP_STATE_FROZEN) {
+            app.cap_credit = 0UL;
+        } else if ((gov_report.budget_bps > gov_report.demand_bps)
+               &&  (app.cap_credit < TX_BUFFER_SIZE)) {
+            app.cap_credit += ((gov_report.budget_bps - gov_report.demand_bps)
+                            / app.gov_config.frame_rate_hz);
+        }
+        uint8_t drain_capture = (app.cap_credit >= app.cap_line_bytes);
+
+        if ((records.emit_mask == 0U) && (records.emit_summary == 0U)
+        &&  (gov_report.changed == 0U) && (app.report_mask == 0U)
+        &&  (app.motion_events.pending_mask == 0U) && (drain_capture == 0U)) {
+            continue;
+        }
+
+        //skip this frame if the previous one is still being transmitted
+        uint8_t *tx_buffer = NULL;
+        if (USART_Get_TX_Buffer(&app.usart_term_config, &tx_buffer) != SUCCESS) {
+            continue;
+        }
+
+        //compose message directly in the USART1 TX buffer
+        FMT_Frame_t frame;
+        CHECK_STATUS(FMT_Frame_Init(&frame, tx_buffer, TX_BUFFER_SIZE));
+
+        //take the first queued diagnostic report, so each frame carries at most one
+        Report_Line report_line = REPORT_COUNT;
+        for (uint8_t i = 0U; i < REPORT_COUNT; i++) {
+            if ((app.report_mask >> i) & 1U) {
+                report_line      = (Report_Line) i;
+                app.report_mask &= (uint16_t) ~(1U << i);
+                break;
+            }
+        }
+
+        if (gov_report.changed) {
+            CHECK_STATUS(App_Report_GOV(&app, &frame, &gov_report));
+        }
+        if (app.motion_events.pending_mask) {
+            CHECK_STATUS(App_Report_EVT(&app, &frame));
+        }
+        CHECK_STATUS(App_Report_Line(&app, &frame, report_line, imu_frame));
+        CHECK_STATUS(App_Report_Records(&app, &frame, imu_frame, &records, &gov_report));
+        if (drain_capture) {
+            CHECK_STATUS(App_Report_CAP(&app, &frame));
+        }
+
+        //transmit message, then acknowledge the plan change and latch the records it carries
+        CHECK_STATUS(USART_Transmit_Buffer_IRQ(&app.usart_term_config, frame.length));
+        if (gov_report.changed) {
+            CHECK_STATUS(GOV_Clear_Changed(&app.gov_state));
+        }
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if ((records.emit_mask >> i) & 1U) {
+                CHECK_STATUS(
+                    DBAND_Commit(
+                        &app.dband_state, i, records.mean_values[i], channel_values[i],
+                        imu_frame->sample_us
+                    )
+                );
+            }
+        }
     }
 }
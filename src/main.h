@@ -13,10 +13,31 @@
 
 
 #include "../lib/utils/utils.h"
+#include "../lib/utils/fmt.h"
 #include "../lib/drivers/gpio/gpio.h"
+#include "../lib/drivers/dwt/dwt.h"
+#include "../lib/drivers/exti/exti.h"
 #include "../lib/drivers/tim1/tim1.h"
 #include "../lib/drivers/usart/usart.h"
 #include "../lib/drivers/bno055/bno.h"
+#include "../lib/imu/events/events.h"
+#include "../lib/imu/ahrs/ahrs.h"
+#include "../lib/imu/capture/capture.h"
+#include "../lib/imu/codec/codec.h"
+#include "../lib/imu/convert/convert.h"
+#include "../lib/imu/deadband/deadband.h"
+#include "../lib/imu/decimate/decimate.h"
+#include "../lib/imu/despike/despike.h"
+#include "../lib/imu/governor/governor.h"
+#include "../lib/imu/magcal/magcal.h"
+#include "../lib/imu/orient/orient.h"
+#include "../lib/imu/predict/predict.h"
+#include "../lib/imu/stabilise/stabilise.h"
+#include "../lib/imu/ring/ring.h"
+#include "../lib/imu/snapshot/snapshot.h"
+#include "../lib/imu/spectrum/spectrum.h"
+#include "../lib/imu/stats/stats.h"
+#include "../lib/imu/scheduler/scheduler.h"
 
 
 
@@ -0,0 +1,257 @@
+/**
+ * @file    test_codec.c
+ * @brief   Lossless Delta Frame Codec Tests
+ * @details This source file checks the delta frame codec on the host: the exact round trip of a
+ *          random walk and its compression ratio, the detection of lost frames and the
+ *          resynchronisation on key frames, including after a gap the sequence number wraps over.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/codec/codec.c"
+
+#define TEST_SEED                   0x9E3779B9UL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+#define TEST_CHANNEL_MASK   ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_MAG) \
+                          |  (1U << IMU_CHANNEL_GYR))
+#define TEST_FRAMES         64U
+
+static IMU_Frame_t test_frames[TEST_FRAMES];
+
+/**
+ * @brief  Fills the test frames with a random walk of the ACC, MAG and GYR channels at 100 Hz
+ * @param  step: Largest change of a value between frames
+ * @retval None
+ */
+static void Test_Random_Walk(int16_t step) {
+    int16_t value[IMU_CHANNEL_COUNT][IMU_VALUES_MAX] = {{0}};
+    memset(test_frames, 0, sizeof(test_frames));
+    for (uint16_t n = 0U; n < TEST_FRAMES; n++) {
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if (!((TEST_CHANNEL_MASK >> i) & 1U)) {
+                continue;
+            }
+            for (uint8_t j = 0U; j < 3U; j++) {
+                int32_t delta = ((int32_t) (Test_Random() % (2U * step + 1U)) - step);
+                value[i][j]  = (int16_t) (value[i][j] + delta);
+                test_frames[n].data[i][j] = value[i][j];
+            }
+        }
+        test_frames[n].updated_mask = TEST_CHANNEL_MASK;
+        test_frames[n].sample_us    = (1000000ULL + (10000ULL * n) + (Test_Random() % 200U));
+    }
+}
+
+/**
+ * @brief  Checks that a decoded frame matches the frame that was encoded
+ * @param  expected: Pointer to the encoded frame
+ * @param  actual:   Pointer to the decoded frame
+ * @retval None
+ */
+static void Test_Frame_Matches(const IMU_Frame_t *expected, const IMU_Frame_t *actual) {
+    TEST_ASSERT_EQUAL_HEX16(TEST_CHANNEL_MASK, actual->updated_mask);
+    TEST_ASSERT_TRUE(expected->sample_us == actual->sample_us);
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if ((TEST_CHANNEL_MASK >> i) & 1U) {
+            TEST_ASSERT_EQUAL_INT16_ARRAY(expected->data[i], actual->data[i], 3U);
+        }
+    }
+}
+
+/**
+ * @brief  Decodes every frame of a buffer
+ * @param  decoder: Pointer to the decoder state
+ * @param  buffer:  Pointer to the encoded frames
+ * @param  length:  Number of bytes in the buffer
+ * @param  frames:  Pointer to an array used to store the decoded frames
+ * @retval Number of frames decoded
+ */
+static uint16_t Test_Decode_All(
+    CODEC_State_t *decoder,
+    const uint8_t *buffer,
+    uint16_t      length,
+    IMU_Frame_t   *frames
+) {
+    uint16_t count = 0U;
+    uint16_t index = 0U;
+    while (index < length) {
+        uint16_t consumed = 0U;
+        TEST_ASSERT_EQUAL_INT(
+            SUCCESS,
+            CODEC_Decode(decoder, &buffer[index], (uint16_t) (length - index), &consumed,
+                         &frames[count])
+        );
+        index += consumed;
+        count++;
+    }
+    return count;
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_round_trip_random_walk(void) {
+    static const int16_t steps[] = {8, 128, 32767};
+    CODEC_Config_t       config  = {.channel_mask = TEST_CHANNEL_MASK};
+    for (uint8_t s = 0U; s < 3U; s++) {
+        CODEC_State_t encoder;
+        CODEC_State_t decoder;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&encoder, &config));
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&decoder, &config));
+        Test_Random_Walk(steps[s]);
+
+        static uint8_t buffer[TEST_FRAMES * 64U];
+        uint16_t       length = 0U;
+        for (uint16_t n = 0U; n < TEST_FRAMES; n++) {
+            TEST_ASSERT_EQUAL_INT(
+                SUCCESS, CODEC_Encode(&encoder, &test_frames[n], buffer, sizeof(buffer), &length)
+            );
+        }
+
+        static IMU_Frame_t decoded[TEST_FRAMES];
+        TEST_ASSERT_EQUAL_UINT16(TEST_FRAMES, Test_Decode_All(&decoder, buffer, length, decoded));
+        for (uint16_t n = 0U; n < TEST_FRAMES; n++) {
+            Test_Frame_Matches(&test_frames[n], &decoded[n]);
+        }
+
+        //every frame is at most frame_bytes_max. Steps within +-63 take one byte per value, which
+        //halves the frames, while larger steps take two and the full range three
+        CODEC_Report_t report;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Get_Report(&encoder, &report));
+        TEST_ASSERT_TRUE(report.coded_bytes <= (TEST_FRAMES * report.frame_bytes_max));
+        TEST_ASSERT_EQUAL_UINT32(TEST_FRAMES * 9UL, report.sample_count);
+        TEST_ASSERT_EQUAL_UINT32(0UL, decoder.lost_count);
+        char  message[48];
+        float ratio = ((float) report.raw_bytes / (float) report.coded_bytes);
+        snprintf(message, sizeof(message), "step %d: ratio %.2f", steps[s], (double) ratio);
+        TEST_MESSAGE(message);
+        if (steps[s] <= 63) {
+            TEST_ASSERT_TRUE_MESSAGE(ratio > 1.9f, message);
+        }
+    }
+}
+
+static void test_lost_frame_skips_to_key(void) {
+    CODEC_Config_t config = {.channel_mask = TEST_CHANNEL_MASK, .key_interval = 16U};
+    CODEC_State_t  encoder;
+    CODEC_State_t  decoder;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&encoder, &config));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&decoder, &config));
+    Test_Random_Walk(8);
+
+    //drop frame 5, so frames 6 to 15 are skipped and frame 16 (a key frame) resynchronises
+    for (uint16_t n = 0U; n < 20U; n++) {
+        uint8_t  buffer[64];
+        uint16_t length = 0U;
+        TEST_ASSERT_EQUAL_INT(
+            SUCCESS, CODEC_Encode(&encoder, &test_frames[n], buffer, sizeof(buffer), &length)
+        );
+        if (n == 5U) {
+            continue;
+        }
+        IMU_Frame_t frame;
+        uint16_t    consumed = 0U;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Decode(&decoder, buffer, length, &consumed, &frame));
+        TEST_ASSERT_EQUAL_UINT16(length, consumed);
+        if ((n > 5U) && (n < 16U)) {
+            TEST_ASSERT_EQUAL_HEX16(0U, frame.updated_mask);
+        } else {
+            Test_Frame_Matches(&test_frames[n], &frame);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(1UL, decoder.lost_count);
+    TEST_ASSERT_EQUAL_UINT32(10UL, decoder.skipped_count);
+}
+
+static void test_forced_key_survives_wrapped_gap(void) {
+    CODEC_Config_t config = {.channel_mask = TEST_CHANNEL_MASK};
+    CODEC_State_t  encoder;
+    CODEC_State_t  decoder;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&encoder, &config));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&decoder, &config));
+    Test_Random_Walk(8);
+
+    //encode blocks of 16 frames, each starting on a forced key frame, and lose the second block,
+    //which leaves the sequence number of the third block exactly as expected
+    static uint8_t blocks[4][16U * 64U];
+    uint16_t       lengths[4] = {0U};
+    for (uint8_t b = 0U; b < 4U; b++) {
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Force_Key(&encoder));
+        for (uint16_t n = 0U; n < 16U; n++) {
+            TEST_ASSERT_EQUAL_INT(
+                SUCCESS,
+                CODEC_Encode(&encoder, &test_frames[(b * 16U) + n], blocks[b], sizeof(blocks[b]),
+                             &lengths[b])
+            );
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(4UL, encoder.key_count);
+
+    for (uint8_t b = 0U; b < 4U; b++) {
+        if (b == 1U) {
+            continue;
+        }
+        static IMU_Frame_t decoded[16];
+        TEST_ASSERT_EQUAL_UINT16(16U, Test_Decode_All(&decoder, blocks[b], lengths[b], decoded));
+        for (uint16_t n = 0U; n < 16U; n++) {
+            Test_Frame_Matches(&test_frames[(b * 16U) + n], &decoded[n]);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0UL, decoder.skipped_count);
+}
+
+static void test_truncated_frame(void) {
+    CODEC_Config_t config = {.channel_mask = TEST_CHANNEL_MASK};
+    CODEC_State_t  encoder;
+    CODEC_State_t  decoder;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&encoder, &config));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Init(&decoder, &config));
+    Test_Random_Walk(32767);
+
+    uint8_t  buffer[64];
+    uint16_t length = 0U;
+    TEST_ASSERT_EQUAL_INT(
+        SUCCESS, CODEC_Encode(&encoder, &test_frames[0], buffer, sizeof(buffer), &length)
+    );
+
+    //a frame cut short is refused without consuming it, and then decodes in full
+    IMU_Frame_t frame;
+    uint16_t    consumed = 0U;
+    TEST_ASSERT_EQUAL_INT(
+        ERROR, CODEC_Decode(&decoder, buffer, (uint16_t) (length - 1U), &consumed, &frame)
+    );
+    TEST_ASSERT_EQUAL_UINT32(0UL, decoder.frame_count);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CODEC_Decode(&decoder, buffer, length, &consumed, &frame));
+    Test_Frame_Matches(&test_frames[0], &frame);
+
+    //a buffer with less than frame_bytes_max free is refused without encoding
+    uint16_t full = (uint16_t) (sizeof(buffer) - encoder.frame_bytes_max + 1U);
+    TEST_ASSERT_EQUAL_INT(
+        ERROR, CODEC_Encode(&encoder, &test_frames[1], buffer, sizeof(buffer), &full)
+    );
+    TEST_ASSERT_EQUAL_UINT32(1UL, encoder.frame_count);
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_random_walk);
+    RUN_TEST(test_lost_frame_skips_to_key);
+    RUN_TEST(test_forced_key_survives_wrapped_gap);
+    RUN_TEST(test_truncated_frame);
+    return UNITY_END();
+}
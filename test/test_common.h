@@ -0,0 +1,38 @@
+/**
+ * @file    test_common.h
+ * @brief   Common Test Helpers
+ * @details This header file contains the helpers shared by the host tests. It includes the
+ *          xorshift generator used to draw reproducible test data, seeded with TEST_SEED, which
+ *          each test defines before including this file so its sequence does not depend on the
+ *          other tests.
+ */
+
+
+#ifndef __TEST_COMMON_H
+#define __TEST_COMMON_H
+
+#include <stdint.h>
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+#ifndef TEST_SEED
+    #define TEST_SEED               0x12345678UL
+#endif
+
+static uint32_t test_seed = TEST_SEED;
+
+/**
+ * @brief  Gets the next value of a xorshift generator
+ * @retval Pseudo-random value
+ */
+static uint32_t Test_Random(void) {
+    test_seed ^= (test_seed << 13);
+    test_seed ^= (test_seed >> 17);
+    test_seed ^= (test_seed << 5);
+    return test_seed;
+}
+
+#endif
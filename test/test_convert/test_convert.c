@@ -0,0 +1,250 @@
+/**
+ * @file    test_convert.c
+ * @brief   Batch Raw to Unit Conversion Tests
+ * @details This source file checks the batch conversion on the host: the product by the
+ *          reciprocal against the per-sample division over the whole int16 range at each BNO055
+ *          scale, to the one unit in the last place and 1.2e-7 relative error stated in
+ *          convert.c, and CONV_Gather() with CONV_Convert() against the division on the two
+ *          batches of a ring that wraps, along with the cost report and invalid settings. The DWT
+ *          cycle counter is replaced with a counter of calls.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/drivers/bno055/bno.h"
+#include "../../lib/imu/ring/ring.c"
+#include "../../lib/imu/convert/convert.c"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+#define TEST_SWEEP_CHUNK            4096U
+#define TEST_ERROR_MAX              (1.2e-7)
+
+static uint32_t test_cycles = 0UL;
+
+static const float test_scales[] = {
+    BNO_ACC_MS, BNO_ACC_MG, BNO_MAG_UT, BNO_GYR_DPS, BNO_GYR_RPS, BNO_EUL_DEGREES,
+    BNO_EUL_RADIANS, BNO_QUA_QUATERNIONS, BNO_TEMP_CEL, BNO_TEMP_FAH
+};
+static const float test_channel_scale[IMU_CHANNEL_COUNT] = {
+    BNO_ACC_MS, BNO_MAG_UT, BNO_GYR_DPS, BNO_LIA_MS, BNO_GRV_MS, BNO_EUL_DEGREES,
+    BNO_QUA_QUATERNIONS, BNO_TEMP_CEL, 1.0f
+};
+
+/**
+ * @brief  Stands in for the DWT cycle counter, advancing by 1000 cycles per call
+ * @param  cycles: Pointer to a variable used to store the cycle count
+ * @retval Status indicating success
+ */
+Status DWT_Get_Cycles(uint32_t *cycles) {
+    test_cycles += 1000UL;
+    *cycles      = test_cycles;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Gets the distance between two floats of the same sign, in units in the last place
+ * @param  a: First value
+ * @param  b: Second value
+ * @retval Distance in units in the last place
+ */
+static uint32_t Test_ULP(float a, float b) {
+    int32_t bits_a;
+    int32_t bits_b;
+    memcpy(&bits_a, &a, sizeof(bits_a));
+    memcpy(&bits_b, &b, sizeof(bits_b));
+    return (bits_a > bits_b) ? (uint32_t) (bits_a - bits_b) : (uint32_t) (bits_b - bits_a);
+}
+
+/**
+ * @brief  Gets a raw value of a frame, unique to its position in the sequence of frames
+ * @param  index:   Index of the frame in the sequence
+ * @param  channel: Channel
+ * @param  value:   Index of the value in the channel
+ * @retval Raw value
+ */
+static int16_t Test_Raw(uint16_t index, uint8_t channel, uint8_t value) {
+    return (int16_t) (((uint32_t) index * 7919UL) + ((uint32_t) channel * 1031UL)
+                    + ((uint32_t) value * 257UL));
+}
+
+/**
+ * @brief  Checks a converted block against the per-sample division of its frames
+ * @param  state:  Pointer to the conversion state
+ * @param  block:  Pointer to the converted block
+ * @param  frames: Pointer to the frames the block was gathered from
+ * @retval None
+ */
+static void Test_Check_Block(
+    const CONV_State_t *state,
+    const CONV_Block_t *block,
+    const IMU_Frame_t  *frames
+) {
+    for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+        if (!((state->config.channel_mask >> i) & 1U)) {
+            continue;
+        }
+        for (uint8_t j = 0U; j < state->values[i]; j++) {
+            for (uint16_t k = 0U; k < block->count; k++) {
+                TEST_ASSERT_EQUAL_INT16(frames[k].data[i][j], block->raw[i][j][k]);
+                float quotient = ((float) frames[k].data[i][j] / state->config.scale[i]);
+                TEST_ASSERT_TRUE(Test_ULP(block->value[i][j][k], quotient) <= 1UL);
+            }
+        }
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_scale_int16_sweep(void) {
+    static int16_t raw[TEST_SWEEP_CHUNK];
+    static float   value[TEST_SWEEP_CHUNK];
+    for (uint8_t s = 0U; s < (sizeof(test_scales) / sizeof(test_scales[0])); s++) {
+        float    scale      = test_scales[s];
+        float    reciprocal = (1.0f / scale);
+        uint32_t ulp_max    = 0UL;
+        double   error_max  = 0.0;
+        for (int32_t base = INT16_MIN; base <= INT16_MAX; base += (int32_t) TEST_SWEEP_CHUNK) {
+            for (uint16_t k = 0U; k < TEST_SWEEP_CHUNK; k++) {
+                raw[k] = (int16_t) (base + k);
+            }
+
+            //an odd count also covers the values converted after the unrolled groups
+            uint16_t count = (uint16_t) (TEST_SWEEP_CHUNK - ((base == INT16_MIN) ? 1U : 0U));
+            TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Scale(raw, value, count, reciprocal));
+            for (uint16_t k = 0U; k < count; k++) {
+                float quotient = ((float) raw[k] / scale);
+                if (quotient == 0.0f) {
+                    TEST_ASSERT_EQUAL_FLOAT(0.0f, value[k]);
+                    continue;
+                }
+                uint32_t ulp   = Test_ULP(value[k], quotient);
+                double   error = fabs(((double) value[k] - quotient) / quotient);
+                ulp_max        = (ulp > ulp_max) ? ulp : ulp_max;
+                error_max      = (error > error_max) ? error : error_max;
+            }
+        }
+        char message[64];
+        snprintf(message, sizeof(message), "scale %g: %u ulp, %.3g relative",
+                 scale, ulp_max, error_max);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE_MESSAGE(ulp_max <= 1UL, message);
+        TEST_ASSERT_TRUE_MESSAGE(error_max <= TEST_ERROR_MAX, message);
+    }
+}
+
+static void test_convert_wrapped_ring(void) {
+    static RING_State_t ring;
+    static CONV_State_t state;
+    static CONV_Block_t block;
+    CONV_Config_t config = {
+        .channel_mask = (uint16_t) ~((uint16_t) ~0U << IMU_CHANNEL_COUNT)
+                      & (uint16_t) ~(1U << IMU_CHANNEL_MAG)
+    };
+    memcpy(config.scale, test_channel_scale, sizeof(config.scale));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, RING_Init(&ring));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Init(&state, &config));
+
+    //move the tail near the last slot, so the next frames wrap to the start of the ring
+    const uint16_t batch_first = 5U;
+    const uint16_t batch_count = 12U;
+    IMU_Frame_t    frame       = {0};
+    for (uint16_t k = 0U; k < (RING_CAPACITY - batch_first); k++) {
+        TEST_ASSERT_EQUAL_INT(SUCCESS, RING_Push(&ring, &frame));
+    }
+    TEST_ASSERT_EQUAL_INT(SUCCESS, RING_Release(&ring, (RING_CAPACITY - batch_first)));
+    for (uint16_t k = 0U; k < batch_count; k++) {
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            for (uint8_t j = 0U; j < IMU_VALUES_MAX; j++) {
+                frame.data[i][j] = Test_Raw(k, i, j);
+            }
+        }
+        TEST_ASSERT_EQUAL_INT(SUCCESS, RING_Push(&ring, &frame));
+    }
+
+    //the queued frames are taken in two batches, split at the last slot
+    const uint16_t expected[2] = {batch_first, (batch_count - batch_first)};
+    uint16_t       taken       = 0U;
+    uint32_t       value_count = 0UL;
+    for (uint8_t b = 0U; b < 2U; b++) {
+        const IMU_Frame_t *batch = NULL;
+        uint16_t          count  = 0U;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, RING_Peek_Batch(&ring, &batch, &count));
+        TEST_ASSERT_EQUAL_UINT16(expected[b], count);
+        TEST_ASSERT_EQUAL_INT16(Test_Raw(taken, IMU_CHANNEL_ACC, 0U),
+                                batch[0].data[IMU_CHANNEL_ACC][0]);
+
+        block.value[IMU_CHANNEL_MAG][0][0] = -1.0f;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Gather(&state, batch, count, &block));
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Convert(&state, &block));
+        TEST_ASSERT_EQUAL_UINT16(count, block.count);
+        Test_Check_Block(&state, &block, batch);
+        TEST_ASSERT_EQUAL_FLOAT(-1.0f, block.value[IMU_CHANNEL_MAG][0][0]);
+
+        //the benchmark compares the same batch with the division
+        CONV_Bench_t bench;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Benchmark(&state, batch, count, &block, &bench));
+        TEST_ASSERT_TRUE(bench.error_max <= (float) TEST_ERROR_MAX);
+        Test_Check_Block(&state, &block, batch);
+
+        TEST_ASSERT_EQUAL_INT(SUCCESS, RING_Release(&ring, count));
+        taken       += count;
+        for (uint8_t i = 0U; i < IMU_CHANNEL_COUNT; i++) {
+            if ((config.channel_mask >> i) & 1U) {
+                value_count += ((uint32_t) state.values[i] * count);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(batch_count, taken);
+
+    //only the CONV_Convert() calls are reported, each of them between two counter reads
+    CONV_Report_t report;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Get_Report(&state, &report));
+    TEST_ASSERT_EQUAL_UINT32(value_count, report.value_count);
+    TEST_ASSERT_EQUAL_UINT32(1000UL, report.cycles_max);
+    TEST_ASSERT_EQUAL_FLOAT((2000.0f / (float) value_count), report.cycles_per_value);
+}
+
+static void test_init_rejects_invalid_settings(void) {
+    static CONV_State_t state;
+    static CONV_Block_t block;
+    IMU_Frame_t   frames[1] = {0};
+    CONV_Config_t config    = {0};
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, CONV_Init(&state, &config));
+    config.channel_mask = (uint16_t) (1U << IMU_CHANNEL_COUNT);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, CONV_Init(&state, &config));
+    config.channel_mask = (uint16_t) (1U << IMU_CHANNEL_ACC);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, CONV_Init(&state, &config));
+    config.scale[IMU_CHANNEL_ACC] = BNO_ACC_MS;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Init(&state, &config));
+    TEST_ASSERT_EQUAL_INT(
+        INVALID_PARAM, CONV_Gather(&state, frames, (CONV_FRAMES_MAX + 1U), &block)
+    );
+
+    //only the channels with a scale have a reciprocal
+    float reciprocal = 0.0f;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, CONV_Get_Reciprocal(&state, IMU_CHANNEL_ACC, &reciprocal));
+    TEST_ASSERT_EQUAL_FLOAT((1.0f / BNO_ACC_MS), reciprocal);
+    TEST_ASSERT_EQUAL_INT(ERROR, CONV_Get_Reciprocal(&state, IMU_CHANNEL_MAG, &reciprocal));
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_scale_int16_sweep);
+    RUN_TEST(test_convert_wrapped_ring);
+    RUN_TEST(test_init_rejects_invalid_settings);
+    return UNITY_END();
+}
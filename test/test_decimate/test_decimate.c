@@ -0,0 +1,246 @@
+/**
+ * @file    test_decimate.c
+ * @brief   Anti-Aliased Decimator Tests
+ * @details This source file checks the anti-aliased decimator on the host against the response
+ *          stated in decimate.c: its DC gain, the ripple of its passband, the rejection of the
+ *          components that would alias into the passband, and the time stamps of its outputs
+ *          against delay_samples. The DWT cycle counter is replaced with a counter of calls.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/decimate/decimate.c"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+#define TEST_PERIOD_US              1000U
+#define TEST_AMPLITUDE              16000.0
+#define TEST_SETTLE                 64U
+#define TEST_OUTPUTS                256U
+
+static uint32_t test_cycles = 0UL;
+
+/**
+ * @brief  Stands in for the DWT cycle counter, advancing by 1000 cycles per call
+ * @param  cycles: Pointer to a variable used to store the cycle count
+ * @retval Status indicating success
+ */
+Status DWT_Get_Cycles(uint32_t *cycles) {
+    test_cycles += 1000UL;
+    *cycles      = test_cycles;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Sets the first accelerometer value and sample time of a frame at 1 kHz
+ * @param  frame: Pointer to the frame
+ * @param  n:     Index of the sample
+ * @param  value: Value of the first axis
+ * @retval None
+ */
+static void Test_Frame_ACC(IMU_Frame_t *frame, uint32_t n, int16_t value) {
+    memset(frame, 0, sizeof(IMU_Frame_t));
+    frame->updated_mask             = (1U << IMU_CHANNEL_ACC);
+    frame->sample_us                = (1000000ULL + ((uint64_t) TEST_PERIOD_US * n));
+    frame->data[IMU_CHANNEL_ACC][0] = value;
+}
+
+/**
+ * @brief  Measures the gain of the decimator for a tone
+ * @param  factor:    Decimation factor
+ * @param  frequency: Frequency of the tone, in multiples of the output rate
+ * @retval Gain, in dB, of the component at the alias of the tone in the output
+ * @note   The alias is a whole number of cycles over TEST_OUTPUTS outputs, so correlating the
+ *         outputs with it measures its amplitude without leakage
+ */
+static double Test_Gain_dB(uint8_t factor, double frequency) {
+    static DEC_State_t state;
+    DEC_Config_t       config = {.channel_mask = (1U << IMU_CHANNEL_ACC), .factor = factor};
+    TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Init(&state, &config));
+
+    double   alias = fabs(frequency - round(frequency));
+    double   re    = 0.0;
+    double   im    = 0.0;
+    uint32_t count = 0UL;
+    for (uint32_t n = 0UL; count < (TEST_SETTLE + TEST_OUTPUTS); n++) {
+        double      x = (TEST_AMPLITUDE * sin((2.0 * M_PI * frequency * (double) n) / factor));
+        IMU_Frame_t frame;
+        uint16_t    ready_mask = 0U;
+        Test_Frame_ACC(&frame, n, (int16_t) lround(x));
+        TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Push(&state, &frame, &ready_mask));
+        if (ready_mask == 0U) {
+            continue;
+        }
+        if (count >= TEST_SETTLE) {
+            double y     = (double) state.channels[0].output[0];
+            double phase = (2.0 * M_PI * alias * (double) (count - TEST_SETTLE));
+            re += (y * cos(phase));
+            im += (y * sin(phase));
+        }
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0UL, state.saturation_count);
+
+    double amplitude = ((2.0 * sqrt((re * re) + (im * im))) / (double) TEST_OUTPUTS);
+    return (20.0 * log10((amplitude / TEST_AMPLITUDE) + 1e-9));
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_unit_dc_gain(void) {
+    static DEC_State_t state;
+    DEC_Config_t       config = {.channel_mask = (1U << IMU_CHANNEL_ACC), .factor = 8U};
+    TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Init(&state, &config));
+
+    //a step between two levels, held until the outputs settle on each
+    const int16_t levels[2] = {12000, -9000};
+    uint32_t      n         = 0UL;
+    for (uint8_t i = 0U; i < 2U; i++) {
+        for (uint16_t count = 0U; count < 40U; n++) {
+            IMU_Frame_t frame;
+            uint16_t    ready_mask = 0U;
+            Test_Frame_ACC(&frame, n, levels[i]);
+            TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Push(&state, &frame, &ready_mask));
+            count += (ready_mask != 0U);
+        }
+        TEST_ASSERT_INT_WITHIN(2, levels[i], state.channels[0].output[0]);
+    }
+}
+
+static void test_flat_passband(void) {
+    //within 0.05 dB up to a third of the output rate, for each factor
+    const uint8_t factors[3] = {4U, 8U, 16U};
+    for (uint8_t i = 0U; i < 3U; i++) {
+        double gain_min = 0.0;
+        double gain_max = -100.0;
+        for (uint16_t k = 4U; k <= (TEST_OUTPUTS / 3U); k += 4U) {
+            double gain = Test_Gain_dB(factors[i], ((double) k / (double) TEST_OUTPUTS));
+            gain_min = (gain < gain_min) ? gain : gain_min;
+            gain_max = (gain > gain_max) ? gain : gain_max;
+        }
+        char message[64];
+        snprintf(message, sizeof(message), "factor %u: passband %.3f to %.3f dB",
+                 factors[i], gain_min, gain_max);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE(gain_min > -0.05);
+        TEST_ASSERT_TRUE(gain_max < 0.05);
+    }
+}
+
+static void test_rejects_aliases(void) {
+    //tones that alias below 0.3 of the output rate: near odd multiples of the output rate the FIR
+    //stage rejects them by over 80 dB, and near multiples of the CIC output rate the CIC stage
+    //alone by at least 37 dB for a factor of 4 and 43 dB for factors of 8 or more
+    const uint8_t factors[3] = {4U, 8U, 16U};
+    for (uint8_t i = 0U; i < 3U; i++) {
+        double fir_worst = -200.0;
+        double cic_worst = -200.0;
+        for (uint8_t multiple = 1U; multiple <= (factors[i] / 2U); multiple++) {
+            for (int16_t k = -76; k <= 76; k += 4) {
+                double frequency = ((double) multiple + ((double) k / (double) TEST_OUTPUTS));
+                if ((k == 0) || (frequency >= ((double) factors[i] / 2.0))) {
+                    continue;
+                }
+                double gain = Test_Gain_dB(factors[i], frequency);
+                if (multiple & 1U) {
+                    fir_worst = (gain > fir_worst) ? gain : fir_worst;
+                } else {
+                    cic_worst = (gain > cic_worst) ? gain : cic_worst;
+                }
+            }
+        }
+        char message[64];
+        snprintf(message, sizeof(message), "factor %u: FIR bands %.1f dB, CIC bands %.1f dB",
+                 factors[i], fir_worst, cic_worst);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE(fir_worst < -80.0);
+        TEST_ASSERT_TRUE(cic_worst < ((factors[i] == 4U) ? -37.0 : -43.0));
+    }
+}
+
+static void test_output_time_matches_delay(void) {
+    const uint8_t factors[2] = {4U, 8U};
+    const float   delays[2]  = {48.5f, 98.5f};
+    for (uint8_t i = 0U; i < 2U; i++) {
+        static DEC_State_t state;
+        DEC_Config_t       config = {.channel_mask = (1U << IMU_CHANNEL_ACC), .factor = factors[i]};
+        TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Init(&state, &config));
+        DEC_Report_t report;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Get_Report(&state, &report));
+        TEST_ASSERT_EQUAL_FLOAT(delays[i], report.delay_samples);
+
+        //a passband tone at a tenth of the output rate, read back at the output time stamps
+        double   frequency = (1.0e6 / (10.0 * TEST_PERIOD_US * factors[i]));
+        double   error_max = 0.0;
+        uint32_t count     = 0UL;
+        for (uint32_t n = 0UL; count < (TEST_SETTLE + TEST_OUTPUTS); n++) {
+            IMU_Frame_t frame;
+            uint16_t    ready_mask = 0U;
+            double      t          = ((double) (TEST_PERIOD_US * n) * 1e-6);
+            double      x          = (TEST_AMPLITUDE * sin(2.0 * M_PI * frequency * t));
+            Test_Frame_ACC(&frame, n, (int16_t) lround(x));
+            TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Push(&state, &frame, &ready_mask));
+            if (ready_mask == 0U) {
+                continue;
+            }
+            IMU_Frame_t output;
+            TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Get_Frame(&state, &output));
+            if (count++ < TEST_SETTLE) {
+                continue;
+            }
+            double t_out = ((double) (output.sample_us - 1000000ULL) * 1e-6);
+            double error = fabs((double) output.data[IMU_CHANNEL_ACC][0]
+                              - (TEST_AMPLITUDE * sin(2.0 * M_PI * frequency * t_out)));
+            error_max    = (error > error_max) ? error : error_max;
+        }
+
+        //within 0.2 % of the amplitude, a time error of at most 0.03 input samples
+        char message[64];
+        snprintf(message, sizeof(message), "factor %u: error %.1f LSB", factors[i], error_max);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE(error_max < (0.002 * TEST_AMPLITUDE));
+    }
+}
+
+static void test_init_rejects_invalid_settings(void) {
+    static DEC_State_t state;
+    DEC_Config_t       config = {.channel_mask = (1U << IMU_CHANNEL_ACC), .factor = 6U};
+    config.taps = 47U;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, DEC_Init(&state, &config));
+    config.taps = (DEC_TAPS_MAX + 2U);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, DEC_Init(&state, &config));
+    config.taps   = 0U;
+    config.factor = 5U;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, DEC_Init(&state, &config));
+    config.factor = (DEC_FACTOR_MAX + 2U);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, DEC_Init(&state, &config));
+    config.factor       = 6U;
+    config.channel_mask = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_GYR)
+                        | (1U << IMU_CHANNEL_MAG));
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, DEC_Init(&state, &config));
+    config.channel_mask = (1U << IMU_CHANNEL_ACC);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, DEC_Init(&state, &config));
+    TEST_ASSERT_EQUAL_UINT8(DEC_TAPS_DEFAULT, state.config.taps);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_unit_dc_gain);
+    RUN_TEST(test_flat_passband);
+    RUN_TEST(test_rejects_aliases);
+    RUN_TEST(test_output_time_matches_delay);
+    RUN_TEST(test_init_rejects_invalid_settings);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+/**
+ * @file    test_despike.c
+ * @brief   Streaming Spike Rejection Tests
+ * @details This source file checks the Hampel spike rejection stage on the host: isolated spikes
+ *          on a noisy signal are replaced with the rolling median, clean noise and steps are
+ *          passed, and duplicate reads are held at the last output.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/despike/despike.c"
+
+#define TEST_SEED                   0x1B873593UL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets an approximately Gaussian noise sample, as the sum of four uniform samples
+ * @param  sigma: Standard deviation in LSB
+ * @retval Noise sample
+ */
+static int16_t Test_Noise(float sigma) {
+    float sum = 0.0f;
+    for (uint8_t i = 0U; i < 4U; i++) {
+        sum += (((float) (Test_Random() & 0xFFFFU) / 65535.0f) - 0.5f);
+    }
+    return (int16_t) lrintf(sum * sigma * 1.7320508f);
+}
+
+/**
+ * @brief  Sets the accelerometer values of a frame
+ * @param  frame: Pointer to the frame
+ * @param  value: Value of every axis
+ * @retval None
+ */
+static void Test_Frame_ACC(IMU_Frame_t *frame, int16_t value) {
+    memset(frame, 0, sizeof(IMU_Frame_t));
+    frame->updated_mask = (1U << IMU_CHANNEL_ACC);
+    for (uint8_t j = 0U; j < 3U; j++) {
+        frame->data[IMU_CHANNEL_ACC][j] = value;
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_rejects_isolated_spikes(void) {
+    SPIKE_Config_t config = {.channel_mask = (1U << IMU_CHANNEL_ACC)};
+    SPIKE_State_t  state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Init(&state, &config));
+
+    //noise of 4 LSB around 1000, with a spike of +-2000 LSB every 50 samples
+    uint32_t spikes = 0UL;
+    uint32_t missed = 0UL;
+    uint32_t false_rejections = 0UL;
+    for (uint32_t n = 0UL; n < 5000UL; n++) {
+        IMU_Frame_t frame;
+        int16_t     clean = (int16_t) (1000 + Test_Noise(4.0f));
+        uint8_t     spike = ((n >= SPIKE_WINDOW_DEFAULT) && ((n % 50UL) == 25UL));
+        Test_Frame_ACC(&frame, spike ? (int16_t) (clean + (((n / 50UL) & 1UL) ? 2000 : -2000))
+                                     : clean);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Filter(&state, &frame));
+        int16_t output = frame.data[IMU_CHANNEL_ACC][0];
+        if (spike) {
+            spikes++;
+            missed += ((output > 1100) || (output < 900));
+        } else {
+            false_rejections += (output != clean);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0UL, missed);
+    TEST_ASSERT_TRUE(spikes > 90UL);
+
+    //the floor of SPIKE_FLOOR_DEFAULT_LSB keeps false rejections of the noise rare
+    char message[48];
+    snprintf(message, sizeof(message), "false rejections %u of %u",
+             (unsigned) false_rejections, (unsigned) (5000UL - spikes));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE_MESSAGE(false_rejections < 50UL, message);
+
+    SPIKE_Report_t report;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Get_Report(&state, &report));
+    TEST_ASSERT_EQUAL_UINT32(5000UL * 3UL, report.sample_count[IMU_CHANNEL_ACC]);
+    TEST_ASSERT_EQUAL_UINT32((spikes + false_rejections) * 3UL,
+                             report.rejected_count[IMU_CHANNEL_ACC]);
+}
+
+static void test_passes_step_after_half_window(void) {
+    SPIKE_Config_t config = {.channel_mask = (1U << IMU_CHANNEL_ACC)};
+    SPIKE_State_t  state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Init(&state, &config));
+
+    //a step is held at the old median until it is the median of the window
+    for (uint8_t n = 0U; n < 20U; n++) {
+        IMU_Frame_t frame;
+        Test_Frame_ACC(&frame, (n < 10U) ? 0 : 500);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Filter(&state, &frame));
+        int16_t expected = (n < (10U + (SPIKE_WINDOW_DEFAULT / 2U))) ? 0 : 500;
+        TEST_ASSERT_EQUAL_INT16(expected, frame.data[IMU_CHANNEL_ACC][0]);
+    }
+}
+
+static void test_holds_duplicate_reads(void) {
+    SPIKE_Config_t config = {.channel_mask = (1U << IMU_CHANNEL_ACC)};
+    SPIKE_State_t  state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Init(&state, &config));
+
+    for (uint8_t n = 0U; n < 8U; n++) {
+        IMU_Frame_t frame;
+        Test_Frame_ACC(&frame, (int16_t) (100 + n));
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Filter(&state, &frame));
+    }
+
+    //a duplicate read is output as the last value, whatever it holds, and not windowed
+    IMU_Frame_t frame;
+    Test_Frame_ACC(&frame, 9000);
+    frame.duplicate_mask = (1U << IMU_CHANNEL_ACC);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Filter(&state, &frame));
+    TEST_ASSERT_EQUAL_INT16(107, frame.data[IMU_CHANNEL_ACC][0]);
+
+    SPIKE_Report_t report;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Get_Report(&state, &report));
+    TEST_ASSERT_EQUAL_UINT32(3UL, report.held_count[IMU_CHANNEL_ACC]);
+    TEST_ASSERT_EQUAL_UINT32(8UL * 3UL, report.sample_count[IMU_CHANNEL_ACC]);
+    TEST_ASSERT_EQUAL_UINT32(0UL, report.rejected_count[IMU_CHANNEL_ACC]);
+}
+
+static void test_init_rejects_invalid_windows(void) {
+    SPIKE_State_t  state;
+    SPIKE_Config_t config = {.channel_mask = (1U << IMU_CHANNEL_ACC)};
+    config.window[IMU_CHANNEL_ACC] = 4U;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPIKE_Init(&state, &config));
+    config.window[IMU_CHANNEL_ACC] = (SPIKE_WINDOW_MAX + 2U);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPIKE_Init(&state, &config));
+    config.window[IMU_CHANNEL_ACC] = 3U;
+    config.sigma[IMU_CHANNEL_ACC]  = -1.0f;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPIKE_Init(&state, &config));
+    config.sigma[IMU_CHANNEL_ACC] = 0.0f;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPIKE_Init(&state, &config));
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_isolated_spikes);
+    RUN_TEST(test_passes_step_after_half_window);
+    RUN_TEST(test_holds_duplicate_reads);
+    RUN_TEST(test_init_rejects_invalid_windows);
+    return UNITY_END();
+}
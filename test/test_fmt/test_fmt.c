@@ -0,0 +1,166 @@
+/**
+ * @file    test_fmt.c
+ * @brief   Fixed-Precision Number Formatting Tests
+ * @details This source file checks the formatter against the C library printf family on the host,
+ *          over random floats at every precision, the largest supported magnitudes and the frame
+ *          builder limits.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+
+#define TEST_SEED                   0x12345678UL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+/**
+ * @brief  Checks FMT_Float() against snprintf() for a value, width and precision
+ * @param  value:     Float to be converted
+ * @param  width:     Minimum field width
+ * @param  precision: Number of digits after the decimal point
+ * @retval None
+ */
+static void Test_Float_Matches(float value, uint8_t width, uint8_t precision) {
+    char     expected[64];
+    char     actual[FMT_NUMBER_LENGTH_MAX + 16U];
+    uint16_t length = 0U;
+    snprintf(expected, sizeof(expected), "%*.*f", width, precision, (double) value);
+    TEST_ASSERT_EQUAL_INT(
+        SUCCESS, FMT_Float(actual, sizeof(actual), value, width, precision, &length)
+    );
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+    TEST_ASSERT_EQUAL_UINT16(strlen(expected), length);
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_float_matches_snprintf(void) {
+    static const float values[] = {
+        0.0f, -0.0f, 0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 9.9999995f, 123.456f, -1.0e-7f, 1.0e-40f,
+        16777216.0f, 3.4e10f, INFINITY, -INFINITY, NAN
+    };
+    for (uint8_t i = 0U; i < (sizeof(values) / sizeof(values[0])); i++) {
+        for (uint8_t precision = 0U; precision <= FMT_FLOAT_PRECISION_MAX; precision++) {
+            Test_Float_Matches(values[i], 0U, precision);
+            Test_Float_Matches(values[i], 12U, precision);
+        }
+    }
+}
+
+static void test_float_random_bits(void) {
+    for (uint32_t i = 0UL; i < 100000UL; i++) {
+        uint32_t bits  = Test_Random();
+        float    value = 0.0f;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value) || (fabsf(value) >= 9.2233720e18f)) {
+            continue;
+        }
+        Test_Float_Matches(value, 0U, (uint8_t) (i % (FMT_FLOAT_PRECISION_MAX + 1U)));
+    }
+}
+
+static void test_float_large_magnitude(void) {
+    //the largest float below 2^63 has 19 integer digits, 27 characters with sign and precision 6
+    float largest = nextafterf(9.2233720e18f, 0.0f);
+    Test_Float_Matches(largest, 0U, FMT_FLOAT_PRECISION_MAX);
+    Test_Float_Matches(-largest, 0U, FMT_FLOAT_PRECISION_MAX);
+    Test_Float_Matches(1.0e17f, 0U, FMT_FLOAT_PRECISION_MAX);
+    Test_Float_Matches(-1.0e18f, 0U, FMT_FLOAT_PRECISION_MAX);
+
+    //magnitudes of 2^63 and above are refused rather than overflowing
+    char     buffer[FMT_NUMBER_LENGTH_MAX];
+    uint16_t length = 0U;
+    float    limit  = 9.2233720e18f;
+    TEST_ASSERT_EQUAL_INT(
+        ERROR, FMT_Float(buffer, sizeof(buffer), limit, 0U, FMT_FLOAT_PRECISION_MAX, &length)
+    );
+    TEST_ASSERT_EQUAL_INT(
+        ERROR, FMT_Float(buffer, sizeof(buffer), -3.0e38f, 0U, FMT_FLOAT_PRECISION_MAX, &length)
+    );
+
+    //a buffer of FMT_NUMBER_LENGTH_MAX holds the longest output
+    TEST_ASSERT_EQUAL_INT(
+        SUCCESS, FMT_Float(buffer, sizeof(buffer), -largest, 0U, FMT_FLOAT_PRECISION_MAX, &length)
+    );
+    TEST_ASSERT_EQUAL_UINT16(27U, length);
+}
+
+static void test_append_float_to_string(void) {
+    float largest = nextafterf(9.2233720e18f, 0.0f);
+    char  message[64] = "v=";
+    char  expected[64];
+    Append_Float_To_String(message, sizeof(message), -largest);
+    snprintf(expected, sizeof(expected), "v=%.6f", (double) -largest);
+    TEST_ASSERT_EQUAL_STRING(expected, message);
+}
+
+static void test_integers(void) {
+    char     buffer[FMT_NUMBER_LENGTH_MAX];
+    uint16_t length = 0U;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Int(buffer, sizeof(buffer), INT32_MIN, 0U, &length));
+    TEST_ASSERT_EQUAL_STRING("-2147483648", buffer);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Uint(buffer, sizeof(buffer), UINT32_MAX, 12U, &length));
+    TEST_ASSERT_EQUAL_STRING("  4294967295", buffer);
+
+    uint8_t     data[32];
+    FMT_Frame_t frame;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Frame_Init(&frame, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Frame_Append_Uint(&frame, UINT64_MAX, 0U));
+    TEST_ASSERT_EQUAL_UINT16(20U, frame.length);
+    TEST_ASSERT_EQUAL_MEMORY("18446744073709551615", data, 20U);
+}
+
+static void test_frame_limits(void) {
+    uint8_t     data[8];
+    FMT_Frame_t frame;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Frame_Init(&frame, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Frame_Append_Str(&frame, "ab"));
+    TEST_ASSERT_EQUAL_INT(ERROR, FMT_Frame_Append_Float(&frame, 1234.5f, 0U, 2U));
+    TEST_ASSERT_EQUAL_UINT16(2U, frame.length);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Frame_Append_Float(&frame, 12.5f, 0U, 2U));
+    TEST_ASSERT_EQUAL_MEMORY("ab12.50", data, 7U);
+}
+
+static void test_base64(void) {
+    static const char *const expected[] = {
+        "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"
+    };
+    for (uint8_t i = 0U; i < 7U; i++) {
+        uint8_t     data[16];
+        FMT_Frame_t frame;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, FMT_Frame_Init(&frame, data, sizeof(data)));
+        TEST_ASSERT_EQUAL_INT(
+            SUCCESS, FMT_Frame_Append_Base64(&frame, (const uint8_t *) "foobar", i)
+        );
+        TEST_ASSERT_EQUAL_UINT16(strlen(expected[i]), frame.length);
+        if (frame.length > 0U) {
+            TEST_ASSERT_EQUAL_MEMORY(expected[i], data, frame.length);
+        }
+    }
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_float_matches_snprintf);
+    RUN_TEST(test_float_random_bits);
+    RUN_TEST(test_float_large_magnitude);
+    RUN_TEST(test_append_float_to_string);
+    RUN_TEST(test_integers);
+    RUN_TEST(test_frame_limits);
+    RUN_TEST(test_base64);
+    return UNITY_END();
+}
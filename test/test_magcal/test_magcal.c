@@ -0,0 +1,259 @@
+/**
+ * @file    test_magcal.c
+ * @brief   Magnetometer Hard and Soft-Iron Calibration Tests
+ * @details This source file checks the magnetometer calibrator on the host: the recovery of a
+ *          known offset and soft-iron distortion from noisy samples of the distorted sphere, that
+ *          rotation about a single axis never converges, the skipping of samples at rest, and the
+ *          conversion of a solution to the BNO055 register format.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/magcal/magcal.c"
+
+#define TEST_SEED                   0x27D4EB2FUL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+#define TEST_FIELD_LSB      768.0f
+
+static const float test_offset[3]         = {310.0f, -145.0f, 420.0f};
+static const float test_distortion[3][3] = {
+    {1.20f, 0.06f, -0.04f},
+    {0.06f, 0.90f, 0.05f},
+    {-0.04f, 0.05f, 1.00f}
+};
+
+/**
+ * @brief  Gets a uniform random value
+ * @retval Value between -1 and 1
+ */
+static float Test_Uniform(void) {
+    return ((((float) (Test_Random() & 0xFFFFU) / 65535.0f) * 2.0f) - 1.0f);
+}
+
+/**
+ * @brief  Sets the magnetometer sample of a frame to a direction of the distorted field
+ * @param  frame:     Pointer to the frame
+ * @param  direction: Pointer to the direction of the undistorted field
+ * @param  noise:     Largest noise added to each axis in LSB
+ * @retval None
+ */
+static void Test_Frame_MAG(IMU_Frame_t *frame, const float *direction, float noise) {
+    memset(frame, 0, sizeof(IMU_Frame_t));
+    frame->updated_mask = (1U << IMU_CHANNEL_MAG);
+    for (uint8_t i = 0U; i < 3U; i++) {
+        float value = test_offset[i];
+        for (uint8_t j = 0U; j < 3U; j++) {
+            value += (test_distortion[i][j] * direction[j] * TEST_FIELD_LSB);
+        }
+        frame->data[IMU_CHANNEL_MAG][i] = (int16_t) lrintf(value + (Test_Uniform() * noise));
+    }
+}
+
+/**
+ * @brief  Gets a random direction, uniform over the sphere
+ * @param  direction: Pointer to an array used to store the unit vector
+ * @retval None
+ */
+static void Test_Random_Direction(float *direction) {
+    float norm = 0.0f;
+    do {
+        for (uint8_t i = 0U; i < 3U; i++) {
+            direction[i] = Test_Uniform();
+        }
+        norm = sqrtf((direction[0] * direction[0]) + (direction[1] * direction[1])
+             + (direction[2] * direction[2]));
+    } while ((norm > 1.0f) || (norm < 0.1f));
+    for (uint8_t i = 0U; i < 3U; i++) {
+        direction[i] /= norm;
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_recovers_offset_and_soft_iron(void) {
+    MAGCAL_Config_t config = {0};
+    MAGCAL_State_t  state;
+    MAGCAL_Result_t result;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Init(&state, &config));
+
+    //random orientations with 2 LSB of noise, solved every 32 samples until converged
+    uint16_t pushed = 0U;
+    memset(&result, 0, sizeof(result));
+    while (!result.converged && (pushed < 2000U)) {
+        float       direction[3];
+        IMU_Frame_t frame;
+        Test_Random_Direction(direction);
+        Test_Frame_MAG(&frame, direction, 2.0f);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Push(&state, &frame));
+        pushed++;
+        if ((pushed % 32U) == 0U) {
+            TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Solve(&state, &result));
+        }
+    }
+    TEST_ASSERT_TRUE(result.converged);
+    TEST_ASSERT_EQUAL_UINT8(MAGCAL_SECTORS, result.coverage);
+
+    char message[64];
+    snprintf(message, sizeof(message), "converged after %u samples, residual %.4f",
+             (unsigned) pushed, (double) result.residual);
+    TEST_MESSAGE(message);
+
+    //the soft-iron matrix is the inverse of the distortion, scaled to a unit determinant, and the
+    //field strength is scaled by the cube root of the determinant of the distortion
+    float d[3][3];
+    memcpy(d, test_distortion, sizeof(d));
+    float cof[3][3] = {
+        {((d[1][1] * d[2][2]) - (d[1][2] * d[2][1])), ((d[0][2] * d[2][1]) - (d[0][1] * d[2][2])),
+         ((d[0][1] * d[1][2]) - (d[0][2] * d[1][1]))},
+        {((d[1][2] * d[2][0]) - (d[1][0] * d[2][2])), ((d[0][0] * d[2][2]) - (d[0][2] * d[2][0])),
+         ((d[0][2] * d[1][0]) - (d[0][0] * d[1][2]))},
+        {((d[1][0] * d[2][1]) - (d[1][1] * d[2][0])), ((d[0][1] * d[2][0]) - (d[0][0] * d[2][1])),
+         ((d[0][0] * d[1][1]) - (d[0][1] * d[1][0]))}
+    };
+    float det = ((d[0][0] * cof[0][0]) + (d[0][1] * cof[1][0]) + (d[0][2] * cof[2][0]));
+    for (uint8_t i = 0U; i < 3U; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(2.0f, test_offset[i], result.offset[i]);
+        for (uint8_t j = 0U; j < 3U; j++) {
+            TEST_ASSERT_FLOAT_WITHIN(0.005f, (cof[i][j] / det) * cbrtf(det),
+                                     result.soft_iron[i][j]);
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, TEST_FIELD_LSB * cbrtf(det), result.field_lsb);
+    TEST_ASSERT_TRUE(result.axis_ratio < MAGCAL_RATIO_DEFAULT);
+
+    //the solution maps new samples back onto the sphere
+    for (uint16_t n = 0U; n < 200U; n++) {
+        float       direction[3];
+        float       corrected[3];
+        IMU_Frame_t frame;
+        Test_Random_Direction(direction);
+        Test_Frame_MAG(&frame, direction, 0.0f);
+        MAGCAL_Correct(&result, frame.data[IMU_CHANNEL_MAG], corrected);
+        float norm = sqrtf((corrected[0] * corrected[0]) + (corrected[1] * corrected[1])
+                   + (corrected[2] * corrected[2]));
+        TEST_ASSERT_FLOAT_WITHIN(0.01f * result.field_lsb, result.field_lsb, norm);
+    }
+}
+
+static void test_rejects_rotation_about_one_axis(void) {
+    MAGCAL_Config_t config = {0};
+    MAGCAL_State_t  state;
+    MAGCAL_Result_t result;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Init(&state, &config));
+    TEST_ASSERT_EQUAL_INT(ERROR, MAGCAL_Solve(&state, &result));
+
+    //a turn on a level table traces a circle, which many ellipsoids pass through. The rounding of
+    //the samples leaves the fit barely determined, so any solution is far too elongated to converge
+    uint8_t solved = 0U;
+    for (uint16_t n = 0U; n < 400U; n++) {
+        float       angle        = ((2.0f * 3.14159265f * (float) n) / 200.0f);
+        float       direction[3] = {cosf(angle), sinf(angle), 0.0f};
+        IMU_Frame_t frame;
+        Test_Frame_MAG(&frame, direction, 0.0f);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Push(&state, &frame));
+        if ((n % 25U) == 24U) {
+            if (MAGCAL_Solve(&state, &result) == SUCCESS) {
+                solved++;
+                TEST_ASSERT_FALSE(result.converged);
+                TEST_ASSERT_TRUE(result.axis_ratio > MAGCAL_RATIO_DEFAULT);
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(state.sample_count >= MAGCAL_COLUMNS);
+
+    char message[48];
+    snprintf(message, sizeof(message), "%u of 16 solves rejected as ERROR", 16U - solved);
+    TEST_MESSAGE(message);
+}
+
+static void test_skips_samples_at_rest(void) {
+    MAGCAL_Config_t config = {0};
+    MAGCAL_State_t  state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Init(&state, &config));
+
+    //samples within step_lsb of the last fitted one are skipped, and duplicates are ignored
+    float       direction[3] = {1.0f, 0.0f, 0.0f};
+    IMU_Frame_t frame;
+    Test_Frame_MAG(&frame, direction, 0.0f);
+    for (uint8_t n = 0U; n < 10U; n++) {
+        frame.data[IMU_CHANNEL_MAG][0] = (int16_t) (frame.data[IMU_CHANNEL_MAG][0] + 2);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Push(&state, &frame));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1UL, state.sample_count);
+    TEST_ASSERT_EQUAL_UINT32(9UL, state.skipped_count);
+
+    frame.data[IMU_CHANNEL_MAG][1] = (int16_t) (frame.data[IMU_CHANNEL_MAG][1]
+                                              + MAGCAL_STEP_DEFAULT_LSB);
+    frame.duplicate_mask = (1U << IMU_CHANNEL_MAG);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Push(&state, &frame));
+    TEST_ASSERT_EQUAL_UINT32(1UL, state.sample_count);
+    frame.duplicate_mask = 0U;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Push(&state, &frame));
+    TEST_ASSERT_EQUAL_UINT32(2UL, state.sample_count);
+}
+
+static void test_registers(void) {
+    MAGCAL_Result_t result = {
+        .offset    = {310.4f, -145.6f, 0.0f},
+        .soft_iron = {{1.0f, 0.25f, 0.0f}, {0.25f, 0.5f, -0.125f}, {0.0f, -0.125f, 1.5f}}
+    };
+    BNO_SIC_Matrix_t sic;
+    BNO_Offset_t     offset;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Registers(&result, &sic, &offset));
+
+    //the matrix is row major with BNO_SIC_ONE as 1.0, and the offsets are rounded
+    const int16_t expected[9] = {16384, 4096, 0, 4096, 8192, -2048, 0, -2048, 24576};
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, sic.sic, 9U);
+    TEST_ASSERT_EQUAL_INT16(310, offset.offset_x);
+    TEST_ASSERT_EQUAL_INT16(-146, offset.offset_y);
+    TEST_ASSERT_EQUAL_INT16(0, offset.offset_z);
+
+    //values beyond the int16_t registers are refused
+    result.soft_iron[2][2] = 2.0f;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, MAGCAL_Registers(&result, &sic, &offset));
+    result.soft_iron[2][2] = 1.5f;
+    result.offset[2]       = 40000.0f;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, MAGCAL_Registers(&result, &sic, &offset));
+}
+
+static void test_init_rejects_invalid_settings(void) {
+    MAGCAL_State_t  state;
+    MAGCAL_Config_t config = {.coverage_min = (MAGCAL_SECTORS + 1U)};
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, MAGCAL_Init(&state, &config));
+    config.coverage_min = 0U;
+    config.residual_max = -0.01f;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, MAGCAL_Init(&state, &config));
+    config.residual_max   = 0.0f;
+    config.axis_ratio_max = 0.5f;
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, MAGCAL_Init(&state, &config));
+    config.axis_ratio_max = 0.0f;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, MAGCAL_Init(&state, &config));
+    TEST_ASSERT_EQUAL_UINT8(MAGCAL_COVERAGE_DEFAULT, state.config.coverage_min);
+    TEST_ASSERT_EQUAL_FLOAT(MAGCAL_RATIO_DEFAULT, state.config.axis_ratio_max);
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recovers_offset_and_soft_iron);
+    RUN_TEST(test_rejects_rotation_about_one_axis);
+    RUN_TEST(test_skips_samples_at_rest);
+    RUN_TEST(test_registers);
+    RUN_TEST(test_init_rejects_invalid_settings);
+    return UNITY_END();
+}
@@ -0,0 +1,344 @@
+/**
+ * @file    test_orient.c
+ * @brief   Orientation Math Tests
+ * @details This source file checks the smallest-three quaternion packing on the host: the
+ *          rotation error of a round trip over random unit quaternions against the documented
+ *          bound at each width, the exact round trip of the identity, and the rejection of
+ *          quaternions that cannot be normalised.
+ *
+ *          It also checks the derived channels against rotations about a single axis, whose Euler
+ *          angles and gravity are known in closed form: the heading, roll and pitch in each angle
+ *          unit and orientation format, the gravity and linear acceleration vectors, and the raw
+ *          EUL, GRV and LIA values stored by ORIENT_Derive_Channels() in the BNO055 register units
+ *          from a raw QUA and ACC, including frames that lack a source.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/orient/orient.c"
+
+#define TEST_SEED                   0x2545F491UL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets a uniform value in [-1, 1) from a xorshift generator
+ * @retval Pseudo-random value
+ */
+static double Test_Uniform(void) {
+    return (((double) Test_Random() / 2147483648.0) - 1.0);
+}
+
+/**
+ * @brief  Gets a random unit quaternion, uniform over the rotations
+ * @param  q: Pointer to a 4-element array used to store the quaternion
+ * @retval None
+ */
+static void Test_Random_Quat(float *q) {
+    double v[4];
+    double norm_sq = 0.0;
+    do {
+        norm_sq = 0.0;
+        for (uint8_t k = 0U; k < 4U; k++) {
+            v[k]     = Test_Uniform();
+            norm_sq += (v[k] * v[k]);
+        }
+    } while ((norm_sq > 1.0) || (norm_sq < 1.0e-6));
+    for (uint8_t k = 0U; k < 4U; k++) {
+        q[k] = (float) (v[k] / sqrt(norm_sq));
+    }
+}
+
+/**
+ * @brief  Gets the angle of the rotation between two unit quaternions
+ * @param  a: Pointer to the first quaternion
+ * @param  b: Pointer to the second quaternion
+ * @retval Angle in degrees
+ */
+static double Test_Angle_Deg(const float *a, const float *b) {
+    double dot    = 0.0;
+    double norm_a = 0.0;
+    double norm_b = 0.0;
+    for (uint8_t k = 0U; k < 4U; k++) {
+        dot    += ((double) a[k] * b[k]);
+        norm_a += ((double) a[k] * a[k]);
+        norm_b += ((double) b[k] * b[k]);
+    }
+    dot = fabs(dot) / sqrt(norm_a * norm_b);
+    return (2.0 * acos((dot > 1.0) ? 1.0 : dot) * (180.0 / M_PI));
+}
+
+/**
+ * @brief  Gets the documented bound on the rotation error of a round trip
+ * @param  bits: Bits per component
+ * @retval Bound in degrees, 4 * sqrt(3) * e with e = 1 / (sqrt(2) * (2^bits - 2))
+ */
+static double Test_Bound_Deg(uint8_t bits) {
+    double e = (1.0 / (sqrt(2.0) * (double) ((1UL << bits) - 2UL)));
+    return (4.0 * sqrt(3.0) * e * (180.0 / M_PI));
+}
+
+
+/**
+ * @brief  Gets the unit quaternion of a rotation about a sensor axis
+ * @param  axis:  Axis index (0 for x, 1 for y, 2 for z)
+ * @param  angle: Angle of the rotation in degrees, counter-clockwise about the axis
+ * @param  q:     Pointer to a 4-element array used to store the quaternion
+ * @retval None
+ */
+static void Test_Axis_Quat(uint8_t axis, double angle, float *q) {
+    double half = ((angle * (M_PI / 180.0)) / 2.0);
+    q[0] = (float) cos(half);
+    q[1] = 0.0f;
+    q[2] = 0.0f;
+    q[3] = 0.0f;
+    q[1U + axis] = (float) sin(half);
+}
+
+/**
+ * @brief  Stores a quaternion in the QUA channel of a frame, in the BNO055 register units
+ * @param  q:     Pointer to the unit quaternion
+ * @param  frame: Pointer to the frame
+ * @retval None
+ */
+static void Test_Set_QUA(const float *q, IMU_Frame_t *frame) {
+    for (uint8_t k = 0U; k < 4U; k++) {
+        frame->data[IMU_CHANNEL_QUA][k] = (int16_t) lround(q[k] * BNO_QUA_QUATERNIONS);
+    }
+    frame->updated_mask |= (uint16_t) (1U << IMU_CHANNEL_QUA);
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_pack_round_trip_bound(void) {
+    static const uint8_t widths[] = {8U, 10U};
+    for (uint8_t w = 0U; w < 2U; w++) {
+        uint8_t bits      = widths[w];
+        double  bound     = Test_Bound_Deg(bits);
+        double  error_max = 0.0;
+        for (uint32_t i = 0UL; i < 200000UL; i++) {
+            float    q[4];
+            float    unpacked[4];
+            uint32_t packed = 0UL;
+            Test_Random_Quat(q);
+            TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Quat_Pack(q, bits, &packed));
+            TEST_ASSERT_TRUE(packed < (1UL << ((3U * bits) + 2U)));
+            TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Quat_Unpack(packed, bits, unpacked));
+            double error = Test_Angle_Deg(q, unpacked);
+            if (error > error_max) {
+                error_max = error;
+            }
+        }
+        char message[64];
+        snprintf(message, sizeof(message), "%u bits: %.3f deg (bound %.3f deg)",
+                 bits, error_max, bound);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE_MESSAGE(error_max <= bound, message);
+    }
+}
+
+static void test_pack_identity_exact(void) {
+    const float identity[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    const float negated[4]  = {-1.0f, 0.0f, 0.0f, 0.0f};
+    float       unpacked[4];
+    uint32_t    packed      = 0UL;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Quat_Pack(identity, ORIENT_PACK_BITS_MAX, &packed));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Quat_Unpack(packed, ORIENT_PACK_BITS_MAX, unpacked));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, unpacked[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, unpacked[1]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, unpacked[2]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, unpacked[3]);
+
+    //q and -q are the same rotation, so they pack to the same code
+    uint32_t packed_negated = 0UL;
+    TEST_ASSERT_EQUAL_INT(
+        SUCCESS, ORIENT_Quat_Pack(negated, ORIENT_PACK_BITS_MAX, &packed_negated)
+    );
+    TEST_ASSERT_EQUAL_UINT32(packed, packed_negated);
+}
+
+static void test_pack_rejects_invalid(void) {
+    const float zero[4]     = {0.0f, 0.0f, 0.0f, 0.0f};
+    const float nan[4]      = {1.0f, NAN, 0.0f, 0.0f};
+    const float infinite[4] = {0.5f, 0.0f, -INFINITY, 0.0f};
+    uint32_t    packed      = 0UL;
+    TEST_ASSERT_EQUAL_INT(ERROR, ORIENT_Quat_Pack(zero, ORIENT_PACK_BITS_MAX, &packed));
+    TEST_ASSERT_EQUAL_INT(ERROR, ORIENT_Quat_Pack(nan, ORIENT_PACK_BITS_MAX, &packed));
+    TEST_ASSERT_EQUAL_INT(ERROR, ORIENT_Quat_Pack(infinite, ORIENT_PACK_BITS_MAX, &packed));
+    TEST_ASSERT_EQUAL_INT(
+        INVALID_PARAM, ORIENT_Quat_Pack(zero, ORIENT_PACK_BITS_MAX + 1U, &packed)
+    );
+}
+
+static void test_euler_known_rotations(void) {
+    static const struct {
+        uint8_t axis;
+        double  angle;
+        float   hrp[3];
+    } cases[] = {
+        {0U,   0.0, {  0.0f,   0.0f,   0.0f}},
+        {2U,  90.0, {270.0f,   0.0f,   0.0f}},
+        {2U, -90.0, { 90.0f,   0.0f,   0.0f}},
+        {2U, 180.0, {180.0f,   0.0f,   0.0f}},
+        {1U,  20.0, {  0.0f,  20.0f,   0.0f}},
+        {1U, -60.0, {  0.0f, -60.0f,   0.0f}},
+        {0U,  30.0, {  0.0f,   0.0f,  30.0f}},
+        {0U, 135.0, {  0.0f,   0.0f, 135.0f}}
+    };
+    const ORIENT_Units_t degrees = {0};
+    const ORIENT_Units_t radians = {
+        .eul_unit = BNO_UNIT_EUL_RADIANS,
+        .ori_unit = BNO_UNIT_ORI_ANDROID
+    };
+    for (uint8_t c = 0U; c < (sizeof(cases) / sizeof(cases[0])); c++) {
+        float q[4];
+        float hrp[3];
+        Test_Axis_Quat(cases[c].axis, cases[c].angle, q);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Get_Euler(q, &degrees, hrp));
+        for (uint8_t i = 0U; i < 3U; i++) {
+            TEST_ASSERT_FLOAT_WITHIN(0.01f, cases[c].hrp[i], hrp[i]);
+        }
+
+        //the Android format only inverts the pitch
+        TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Get_Euler(q, &radians, hrp));
+        TEST_ASSERT_FLOAT_WITHIN(2.0e-4f, cases[c].hrp[BNO_EUL_HEADING] / ORIENT_RAD_TO_DEG,
+                                 hrp[BNO_EUL_HEADING]);
+        TEST_ASSERT_FLOAT_WITHIN(2.0e-4f, cases[c].hrp[BNO_EUL_ROLL] / ORIENT_RAD_TO_DEG,
+                                 hrp[BNO_EUL_ROLL]);
+        TEST_ASSERT_FLOAT_WITHIN(2.0e-4f, -cases[c].hrp[BNO_EUL_PITCH] / ORIENT_RAD_TO_DEG,
+                                 hrp[BNO_EUL_PITCH]);
+    }
+}
+
+static void test_gravity_and_linear_acc(void) {
+    float q[4];
+    float gravity[3];
+
+    //level, gravity is measured along +z
+    Test_Axis_Quat(0U, 0.0, q);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Get_Gravity(q, gravity));
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, 0.0f, gravity[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, 0.0f, gravity[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, 1.0f, gravity[2]);
+
+    //pitched by 30 degrees about x, gravity tilts towards +y
+    Test_Axis_Quat(0U, 30.0, q);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Get_Gravity(q, gravity));
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, 0.0f, gravity[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, 0.5f, gravity[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, (float) cos(M_PI / 6.0), gravity[2]);
+
+    //rolled by 20 degrees about y, gravity tilts towards -x
+    Test_Axis_Quat(1U, 20.0, q);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Get_Gravity(q, gravity));
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, (float) -sin(M_PI / 9.0), gravity[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, 0.0f, gravity[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-6f, (float) cos(M_PI / 9.0), gravity[2]);
+
+    //the acceleration left once gravity is removed, computed in place
+    const float motion[3] = {0.1f, 0.2f, -0.3f};
+    float       acc[3];
+    for (uint8_t i = 0U; i < 3U; i++) {
+        acc[i] = ((ORIENT_GRAVITY_MS * gravity[i]) + motion[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Get_Linear_Acc(q, acc, ORIENT_GRAVITY_MS, acc));
+    for (uint8_t i = 0U; i < 3U; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(1.0e-5f, motion[i], acc[i]);
+    }
+}
+
+static void test_derive_channels_raw_units(void) {
+    static const struct {
+        ORIENT_Units_t units;
+        int16_t        eul[3];
+        int16_t        grv[3];
+    } cases[] = {
+        //30 degrees about x: pitch 30 deg = 480 LSB, gravity (0, 0.5, 0.866) g at 100 LSB/m/s^2
+        {{0},                                         {0, 0, 480}, {0, 490, 849}},
+        //the same in mg and radians: pitch 0.5236 rad = 471 LSB, gravity at 1 LSB/mg
+        {{BNO_UNIT_ACC_MG, BNO_UNIT_EUL_RADIANS, 0}, {0, 0, 471}, {0, 500, 866}}
+    };
+    static const int16_t motion[3] = {50, -20, 10};
+    for (uint8_t c = 0U; c < 2U; c++) {
+        float       q[4];
+        IMU_Frame_t frame = {0};
+        Test_Axis_Quat(0U, 30.0, q);
+        Test_Set_QUA(q, &frame);
+        for (uint8_t i = 0U; i < 3U; i++) {
+            frame.data[IMU_CHANNEL_ACC][i] = (int16_t) (cases[c].grv[i] + motion[i]);
+        }
+        frame.updated_mask |= (uint16_t) (1U << IMU_CHANNEL_ACC);
+
+        TEST_ASSERT_EQUAL_INT(
+            SUCCESS, ORIENT_Derive_Channels(&cases[c].units, ORIENT_DERIVABLE_MASK, &frame)
+        );
+        TEST_ASSERT_EQUAL_HEX16(
+            ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_QUA) | ORIENT_DERIVABLE_MASK),
+            frame.updated_mask
+        );
+        for (uint8_t i = 0U; i < 3U; i++) {
+            TEST_ASSERT_INT_WITHIN(1, cases[c].eul[i], frame.data[IMU_CHANNEL_EUL][i]);
+            TEST_ASSERT_INT_WITHIN(1, cases[c].grv[i], frame.data[IMU_CHANNEL_GRV][i]);
+            TEST_ASSERT_INT_WITHIN(1, motion[i], frame.data[IMU_CHANNEL_LIA][i]);
+        }
+    }
+}
+
+static void test_derive_channels_missing_sources(void) {
+    const ORIENT_Units_t units = {0};
+    float                q[4];
+    Test_Axis_Quat(1U, 20.0, q);
+
+    //without ACC, LIA is left as it was while EUL and GRV are derived
+    IMU_Frame_t frame = {0};
+    Test_Set_QUA(q, &frame);
+    frame.data[IMU_CHANNEL_LIA][0] = 1234;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Derive_Channels(&units, ORIENT_DERIVABLE_MASK, &frame));
+    TEST_ASSERT_EQUAL_HEX16(
+        ((1U << IMU_CHANNEL_QUA) | (1U << IMU_CHANNEL_GRV) | (1U << IMU_CHANNEL_EUL)),
+        frame.updated_mask
+    );
+    TEST_ASSERT_EQUAL_INT16(1234, frame.data[IMU_CHANNEL_LIA][0]);
+    TEST_ASSERT_INT_WITHIN(1, 320, frame.data[IMU_CHANNEL_EUL][BNO_EUL_ROLL]);
+
+    //without QUA, or with a zero quaternion, nothing is derived
+    IMU_Frame_t empty = {0};
+    empty.updated_mask = (uint16_t) (1U << IMU_CHANNEL_ACC);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Derive_Channels(&units, ORIENT_DERIVABLE_MASK, &empty));
+    TEST_ASSERT_EQUAL_HEX16((1U << IMU_CHANNEL_ACC), empty.updated_mask);
+    empty.updated_mask |= (uint16_t) (1U << IMU_CHANNEL_QUA);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Derive_Channels(&units, ORIENT_DERIVABLE_MASK, &empty));
+    TEST_ASSERT_EQUAL_HEX16(((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_QUA)),
+                            empty.updated_mask);
+
+    //only EUL, GRV and LIA can be derived
+    TEST_ASSERT_EQUAL_INT(
+        INVALID_PARAM, ORIENT_Derive_Channels(&units, (1U << IMU_CHANNEL_ACC), &frame)
+    );
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pack_round_trip_bound);
+    RUN_TEST(test_pack_identity_exact);
+    RUN_TEST(test_pack_rejects_invalid);
+    RUN_TEST(test_euler_known_rotations);
+    RUN_TEST(test_gravity_and_linear_acc);
+    RUN_TEST(test_derive_channels_raw_units);
+    RUN_TEST(test_derive_channels_missing_sources);
+    return UNITY_END();
+}
@@ -0,0 +1,220 @@
+/**
+ * @file    test_predict.c
+ * @brief   Orientation Predictor Tests
+ * @details This source file checks the orientation predictor on the host against rotations known
+ *          in closed form: the slerp at the start, middle and end of the interval between two
+ *          fused samples, the extrapolation of the latest sample by a constant gyroscope rate in
+ *          the sensor frame, and its clamp at horizon_max_us. It also checks an empty history,
+ *          a history of a single sample with and without a gyroscope rate, and the fused samples
+ *          that are ignored.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/orient/orient.c"
+#include "../../lib/imu/predict/predict.c"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+/**
+ * @brief  Gets the unit quaternion of a rotation about a sensor axis
+ * @param  axis:  Axis index (0 for x, 1 for y, 2 for z)
+ * @param  angle: Angle of the rotation in degrees
+ * @param  q:     Pointer to a 4-element array used to store the quaternion
+ * @retval None
+ */
+static void Test_Axis_Quat(uint8_t axis, double angle, float *q) {
+    double half = ((angle * (M_PI / 180.0)) / 2.0);
+    q[0] = (float) cos(half);
+    q[1] = 0.0f;
+    q[2] = 0.0f;
+    q[3] = 0.0f;
+    q[1U + axis] = (float) sin(half);
+}
+
+/**
+ * @brief  Sets the QUA channel of a frame, in the BNO055 register units
+ * @param  frame:     Pointer to the frame
+ * @param  q:         Pointer to the unit quaternion
+ * @param  sample_us: Sample time of the frame
+ * @retval None
+ */
+static void Test_Set_QUA(IMU_Frame_t *frame, const float *q, uint64_t sample_us) {
+    for (uint8_t k = 0U; k < 4U; k++) {
+        frame->data[IMU_CHANNEL_QUA][k] = (int16_t) lround(q[k] * BNO_QUA_QUATERNIONS);
+    }
+    frame->updated_mask |= (uint16_t) (1U << IMU_CHANNEL_QUA);
+    frame->sample_us     = sample_us;
+}
+
+/**
+ * @brief  Gets the angle of the rotation between two unit quaternions
+ * @param  a: Pointer to the first quaternion
+ * @param  b: Pointer to the second quaternion
+ * @retval Angle in degrees
+ */
+static double Test_Angle_Deg(const float *a, const float *b) {
+    //vector part of conj(a) * b, whose length is the sine of half the angle, so the angle keeps
+    //its precision near 0 where the acos of the dot product would not
+    double w = (((double) a[0] * b[0]) + ((double) a[1] * b[1]) + ((double) a[2] * b[2])
+             + ((double) a[3] * b[3]));
+    double x = (((double) a[0] * b[1]) - ((double) a[1] * b[0]) - ((double) a[2] * b[3])
+             + ((double) a[3] * b[2]));
+    double y = (((double) a[0] * b[2]) + ((double) a[1] * b[3]) - ((double) a[2] * b[0])
+             - ((double) a[3] * b[1]));
+    double z = (((double) a[0] * b[3]) - ((double) a[1] * b[2]) + ((double) a[2] * b[1])
+             - ((double) a[3] * b[0]));
+    return (2.0 * atan2(sqrt((x * x) + (y * y) + (z * z)), fabs(w)) * (180.0 / M_PI));
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_empty_and_single_history(void) {
+    static PRED_State_t state;
+    PRED_Config_t       config = {0};
+    PRED_Report_t       report;
+    float               q[4];
+    float               expected[4];
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Init(&state, &config));
+
+    //no fused sample yet, even with a gyroscope rate
+    IMU_Frame_t frame = {0};
+    frame.updated_mask = (uint16_t) (1U << IMU_CHANNEL_GYR);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Update(&state, &frame));
+    TEST_ASSERT_EQUAL_INT(ERROR, PRED_Get_Quaternion(&state, 1000ULL, q));
+
+    //a duplicate or zero-length QUA is not a fused sample
+    Test_Axis_Quat(2U, 40.0, expected);
+    Test_Set_QUA(&frame, expected, 10000ULL);
+    frame.duplicate_mask = (uint16_t) (1U << IMU_CHANNEL_QUA);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Update(&state, &frame));
+    frame.duplicate_mask = 0U;
+    memset(frame.data[IMU_CHANNEL_QUA], 0, sizeof(frame.data[IMU_CHANNEL_QUA]));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Update(&state, &frame));
+    TEST_ASSERT_EQUAL_INT(ERROR, PRED_Get_Quaternion(&state, 1000ULL, q));
+
+    //a single sample is held at every earlier time, and at later times with a zero rate
+    Test_Set_QUA(&frame, expected, 10000ULL);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Update(&state, &frame));
+    const uint64_t times_us[] = {0ULL, 10000ULL, 30000ULL};
+    for (uint8_t t = 0U; t < 3U; t++) {
+        TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Quaternion(&state, times_us[t], q));
+        TEST_ASSERT_TRUE(Test_Angle_Deg(expected, q) < 0.01);
+    }
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Report(&state, &report));
+    TEST_ASSERT_EQUAL_UINT32(2UL, report.interpolation_count);
+    TEST_ASSERT_EQUAL_UINT32(1UL, report.prediction_count);
+    TEST_ASSERT_EQUAL_UINT32(20000UL, report.horizon_last_us);
+    TEST_ASSERT_EQUAL_UINT32(0UL, report.sample_period_us);
+
+    //without any gyroscope rate, the single sample is held beyond it
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Init(&state, &config));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Push_Quaternion(&state, expected, 10000ULL));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Quaternion(&state, 30000ULL, q));
+    TEST_ASSERT_TRUE(Test_Angle_Deg(expected, q) < 0.01);
+
+    //with external fusion, the QUA channel of the frames is ignored
+    config.external_fusion = 1U;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Init(&state, &config));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Update(&state, &frame));
+    TEST_ASSERT_EQUAL_INT(ERROR, PRED_Get_Quaternion(&state, 10000ULL, q));
+}
+
+static void test_slerp_between_samples(void) {
+    static PRED_State_t state;
+    PRED_Config_t       config = {.external_fusion = 1U};
+    PRED_Report_t       report;
+    float               a[4];
+    float               b[4];
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Init(&state, &config));
+    Test_Axis_Quat(2U, 0.0, a);
+    Test_Axis_Quat(2U, 60.0, b);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Push_Quaternion(&state, a, 1000ULL));
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Push_Quaternion(&state, b, 11000ULL));
+
+    //0, 0.5 and 1 of the interval, and a time before it, which is clamped to its start
+    static const struct {
+        uint64_t time_us;
+        double   angle;
+    } cases[] = {
+        {  1000ULL,  0.0},
+        {  6000ULL, 30.0},
+        { 11000ULL, 60.0},
+        {   500ULL,  0.0}
+    };
+    for (uint8_t c = 0U; c < 4U; c++) {
+        float q[4];
+        float expected[4];
+        Test_Axis_Quat(2U, cases[c].angle, expected);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Quaternion(&state, cases[c].time_us, q));
+        TEST_ASSERT_TRUE(Test_Angle_Deg(expected, q) < 0.01);
+    }
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Report(&state, &report));
+    TEST_ASSERT_EQUAL_UINT32(4UL, report.interpolation_count);
+    TEST_ASSERT_EQUAL_UINT32(0UL, report.prediction_count);
+    TEST_ASSERT_EQUAL_UINT32(10000UL, report.sample_period_us);
+}
+
+static void test_gyro_extrapolation(void) {
+    static PRED_State_t state;
+    PRED_Config_t       config = {0};
+    PRED_Report_t       report;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Init(&state, &config));
+
+    //headed 90 degrees about z, turning at 100 dps about the sensor x axis
+    float       start[4];
+    IMU_Frame_t frame = {0};
+    Test_Axis_Quat(2U, 90.0, start);
+    Test_Set_QUA(&frame, start, 20000ULL);
+    frame.data[IMU_CHANNEL_GYR][0] = (int16_t) (100.0f * BNO_GYR_DPS);
+    frame.updated_mask            |= (uint16_t) (1U << IMU_CHANNEL_GYR);
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Update(&state, &frame));
+
+    //the rate is in the sensor frame, so the turn applies after the heading: 3 degrees over
+    //30 ms, and 5 degrees once the 80 ms horizon is clamped to the default 50 ms
+    static const struct {
+        uint64_t time_us;
+        double   angle;
+    } cases[] = {
+        { 50000ULL, 3.0},
+        {100000ULL, 5.0}
+    };
+    for (uint8_t c = 0U; c < 2U; c++) {
+        float q[4];
+        float turn[4];
+        float expected[4];
+        Test_Axis_Quat(0U, cases[c].angle, turn);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, ORIENT_Quat_Multiply(start, turn, expected));
+        TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Quaternion(&state, cases[c].time_us, q));
+        char message[64];
+        snprintf(message, sizeof(message), "%.1f deg: %.4f deg off",
+                 cases[c].angle, Test_Angle_Deg(expected, q));
+        TEST_ASSERT_TRUE_MESSAGE(Test_Angle_Deg(expected, q) < 0.01, message);
+    }
+    TEST_ASSERT_EQUAL_INT(SUCCESS, PRED_Get_Report(&state, &report));
+    TEST_ASSERT_EQUAL_UINT32(2UL, report.prediction_count);
+    TEST_ASSERT_EQUAL_UINT32(1UL, report.clamp_count);
+    TEST_ASSERT_EQUAL_UINT32(PRED_HORIZON_US_DEFAULT, report.horizon_last_us);
+    TEST_ASSERT_EQUAL_UINT32(80000UL, report.age_last_us);
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_and_single_history);
+    RUN_TEST(test_slerp_between_samples);
+    RUN_TEST(test_gyro_extrapolation);
+    return UNITY_END();
+}
@@ -0,0 +1,218 @@
+/**
+ * @file    test_spectrum.c
+ * @brief   Vibration Spectrum Analyser Tests
+ * @details This source file checks the vibration spectrum analyser on the host: the amplitude
+ *          spectrum of random data against a direct DFT, the frequency and amplitude of the peaks
+ *          of tones between bins, and the handling of duplicate samples and invalid settings. The
+ *          DWT cycle counter is replaced with a counter of calls.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/spectrum/spectrum.c"
+
+#define TEST_SEED                   0xC2B2AE35UL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+static uint32_t test_cycles = 0UL;
+
+/**
+ * @brief  Stands in for the DWT cycle counter, advancing by 1000 cycles per call
+ * @param  cycles: Pointer to a variable used to store the cycle count
+ * @retval Status indicating success
+ */
+Status DWT_Get_Cycles(uint32_t *cycles) {
+    test_cycles += 1000UL;
+    *cycles      = test_cycles;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Sets the accelerometer values and sample time of a frame at 100 Hz
+ * @param  frame:  Pointer to the frame
+ * @param  n:      Index of the sample
+ * @param  values: Values of the three axes
+ * @retval None
+ */
+static void Test_Frame_ACC(IMU_Frame_t *frame, uint32_t n, const int16_t values[3]) {
+    memset(frame, 0, sizeof(IMU_Frame_t));
+    frame->updated_mask = (1U << IMU_CHANNEL_ACC);
+    frame->sample_us    = (2000000ULL + (10000ULL * n));
+    for (uint8_t j = 0U; j < 3U; j++) {
+        frame->data[IMU_CHANNEL_ACC][j] = values[j];
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_matches_direct_dft(void) {
+    SPEC_Config_t config = {.points = 256U, .window = SPEC_WINDOW_RECTANGULAR};
+    static SPEC_State_t spec_state;
+    SPEC_State_t        *state = &spec_state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Init(state, &config));
+
+    //random data, of which the mean is removed before the transform
+    static int16_t data[256][3];
+    uint8_t        ready = 0U;
+    for (uint16_t n = 0U; n < 256U; n++) {
+        for (uint8_t j = 0U; j < 3U; j++) {
+            data[n][j] = (int16_t) ((int32_t) (Test_Random() % 4001U) - 2000 + (j * 500));
+        }
+        IMU_Frame_t frame;
+        Test_Frame_ACC(&frame, n, data[n]);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Push(state, &frame, &ready));
+        TEST_ASSERT_EQUAL_UINT8((n == 255U), ready);
+    }
+
+    //the single-sided amplitude of bin k is 2 |X[k]| / N, and that of the DC bin |X[0]| / N
+    for (uint8_t axis = 0U; axis < SPEC_AXES; axis++) {
+        const float *magnitude = NULL;
+        uint16_t    bins       = 0U;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Get_Magnitude(state, axis, &magnitude, &bins));
+        TEST_ASSERT_EQUAL_UINT16(129U, bins);
+
+        double mean = 0.0;
+        for (uint16_t n = 0U; n < 256U; n++) {
+            mean += data[n][axis];
+        }
+        mean /= 256.0;
+        for (uint16_t k = 0U; k < bins; k++) {
+            double re = 0.0;
+            double im = 0.0;
+            for (uint16_t n = 0U; n < 256U; n++) {
+                double phase = ((2.0 * M_PI * k * n) / 256.0);
+                re += ((data[n][axis] - mean) * cos(phase));
+                im -= ((data[n][axis] - mean) * sin(phase));
+            }
+            double scale = ((k == 0U) || (k == 128U)) ? (1.0 / 256.0) : (2.0 / 256.0);
+            TEST_ASSERT_FLOAT_WITHIN(0.05f, (float) (sqrt((re * re) + (im * im)) * scale),
+                                     magnitude[k]);
+        }
+    }
+}
+
+static void test_peaks_of_tones_between_bins(void) {
+    SPEC_Config_t config = {.points = 512U};
+    static SPEC_State_t spec_state;
+    SPEC_State_t        *state = &spec_state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Init(state, &config));
+
+    //tones of 1000 LSB at 12.34 Hz and 400 LSB at 31.7 Hz on gravity, with the bins 0.195 Hz apart
+    uint8_t ready = 0U;
+    for (uint16_t n = 0U; n < 512U; n++) {
+        float   t         = ((float) n / 100.0f);
+        int16_t values[3] = {
+            (int16_t) lrintf(1000.0f * sinf(2.0f * SPEC_PI * 12.34f * t)),
+            (int16_t) lrintf((1000.0f * sinf(2.0f * SPEC_PI * 12.34f * t))
+                           + (400.0f * cosf(2.0f * SPEC_PI * 31.7f * t))),
+            (int16_t) (8192 + (int16_t) ((int32_t) (Test_Random() % 5U) - 2))
+        };
+        IMU_Frame_t frame;
+        Test_Frame_ACC(&frame, n, values);
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Push(state, &frame, &ready));
+    }
+    TEST_ASSERT_EQUAL_UINT8(1U, ready);
+
+    SPEC_Report_t report;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Get_Report(state, &report));
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-3f, 100.0f, report.sample_rate_hz);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-4f, (100.0f / 512.0f), report.resolution_hz);
+    TEST_ASSERT_EQUAL_UINT32(1000UL, report.cycles_last);
+
+    //the parabolic interpolation places the peaks within a tenth of a bin, but only partly corrects
+    //the scalloping loss of the Hann window, which leaves the amplitudes within 4 %
+    SPEC_Peak_t peaks[SPEC_PEAKS_MAX];
+    uint8_t     count = 0U;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Get_Peaks(state, 0U, peaks, &count));
+    TEST_ASSERT_TRUE(count >= 1U);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * report.resolution_hz, 12.34f, peaks[0].frequency_hz);
+    TEST_ASSERT_FLOAT_WITHIN(40.0f, 1000.0f, peaks[0].amplitude);
+
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Get_Peaks(state, 1U, peaks, &count));
+    TEST_ASSERT_TRUE(count >= 2U);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * report.resolution_hz, 12.34f, peaks[0].frequency_hz);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * report.resolution_hz, 31.7f, peaks[1].frequency_hz);
+    TEST_ASSERT_FLOAT_WITHIN(16.0f, 400.0f, peaks[1].amplitude);
+
+    char message[64];
+    snprintf(message, sizeof(message), "peaks %.3f Hz %.1f, %.3f Hz %.1f",
+             (double) peaks[0].frequency_hz, (double) peaks[0].amplitude,
+             (double) peaks[1].frequency_hz, (double) peaks[1].amplitude);
+    TEST_MESSAGE(message);
+
+    //the noise of the gravity axis stays far below the tones
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Get_Peaks(state, 2U, peaks, &count));
+    TEST_ASSERT_TRUE((count == 0U) || (peaks[0].amplitude < 5.0f));
+}
+
+static void test_skips_duplicates(void) {
+    SPEC_Config_t config = {.points = SPEC_POINTS_MIN};
+    static SPEC_State_t spec_state;
+    SPEC_State_t        *state = &spec_state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Init(state, &config));
+
+    //nothing is available before the first block
+    SPEC_Peak_t peaks[SPEC_PEAKS_MAX];
+    uint8_t     count = 0U;
+    TEST_ASSERT_EQUAL_INT(ERROR, SPEC_Get_Peaks(state, 0U, peaks, &count));
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPEC_Get_Peaks(state, SPEC_AXES, peaks, &count));
+
+    //every other frame is a duplicate, so the block takes twice as many frames
+    uint8_t  ready  = 0U;
+    uint16_t frames = 0U;
+    while (!ready) {
+        int16_t     values[3] = {(int16_t) frames, 0, 0};
+        IMU_Frame_t frame;
+        Test_Frame_ACC(&frame, frames, values);
+        frame.duplicate_mask = (frames & 1U) ? (1U << IMU_CHANNEL_ACC) : 0U;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Push(state, &frame, &ready));
+        frames++;
+    }
+    TEST_ASSERT_EQUAL_UINT16((2U * SPEC_POINTS_MIN) - 1U, frames);
+
+    SPEC_Report_t report;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Get_Report(state, &report));
+    TEST_ASSERT_EQUAL_UINT32(1UL, report.block_count);
+    TEST_ASSERT_EQUAL_UINT32(SPEC_POINTS_MIN - 1U, report.duplicate_count);
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-3f, 50.0f, report.sample_rate_hz);
+}
+
+static void test_init_rejects_invalid_settings(void) {
+    static SPEC_State_t spec_state;
+    SPEC_Config_t       config = {.points = 384U};
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPEC_Init(&spec_state, &config));
+    config.points = (SPEC_POINTS_MIN / 2U);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPEC_Init(&spec_state, &config));
+    config.points = (SPEC_POINTS_MAX * 2U);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPEC_Init(&spec_state, &config));
+    config.points     = SPEC_POINTS_MAX;
+    config.peak_count = (SPEC_PEAKS_MAX + 1U);
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, SPEC_Init(&spec_state, &config));
+    config.peak_count = 0U;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, SPEC_Init(&spec_state, &config));
+    TEST_ASSERT_EQUAL_UINT8(SPEC_PEAKS_DEFAULT, spec_state.config.peak_count);
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_direct_dft);
+    RUN_TEST(test_peaks_of_tones_between_bins);
+    RUN_TEST(test_skips_duplicates);
+    RUN_TEST(test_init_rejects_invalid_settings);
+    return UNITY_END();
+}
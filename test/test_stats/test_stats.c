@@ -0,0 +1,180 @@
+/**
+ * @file    test_stats.c
+ * @brief   Windowed Channel Statistics Tests
+ * @details This source file checks the windowed statistics on the host against a direct
+ *          computation over the samples of each window, for overlapping windows of random data,
+ *          and checks that duplicate samples are skipped and overflows are counted.
+ */
+
+
+#include <unity.h>
+#include "../../lib/utils/utils.c"
+#include "../../lib/utils/fmt.c"
+#include "../../lib/imu/stats/stats.c"
+
+#define TEST_SEED                   0x85EBCA6BUL
+#include "../test_common.h"
+
+
+/**************************************************************************************************/
+/*                                         Helper Functions                                       */
+/**************************************************************************************************/
+
+#define TEST_SAMPLES        1000U
+
+static int16_t  test_data[TEST_SAMPLES][3];
+static uint64_t test_time_us[TEST_SAMPLES];
+
+/**
+ * @brief  Checks a summary against the samples stamped within its window
+ * @param  summary:   Pointer to the summary
+ * @param  window_us: Length of the window
+ * @param  pushed:    Number of samples pushed before the summary was latched
+ * @retval None
+ */
+static void Test_Summary_Matches(
+    const STATS_Summary_t *summary,
+    uint32_t              window_us,
+    uint16_t              pushed
+) {
+    double   sum       = 0.0;
+    double   sum_sq[3] = {0.0};
+    double   mean[3]   = {0.0};
+    int16_t  min[3]    = {INT16_MAX, INT16_MAX, INT16_MAX};
+    int16_t  max[3]    = {INT16_MIN, INT16_MIN, INT16_MIN};
+    uint16_t count     = 0U;
+    for (uint16_t n = 0U; n < pushed; n++) {
+        if ((test_time_us[n] + window_us) <= summary->end_us) {
+            continue;
+        }
+        count++;
+        for (uint8_t i = 0U; i < 3U; i++) {
+            mean[i] += test_data[n][i];
+            min[i]   = (test_data[n][i] < min[i]) ? test_data[n][i] : min[i];
+            max[i]   = (test_data[n][i] > max[i]) ? test_data[n][i] : max[i];
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(count, summary->count);
+    for (uint8_t i = 0U; i < 3U; i++) {
+        mean[i] /= count;
+        sum      = 0.0;
+        for (uint16_t n = 0U; n < pushed; n++) {
+            if ((test_time_us[n] + window_us) > summary->end_us) {
+                sum       += ((test_data[n][i] - mean[i]) * (test_data[n][i] - mean[i]));
+                sum_sq[i] += ((double) test_data[n][i] * test_data[n][i]);
+            }
+        }
+        TEST_ASSERT_EQUAL_FLOAT((float) min[i], summary->min[i]);
+        TEST_ASSERT_EQUAL_FLOAT((float) max[i], summary->max[i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, (float) mean[i], summary->mean[i]);
+        TEST_ASSERT_FLOAT_WITHIN(2.0e-3f * (float) (sum / (count - 1U)),
+                                 (float) (sum / (count - 1U)), summary->variance[i]);
+        TEST_ASSERT_FLOAT_WITHIN(1.0e-3f * (float) sqrt(sum_sq[i] / count),
+                                 (float) sqrt(sum_sq[i] / count), summary->rms[i]);
+    }
+}
+
+
+/**************************************************************************************************/
+/*                                              Tests                                             */
+/**************************************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_overlapping_windows_match(void) {
+    STATS_Config_t config = {
+        .channel_mask = (1U << IMU_CHANNEL_ACC),
+        .window_us    = 1000000UL,
+        .hop_us       = 250000UL
+    };
+    static STATS_State_t stats_state;
+    STATS_State_t        *state = &stats_state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Init(state, &config));
+
+    //random walk around an offset at 100 Hz, with jittered sample times
+    int16_t  value[3]  = {1000, -2000, 9800};
+    uint32_t summaries = 0UL;
+    for (uint16_t n = 0U; n < TEST_SAMPLES; n++) {
+        IMU_Frame_t frame = {0};
+        for (uint8_t i = 0U; i < 3U; i++) {
+            value[i] = (int16_t) (value[i] + (int16_t) (Test_Random() % 201U) - 100);
+            test_data[n][i] = value[i];
+            frame.data[IMU_CHANNEL_ACC][i] = value[i];
+        }
+        test_time_us[n]    = (5000ULL + (10000ULL * n) + (Test_Random() % 3000U));
+        frame.sample_us    = test_time_us[n];
+        frame.updated_mask = (1U << IMU_CHANNEL_ACC);
+
+        //a summary is latched before the samples of the frame closing its window are added
+        uint8_t ready = 0U;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Push(state, &frame, &ready));
+        if (ready) {
+            STATS_Summary_t summary;
+            TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Get_Summary(state, 0U, &summary));
+            TEST_ASSERT_EQUAL_UINT64(0ULL, summary.end_us % config.hop_us);
+            TEST_ASSERT_TRUE(summary.end_us <= frame.sample_us);
+            if (summary.end_us >= config.window_us) {
+                Test_Summary_Matches(&summary, config.window_us, n);
+            }
+            summaries++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(summaries, state->summary_count);
+    TEST_ASSERT_TRUE(summaries >= 39UL);
+    TEST_ASSERT_EQUAL_UINT32(0UL, state->channels[0].overflow_count);
+}
+
+static void test_duplicates_and_overflow(void) {
+    STATS_Config_t config = {
+        .channel_mask = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_TEMP)),
+        .window_us    = 1000000UL
+    };
+    static STATS_State_t stats_state;
+    STATS_State_t        *state = &stats_state;
+    TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Init(state, &config));
+
+    //nothing is summarised before the first boundary
+    STATS_Summary_t summary;
+    TEST_ASSERT_EQUAL_INT(ERROR, STATS_Get_Summary(state, 0U, &summary));
+    TEST_ASSERT_EQUAL_INT(INVALID_PARAM, STATS_Get_Summary(state, 2U, &summary));
+
+    //ACC at 200 Hz overflows the held samples, TEMP is every other frame a duplicate of 1000
+    uint8_t ready = 0U;
+    for (uint16_t n = 0U; n <= 300U; n++) {
+        IMU_Frame_t frame = {0};
+        frame.sample_us                 = (500000ULL + (5000ULL * n));
+        frame.updated_mask              = ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_TEMP));
+        frame.duplicate_mask            = (n & 1U) ? (1U << IMU_CHANNEL_TEMP) : 0U;
+        frame.data[IMU_CHANNEL_ACC][0]  = (int16_t) n;
+        frame.data[IMU_CHANNEL_TEMP][0] = (n & 1U) ? 1000 : 25;
+        TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Push(state, &frame, &ready));
+    }
+    TEST_ASSERT_EQUAL_UINT8(1U, ready);
+
+    //the frame at 2 s closes the window from 1 s, which held the latest STATS_SAMPLES_MAX of its
+    //199 ACC samples, and 99 TEMP samples
+    TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Get_Summary(state, 0U, &summary));
+    TEST_ASSERT_EQUAL_INT(IMU_CHANNEL_ACC, summary.channel);
+    TEST_ASSERT_TRUE(summary.end_us == 2000000ULL);
+    TEST_ASSERT_EQUAL_UINT16(STATS_SAMPLES_MAX, summary.count);
+    TEST_ASSERT_EQUAL_FLOAT(299.0f, summary.max[0]);
+    TEST_ASSERT_EQUAL_FLOAT((float) (300U - STATS_SAMPLES_MAX), summary.min[0]);
+    TEST_ASSERT_TRUE(state->channels[0].overflow_count > 0UL);
+
+    TEST_ASSERT_EQUAL_INT(SUCCESS, STATS_Get_Summary(state, 1U, &summary));
+    TEST_ASSERT_EQUAL_INT(IMU_CHANNEL_TEMP, summary.channel);
+    TEST_ASSERT_EQUAL_UINT8(1U, summary.values);
+    TEST_ASSERT_EQUAL_UINT16(99U, summary.count);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, summary.max[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, summary.variance[0]);
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_overlapping_windows_match);
+    RUN_TEST(test_duplicates_and_overflow);
+    return UNITY_END();
+}
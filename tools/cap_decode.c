@@ -0,0 +1,152 @@
+/**
+ * @file    cap_decode.c
+ * @brief   Host Decoder for the Capture Blocks
+ * @details This host program reads the terminal log of the application from stdin, decodes the
+ *          base64 blocks of the CAP lines with the delta frame codec, and writes one CSV row per
+ *          captured frame to stdout:
+ *          - Trigger (HG or AM) and offset of the frame from the trigger, in frames
+ *          - Sample time in micro-seconds
+ *          - Raw ACC, MAG and GYR values, with empty fields for channels not updated in the frame
+ *
+ *          The compression ratio and the frames lost or skipped before a key frame are written to
+ *          stderr once the log has been read.
+ *
+ * @note    Build on the host from the repository root with:
+ *          gcc -std=gnu11 -fcommon -Iinclude tools/cap_decode.c lib/imu/codec/codec.c \
+ *              lib/utils/utils.c lib/utils/fmt.c -lm -o cap_decode
+ * @note    The channels must match the codec_config of main.c
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "../lib/imu/codec/codec.h"
+
+
+#define DECODE_LINE_MAX             1024U
+#define DECODE_CHANNEL_MASK         ((1U << IMU_CHANNEL_ACC) | (1U << IMU_CHANNEL_MAG) \
+                                    | (1U << IMU_CHANNEL_GYR))
+
+
+/**
+ * @brief  Gets the value of a base64 character
+ * @param  c: Character
+ * @retval Value (0 - 63), or -1 if the character is not in the alphabet
+ */
+static int Base64_Value(char c) {
+    if ((c >= 'A') && (c <= 'Z')) return (c - 'A');
+    if ((c >= 'a') && (c <= 'z')) return (c - 'a' + 26);
+    if ((c >= '0') && (c <= '9')) return (c - '0' + 52);
+    if (c == '+')                 return 62;
+    if (c == '/')                 return 63;
+    return -1;
+}
+
+/**
+ * @brief  Decodes base64 text, stopping at the first character outside the alphabet
+ * @param  text:     Pointer to the text
+ * @param  data:     Pointer to the buffer used to store the bytes
+ * @param  capacity: Size of the buffer in bytes
+ * @retval Number of bytes decoded
+ */
+static uint16_t Base64_Decode(const char *text, uint8_t *data, uint16_t capacity) {
+    uint16_t length = 0U;
+    uint32_t bits   = 0UL;
+    uint8_t  count  = 0U;
+
+    for (; *text != '\0'; text++) {
+        int value = Base64_Value(*text);
+        if (value < 0) {
+            break;
+        }
+        bits = ((bits << 6) | (uint32_t) value);
+        if (++count == 4U) {
+            for (int8_t shift = 16; (shift >= 0) && (length < capacity); shift -= 8) {
+                data[length++] = (uint8_t) (bits >> shift);
+            }
+            bits  = 0UL;
+            count = 0U;
+        }
+    }
+
+    //a padded group carries one byte per 2 characters and two per 3
+    if ((count >= 2U) && (length < capacity)) {
+        bits <<= (6U * (4U - count));
+        data[length++] = (uint8_t) (bits >> 16);
+        if ((count == 3U) && (length < capacity)) {
+            data[length++] = (uint8_t) (bits >> 8);
+        }
+    }
+
+    return length;
+}
+
+
+int main(void) {
+    CODEC_Config_t codec_config = {
+        .channel_mask = DECODE_CHANNEL_MASK
+    };
+    CODEC_State_t codec_state;
+    if (CODEC_Init(&codec_state, &codec_config) != SUCCESS) {
+        return 1;
+    }
+
+    static const IMU_Channel channels[] = {IMU_CHANNEL_ACC, IMU_CHANNEL_MAG, IMU_CHANNEL_GYR};
+    printf("trigger,offset,sample_us,acc_x,acc_y,acc_z,mag_x,mag_y,mag_z,gyr_x,gyr_y,gyr_z\n");
+
+    char     line[DECODE_LINE_MAX];
+    uint8_t  block[DECODE_LINE_MAX];
+    uint32_t error_count = 0UL;
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        //CAP -> <trigger> <offset> | <base64>, where lines end with "\n\r"
+        const char *record    = strstr(line, "CAP -> ");
+        char       trigger[3] = {0};
+        int        offset     = 0;
+        int        text_start = 0;
+        if ((record == NULL)
+        ||  (sscanf(record, "CAP -> %2s %d | %n", trigger, &offset, &text_start) != 2)) {
+            continue;
+        }
+        uint16_t length = Base64_Decode(&record[text_start], block, sizeof(block));
+
+        uint16_t index = 0U;
+        while (index < length) {
+            IMU_Frame_t frame;
+            uint16_t    consumed = 0U;
+            if (CODEC_Decode(&codec_state, &block[index], (uint16_t) (length - index), &consumed,
+                             &frame) != SUCCESS) {
+                error_count++;
+                break;
+            }
+            index += consumed;
+            if (frame.updated_mask != 0U) {
+                printf("%s,%d,%llu", trigger, offset, (unsigned long long) frame.sample_us);
+                for (uint8_t i = 0U; i < 3U; i++) {
+                    uint8_t updated = ((frame.updated_mask >> channels[i]) & 1U);
+                    for (uint8_t j = 0U; j < 3U; j++) {
+                        if (updated) {
+                            printf(",%d", frame.data[channels[i]][j]);
+                        } else {
+                            printf(",");
+                        }
+                    }
+                }
+                printf("\n");
+            }
+            offset++;
+        }
+    }
+
+    CODEC_Report_t codec_report;
+    CODEC_Get_Report(&codec_state, &codec_report);
+    fprintf(stderr, "frames %lu | values %lu | %lu/%lu B (ratio %.2f) | key %lu | lost %lu"
+                    " | skipped %lu | errors %lu\n",
+            (unsigned long) codec_report.frame_count, (unsigned long) codec_report.sample_count,
+            (unsigned long) codec_report.raw_bytes, (unsigned long) codec_report.coded_bytes,
+            (codec_report.coded_bytes == 0UL) ? 0.0
+            : ((double) codec_report.raw_bytes / (double) codec_report.coded_bytes),
+            (unsigned long) codec_report.key_count, (unsigned long) codec_report.lost_count,
+            (unsigned long) codec_report.skipped_count, (unsigned long) error_count);
+
+    return 0;
+}
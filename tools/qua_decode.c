@@ -0,0 +1,59 @@
+/**
+ * @file    qua_decode.c
+ * @brief   Host Decoder for the Packed Orientation
+ * @details This host program reads the terminal log of the application from stdin, unpacks the
+ *          smallest-three quaternions of the QUA lines, and writes one CSV row per quaternion to
+ *          stdout, with the sample time of the TS line of its output frame and the unit
+ *          quaternion (w, x, y, z), whose largest component is positive.
+ *
+ * @note    Build on the host from the repository root with:
+ *          gcc -std=gnu11 -fcommon -Iinclude tools/qua_decode.c lib/imu/orient/orient.c \
+ *              lib/utils/utils.c lib/utils/fmt.c -lm -o qua_decode
+ * @note    The bits per component must match the ORIENT_Quat_Pack() call of main.c
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "../lib/imu/orient/orient.h"
+
+
+#define DECODE_LINE_MAX             1024U
+#define DECODE_PACK_BITS            ORIENT_PACK_BITS_MAX
+
+
+int main(void) {
+    printf("sample_us,w,x,y,z\n");
+
+    char               line[DECODE_LINE_MAX];
+    unsigned long long sample_us   = 0ULL;
+    uint32_t           qua_count   = 0UL;
+    uint32_t           error_count = 0UL;
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        //TS -> <sample time> us | ... precedes the records of each output frame
+        const char *record = strstr(line, "TS -> ");
+        if (record != NULL) {
+            sscanf(record, "TS -> %llu", &sample_us);
+            continue;
+        }
+
+        //QUA -> <packed>, where lines end with "\n\r"
+        unsigned long packed = 0UL;
+        record = strstr(line, "QUA -> ");
+        if ((record == NULL) || (sscanf(record, "QUA -> %lu", &packed) != 1)) {
+            continue;
+        }
+        float q[4];
+        if (ORIENT_Quat_Unpack((uint32_t) packed, DECODE_PACK_BITS, q) != SUCCESS) {
+            error_count++;
+            continue;
+        }
+        printf("%llu,%.6f,%.6f,%.6f,%.6f\n", sample_us, q[0], q[1], q[2], q[3]);
+        qua_count++;
+    }
+
+    fprintf(stderr, "quaternions %lu | errors %lu\n",
+            (unsigned long) qua_count, (unsigned long) error_count);
+
+    return 0;
+}